@@ -31,6 +31,14 @@
 @required
 /// @brief The value of this property is set before the command is executed.
 @property(nonatomic, assign) id<AsynchronousCommandDelegate> asynchronousCommandDelegate;
+@optional
+/// @brief Is true if the user may cancel the command while it is executed.
+///
+/// A command should be cancellable only if it does not change the state of
+/// the GTP engine, i.e. if all GTP commands that it submits are cancellable
+/// (see GtpCommand::cancellable). A command that does not implement this
+/// property is not cancellable.
+@property(nonatomic, assign, readonly) bool cancellable;
 @end
 
 // -----------------------------------------------------------------------------
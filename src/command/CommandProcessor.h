@@ -54,6 +54,25 @@
 /// the command into the HUD. Progress updates are delivered via the
 /// AsynchronousCommandDelegate protocol.
 ///
+///
+/// @par Cancellation
+///
+/// While CommandProcessor executes an asynchronous command it binds a
+/// GtpCancellationToken to the command execution secondary thread. All GTP
+/// commands that the command submits, and all GTP commands submitted by
+/// commands that it submits in turn, carry this token. When
+/// cancelAsynchronousCommand() is invoked, CommandProcessor cancels the token.
+/// This abandons the cancellable GTP commands that are still outstanding, and
+/// completes cancellable GTP commands that are submitted later immediately
+/// with a failure response. GTP commands that change the state of the GTP
+/// engine are not cancellable (see GtpCommand::cancellable), they are still
+/// processed so that the engine remains in sync with the application. The
+/// asynchronous command itself keeps running until its doIt() method returns.
+///
+/// The progress HUD offers the user to cancel the asynchronous command by
+/// tapping the HUD only if the command is cancellable (see
+/// AsynchronousCommand::cancellable).
+///
 /// @see submitCommand:()
 // -----------------------------------------------------------------------------
 @interface CommandProcessor : NSObject <AsynchronousCommandDelegate, MBProgressHUDDelegate>
@@ -63,6 +82,7 @@
 + (CommandProcessor*) sharedProcessor;
 + (void) releaseSharedProcessor;
 - (bool) submitCommand:(id<Command>)command;
+- (void) cancelAsynchronousCommand;
 // TODO implement undo functionality discussed in the class documentation
 // - (void) undoCommand;
 
@@ -18,6 +18,7 @@
 // Project includes
 #import "CommandProcessor.h"
 #import "Command.h"
+#import "../gtp/GtpCancellationToken.h"
 #import "../main/ApplicationDelegate.h"
 
 
@@ -27,6 +28,11 @@
 @interface CommandProcessor()
 @property(nonatomic, retain) NSThread* thread;
 @property(nonatomic, retain) MBProgressHUD* progressHUD;
+/// @brief The token that is bound to the command execution secondary thread
+/// while an asynchronous command is executed. Is nil if no asynchronous
+/// command is being executed. Is accessed both by the main thread and by the
+/// command execution secondary thread, therefore the property is atomic.
+@property(retain) GtpCancellationToken* asynchronousCommandCancellationToken;
 @end
 
 
@@ -73,6 +79,7 @@ static CommandProcessor* sharedProcessor = nil;
     return nil;
   [self setupThread];
   self.progressHUD = nil;
+  self.asynchronousCommandCancellationToken = nil;
   return self;
 }
 
@@ -82,6 +89,7 @@ static CommandProcessor* sharedProcessor = nil;
 - (void) dealloc
 {
   self.progressHUD = nil;
+  self.asynchronousCommandCancellationToken = nil;
   self.thread = nil;
   if (sharedProcessor == self)
     sharedProcessor = nil;
@@ -174,11 +182,21 @@ static CommandProcessor* sharedProcessor = nil;
 /// @brief Initializes the HUD, then submits @a command to the command execution
 /// secondary thread. Returns immediately before command execution begins.
 ///
+/// The HUD offers the user to cancel @a command only if @a command is
+/// cancellable.
+///
 /// This helper method can be executed in arbitrary thread contexts (except for
 /// the context of the command execution secondary thread).
 // -----------------------------------------------------------------------------
 - (void) submitAsynchronousCommand:(id<Command>)command
 {
+  id<AsynchronousCommand> asynchronousCommand = (id<AsynchronousCommand>)command;
+  if ([asynchronousCommand respondsToSelector:@selector(cancellable)] && asynchronousCommand.cancellable)
+  {
+    self.progressHUD.detailsLabelText = @"Tap to cancel";
+    UITapGestureRecognizer* tapRecognizer = [[[UITapGestureRecognizer alloc] initWithTarget:self action:@selector(handleTapFrom:)] autorelease];
+    [self.progressHUD addGestureRecognizer:tapRecognizer];
+  }
   BOOL animated = YES;
   [self.progressHUD show:animated];
 
@@ -194,6 +212,10 @@ static CommandProcessor* sharedProcessor = nil;
 // -----------------------------------------------------------------------------
 /// @brief Invokes executeCommand:() to execute the asynchronous @a command.
 ///
+/// Binds a new GtpCancellationToken to the current thread while @a command is
+/// executed, so that all GTP commands that are submitted on behalf of
+/// @a command can be cancelled together (see cancelAsynchronousCommand()).
+///
 /// This helper method is always executed in the command execution secondary
 /// thread.
 // -----------------------------------------------------------------------------
@@ -202,7 +224,18 @@ static CommandProcessor* sharedProcessor = nil;
   // Undo retain message sent to the command object by
   // submitAsynchronousCommand:()
   [command autorelease];
-  [self executeCommand:command];
+  GtpCancellationToken* cancellationToken = [GtpCancellationToken token];
+  self.asynchronousCommandCancellationToken = cancellationToken;
+  [GtpCancellationToken setCurrentToken:cancellationToken];
+  @try
+  {
+    [self executeCommand:command];
+  }
+  @finally
+  {
+    [GtpCancellationToken setCurrentToken:nil];
+    self.asynchronousCommandCancellationToken = nil;
+  }
   [self performSelectorOnMainThread:@selector(hideProgressHUDOnMainThread) withObject:nil waitUntilDone:YES];
 }
 
@@ -251,6 +284,40 @@ static CommandProcessor* sharedProcessor = nil;
   return result;
 }
 
+// -----------------------------------------------------------------------------
+/// @brief Cancels the cancellable GTP commands that the asynchronous command
+/// that is currently being executed has submitted, or will submit. Does
+/// nothing if no asynchronous command is being executed.
+///
+/// The asynchronous command itself is not stopped, but because the GTP
+/// commands it is waiting for are abandoned, it usually ends soon.
+///
+/// This method can be executed in arbitrary thread contexts.
+// -----------------------------------------------------------------------------
+- (void) cancelAsynchronousCommand
+{
+  GtpCancellationToken* cancellationToken = self.asynchronousCommandCancellationToken;
+  if (! cancellationToken)
+    return;
+  DDLogInfo(@"%@: Cancelling asynchronous command", self);
+  [cancellationToken cancel];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Reacts to the user tapping the progress HUD that is displayed while
+/// an asynchronous command is executed. Cancels the command.
+///
+/// This method is executed in the context of the main thread.
+// -----------------------------------------------------------------------------
+- (void) handleTapFrom:(UITapGestureRecognizer*)gestureRecognizer
+{
+  if (UIGestureRecognizerStateEnded != gestureRecognizer.state)
+    return;
+  MBProgressHUD* progressHUD = (MBProgressHUD*)gestureRecognizer.view;
+  progressHUD.detailsLabelText = @"Cancelling...";
+  [self cancelAsynchronousCommand];
+}
+
 // -----------------------------------------------------------------------------
 /// @brief The command execution secondary thread's main loop method. Returns
 /// only after the @e shouldExit property has been set to true.
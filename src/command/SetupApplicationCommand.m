@@ -81,7 +81,12 @@
 
     // Here we are sending the very first GTP command to the GTP engine. The
     // engine is probably still in the process of setting itself up, so there
-    // will be a delay in executing the command.
+    // will be a delay in executing the command. The command does not wait for
+    // the engine to parse the opening book, so the remaining setup steps can
+    // proceed in the meantime. The command does, however, submit "book_load"
+    // before it returns, so the engine loads the opening book before it
+    // processes any of the GTP commands that the remaining setup steps
+    // submit.
     [[[[LoadOpeningBookCommand alloc] init] autorelease] submit];
     [self increaseProgressAndNotifyDelegate];
 
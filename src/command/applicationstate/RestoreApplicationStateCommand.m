@@ -20,11 +20,8 @@
 #import "../boardposition/SyncGTPEngineCommand.h"
 #import "../game/NewGameCommand.h"
 #import "../playerinfluence/ToggleTerritoryStatisticsCommand.h"
-#import "../../go/GoBoard.h"
 #import "../../go/GoGame.h"
-#import "../../go/GoMove.h"
 #import "../../go/GoScore.h"
-#import "../../go/GoZobristTable.h"
 #import "../../utility/PathUtilities.h"
 
 
@@ -70,8 +67,6 @@
     return false;
   }
 
-  [self calculateZobristHashes:unarchivedGame];
-
   NewGameCommand* command = [[[NewGameCommand alloc] initWithGame:unarchivedGame] autorelease];
   // Computer player must not be triggered before the GTP engine has been
   // sync'ed (it is irrelevant that we are not going to trigger the computer
@@ -135,14 +130,4 @@
   return true;
 }
 
-// -----------------------------------------------------------------------------
-/// Private helper
-// -----------------------------------------------------------------------------
-- (void) calculateZobristHashes:(GoGame*)unarchivedGame
-{
-  GoZobristTable* zobristTable = unarchivedGame.board.zobristTable;
-  for (GoMove* move = unarchivedGame.firstMove; move != nil; move = move.next)
-    move.zobristHash = [zobristTable hashForMove:move];
-}
-
 @end
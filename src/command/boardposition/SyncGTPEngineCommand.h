@@ -38,6 +38,15 @@ enum SyncMoveType
 ///
 /// Optionally SyncGTPEngineCommand may be configured so that it synchronizes
 /// the GTP engine with all moves of the entire game.
+///
+/// If GtpEngineMoveHistory knows which moves the GTP engine currently has on
+/// its board, SyncGTPEngineCommand synchronizes incrementally: It takes back
+/// the engine's moves that follow the last move the engine has in common with
+/// the GoGame ("undo"), then plays the GoGame's remaining moves. Otherwise, or
+/// if the engine's board size, komi or handicap differ from those of the
+/// GoGame, or if this is more expensive than replaying all moves,
+/// SyncGTPEngineCommand sets up the board size and komi, clears the engine's
+/// board, sets up the handicap and replays all moves.
 // -----------------------------------------------------------------------------
 @interface SyncGTPEngineCommand : CommandBase
 {
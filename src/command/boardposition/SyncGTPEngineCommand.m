@@ -17,15 +17,16 @@
 
 // Project includes
 #import "SyncGTPEngineCommand.h"
+#import "../../go/GoBoard.h"
 #import "../../go/GoBoardPosition.h"
 #import "../../go/GoGame.h"
 #import "../../go/GoMove.h"
-#import "../../go/GoMoveModel.h"
-#import "../../go/GoPlayer.h"
-#import "../../go/GoPoint.h"
-#import "../../go/GoVertex.h"
+#import "../../gtp/GtpClient.h"
 #import "../../gtp/GtpCommand.h"
+#import "../../gtp/GtpEngineMoveHistory.h"
 #import "../../gtp/GtpResponse.h"
+#import "../../gtp/GtpUtilities.h"
+#import "../../main/ApplicationDelegate.h"
 
 
 @implementation SyncGTPEngineCommand
@@ -51,6 +52,21 @@
 // -----------------------------------------------------------------------------
 - (bool) doIt
 {
+  NSArray* moveStrings = [self moveStringsToSync];
+  if (! moveStrings)
+  {
+    DDLogError(@"%@: Aborting because moveStringsToSync failed", [self shortDescription]);
+    return false;
+  }
+
+  if ([self syncGTPEngineIncrementally:moveStrings])
+    return true;
+
+  if (! [self syncGTPEngineBoardSizeAndKomi])
+  {
+    DDLogError(@"%@: Aborting because syncGTPEngineBoardSizeAndKomi failed", [self shortDescription]);
+    return false;
+  }
   if (! [self syncGTPEngineClearBoard])
   {
     DDLogError(@"%@: Aborting because syncGTPEngineClearBoard failed", [self shortDescription]);
@@ -62,7 +78,7 @@
     DDLogError(@"%@: Aborting because syncGTPEngineHandicap failed", [self shortDescription]);
     return false;
   }
-  if (! [self syncGTPEngineMoves])
+  if (! [self syncGTPEngineMoves:moveStrings startingAtIndex:0])
   {
     DDLogError(@"%@: Aborting because syncGTPEngineMoves failed", [self shortDescription]);
     return false;
@@ -70,6 +86,96 @@
   return true;
 }
 
+// -----------------------------------------------------------------------------
+/// @brief Private helper for doIt(). Returns true if the GTP engine was
+/// synchronized by undoing and playing only those moves in which the engine's
+/// board differs from @a moveStrings. Returns false if the content of the
+/// engine's board is unknown, if the engine's board size, komi or handicap
+/// differ from those of the GoGame, if a full synchronization is cheaper, or
+/// if one of the GTP commands failed. In all these cases the caller must
+/// perform a full synchronization.
+// -----------------------------------------------------------------------------
+- (bool) syncGTPEngineIncrementally:(NSArray*)moveStrings
+{
+  GoGame* game = [GoGame sharedGame];
+  GtpEngineMoveHistory* engineMoveHistory = [ApplicationDelegate sharedDelegate].gtpClient.engineMoveHistory;
+  NSUInteger numberOfCommonMoves;
+  NSUInteger numberOfMovesToUndo;
+  if (! [engineMoveHistory deltaToBoardSize:game.board.size
+                                       komi:game.komi
+                                   handicap:game.handicapPoints.count
+                                      moves:moveStrings
+                        numberOfCommonMoves:&numberOfCommonMoves
+                        numberOfMovesToUndo:&numberOfMovesToUndo])
+  {
+    return false;
+  }
+
+  if (! [self syncGTPEngineUndoMoves:numberOfMovesToUndo])
+  {
+    DDLogWarn(@"%@: syncGTPEngineUndoMoves failed, falling back to full synchronization", [self shortDescription]);
+    return false;
+  }
+  if (! [self syncGTPEngineMoves:moveStrings startingAtIndex:numberOfCommonMoves])
+  {
+    DDLogWarn(@"%@: syncGTPEngineMoves failed, falling back to full synchronization", [self shortDescription]);
+    return false;
+  }
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Private helper for syncGTPEngineIncrementally:(). Takes back the
+/// last @a numberOfMovesToUndo moves on the GTP engine's board. Returns true
+/// on success, false on failure.
+///
+/// All "undo" commands except the last are submitted without waiting for
+/// their response, so that GtpClient can write them to the engine in a single
+/// burst.
+// -----------------------------------------------------------------------------
+- (bool) syncGTPEngineUndoMoves:(NSUInteger)numberOfMovesToUndo
+{
+  if (0 == numberOfMovesToUndo)
+    return true;
+  NSMutableArray* commandsUndo = [NSMutableArray arrayWithCapacity:numberOfMovesToUndo];
+  for (NSUInteger indexOfUndo = 0; indexOfUndo < numberOfMovesToUndo; ++indexOfUndo)
+  {
+    GtpCommand* commandUndo = [GtpCommand command:@"undo"];
+    commandUndo.waitUntilDone = (indexOfUndo == numberOfMovesToUndo - 1);
+    [commandUndo submit];
+    [commandsUndo addObject:commandUndo];
+  }
+  // Responses arrive in the order in which commands were submitted, so when
+  // the last command has been answered all others have been answered, too
+  for (GtpCommand* commandUndo in commandsUndo)
+  {
+    if (! commandUndo.response.status)
+      return false;
+  }
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Private helper for doIt(). Returns true on success, false on failure.
+///
+/// Usually the GTP engine already has the GoGame's board size and komi, but
+/// this is not known for sure after a full synchronization becomes necessary,
+/// e.g. because the engine loaded a game with "loadsgf".
+// -----------------------------------------------------------------------------
+- (bool) syncGTPEngineBoardSizeAndKomi
+{
+  GoGame* game = [GoGame sharedGame];
+  GtpCommand* commandBoardSize = [GtpCommand command:[NSString stringWithFormat:@"boardsize %d", game.board.size]];
+  [commandBoardSize submit];
+  assert(commandBoardSize.response.status);
+  if (! commandBoardSize.response.status)
+    return false;
+  GtpCommand* commandKomi = [GtpCommand command:[NSString stringWithFormat:@"komi %.1f", game.komi]];
+  [commandKomi submit];
+  assert(commandKomi.response.status);
+  return commandKomi.response.status;
+}
+
 // -----------------------------------------------------------------------------
 /// @brief Private helper for doIt(). Returns true on success, false on failure.
 // -----------------------------------------------------------------------------
@@ -97,47 +203,42 @@
 }
 
 // -----------------------------------------------------------------------------
-/// @brief Private helper for doIt(). Returns true on success, false on failure.
+/// @brief Private helper for doIt() and syncGTPEngineIncrementally:(). Plays
+/// the moves in @a moveStrings that start at index @a indexOfFirstMove.
+/// Returns true on success, false on failure.
 // -----------------------------------------------------------------------------
-- (bool) syncGTPEngineMoves
+- (bool) syncGTPEngineMoves:(NSArray*)moveStrings startingAtIndex:(NSUInteger)indexOfFirstMove
 {
-  GoGame* game = [GoGame sharedGame];
-  GoMove* syncUpToThisMove = nil;
-  if (SyncMovesUpToCurrentBoardPosition == self.syncMoveType)
-    syncUpToThisMove = game.boardPosition.currentMove;
-  else
-    syncUpToThisMove = game.lastMove;
-  if (! syncUpToThisMove)
+  if (indexOfFirstMove >= moveStrings.count)
     return true;
-  NSString* commandString = @"gogui-play_sequence";
-  GoMove* move = game.moveModel.firstMove;
-  while (true)
+  // Each move string has at most 6 characters (e.g. "W PASS"), plus 1
+  // separator character
+  NSString* commandName = @"gogui-play_sequence";
+  NSUInteger numberOfMoves = moveStrings.count - indexOfFirstMove;
+  NSMutableString* commandString = [NSMutableString stringWithCapacity:commandName.length + numberOfMoves * 7];
+  [commandString appendString:commandName];
+  for (NSUInteger indexOfMove = indexOfFirstMove; indexOfMove < moveStrings.count; ++indexOfMove)
   {
-    if (move.player.black)
-      commandString = [commandString stringByAppendingString:@" B "];
-    else
-      commandString = [commandString stringByAppendingString:@" W "];
-    switch (move.type)
-    {
-      case GoMoveTypePlay:
-        commandString = [commandString stringByAppendingString:move.point.vertex.string];
-        break;
-      case GoMoveTypePass:
-        commandString = [commandString stringByAppendingString:@" PASS"];
-        break;
-      default:
-        DDLogError(@"%@: Unexpected move type %d", [self shortDescription], move.type);
-        assert(0);
-        return false;
-    }
-    if (move == syncUpToThisMove)
-      break;
-    move = move.next;
+    [commandString appendString:@" "];
+    [commandString appendString:[moveStrings objectAtIndex:indexOfMove]];
   }
   GtpCommand* commandSetup = [GtpCommand command:commandString];
   [commandSetup submit];
-  assert(commandSetup.response.status);
   return commandSetup.response.status;
 }
 
+// -----------------------------------------------------------------------------
+/// @brief Private helper for doIt(). Returns the moves to synchronize as an
+/// array of strings in the form used by GtpEngineMoveHistory (e.g. "B D4"), or
+/// nil if a move of an unexpected type is found.
+// -----------------------------------------------------------------------------
+- (NSArray*) moveStringsToSync
+{
+  GoGame* game = [GoGame sharedGame];
+  if (SyncMovesUpToCurrentBoardPosition == self.syncMoveType)
+    return [GtpUtilities moveStringsUpToMove:game.boardPosition.currentMove];
+  else
+    return [GtpUtilities moveStringsUpToMove:game.lastMove];
+}
+
 @end
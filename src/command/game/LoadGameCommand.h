@@ -21,6 +21,7 @@
 
 // Forward declarations
 @class GtpCommand;
+@class GtpResponse;
 
 
 // -----------------------------------------------------------------------------
@@ -67,9 +68,9 @@
 {
 @private
   enum GoBoardSize m_boardSize;
-  NSString* m_handicap;
+  GtpResponse* m_handicapResponse;
   NSString* m_komi;
-  NSString* m_moves;
+  GtpResponse* m_movesResponse;
   NSString* m_oldCurrentDirectory;
 }
 
@@ -40,8 +40,6 @@
 #import "../../utility/PathUtilities.h"
 
 
-static const int maxStepsForReplayMoves = 10;
-
 // -----------------------------------------------------------------------------
 /// @brief Class extension with private properties for LoadGameCommand.
 // -----------------------------------------------------------------------------
@@ -74,11 +72,11 @@ static const int maxStepsForReplayMoves = 10;
   self.restoreMode = false;
   self.didTriggerComputerPlayer = false;
   m_boardSize = GoBoardSizeUndefined;
-  m_handicap = nil;
+  m_handicapResponse = nil;
   m_komi = nil;
-  m_moves = nil;
+  m_movesResponse = nil;
   m_oldCurrentDirectory = nil;
-  self.totalSteps = (6 + maxStepsForReplayMoves);  // 6 fixed steps for GTP commands
+  self.totalSteps = (6 + 1);  // 6 fixed steps for GTP commands, 1 step for replaying moves
   self.stepIncrease = 1.0 / self.totalSteps;
   self.progress = 0.0;
 
@@ -101,9 +99,9 @@ static const int maxStepsForReplayMoves = 10;
 - (void) dealloc
 {
   self.filePath = nil;
-  [m_handicap release];
+  [m_handicapResponse release];
   [m_komi release];
-  [m_moves release];
+  [m_movesResponse release];
   [m_oldCurrentDirectory release];
 
   [super dealloc];
@@ -242,6 +240,7 @@ static const int maxStepsForReplayMoves = 10;
   // Use the file *NAME* without the path
   NSString* commandString = [NSString stringWithFormat:@"loadsgf %@", sgfTemporaryFileName];
   GtpCommand* command = [GtpCommand command:commandString];
+  command.timeout = gSgfGtpCommandTimeout;
   [command submit];
   if (! command.response.status)
   {
@@ -326,7 +325,8 @@ static const int maxStepsForReplayMoves = 10;
     *errorMessage = @"Internal error: Failed to detect handicap of the game to be loaded";
     return false;
   }
-  m_handicap = [command.response.parsedResponse copy];
+  // Keep the response object itself, its typed views are parsed later on
+  m_handicapResponse = [command.response retain];
   return true;
 }
 
@@ -342,7 +342,7 @@ static const int maxStepsForReplayMoves = 10;
     *errorMessage = @"Internal error: Failed to detect moves of the game to be loaded";
     return false;
   }
-  m_moves = [command.response.parsedResponse copy];
+  m_movesResponse = [command.response retain];
   return true;
 }
 
@@ -358,9 +358,9 @@ static const int maxStepsForReplayMoves = 10;
   // behind our back to set up a new clean game. All game characteristics that
   // have been set up to then are discarded.
   [self startNewGameForSuccessfulCommand:true boardSize:m_boardSize];
-  [self setupHandicap:m_handicap];
+  [self setupHandicap:m_handicapResponse];
   [self setupKomi:m_komi];
-  [self setupMoves:m_moves];
+  [self setupMoves:m_movesResponse];
   if (self.restoreMode)
   {
     // Can't invoke notifyGoGameDocument 1) because we are not loading from the
@@ -433,31 +433,37 @@ static const int maxStepsForReplayMoves = 10;
 
 // -----------------------------------------------------------------------------
 /// @brief Sets up handicap for the new game, using the information in
-/// @a handicapFromGtp.
+/// @a handicapResponse.
 ///
-/// Expected format for @a handicapFromGtp is: "vertex vertex vertex[...]"
+/// Expected format for @a handicapResponse is: "vertex vertex vertex[...]"
 ///
-/// @a handicapFromGtp may be empty to indicate that there is no handicap.
+/// @a handicapResponse may be empty to indicate that there is no handicap.
 // -----------------------------------------------------------------------------
-- (void) setupHandicap:(NSString*)handicapFromGtp
+- (void) setupHandicap:(GtpResponse*)handicapResponse
 {
   GoGame* game = [GoGame sharedGame];
-  NSMutableArray* handicapPoints = [NSMutableArray arrayWithCapacity:0];
-  if (0 == handicapFromGtp.length)
-  {
-    // do nothing, just leave the empty array to be applied to the GoGame
-    // instance; this is important because the GoGame instance might have been
-    // set up by NewGameCommand with a different default handicap
-  }
-  else
+  GoBoard* board = game.board;
+  int numberOfHandicapPoints;
+  const int* handicapPointIndexes = [handicapResponse pointIndexesWithBoardState:board.boardState
+                                                                           count:&numberOfHandicapPoints];
+  // If there are no vertices we just leave the empty array to be applied to the
+  // GoGame instance; this is important because the GoGame instance might have
+  // been set up by NewGameCommand with a different default handicap
+  NSMutableArray* handicapPoints = [NSMutableArray arrayWithCapacity:numberOfHandicapPoints];
+  for (int indexOfPoint = 0; indexOfPoint < numberOfHandicapPoints; ++indexOfPoint)
   {
-    GoBoard* board = game.board;
-    NSArray* handicapVertices = [handicapFromGtp componentsSeparatedByString:@" "];
-    for (NSString* vertex in handicapVertices)
+    int pointIndex = handicapPointIndexes[indexOfPoint];
+    GoPoint* point = (pointIndex < 0 ? nil : [board pointAtIndex:pointIndex]);
+    if (! point)
     {
-      GoPoint* point = [board pointAtVertex:vertex];
-      [handicapPoints addObject:point];
+      NSString* errorMessage = [NSString stringWithFormat:@"Handicap vertex %d is not on the board", indexOfPoint + 1];
+      DDLogError(@"%@: %@", [self shortDescription], errorMessage);
+      NSException* exception = [NSException exceptionWithName:NSRangeException
+                                                       reason:errorMessage
+                                                     userInfo:nil];
+      @throw exception;
     }
+    [handicapPoints addObject:point];
   }
   // GoGame takes care to place black stones on the points
   game.handicapPoints = handicapPoints;
@@ -485,71 +491,43 @@ static const int maxStepsForReplayMoves = 10;
 
 // -----------------------------------------------------------------------------
 /// @brief Sets up the moves for the new game, using the information in
-/// @a movesFromGtp.
+/// @a movesResponse.
 ///
-/// Expected format for @a movesFromGtp:
+/// Expected format for @a movesResponse:
 ///   "color vertex, color vertex, color vertex[...]"
 ///
-/// @a movesFromGtp may be empty to indicate that there are no moves.
+/// @a movesResponse may be empty to indicate that there are no moves.
 ///
-/// @note If an error occurs while this method runs, handleCommandFailed:() is
-/// invoked with an appropriate error message.
-// -----------------------------------------------------------------------------
-- (void) setupMoves:(NSString*)movesFromGtp
-{
-  NSArray* moveList;
-  if (0 == movesFromGtp.length)
-    moveList = [NSArray array];
-  else
-    moveList = [movesFromGtp componentsSeparatedByString:@", "];
-  [self replayMoves:moveList];
-}
-
-// -----------------------------------------------------------------------------
-/// @brief Replays the moves in @a moveList.
+/// The moves are first checked and converted into a compact list, which is
+/// then replayed by GoGame in a single transaction. Observers of the game
+/// therefore see only one change at the end, instead of one change per move.
+/// This is important for long games, especially on older devices, where
+/// processing the per-move notifications used to take more time than
+/// actually playing the moves. The asynchronous command delegate is updated
+/// once when all moves have been replayed.
 ///
-/// @a moveList is expected to contain NSString objects, each having the format
-/// "color vertex" (e.g. "W C13").
-///
-/// The asynchronous command delegate is updated continuously with progress
-/// information as the moves are replayed. In an ideal world we would have
-/// fine-grained progress updates with as many steps as there are moves.
-/// However, when there are many moves to be replayed this wastes a lot of
-/// precious CPU cycles for GUI updates, considerably slowing down the process
-/// of loading a game - on older devices to an intolerable level. In the real
-/// world, we therefore limit the number of progress updates to a fixed,
-/// hard-coded number.
+/// The move list is obtained from the typed view of @a movesResponse, so no
+/// string objects are created for individual moves.
 ///
 /// @note If an error occurs while this method runs, handleCommandFailed:() is
 /// invoked with an appropriate error message.
 // -----------------------------------------------------------------------------
-- (void) replayMoves:(NSArray*)moveList
+- (void) setupMoves:(GtpResponse*)movesResponse
 {
   GoGame* game = [GoGame sharedGame];
   GoBoard* board = game.board;
 
-  float movesPerStep;
-  NSUInteger remainingNumberOfSteps;
-  if (moveList.count <= maxStepsForReplayMoves)
-  {
-    movesPerStep = 1;
-    remainingNumberOfSteps = moveList.count;
-  }
-  else
-  {
-    movesPerStep = moveList.count / maxStepsForReplayMoves;
-    remainingNumberOfSteps = maxStepsForReplayMoves;
-  }
-  float remainingProgress = 1.0 - self.progress;
-  // Adjust for increaseProgressAndNotifyDelegate()
-  self.stepIncrease = remainingProgress / remainingNumberOfSteps;
-
+  int numberOfMoves;
+  const struct GtpResponseMove* moves = [movesResponse movesWithCount:&numberOfMoves];
+  struct GoGameReplayMove* replayMoves = malloc(MAX(numberOfMoves, 1) * sizeof(struct GoGameReplayMove));
   @try
   {
+    // Moves must alternate between the two players, starting with the player
+    // whose turn it is now
+    bool isBlacksTurn = [game currentPlayer].isBlack;
     bool hasResigned = false;
-    int movesReplayed = 0;
-    float nextProgressUpdate = movesPerStep;  // use float in case movesPerStep has fractions
-    for (NSString* move in moveList)
+    int numberOfReplayMoves = 0;
+    for (int indexOfMove = 0; indexOfMove < numberOfMoves; ++indexOfMove)
     {
       if (hasResigned)
       {
@@ -558,70 +536,74 @@ static const int maxStepsForReplayMoves = 10;
         break;
       }
 
-      NSArray* moveComponents = [move componentsSeparatedByString:@" "];
-      NSString* colorString = [[moveComponents objectAtIndex:0] lowercaseString];
-      NSString* vertexString = [[moveComponents objectAtIndex:1] lowercaseString];
+      const struct GtpResponseMove* move = &moves[indexOfMove];
 
 
       // Sanitary check 1: Is the move by the correct player?
-      NSString* expectedColorString;
-      NSString* expectedColorName;
-      NSString* otherColorName;
-      if ([game currentPlayer].isBlack)
-      {
-        expectedColorString = @"b";
-        expectedColorName = @"Black";
-        otherColorName = @"White";
-      }
-      else
-      {
-        expectedColorString = @"w";
-        expectedColorName = @"White";
-        otherColorName = @"Black";
-      }
-      if (! [colorString isEqualToString:expectedColorString])
+      enum GoColor expectedColor = (isBlacksTurn ? GoColorBlack : GoColorWhite);
+      if (move->color != expectedColor)
       {
+        NSString* expectedColorName = (isBlacksTurn ? @"Black" : @"White");
+        NSString* otherColorName = (isBlacksTurn ? @"White" : @"Black");
         NSString* errorMessageFormat = @"Game contains a move by the wrong player: Move %d, should have been played by %@, but was played by %@.";
-        NSString* errorMessage = [NSString stringWithFormat:errorMessageFormat, (movesReplayed + 1), expectedColorName, otherColorName];
+        NSString* errorMessage = [NSString stringWithFormat:errorMessageFormat, (numberOfReplayMoves + 1), expectedColorName, otherColorName];
         [self handleCommandFailed:errorMessage];
         return;
       }
       // End sanitary check 1
 
-      
-      if ([vertexString isEqualToString:@"pass"])
-        [game pass];
-      else if ([vertexString isEqualToString:@"resign"])  // not sure if this is ever sent
+
+      struct GoGameReplayMove* replayMove = &replayMoves[numberOfReplayMoves];
+      if (GtpResponseMoveTypePass == move->type)
       {
-        [game resign];
+        replayMove->type = GoMoveTypePass;
+        replayMove->pointIndex = -1;
+      }
+      else if (GtpResponseMoveTypeResign == move->type)  // not sure if this is ever sent
+      {
+        // The resignation is not a move, it is handled after the replay
         hasResigned = true;
+        continue;
       }
       else
       {
-        GoPoint* point = [board pointAtVertex:vertexString];
-        
-        // Sanitary check 2: Is the move legal?
-        enum GoMoveIsIllegalReason illegalReason;
-        if (! [game isLegalMove:point isIllegalReason:&illegalReason])
-        {
-          NSString* errorMessageFormat = @"Game contains an illegal move: Move %d, played by %@, on intersection %@. Reason: %@.";
-          NSString* illegalReasonString = [NSString stringWithMoveIsIllegalReason:illegalReason];
-          NSString* errorMessage = [NSString stringWithFormat:errorMessageFormat, (movesReplayed + 1), expectedColorName, [vertexString uppercaseString], illegalReasonString];
-          [self handleCommandFailed:errorMessage];
-          return;
-        }
-        // End sanitary check 2
-
-        [game play:point];
+        replayMove->type = GoMoveTypePlay;
+        GoPoint* point = [board pointAtNumericVertex:move->vertex];
+        // An invalid vertex is reported by GoGame with an exception
+        replayMove->pointIndex = (point ? point.pointIndex : -1);
       }
-      ++movesReplayed;
+      ++numberOfReplayMoves;
+      isBlacksTurn = ! isBlacksTurn;
+    }
 
-      if (movesReplayed >= nextProgressUpdate)
-      {
-        nextProgressUpdate += movesPerStep;
-        [self increaseProgressAndNotifyDelegate];
-      }
+    // Sanitary check 2: Are the moves legal?
+    enum GoMoveIsIllegalReason illegalReason;
+    int indexOfIllegalMove = [game replayMoves:replayMoves
+                                 numberOfMoves:numberOfReplayMoves
+                               isIllegalReason:&illegalReason];
+    if (-1 != indexOfIllegalMove)
+    {
+      // Moves alternate, so the player of the illegal move can be derived from
+      // its index
+      bool isIllegalMoveByBlack = ([game currentPlayer].isBlack == (0 == indexOfIllegalMove % 2));
+      NSString* colorName = (isIllegalMoveByBlack ? @"Black" : @"White");
+      // Resignation can only occur at the end, so the index of the illegal move
+      // is also its index in the original move list. Illegal moves are always
+      // moves that place a stone, i.e. the vertex is valid.
+      NSString* vertexString = [GoVertex vertexFromNumeric:moves[indexOfIllegalMove].vertex].string;
+      NSString* errorMessageFormat = @"Game contains an illegal move: Move %d, played by %@, on intersection %@. Reason: %@.";
+      NSString* illegalReasonString = [NSString stringWithMoveIsIllegalReason:illegalReason];
+      NSString* errorMessage = [NSString stringWithFormat:errorMessageFormat, (indexOfIllegalMove + 1), colorName, vertexString, illegalReasonString];
+      [self handleCommandFailed:errorMessage];
+      return;
     }
+    // End sanitary check 2
+
+    if (hasResigned)
+      [game resign];
+
+    self.stepIncrease = 1.0 - self.progress;
+    [self increaseProgressAndNotifyDelegate];
   }
   @catch (NSException* exception)
   {
@@ -630,6 +612,10 @@ static const int maxStepsForReplayMoves = 10;
     [self handleCommandFailed:errorMessage];
     return;
   }
+  @finally
+  {
+    free(replayMoves);
+  }
 }
 
 // -----------------------------------------------------------------------------
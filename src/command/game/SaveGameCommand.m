@@ -90,6 +90,7 @@
   // Use the file *NAME* without the path
   NSString* commandString = [NSString stringWithFormat:@"savesgf %@", sgfTemporaryFileName];
   GtpCommand* command = [GtpCommand command:commandString];
+  command.timeout = gSgfGtpCommandTimeout;
   [command submit];
 
   if (temporarilyResyncGTPEngine)
@@ -22,7 +22,25 @@
 // -----------------------------------------------------------------------------
 /// @brief The LoadOpeningBookCommand class is responsible for submitting a
 /// "book_load" command to the GTP engine. Command execution occurs
-/// synchronously.
+/// asynchronously.
+///
+/// LoadOpeningBookCommand does not wait until the GTP engine has parsed the
+/// opening book, so that application startup is not blocked. It does submit
+/// "book_load" in the context of the thread that executes the command, though,
+/// before it returns. The GTP engine processes
+/// commands in the order in which they are submitted, therefore all commands
+/// that are submitted after LoadOpeningBookCommand has been executed, e.g. the
+/// commands that restore the application state or "genmove", are processed
+/// after the opening book has been loaded. Failure to load the opening book is
+/// logged, but otherwise ignored.
+///
+/// The GTP engine is given the absolute path of a symbolic link in the
+/// temporary directory that points to the opening book file. This avoids
+/// changing the process' working directory while other threads may depend on
+/// it. The link is removed when the GTP engine has responded to "book_load".
+/// If the path of the link contains characters that are prohibited by GTP,
+/// no link is created and LoadOpeningBookCommand falls back to synchronously
+/// loading the opening book from within its folder.
 ///
 /// The opening book file used as the command argument is a project resource
 /// with hard-coded name, i.e. there is no support for variable opening books.
@@ -22,8 +22,48 @@
 #import "../../gtp/GtpResponse.h"
 
 
+// -----------------------------------------------------------------------------
+/// @brief Class extension with private properties for LoadOpeningBookCommand.
+// -----------------------------------------------------------------------------
+@interface LoadOpeningBookCommand()
+/// @brief The path of the symbolic link to the opening book file that the GTP
+/// engine is loading. Is nil if no link was created.
+@property(retain) NSString* bookLinkPath;
+/// @brief The "book_load" command whose response is awaited. Is nil if no
+/// response is awaited.
+@property(retain) GtpCommand* bookLoadCommand;
+@end
+
+
 @implementation LoadOpeningBookCommand
 
+// -----------------------------------------------------------------------------
+/// @brief Initializes a LoadOpeningBookCommand object.
+///
+/// @note This is the designated initializer of LoadOpeningBookCommand.
+// -----------------------------------------------------------------------------
+- (id) init
+{
+  // Call designated initializer of superclass (CommandBase)
+  self = [super init];
+  if (! self)
+    return nil;
+  self.bookLinkPath = nil;
+  self.bookLoadCommand = nil;
+  return self;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Deallocates memory allocated by this LoadOpeningBookCommand object.
+// -----------------------------------------------------------------------------
+- (void) dealloc
+{
+  [[NSNotificationCenter defaultCenter] removeObserver:self];
+  self.bookLinkPath = nil;
+  self.bookLoadCommand = nil;
+  [super dealloc];
+}
+
 // -----------------------------------------------------------------------------
 /// @brief Executes this command. See the class documentation for details.
 // -----------------------------------------------------------------------------
@@ -36,6 +76,103 @@
     DDLogError(@"%@: Opening book file not found: %@", [self shortDescription], bookFilePath);
     return false;
   }
+
+  // The GTP engine needs a path that does not contain any characters that are
+  // prohibited by GTP. The bundle path may contain spaces (e.g. "Little
+  // Go.app"), so the engine gets a link in the temporary directory instead.
+  NSString* bookLinkPath = [NSTemporaryDirectory() stringByAppendingPathComponent:openingBookResource];
+  if ([bookLinkPath rangeOfCharacterFromSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]].location != NSNotFound)
+    return [self loadOpeningBookWithFileName:bookFilePath];
+  NSError* error;
+  [fileManager removeItemAtPath:bookLinkPath error:nil];
+  if (! [fileManager createSymbolicLinkAtPath:bookLinkPath withDestinationPath:bookFilePath error:&error])
+  {
+    DDLogError(@"%@: Failed to create link to opening book file, reason: %@", [self shortDescription], [error localizedDescription]);
+    return false;
+  }
+  self.bookLinkPath = bookLinkPath;
+
+  [self submitBookLoadCommand];
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Private helper for doIt(). Submits the "book_load" command for the
+/// opening book link at @e bookLinkPath in the context of the current thread,
+/// without waiting for the response. gtpResponseWasReceived:() handles the
+/// response when it arrives.
+///
+/// GtpClient writes commands in the order in which they are submitted, so all
+/// commands submitted after this method returns are processed after
+/// "book_load". No other thread is involved in the submission, which
+/// therefore cannot deadlock, even if the main thread waits for this command.
+///
+/// This command may run in a secondary thread that goes away before the
+/// response arrives, so the response is not delivered to a response target in
+/// the context of the current thread. Instead this command observes
+/// #gtpResponseWasReceivedNotification, and keeps itself alive until the
+/// response has arrived.
+// -----------------------------------------------------------------------------
+- (void) submitBookLoadCommand
+{
+  NSString* commandString = [NSString stringWithFormat:@"book_load %@", self.bookLinkPath];
+  GtpCommand* command = [GtpCommand command:commandString];
+  command.waitUntilDone = false;
+  self.bookLoadCommand = command;
+  // Is balanced in gtpResponseWasReceived:()
+  [self retain];
+  [[NSNotificationCenter defaultCenter] addObserver:self
+                                           selector:@selector(gtpResponseWasReceived:)
+                                               name:gtpResponseWasReceivedNotification
+                                             object:nil];
+  [command submit];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Responds to the #gtpResponseWasReceivedNotification, which is
+/// posted in the context of the secondary thread of the GtpClient that
+/// received the response. Ignores responses to commands other than the
+/// command submitted by submitBookLoadCommand().
+///
+/// Removes the link to the opening book file, which is no longer needed
+/// regardless of whether the GTP engine succeeded in loading the opening book.
+// -----------------------------------------------------------------------------
+- (void) gtpResponseWasReceived:(NSNotification*)notification
+{
+  GtpResponse* response = notification.object;
+  if (response.command != self.bookLoadCommand)
+    return;
+  [[NSNotificationCenter defaultCenter] removeObserver:self
+                                                  name:gtpResponseWasReceivedNotification
+                                                object:nil];
+  self.bookLoadCommand = nil;
+
+  if (! response.status)
+    DDLogError(@"%@: GTP engine failed to load opening book, reason: %@", [self shortDescription], [response parsedResponse]);
+  else
+    DDLogVerbose(@"%@: Opening book loaded", [self shortDescription]);
+
+  NSError* error;
+  if (! [[NSFileManager defaultManager] removeItemAtPath:self.bookLinkPath error:&error])
+    DDLogWarn(@"%@: Failed to remove link to opening book file, reason: %@", [self shortDescription], [error localizedDescription]);
+  self.bookLinkPath = nil;
+
+  // Balance the retain message sent in submitBookLoadCommand()
+  [self autorelease];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Private helper for doIt(). Loads the opening book file at
+/// @a bookFilePath synchronously, by temporarily changing the working
+/// directory to the folder that contains the file and passing only the file
+/// name to the GTP engine.
+///
+/// This is the fallback if no path without prohibited characters could be
+/// obtained for the opening book file.
+// -----------------------------------------------------------------------------
+- (bool) loadOpeningBookWithFileName:(NSString*)bookFilePath
+{
+  NSFileManager* fileManager = [NSFileManager defaultManager];
   NSString* bookFileName = [bookFilePath lastPathComponent];
   NSString* bookFileFolder = [bookFilePath stringByDeletingLastPathComponent];
 
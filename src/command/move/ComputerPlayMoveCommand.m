@@ -31,6 +31,7 @@
 #import "../../go/GoVertex.h"
 #import "../../gtp/GtpCommand.h"
 #import "../../gtp/GtpResponse.h"
+#import "../../gtp/GtpUtilities.h"
 #import "../../main/ApplicationDelegate.h"
 #import "../../main/WindowRootViewController.h"
 #import "../../shared/ApplicationStateManager.h"
@@ -103,7 +104,14 @@
   GtpCommand* command = [GtpCommand asynchronousCommand:commandString
                                          responseTarget:self
                                                selector:@selector(gtpResponseReceived:)];
+  // The user may interrupt the computer (see InterruptComputerCommand)
+  command.interruptible = true;
+  // Only this search reports its progress to the user. The engine processes
+  // commands in order, so live graphics are disabled again as soon as
+  // "genmove" is done, before the engine starts to ponder.
+  [GtpUtilities startLiveGraphics];
   [command submit];
+  [GtpUtilities stopLiveGraphics];
   self.game.reasonForComputerIsThinking = GoGameComputerIsThinkingReasonComputerPlay;
   return true;
 }
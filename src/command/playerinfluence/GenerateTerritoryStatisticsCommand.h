@@ -29,6 +29,10 @@
 /// make a move, it only lets the GTP engine make a suggestion. In order to be
 /// able to make a suggestion, the GTP engine is forced to calculate playouts
 /// which, as a side-effect, generates territory statistics.
+///
+/// If the application's GtpAnalysisCache already contains territory statistics
+/// for the current board position, GenerateTerritoryStatisticsCommand does not
+/// submit "reg_genmove" and uses the cached territory statistics instead.
 // -----------------------------------------------------------------------------
 @interface GenerateTerritoryStatisticsCommand : CommandBase
 {
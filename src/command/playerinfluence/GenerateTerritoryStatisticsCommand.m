@@ -20,8 +20,10 @@
 #import "UpdateTerritoryStatisticsCommand.h"
 #import "../../go/GoGame.h"
 #import "../../go/GoPlayer.h"
+#import "../../gtp/GtpAnalysisCache.h"
 #import "../../gtp/GtpCommand.h"
 #import "../../gtp/GtpResponse.h"
+#import "../../main/ApplicationDelegate.h"
 
 
 @implementation GenerateTerritoryStatisticsCommand
@@ -34,11 +36,28 @@
   GoGame* game = [GoGame sharedGame];
   if (! game)
     return false;
+
+  // If the current board position was analyzed before, the cached territory
+  // statistics are used and the expensive search is skipped
+  GtpAnalysisCache* cache = [ApplicationDelegate sharedDelegate].gtpAnalysisCache;
+  int numberOfRows;
+  int numberOfColumns;
+  if ([cache territoryScoresForKey:[GtpAnalysisCache keyForBoardPositionOfGame:game]
+                      numberOfRows:&numberOfRows
+                   numberOfColumns:&numberOfColumns])
+  {
+    UpdateTerritoryStatisticsCommand* command = [[[UpdateTerritoryStatisticsCommand alloc] init] autorelease];
+    command.allowCachedStatistics = true;
+    return [command submit];
+  }
+
   NSString* commandString = @"reg_genmove ";
   commandString = [commandString stringByAppendingString:game.currentPlayer.colorString];
   GtpCommand* command = [GtpCommand asynchronousCommand:commandString
                                          responseTarget:self
                                                selector:@selector(gtpResponseReceived:)];
+  // The user may interrupt the computer (see InterruptComputerCommand)
+  command.interruptible = true;
   [command submit];
   game.reasonForComputerIsThinking = GoGameComputerIsThinkingReasonPlayerInfluence;
   return true;
@@ -20,8 +20,8 @@
 #import "../../main/ApplicationDelegate.h"
 #import "../../play/model/BoardViewModel.h"
 #import "../../go/GoBoard.h"
+#import "../../go/GoBoardState.h"
 #import "../../go/GoGame.h"
-#import "../../go/GoPoint.h"
 #import "../../gtp/GtpCommand.h"
 #import "../../gtp/GtpResponse.h"
 
@@ -64,16 +64,11 @@
 // -----------------------------------------------------------------------------
 - (void) updateBoardWithZeroStatistics
 {
-  GoBoard* board = [GoGame sharedGame].board;
-  GoPoint* point = [board pointAtVertex:@"A1"];
-  while (point)
-  {
-    // Zero = no influence = nothing will be drawn on that intersection. Without
-    // this initialization, the Go board would draw player influence with data
-    // from the last time that the display of player influence was enabled.
-    point.territoryStatisticsScore = 0.0f;
-    point = point.next;
-  }
+  struct GoBoardState* boardState = [GoGame sharedGame].board.boardState;
+  // Zero = no influence = nothing will be drawn on that intersection. Without
+  // this initialization, the Go board would draw player influence with data
+  // from the last time that the display of player influence was enabled.
+  memset(boardState->territoryStatisticsScores, 0, boardState->numberOfPointIndexes * sizeof(float));
 }
 
 // -----------------------------------------------------------------------------
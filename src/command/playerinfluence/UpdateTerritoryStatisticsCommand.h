@@ -29,9 +29,20 @@
 ///
 /// UpdateTerritoryStatisticsCommand executes successfully but does nothing if
 /// the user preference to display player influence is turned off.
+///
+/// The values obtained from the GTP engine are stored in the application's
+/// GtpAnalysisCache. If the property @e allowCachedStatistics is true and the
+/// cache already contains values for the current board position,
+/// UpdateTerritoryStatisticsCommand uses the cached values instead of asking
+/// the GTP engine.
 // -----------------------------------------------------------------------------
 @interface UpdateTerritoryStatisticsCommand : CommandBase
 {
 }
 
+/// @brief True if values stored in the GtpAnalysisCache may be used instead
+/// of values obtained from the GTP engine. The default is false, because the
+/// GTP engine's values usually become more accurate with every search.
+@property(nonatomic, assign) bool allowCachedStatistics;
+
 @end
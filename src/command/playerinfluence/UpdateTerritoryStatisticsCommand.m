@@ -19,9 +19,9 @@
 #import "UpdateTerritoryStatisticsCommand.h"
 #import "../../main/ApplicationDelegate.h"
 #import "../../go/GoBoard.h"
+#import "../../go/GoBoardState.h"
 #import "../../go/GoGame.h"
-#import "../../go/GoPoint.h"
-#import "../../go/GoVertex.h"
+#import "../../gtp/GtpAnalysisCache.h"
 #import "../../gtp/GtpCommand.h"
 #import "../../gtp/GtpResponse.h"
 #import "../../play/model/BoardViewModel.h"
@@ -29,6 +29,22 @@
 
 @implementation UpdateTerritoryStatisticsCommand
 
+// -----------------------------------------------------------------------------
+/// @brief Initializes an UpdateTerritoryStatisticsCommand object.
+///
+/// @note This is the designated initializer of
+/// UpdateTerritoryStatisticsCommand.
+// -----------------------------------------------------------------------------
+- (id) init
+{
+  // Call designated initializer of superclass (CommandBase)
+  self = [super init];
+  if (! self)
+    return nil;
+  self.allowCachedStatistics = false;
+  return self;
+}
+
 // -----------------------------------------------------------------------------
 /// @brief Executes this command. See the class documentation for details.
 // -----------------------------------------------------------------------------
@@ -40,11 +56,32 @@
     DDLogVerbose(@"%@: Display of player influence is turned off, nothing to do.", [self shortDescription]);
     return true;
   }
-  GtpCommand* command = [GtpCommand command:@"uct_stat_territory"];
-  [command submit];
-  if (! command.response.status)
-    return false;
-  bool success = [self updateBoardWithGtpResponse:command.response.parsedResponse];
+  GtpAnalysisCache* cache = [ApplicationDelegate sharedDelegate].gtpAnalysisCache;
+  NSString* cacheKey = [GtpAnalysisCache keyForBoardPositionOfGame:[GoGame sharedGame]];
+  int numberOfRows;
+  int numberOfColumns;
+  const float* scores = NULL;
+  NSData* cachedScores = nil;
+  if (self.allowCachedStatistics)
+    cachedScores = [cache territoryScoresForKey:cacheKey numberOfRows:&numberOfRows numberOfColumns:&numberOfColumns];
+  if (cachedScores)
+  {
+    DDLogVerbose(@"%@: Using cached territory statistics", [self shortDescription]);
+    scores = (const float*)cachedScores.bytes;
+  }
+  else
+  {
+    GtpCommand* command = [GtpCommand command:@"uct_stat_territory"];
+    [command submit];
+    if (! command.response.status)
+      return false;
+    // The float grid view is owned by the response, which stays alive until
+    // the command goes away
+    scores = [command.response floatGridWithNumberOfRows:&numberOfRows numberOfColumns:&numberOfColumns];
+    if (scores)
+      [cache setTerritoryScores:scores numberOfRows:numberOfRows numberOfColumns:numberOfColumns forKey:cacheKey];
+  }
+  bool success = [self updateBoardWithScores:scores numberOfRows:numberOfRows numberOfColumns:numberOfColumns];
   if (! success)
     return false;
   [[NSNotificationCenter defaultCenter] postNotificationName:territoryStatisticsChanged object:nil];
@@ -53,54 +90,32 @@
 
 // -----------------------------------------------------------------------------
 /// @brief Private helper
+///
+/// Writes @a scores, a grid of numbers with @a numberOfRows rows and
+/// @a numberOfColumns columns in the order used by the response to
+/// "uct_stat_territory", directly into the flat array
+/// GoBoardState.territoryStatisticsScores. No intermediate string or number
+/// objects are created.
 // -----------------------------------------------------------------------------
-- (bool) updateBoardWithGtpResponse:(NSString*)gtpResponse
+- (bool) updateBoardWithScores:(const float*)scores numberOfRows:(int)numberOfRows numberOfColumns:(int)numberOfColumns
 {
-  GoBoard* board = [GoGame sharedGame].board;
-  struct GoVertexNumeric vertexNumeric;
-  vertexNumeric.x = 1;
-  vertexNumeric.y = board.size;  // start at the top of the board
-  NSArray* responseLines = [gtpResponse componentsSeparatedByString:@"\n"];
-  for (NSString* responseLine in responseLines)
-  {
-    if (0 == vertexNumeric.y)
-    {
-      assert(false);
-      DDLogError(@"%@: GTP response has too many lines", [self shortDescription]);
-      return false;
-    }
-    NSMutableArray* territoryStatisticScores = [NSMutableArray arrayWithArray:[responseLine componentsSeparatedByString:@" "]];
-    [territoryStatisticScores removeObject:@""];
-    if (territoryStatisticScores.count != board.size)
-      continue;  // skip the first line which is empty
-    // Start at the left edge of the board
-    NSString* vertexLeftEdge = [GoVertex vertexFromNumeric:vertexNumeric].string;
-    GoPoint* point = [board pointAtVertex:vertexLeftEdge];
-    for (NSString* territoryStatisticScore in territoryStatisticScores)
-    {
-      if (! point)
-      {
-        assert(false);
-        DDLogError(@"%@: Line in GTP response has too many elements", [self shortDescription]);
-        return false;
-      }
-      point.territoryStatisticsScore = [territoryStatisticScore floatValue];
-      point = point.right;  // continue on the same line to the right
-    }
-    if (point)
-    {
-      assert(false);
-      DDLogError(@"%@: Line in GTP response has not enough elements", [self shortDescription]);
-      return false;
-    }
-    vertexNumeric.y--;  // move down one line
-  }
-  if (0 != vertexNumeric.y)
+  struct GoBoardState* boardState = [GoGame sharedGame].board.boardState;
+  int boardSize = boardState->boardSize;
+  if (! scores || numberOfRows != boardSize || numberOfColumns != boardSize)
   {
     assert(false);
-    DDLogError(@"%@: GTP response has not enough lines", [self shortDescription]);
+    DDLogError(@"%@: GTP response is not a %dx%d grid of numbers", [self shortDescription], boardSize, boardSize);
     return false;
   }
+  float* territoryStatisticsScores = boardState->territoryStatisticsScores;
+  // The first row is the top of the board
+  for (int y = boardSize; y >= 1; --y, scores += boardSize)
+  {
+    // Within a row the point indexes of the board state are contiguous
+    memcpy(&territoryStatisticsScores[GoBoardStatePointIndexOfVertex(boardState, 1, y)],
+           scores,
+           boardSize * sizeof(float));
+  }
   return true;
 }
 
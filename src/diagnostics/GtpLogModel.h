@@ -43,6 +43,13 @@
 /// activities that occur around GTP client and engine. There is a guarantee,
 /// though, that items will pop up in the log in the same order that commands
 /// were submitted to the GTP engine.
+///
+/// In addition to the log, which is limited in size, GtpLogModel can record a
+/// complete transcript of the GTP client/engine exchange to a file. Recording
+/// is enabled if the launch argument #gtpTranscriptRecordingPathKey specifies
+/// the path of the file. The transcript has the format expected by
+/// GtpReplayEngine, so it can be replayed later on without the real GTP
+/// engine.
 // -----------------------------------------------------------------------------
 @interface GtpLogModel : NSObject
 {
@@ -68,6 +75,9 @@
 /// If a new item is about to be added to @e itemList that would exceed the
 /// limit, the oldest item is discarded first.
 @property(nonatomic, assign) int gtpLogSize;
+/// @brief The path of the file that the transcript is recorded to. Is nil if no
+/// transcript is recorded.
+@property(nonatomic, retain, readonly) NSString* transcriptRecordingPath;
 /// @brief True if the "GTP Log" view currently displays the frontside view,
 /// false if it displays the backside view.
 @property(nonatomic, assign) bool gtpLogViewFrontSideIsVisible;
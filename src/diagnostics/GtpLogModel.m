@@ -29,26 +29,34 @@
 /// @name Re-declaration of properties to make them readwrite privately
 //@{
 @property(nonatomic, retain, readwrite) NSArray* itemList;
+@property(nonatomic, retain, readwrite) NSString* transcriptRecordingPath;
 //@}
 /// @name Private properties
 //@{
 /// @brief Stores GtpLogItem objects for which a GTP response is still
 /// outstanding.
 ///
-/// The array acts as a fifo queue. enqueueItemWithNoResponse() and
-/// dequeueItemWithNoResponse() are used to modify the queue.
+/// There is one queue for each GtpClient, i.e. for each GTP engine. Keys are
+/// NSValue objects that wrap the GtpClient, values are NSMutableArray objects
+/// that act as fifo queues. enqueueItemWithNoResponse:command:() and
+/// dequeueItemWithNoResponse:() are used to modify the queues.
 ///
-/// The assumption behind this is that the GTP engine also works as a queue: It
+/// The assumption behind this is that a GTP engine also works as a queue: It
 /// processes GTP commands in the order that they are submitted, and does not
 /// start processing a new command before it has sent the response to the
-/// preceding command.
+/// preceding command. Different engines work concurrently, though, so their
+/// responses may arrive in any order relative to each other.
 ///
 /// Based on this assumption, GtpLogItem objects can simply be added to the
-/// queue as the GTP command submissions are pouring in. Whenever a GTP response
-/// is received, the GtpLogItem object at the front of the queue must be the
-/// one with the command that the response belongs to.
-@property(nonatomic, retain) NSMutableArray* itemQueueNoResponses;
+/// queue of their engine as the GTP command submissions are pouring in.
+/// Whenever a GTP response is received, the GtpLogItem object at the front of
+/// the queue of the engine that sent the response must be the one with the
+/// command that the response belongs to.
+@property(nonatomic, retain) NSMutableDictionary* itemQueueNoResponses;
 @property(nonatomic, retain) NSDateFormatter* dateFormatter;
+/// @brief The file that the transcript is recorded to. Is nil if no
+/// transcript is recorded.
+@property(nonatomic, retain) NSFileHandle* transcriptFileHandle;
 //@}
 @end
 
@@ -79,7 +87,9 @@
   self.itemList = [NSMutableArray arrayWithCapacity:0];
   self.gtpLogSize = 100;
   self.gtpLogViewFrontSideIsVisible = true;
-  self.itemQueueNoResponses = [NSMutableArray arrayWithCapacity:0];
+  self.itemQueueNoResponses = [NSMutableDictionary dictionaryWithCapacity:0];
+  self.transcriptRecordingPath = nil;
+  self.transcriptFileHandle = nil;
 
   self.dateFormatter = [[[NSDateFormatter alloc] init] autorelease];
   [self.dateFormatter setLocale:[NSLocale currentLocale]];
@@ -100,6 +110,9 @@
   self.itemList = nil;
   self.itemQueueNoResponses = nil;
   self.dateFormatter = nil;
+  [self.transcriptFileHandle closeFile];
+  self.transcriptFileHandle = nil;
+  self.transcriptRecordingPath = nil;
   [super dealloc];
 }
 
@@ -112,6 +125,29 @@
   NSDictionary* dictionary = [userDefaults dictionaryForKey:gtpLogViewKey];
   self.gtpLogSize = [[dictionary valueForKey:gtpLogSizeKey] intValue];
   self.gtpLogViewFrontSideIsVisible = [[dictionary valueForKey:gtpLogViewFrontSideIsVisibleKey] boolValue];
+
+  // Launch argument, not stored in the user defaults
+  NSString* transcriptRecordingPath = [userDefaults stringForKey:gtpTranscriptRecordingPathKey];
+  if (transcriptRecordingPath && ! self.transcriptFileHandle)
+    [self startRecordingTranscriptToPath:transcriptRecordingPath];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Creates the file at @a path, or truncates it if it already exists,
+/// and starts recording the transcript to the file.
+// -----------------------------------------------------------------------------
+- (void) startRecordingTranscriptToPath:(NSString*)path
+{
+  [[NSFileManager defaultManager] createFileAtPath:path contents:nil attributes:nil];
+  NSFileHandle* fileHandle = [NSFileHandle fileHandleForWritingAtPath:path];
+  if (! fileHandle)
+  {
+    DDLogError(@"%@: Failed to open transcript file %@", self, path);
+    return;
+  }
+  DDLogInfo(@"%@: Recording GTP transcript to %@", self, path);
+  self.transcriptFileHandle = fileHandle;
+  self.transcriptRecordingPath = path;
 }
 
 // -----------------------------------------------------------------------------
@@ -168,6 +204,11 @@
 - (void) gtpResponseWasReceived:(NSNotification*)notification
 {
   GtpResponse* response = (GtpResponse*)[notification object];
+  // Must happen in the secondary thread because GtpResponse does not retain
+  // its command object, which might no longer exist by the time the main
+  // thread gets to process the response. Notifications are posted by a single
+  // thread, so writes to the transcript file are serialized.
+  [self recordTranscriptWithResponse:response];
   // Retain to make sure that object is still alive when it "arrives" in
   // the main thread
   [response retain];
@@ -177,6 +218,34 @@
           waitUntilDone:NO];
 }
 
+// -----------------------------------------------------------------------------
+/// @brief Appends the command of @a response, and @a response itself, to the
+/// transcript file. Does nothing if no transcript is recorded.
+///
+/// The format is the one expected by GtpReplayEngine: The command on the first
+/// line, the raw response including the status prefix on the following lines,
+/// and an empty line to separate the exchange from the next one.
+// -----------------------------------------------------------------------------
+- (void) recordTranscriptWithResponse:(GtpResponse*)response
+{
+  NSFileHandle* transcriptFileHandle = self.transcriptFileHandle;
+  if (! transcriptFileHandle)
+    return;
+  NSString* exchange = [NSString stringWithFormat:@"%@\n%@\n\n", response.command.command, response.rawResponse];
+  @try
+  {
+    // Responses of different engines are received in different threads
+    @synchronized(transcriptFileHandle)
+    {
+      [transcriptFileHandle writeData:[exchange dataUsingEncoding:NSUTF8StringEncoding]];
+    }
+  }
+  @catch (NSException* exception)
+  {
+    DDLogError(@"%@: Failed to write to transcript file, exception reason = %@", self, [exception reason]);
+  }
+}
+
 // -----------------------------------------------------------------------------
 /// @brief Delegate method of gtpCommandWillBeSubmitted:(). This method is
 /// executed in the main thread. See class documentation for details.
@@ -187,7 +256,7 @@
   // gtpResponseWasReceived:()
   [response autorelease];
 
-  GtpLogItem* logItem = [self dequeueItemWithNoResponse];
+  GtpLogItem* logItem = [self dequeueItemWithNoResponse:response.command];
   assert(logItem != nil);
   if (! logItem)
     DDLogError(@"%@: GtpLogItem object is nil", self);
@@ -262,7 +331,7 @@
   [(NSMutableArray*)_itemList addObject:logItem];  // _itemList has ownership
   [logItem release];
 
-  [self enqueueItemWithNoResponse:logItem];
+  [self enqueueItemWithNoResponse:logItem command:command];
 
   logItem.commandString = command.command;
   logItem.timeStamp = [self.dateFormatter stringFromDate:[NSDate date]];
@@ -292,30 +361,41 @@
 
 // -----------------------------------------------------------------------------
 /// @brief Adds @a item to the end of the queue with log items for which the
-/// response is still outstanding.
+/// response is still outstanding. The queue is the one of the GtpClient that
+/// @a command was submitted to.
 // -----------------------------------------------------------------------------
-- (void) enqueueItemWithNoResponse:(GtpLogItem*)logItem
+- (void) enqueueItemWithNoResponse:(GtpLogItem*)logItem command:(GtpCommand*)command
 {
-  [_itemQueueNoResponses addObject:logItem];
+  NSValue* key = [NSValue valueWithNonretainedObject:command.gtpClient];
+  NSMutableArray* itemQueue = [_itemQueueNoResponses objectForKey:key];
+  if (! itemQueue)
+  {
+    itemQueue = [NSMutableArray arrayWithCapacity:0];
+    [_itemQueueNoResponses setObject:itemQueue forKey:key];
+  }
+  [itemQueue addObject:logItem];
 }
 
 // -----------------------------------------------------------------------------
 /// @brief Removes an item from the front of the queue with log items for which
-/// the response is still outstanding, then returns that item.
+/// the response is still outstanding, then returns that item. The queue is the
+/// one of the GtpClient that @a command was submitted to.
 ///
 /// Returns nil if the queue is currently empty.
 // -----------------------------------------------------------------------------
-- (GtpLogItem*) dequeueItemWithNoResponse
+- (GtpLogItem*) dequeueItemWithNoResponse:(GtpCommand*)command
 {
-  if (_itemQueueNoResponses.count == 0)
+  NSValue* key = [NSValue valueWithNonretainedObject:command.gtpClient];
+  NSMutableArray* itemQueue = [_itemQueueNoResponses objectForKey:key];
+  if (itemQueue.count == 0)
     return nil;
-  GtpLogItem* logItem = [_itemQueueNoResponses objectAtIndex:0];
-  [_itemQueueNoResponses removeObjectAtIndex:0];
+  GtpLogItem* logItem = [itemQueue objectAtIndex:0];
+  [itemQueue removeObjectAtIndex:0];
   return logItem;
 }
 
 // -----------------------------------------------------------------------------
-/// @brief Removes all items from the queue with items for which the GTP
+/// @brief Removes all items from the queues with items for which the GTP
 /// response is still outstanding.
 // -----------------------------------------------------------------------------
 - (void) clearItemQueueWithNoResponse
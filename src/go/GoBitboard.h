@@ -0,0 +1,100 @@
+// -----------------------------------------------------------------------------
+// Copyright 2014 Patrick Näf (herzbube@herzbube.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// -----------------------------------------------------------------------------
+
+
+
+/// @brief The number of 64-bit words in a GoBitboard. This is sufficient for
+/// the padded layout of the largest supported board size (21 x 21 = 441 bits
+/// for 19x19).
+enum { GoBitboardNumberOfWords = 7 };
+
+
+// -----------------------------------------------------------------------------
+/// @brief The GoBitboard struct is a set of intersections, stored as one bit
+/// per point index.
+///
+/// @ingroup go
+///
+/// GoBitboard uses the same point indexes as GoBoardState, i.e. the board is
+/// padded with a border on all sides. Shifting a GoBitboard by 1 bit moves all
+/// intersections one column to the left or right, shifting by
+/// GoBoardState.rowStride bits moves them one row up or down. Thanks to the
+/// padding, intersections never wrap around from one edge of the board to the
+/// other edge; they land on the border and are removed by masking with
+/// GoBoardState.onBoardMask.
+///
+/// The operations on GoBitboard process all intersections of the board in
+/// parallel, 64 at a time. This makes it possible to, for instance, find all
+/// points of a connected area by repeatedly dilating a seed point
+/// (GoBitboardFloodFill()). The cost of such an operation depends on the
+/// diameter of the area, but not on the number of points in it.
+///
+/// All kernels are written as loops over a fixed number of words without
+/// data-dependent branches. The compiler is therefore free to vectorize them
+/// for the target architecture; the plain loops are at the same time the
+/// portable scalar fallback.
+// -----------------------------------------------------------------------------
+struct GoBitboard
+{
+  unsigned long long words[GoBitboardNumberOfWords];  ///< @brief Bit n represents point index n.
+};
+
+// -----------------------------------------------------------------------------
+/// @brief Adds the point index @a pointIndex to @a bitboard.
+// -----------------------------------------------------------------------------
+static inline void GoBitboardSetBit(struct GoBitboard* bitboard, int pointIndex)
+{
+  bitboard->words[pointIndex / 64] |= (1ULL << (pointIndex % 64));
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Removes the point index @a pointIndex from @a bitboard.
+// -----------------------------------------------------------------------------
+static inline void GoBitboardClearBit(struct GoBitboard* bitboard, int pointIndex)
+{
+  bitboard->words[pointIndex / 64] &= ~(1ULL << (pointIndex % 64));
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns true if @a bitboard contains the point index @a pointIndex.
+// -----------------------------------------------------------------------------
+static inline bool GoBitboardTestBit(const struct GoBitboard* bitboard, int pointIndex)
+{
+  return (bitboard->words[pointIndex / 64] & (1ULL << (pointIndex % 64))) != 0;
+}
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// Helper functions
+extern void GoBitboardClear(struct GoBitboard* bitboard);
+extern void GoBitboardAnd(struct GoBitboard* result, const struct GoBitboard* bitboard1, const struct GoBitboard* bitboard2);
+extern void GoBitboardOr(struct GoBitboard* result, const struct GoBitboard* bitboard1, const struct GoBitboard* bitboard2);
+extern void GoBitboardAndNot(struct GoBitboard* result, const struct GoBitboard* bitboard1, const struct GoBitboard* bitboard2);
+extern bool GoBitboardIsEmpty(const struct GoBitboard* bitboard);
+extern bool GoBitboardIntersects(const struct GoBitboard* bitboard1, const struct GoBitboard* bitboard2);
+extern bool GoBitboardIsEqual(const struct GoBitboard* bitboard1, const struct GoBitboard* bitboard2);
+extern int GoBitboardPopCount(const struct GoBitboard* bitboard);
+extern int GoBitboardNextSetBit(const struct GoBitboard* bitboard, int pointIndex);
+extern void GoBitboardDilate(struct GoBitboard* result, const struct GoBitboard* bitboard, int rowStride, const struct GoBitboard* mask);
+extern void GoBitboardBorder(struct GoBitboard* result, const struct GoBitboard* bitboard, int rowStride, const struct GoBitboard* mask);
+extern void GoBitboardFloodFill(struct GoBitboard* result, const struct GoBitboard* seed, int rowStride, const struct GoBitboard* mask);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
@@ -0,0 +1,232 @@
+// -----------------------------------------------------------------------------
+// Copyright 2014 Patrick Näf (herzbube@herzbube.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// -----------------------------------------------------------------------------
+
+
+
+// Project includes
+#import "GoBitboard.h"
+
+
+// -----------------------------------------------------------------------------
+/// @brief Shifts all bits in @a bitboard by @a shift positions towards higher
+/// point indexes and stores the result in @a result. @a shift must be between
+/// 1 and 63.
+///
+/// This is a private helper.
+// -----------------------------------------------------------------------------
+static void GoBitboardShiftUp(struct GoBitboard* result, const struct GoBitboard* bitboard, int shift)
+{
+  int carryShift = 64 - shift;
+  for (int indexOfWord = GoBitboardNumberOfWords - 1; indexOfWord > 0; --indexOfWord)
+    result->words[indexOfWord] = (bitboard->words[indexOfWord] << shift) | (bitboard->words[indexOfWord - 1] >> carryShift);
+  result->words[0] = bitboard->words[0] << shift;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Shifts all bits in @a bitboard by @a shift positions towards lower
+/// point indexes and stores the result in @a result. @a shift must be between
+/// 1 and 63.
+///
+/// This is a private helper.
+// -----------------------------------------------------------------------------
+static void GoBitboardShiftDown(struct GoBitboard* result, const struct GoBitboard* bitboard, int shift)
+{
+  int carryShift = 64 - shift;
+  for (int indexOfWord = 0; indexOfWord < GoBitboardNumberOfWords - 1; ++indexOfWord)
+    result->words[indexOfWord] = (bitboard->words[indexOfWord] >> shift) | (bitboard->words[indexOfWord + 1] << carryShift);
+  result->words[GoBitboardNumberOfWords - 1] = bitboard->words[GoBitboardNumberOfWords - 1] >> shift;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Removes all point indexes from @a bitboard.
+// -----------------------------------------------------------------------------
+void GoBitboardClear(struct GoBitboard* bitboard)
+{
+  for (int indexOfWord = 0; indexOfWord < GoBitboardNumberOfWords; ++indexOfWord)
+    bitboard->words[indexOfWord] = 0;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Stores the intersection of @a bitboard1 and @a bitboard2 in
+/// @a result. @a result may be the same as one of the arguments.
+// -----------------------------------------------------------------------------
+void GoBitboardAnd(struct GoBitboard* result, const struct GoBitboard* bitboard1, const struct GoBitboard* bitboard2)
+{
+  for (int indexOfWord = 0; indexOfWord < GoBitboardNumberOfWords; ++indexOfWord)
+    result->words[indexOfWord] = bitboard1->words[indexOfWord] & bitboard2->words[indexOfWord];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Stores the union of @a bitboard1 and @a bitboard2 in @a result.
+/// @a result may be the same as one of the arguments.
+// -----------------------------------------------------------------------------
+void GoBitboardOr(struct GoBitboard* result, const struct GoBitboard* bitboard1, const struct GoBitboard* bitboard2)
+{
+  for (int indexOfWord = 0; indexOfWord < GoBitboardNumberOfWords; ++indexOfWord)
+    result->words[indexOfWord] = bitboard1->words[indexOfWord] | bitboard2->words[indexOfWord];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Stores the point indexes that are in @a bitboard1 but not in
+/// @a bitboard2 in @a result. @a result may be the same as one of the
+/// arguments.
+// -----------------------------------------------------------------------------
+void GoBitboardAndNot(struct GoBitboard* result, const struct GoBitboard* bitboard1, const struct GoBitboard* bitboard2)
+{
+  for (int indexOfWord = 0; indexOfWord < GoBitboardNumberOfWords; ++indexOfWord)
+    result->words[indexOfWord] = bitboard1->words[indexOfWord] & ~bitboard2->words[indexOfWord];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns true if @a bitboard contains no point indexes.
+// -----------------------------------------------------------------------------
+bool GoBitboardIsEmpty(const struct GoBitboard* bitboard)
+{
+  unsigned long long accumulator = 0;
+  for (int indexOfWord = 0; indexOfWord < GoBitboardNumberOfWords; ++indexOfWord)
+    accumulator |= bitboard->words[indexOfWord];
+  return (0 == accumulator);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns true if @a bitboard1 and @a bitboard2 have at least one point
+/// index in common.
+// -----------------------------------------------------------------------------
+bool GoBitboardIntersects(const struct GoBitboard* bitboard1, const struct GoBitboard* bitboard2)
+{
+  unsigned long long accumulator = 0;
+  for (int indexOfWord = 0; indexOfWord < GoBitboardNumberOfWords; ++indexOfWord)
+    accumulator |= bitboard1->words[indexOfWord] & bitboard2->words[indexOfWord];
+  return (0 != accumulator);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns true if @a bitboard1 and @a bitboard2 contain the same point
+/// indexes.
+// -----------------------------------------------------------------------------
+bool GoBitboardIsEqual(const struct GoBitboard* bitboard1, const struct GoBitboard* bitboard2)
+{
+  unsigned long long accumulator = 0;
+  for (int indexOfWord = 0; indexOfWord < GoBitboardNumberOfWords; ++indexOfWord)
+    accumulator |= bitboard1->words[indexOfWord] ^ bitboard2->words[indexOfWord];
+  return (0 == accumulator);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns the number of point indexes in @a bitboard.
+// -----------------------------------------------------------------------------
+int GoBitboardPopCount(const struct GoBitboard* bitboard)
+{
+  int popCount = 0;
+  for (int indexOfWord = 0; indexOfWord < GoBitboardNumberOfWords; ++indexOfWord)
+    popCount += __builtin_popcountll(bitboard->words[indexOfWord]);
+  return popCount;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns the lowest point index in @a bitboard that is equal to or
+/// greater than @a pointIndex. Returns -1 if there is no such point index.
+///
+/// This is intended for iterating over the point indexes in @a bitboard:
+/// @verbatim
+/// for (int pointIndex = GoBitboardNextSetBit(bitboard, 0);
+///      pointIndex != -1;
+///      pointIndex = GoBitboardNextSetBit(bitboard, pointIndex + 1))
+/// @endverbatim
+// -----------------------------------------------------------------------------
+int GoBitboardNextSetBit(const struct GoBitboard* bitboard, int pointIndex)
+{
+  int indexOfWord = pointIndex / 64;
+  if (indexOfWord >= GoBitboardNumberOfWords)
+    return -1;
+  unsigned long long word = bitboard->words[indexOfWord] & (~0ULL << (pointIndex % 64));
+  while (true)
+  {
+    if (word)
+      return indexOfWord * 64 + __builtin_ctzll(word);
+    if (++indexOfWord >= GoBitboardNumberOfWords)
+      return -1;
+    word = bitboard->words[indexOfWord];
+  }
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Stores @a bitboard plus all direct neighbours of its intersections
+/// in @a result, restricted to the point indexes in @a mask. @a result may be
+/// the same as @a bitboard.
+///
+/// @a rowStride is GoBoardState.rowStride. Typically @a mask is
+/// GoBoardState.onBoardMask, or a subset thereof.
+// -----------------------------------------------------------------------------
+void GoBitboardDilate(struct GoBitboard* result, const struct GoBitboard* bitboard, int rowStride, const struct GoBitboard* mask)
+{
+  struct GoBitboard left;
+  struct GoBitboard right;
+  struct GoBitboard up;
+  struct GoBitboard down;
+  GoBitboardShiftDown(&left, bitboard, 1);
+  GoBitboardShiftUp(&right, bitboard, 1);
+  GoBitboardShiftUp(&up, bitboard, rowStride);
+  GoBitboardShiftDown(&down, bitboard, rowStride);
+  for (int indexOfWord = 0; indexOfWord < GoBitboardNumberOfWords; ++indexOfWord)
+  {
+    unsigned long long dilated = (bitboard->words[indexOfWord] |
+                                  left.words[indexOfWord] |
+                                  right.words[indexOfWord] |
+                                  up.words[indexOfWord] |
+                                  down.words[indexOfWord]);
+    result->words[indexOfWord] = dilated & mask->words[indexOfWord];
+  }
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Stores the point indexes that are direct neighbours of intersections
+/// in @a bitboard, but that are not in @a bitboard themselves, in @a result.
+/// The result is restricted to the point indexes in @a mask.
+///
+/// If @a bitboard is a stone group and @a mask are the empty intersections,
+/// the result are the liberties of the stone group. If @a bitboard is an empty
+/// area and @a mask is GoBoardState.onBoardMask, the result are the stones
+/// that surround the empty area.
+// -----------------------------------------------------------------------------
+void GoBitboardBorder(struct GoBitboard* result, const struct GoBitboard* bitboard, int rowStride, const struct GoBitboard* mask)
+{
+  struct GoBitboard dilated;
+  GoBitboardDilate(&dilated, bitboard, rowStride, mask);
+  GoBitboardAndNot(result, &dilated, bitboard);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Stores all point indexes in @a mask that are connected to @a seed
+/// via direct neighbours in @a mask in @a result.
+///
+/// The seed itself must be a subset of @a mask. If @a seed consists of a
+/// single point index, the result is the connected component of @a mask that
+/// contains that point index.
+// -----------------------------------------------------------------------------
+void GoBitboardFloodFill(struct GoBitboard* result, const struct GoBitboard* seed, int rowStride, const struct GoBitboard* mask)
+{
+  struct GoBitboard current = *seed;
+  struct GoBitboard next;
+  while (true)
+  {
+    GoBitboardDilate(&next, &current, rowStride, mask);
+    if (GoBitboardIsEqual(&next, &current))
+      break;
+    current = next;
+  }
+  *result = current;
+}
@@ -15,9 +15,14 @@
 // -----------------------------------------------------------------------------
 
 
+// Project includes
+#import "GoVertexNumeric.h"
+
 // Forward declarations
 @class GoPoint;
 @class GoZobristTable;
+struct GoBitboard;
+struct GoBoardState;
 
 
 // -----------------------------------------------------------------------------
@@ -33,12 +38,22 @@
 /// these objects. A GoPoint object is identified by the coordinates of the
 /// intersection it is located on, or by its association with its neighbouring
 /// GoPoint objects in one of several directions (see #GoBoardDirection).
+///
+/// In addition, GoBoard maintains a GoBoardState, i.e. a flat representation
+/// of the board in which every intersection is identified by an integer point
+/// index (see GoPoint::pointIndex()). Performance critical code should prefer
+/// pointAtIndex:() and the GoBoardState over the string based
+/// pointAtVertex:().
 // -----------------------------------------------------------------------------
 @interface GoBoard : NSObject <NSCoding>
 {
 @private
   /// @brief Keys = Vertices as NSString objects, values = GoPoint objects
   NSMutableDictionary* m_vertexDict;
+  /// @brief Array of GoPoint objects, indexed by point index. Entries for
+  /// border indexes are nil. The array does not retain the GoPoint objects,
+  /// this is done by m_vertexDict.
+  GoPoint** m_pointsByIndex;
 }
 
 + (GoBoard*) boardWithDefaultSize;
@@ -46,8 +61,11 @@
 + (NSString*) stringForSize:(enum GoBoardSize)size;
 - (NSEnumerator*) pointEnumerator;
 - (GoPoint*) pointAtVertex:(NSString*)vertex;
+- (GoPoint*) pointAtIndex:(int)pointIndex;
+- (GoPoint*) pointAtNumericVertex:(struct GoVertexNumeric)vertex;
 - (GoPoint*) neighbourOf:(GoPoint*)point inDirection:(enum GoBoardDirection)direction;
 - (GoPoint*) pointAtCorner:(enum GoBoardCorner)corner;
+- (void) setStonesWithBlackStones:(const struct GoBitboard*)blackStones whiteStones:(const struct GoBitboard*)whiteStones;
 
 /// @brief The board size, specifying the horizontal and vertical board
 /// dimensions.
@@ -61,5 +79,8 @@
 /// @brief Zobrist table used for calculating Zobrist hashes. Zobrist hashes
 /// are used to detect superko.
 @property(nonatomic, retain, readonly) GoZobristTable* zobristTable;
+/// @brief The flat board state. GoBoard owns the memory, clients must not
+/// free it. See GoBoardState for details.
+@property(nonatomic, assign, readonly) struct GoBoardState* boardState;
 
 @end
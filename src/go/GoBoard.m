@@ -26,6 +26,7 @@
 // Project includes
 #import "GoBoard.h"
 #import "GoBoardRegion.h"
+#import "GoBoardState.h"
 #import "GoPoint.h"
 #import "GoVertex.h"
 #import "GoZobristTable.h"
@@ -42,6 +43,7 @@
 @property(nonatomic, assign, readwrite) enum GoBoardSize size;
 @property(nonatomic, retain, readwrite) NSArray* starPoints;
 @property(nonatomic, retain, readwrite) GoZobristTable* zobristTable;
+@property(nonatomic, assign, readwrite) struct GoBoardState* boardState;
 //@}
 @end
 
@@ -147,6 +149,8 @@
     return nil;
 
   self.size = boardSize;
+  self.boardState = GoBoardStateCreate(boardSize);
+  m_pointsByIndex = calloc(self.boardState->numberOfPointIndexes, sizeof(GoPoint*));
   m_vertexDict = [[NSMutableDictionary dictionary] retain];
   self.starPoints = nil;
   self.zobristTable = [[[GoZobristTable alloc] initWithBoardSize:self.size] autorelease];
@@ -168,9 +172,13 @@
   if ([decoder decodeIntForKey:nscodingVersionKey] != nscodingVersion)
     return nil;
   self.size = [decoder decodeIntForKey:goBoardSizeKey];
+  // The board state must exist before GoPoint objects are decoded
+  self.boardState = GoBoardStateCreate(self.size);
+  m_pointsByIndex = calloc(self.boardState->numberOfPointIndexes, sizeof(GoPoint*));
   m_vertexDict = [[decoder decodeObjectForKey:goBoardVertexDictKey] retain];
   self.starPoints = [decoder decodeObjectForKey:goBoardStarPointsKey];
   self.zobristTable = [[[GoZobristTable alloc] initWithBoardSize:self.size] autorelease];
+  [self synchronizeBoardStateWithPoints];
 
   return self;
 }
@@ -186,11 +194,36 @@
   for (GoPoint* point in [m_vertexDict allValues])
     [point prepareForDealloc];
   [m_vertexDict release];
+  free(m_pointsByIndex);
+  m_pointsByIndex = NULL;
+  GoBoardStateFree(self.boardState);
+  self.boardState = NULL;
   self.starPoints = nil;
   self.zobristTable = nil;
   [super dealloc];
 }
 
+// -----------------------------------------------------------------------------
+/// @brief Populates the board state and the point index lookup table with the
+/// data in the GoPoint objects in m_vertexDict.
+///
+/// This is an internal helper invoked after an NSCoding archive has been
+/// decoded. It does not rely on the order in which objects in the archive were
+/// decoded.
+// -----------------------------------------------------------------------------
+- (void) synchronizeBoardStateWithPoints
+{
+  struct GoBoardState* boardState = self.boardState;
+  for (GoPoint* point in [m_vertexDict allValues])
+  {
+    int pointIndex = point.pointIndex;
+    m_pointsByIndex[pointIndex] = point;
+    boardState->colors[pointIndex] = point.stoneState;
+    boardState->regionIDs[pointIndex] = point.region.regionID;
+  }
+  GoBoardStateRebuildGroups(boardState);
+}
+
 // -----------------------------------------------------------------------------
 /// @brief Sets up this GoBoard.
 ///
@@ -230,14 +263,21 @@
   //
   // Bottom line: Let's KISS :-)
 
-  // Create an initial GoPoint and GoBoardRegion object
-  GoPoint* point = [self pointAtVertex:@"A1"];
-  GoBoardRegion* region = [GoBoardRegion region];
-
   // On a clear board, the initial region contains all GoPoint objects.
-  // Note: Moving to the next point creates the corresponding GoPoint object!
-  for (; point != nil; point = point.next)
-    [region addPoint:point];
+  // Iterate in the same order as GoPoint::next() so that GoBoardRegion::points
+  // has the same order as before the introduction of point indexes.
+  GoBoardRegion* region = [GoBoardRegion region];
+  for (int y = 1; y <= _size; ++y)
+  {
+    for (int x = 1; x <= _size; ++x)
+    {
+      struct GoVertexNumeric numericVertex = {x, y};
+      GoPoint* point = [GoPoint pointAtVertex:[GoVertex vertexFromNumeric:numericVertex] onBoard:self];
+      [m_vertexDict setObject:point forKey:point.vertex.string];
+      m_pointsByIndex[point.pointIndex] = point;
+      [region addPoint:point];
+    }
+  }
 }
 
 // -----------------------------------------------------------------------------
@@ -299,10 +339,50 @@
   {
     point = [GoPoint pointAtVertex:[GoVertex vertexFromString:vertex] onBoard:self];
     [m_vertexDict setObject:point forKey:vertex];
+    m_pointsByIndex[point.pointIndex] = point;
   }
   return point;
 }
 
+// -----------------------------------------------------------------------------
+/// @brief Returns the GoPoint object identified by @a pointIndex. Returns nil
+/// if @a pointIndex refers to a border entry of the board state.
+///
+/// This is the fast alternative to pointAtVertex:(). It does not involve any
+/// string operations or dictionary lookups.
+///
+/// Raises an @e NSRangeException if @a pointIndex is outside the range of the
+/// board state.
+// -----------------------------------------------------------------------------
+- (GoPoint*) pointAtIndex:(int)pointIndex
+{
+  if (pointIndex < 0 || pointIndex >= _boardState->numberOfPointIndexes)
+  {
+    NSString* errorMessage = [NSString stringWithFormat:@"Point index %d is out of range", pointIndex];
+    DDLogError(@"%@: %@", self, errorMessage);
+    NSException* exception = [NSException exceptionWithName:NSRangeException
+                                                     reason:errorMessage
+                                                   userInfo:nil];
+    @throw exception;
+  }
+  return m_pointsByIndex[pointIndex];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns the GoPoint object located at the numeric vertex @a vertex.
+/// Returns nil if @a vertex is not on the board.
+///
+/// This is the fast alternative to pointAtVertex:() for clients that already
+/// have the numeric vertex compounds, e.g. from one of the typed views of
+/// GtpResponse.
+// -----------------------------------------------------------------------------
+- (GoPoint*) pointAtNumericVertex:(struct GoVertexNumeric)vertex
+{
+  if (vertex.x < 1 || vertex.x > _size || vertex.y < 1 || vertex.y > _size)
+    return nil;
+  return m_pointsByIndex[GoBoardStatePointIndexOfVertex(_boardState, vertex.x, vertex.y)];
+}
+
 // -----------------------------------------------------------------------------
 /// @brief Returns the GoPoint object that is a direct neighbour of @a point
 /// located in direction @a direction.
@@ -319,54 +399,42 @@
 // -----------------------------------------------------------------------------
 - (GoPoint*) neighbourOf:(GoPoint*)point inDirection:(enum GoBoardDirection)direction
 {
-  struct GoVertexNumeric numericVertex = point.vertex.numeric;
+  int pointIndex = point.pointIndex;
+  int rowStride = _boardState->rowStride;
+  unsigned char* colors = _boardState->colors;
   switch (direction)
   {
     case GoBoardDirectionLeft:
-      numericVertex.x--;
-      if (numericVertex.x < 1)
-        return nil;
+      pointIndex--;
       break;
     case GoBoardDirectionRight:
-      numericVertex.x++;
-      if (numericVertex.x > _size)
-        return nil;
+      pointIndex++;
       break;
     case GoBoardDirectionUp:
-      numericVertex.y++;
-      if (numericVertex.y > _size)
-        return nil;
+      pointIndex += rowStride;
       break;
     case GoBoardDirectionDown:
-      numericVertex.y--;
-      if (numericVertex.y < 1)
-        return nil;
+      pointIndex -= rowStride;
       break;
     case GoBoardDirectionNext:
-      numericVertex.x++;
-      if (numericVertex.x > _size)
-      {
-        numericVertex.x = 1;
-        numericVertex.y++;
-        if (numericVertex.y > _size)
-          return nil;
-      }
+      pointIndex++;
+      // Skip the right border of this row and the left border of the next row
+      if (GoBoardStateBorder == colors[pointIndex])
+        pointIndex += 2;
       break;
     case GoBoardDirectionPrevious:
-      numericVertex.x--;
-      if (numericVertex.x < 1)
-      {
-        numericVertex.x = _size;
-        numericVertex.y--;
-        if (numericVertex.y < 1)
-          return nil;
-      }
+      pointIndex--;
+      // Skip the left border of this row and the right border of the previous
+      // row
+      if (GoBoardStateBorder == colors[pointIndex])
+        pointIndex -= 2;
       break;
     default:
       return nil;
   }
-  GoVertex* vertex = [GoVertex vertexFromNumeric:numericVertex];
-  return [self pointAtVertex:vertex.string];
+  if (pointIndex < 0 || pointIndex >= _boardState->numberOfPointIndexes)
+    return nil;
+  return m_pointsByIndex[pointIndex];
 }
 
 // -----------------------------------------------------------------------------
@@ -404,8 +472,7 @@
       @throw exception;
     }
   }
-  GoVertex* vertex = [GoVertex vertexFromNumeric:numericVertex];
-  return [self pointAtVertex:vertex.string];
+  return m_pointsByIndex[GoBoardStatePointIndexOfVertex(_boardState, numericVertex.x, numericVertex.y)];
 }
 
 // -----------------------------------------------------------------------------
@@ -436,18 +503,111 @@
   return [starPointVertexListAsString componentsSeparatedByString:@","];
 }
 
+// -----------------------------------------------------------------------------
+/// @brief Replaces all stones on the board with the stones in @a blackStones
+/// and @a whiteStones, and rebuilds all GoBoardRegion objects to match the
+/// new stones.
+///
+/// @a blackStones and @a whiteStones are typically snapshots taken earlier from
+/// GoBoardState.blackStones and GoBoardState.whiteStones. The two bitboards
+/// must not have any point indexes in common.
+///
+/// This is much faster than getting to the same stones by playing or undoing
+/// a long sequence of moves, because every GoPoint is updated at most once and
+/// GoBoardRegion objects are never split. All GoBoardRegion objects that
+/// exist when this method is invoked are discarded, unless the stones on the
+/// board already match the snapshot, in which case this method does nothing.
+// -----------------------------------------------------------------------------
+- (void) setStonesWithBlackStones:(const struct GoBitboard*)blackStones whiteStones:(const struct GoBitboard*)whiteStones
+{
+  struct GoBoardState* boardState = _boardState;
+  if (GoBitboardIsEqual(blackStones, &boardState->blackStones) &&
+      GoBitboardIsEqual(whiteStones, &boardState->whiteStones))
+  {
+    return;
+  }
+
+  // Step 1: Update the stone state of all points. Regions are inconsistent
+  // until step 3 has been completed.
+  const struct GoBitboard* onBoardMask = &boardState->onBoardMask;
+  for (int pointIndex = GoBitboardNextSetBit(onBoardMask, 0);
+       pointIndex != -1;
+       pointIndex = GoBitboardNextSetBit(onBoardMask, pointIndex + 1))
+  {
+    enum GoColor color;
+    if (GoBitboardTestBit(blackStones, pointIndex))
+      color = GoColorBlack;
+    else if (GoBitboardTestBit(whiteStones, pointIndex))
+      color = GoColorWhite;
+    else
+      color = GoColorNone;
+    GoPoint* point = m_pointsByIndex[pointIndex];
+    if (point.stoneState != color)
+      point.stoneState = color;
+  }
+
+  // Step 2: Detach all points from their current region. A region is
+  // deallocated when its last point is detached. The points themselves remain
+  // alive because they are retained by m_vertexDict.
+  for (int pointIndex = GoBitboardNextSetBit(onBoardMask, 0);
+       pointIndex != -1;
+       pointIndex = GoBitboardNextSetBit(onBoardMask, pointIndex + 1))
+  {
+    m_pointsByIndex[pointIndex].region = nil;
+  }
+
+  // Step 3: Every connected area of empty intersections, of black stones and
+  // of white stones becomes a new region. Because the points don't have a
+  // region anymore, adding them to the new regions never causes a region to
+  // be split.
+  struct GoBitboard emptyPoints;
+  GoBitboardOr(&emptyPoints, blackStones, whiteStones);
+  GoBitboardAndNot(&emptyPoints, onBoardMask, &emptyPoints);
+  const struct GoBitboard* masks[3] = { &emptyPoints, blackStones, whiteStones };
+  for (int indexOfMask = 0; indexOfMask < 3; ++indexOfMask)
+  {
+    const struct GoBitboard* mask = masks[indexOfMask];
+    struct GoBitboard remainingPoints = *mask;
+    while (true)
+    {
+      int seedIndex = GoBitboardNextSetBit(&remainingPoints, 0);
+      if (-1 == seedIndex)
+        break;
+      struct GoBitboard seed;
+      GoBitboardClear(&seed);
+      GoBitboardSetBit(&seed, seedIndex);
+      struct GoBitboard regionPoints;
+      GoBitboardFloodFill(&regionPoints, &seed, boardState->rowStride, mask);
+      GoBoardRegion* region = [GoBoardRegion region];
+      for (int pointIndex = seedIndex;
+           pointIndex != -1;
+           pointIndex = GoBitboardNextSetBit(&regionPoints, pointIndex + 1))
+      {
+        [region addPoint:m_pointsByIndex[pointIndex]];
+      }
+      GoBitboardAndNot(&remainingPoints, &remainingPoints, &regionPoints);
+    }
+  }
+}
+
 // -----------------------------------------------------------------------------
 // Property is documented in the header file.
 // -----------------------------------------------------------------------------
 - (NSArray*) regions
 {
   NSMutableArray* regionList = [NSMutableArray arrayWithCapacity:0];
-  GoPoint* point = [self pointAtVertex:@"A1"];
-  for (; point != nil; point = point.next)
+  // Iterate points in the same order as GoPoint::next(). Whenever we find a
+  // new region we remove all of its points from the bitboard of remaining
+  // points, so that every region is visited exactly once without having to
+  // search regionList.
+  struct GoBitboard remainingPoints = _boardState->onBoardMask;
+  for (int pointIndex = GoBitboardNextSetBit(&remainingPoints, 0);
+       pointIndex != -1;
+       pointIndex = GoBitboardNextSetBit(&remainingPoints, pointIndex + 1))
   {
-    GoBoardRegion* region = point.region;
-    if (! [regionList containsObject:region])
-      [regionList addObject:region];
+    GoBoardRegion* region = m_pointsByIndex[pointIndex].region;
+    [regionList addObject:region];
+    GoBitboardAndNot(&remainingPoints, &remainingPoints, [region pointsBitboard]);
   }
   return regionList;
 }
@@ -16,6 +16,7 @@
 
 
 // Forward declarations
+@class GoBoardSnapshot;
 @class GoGame;
 @class GoMove;
 @class GoPlayer;
@@ -68,6 +69,37 @@
 /// move-generating methods in GoGame/ (GoGame::play:() and GoGame::pass()).
 ///
 ///
+/// @par Keyframes
+///
+/// Changing the board position from A to B requires that all moves between A
+/// and B are played or undone, one by one. To make large jumps faster,
+/// GoBoardPosition stores keyframes, i.e. compact snapshots of the stones on
+/// the board, for every board position that is a multiple of
+/// @e keyframeInterval. A keyframe is stored whenever such a board position is
+/// visited, regardless of whether this happens during regular play or while
+/// the board position is changed.
+///
+/// When the board position changes, GoBoardPosition restores the keyframe that
+/// is nearest to the new board position, provided that it is nearer than the
+/// current board position, and then plays or undoes only the few remaining
+/// moves. The amount of memory used for keyframes is limited by
+/// @e keyframeMemoryLimit. Keyframes for board positions that no longer exist
+/// (because moves were discarded) are discarded as well.
+///
+/// Keyframes do not contain information about moves (e.g. captured stones,
+/// Zobrist hashes), because that information is stored in GoMove objects and
+/// does not change when a move is played again after it was undone.
+///
+///
+/// @par Snapshots
+///
+/// GoPoint and GoBoardRegion objects are changed in place, so they cannot be
+/// read safely by code that runs in a secondary thread. Such code can instead
+/// obtain an immutable GoBoardSnapshot object for any board position via
+/// snapshotForBoardPosition:(). Snapshots are cached, one per board position,
+/// and are discarded together with the moves they refer to.
+///
+///
 /// @par Notifications
 ///
 /// Use KVO to observe @e currentBoardPosition and @e numberOfBoardPositions for
@@ -80,14 +112,16 @@
 /// indicate to the user that the operation is still running. The client in this
 /// case can observe the default notification center for the notification
 /// #boardPositionChangeProgress. The notification is sent (B-A) times for a
-/// board position change from A to B. Note that KVO observers of
-/// @e currentBoardPosition will still be notified just once.
+/// board position change from A to B, even if a keyframe is used to skip some
+/// of the board positions. Note that KVO observers of @e currentBoardPosition
+/// will still be notified just once.
 // -----------------------------------------------------------------------------
 @interface GoBoardPosition : NSObject
 {
 }
 
 - (id) initWithGame:(GoGame*)game;
+- (GoBoardSnapshot*) snapshotForBoardPosition:(int)boardPosition;
 
 /// @brief The current board position as described in the GoBoardPosition class
 /// documentation.
@@ -120,5 +154,20 @@
 /// @brief The number of board positions in the GoGame associated with this
 /// GoBoardPosition.
 @property(nonatomic, assign, readonly) int numberOfBoardPositions;
+/// @brief The number of board positions between two keyframes. See class
+/// documentation for details. The default is #gDefaultKeyframeInterval.
+///
+/// Setting this property discards all keyframes.
+///
+/// Raises @e NSInvalidArgumentException if a new value is set that is <= 0.
+@property(nonatomic, assign) int keyframeInterval;
+/// @brief The maximum number of bytes that may be used to store keyframes.
+/// See class documentation for details. The default is
+/// #gDefaultKeyframeMemoryLimit. 0 (zero) disables keyframes.
+///
+/// Setting this property discards all keyframes.
+///
+/// Raises @e NSInvalidArgumentException if a new value is set that is < 0.
+@property(nonatomic, assign) int keyframeMemoryLimit;
 
 @end
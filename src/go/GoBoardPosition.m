@@ -17,6 +17,9 @@
 
 // Project includes
 #import "GoBoardPosition.h"
+#import "../go/GoBoard.h"
+#import "../go/GoBoardSnapshot.h"
+#import "../go/GoBoardState.h"
 #import "../go/GoGame.h"
 #import "../go/GoMove.h"
 #import "../go/GoMoveModel.h"
@@ -25,13 +28,37 @@
 #import "../player/Player.h"
 
 
+// -----------------------------------------------------------------------------
+/// @brief The GoBoardPositionKeyframe struct is a snapshot of the stones on the
+/// board in a given board position.
+// -----------------------------------------------------------------------------
+struct GoBoardPositionKeyframe
+{
+  bool isValid;                   ///< @brief Is false if the keyframe has not been stored yet, or if it has been discarded.
+  struct GoBitboard blackStones;  ///< @brief Point indexes of all black stones.
+  struct GoBitboard whiteStones;  ///< @brief Point indexes of all white stones.
+};
+
+
 // -----------------------------------------------------------------------------
 /// @brief Class extension with private properties for GoBoardPosition.
 // -----------------------------------------------------------------------------
 @interface GoBoardPosition()
+{
+@private
+  /// @brief Array of keyframes. The entry at index i is the keyframe for board
+  /// position i * keyframeInterval.
+  struct GoBoardPositionKeyframe* m_keyframes;
+  /// @brief The number of entries in m_keyframes.
+  int m_numberOfKeyframes;
+}
 /// @name Private properties
 //@{
 @property(nonatomic, assign) GoGame* game;
+/// @brief Cache of GoBoardSnapshot objects. The object at index i is the
+/// snapshot for board position i, or NSNull if no snapshot has been created
+/// yet for that board position.
+@property(nonatomic, retain) NSMutableArray* snapshots;
 //@}
 /// @name Re-declaration of properties to make them readwrite privately
 //@{
@@ -57,6 +84,11 @@
   self.game = aGame;
   _currentBoardPosition = 0;  // don't use self to avoid the setter
   _numberOfBoardPositions = self.game.moveModel.numberOfMoves + 1;
+  _keyframeInterval = gDefaultKeyframeInterval;
+  _keyframeMemoryLimit = gDefaultKeyframeMemoryLimit;
+  m_keyframes = NULL;
+  m_numberOfKeyframes = 0;
+  self.snapshots = [NSMutableArray arrayWithCapacity:0];
   [self setupKVOObserving];
   return self;
 }
@@ -75,6 +107,12 @@
   // Don't use self, otherwise we trigger the setter!
   _currentBoardPosition = [decoder decodeIntForKey:goBoardPositionCurrentBoardPositionKey];
   self.numberOfBoardPositions = [decoder decodeIntForKey:goBoardPositionNumberOfBoardPositionsKey];
+  // Keyframes are not archived, they are re-created on demand
+  _keyframeInterval = gDefaultKeyframeInterval;
+  _keyframeMemoryLimit = gDefaultKeyframeMemoryLimit;
+  m_keyframes = NULL;
+  m_numberOfKeyframes = 0;
+  self.snapshots = [NSMutableArray arrayWithCapacity:0];
   [self setupKVOObserving];
   return self;
 }
@@ -86,6 +124,9 @@
 {
   [self.game.moveModel removeObserver:self forKeyPath:@"numberOfMoves"];
   self.game = nil;
+  self.snapshots = nil;
+  free(m_keyframes);
+  m_keyframes = NULL;
   [super dealloc];
 }
 
@@ -130,28 +171,270 @@
 {
   NSNotificationCenter* center = [NSNotificationCenter defaultCenter];
   GoMoveModel* moveModel = self.game.moveModel;
-  int indexOfTargetMove = newBoardPosition - 1;
-  int indexOfCurrentMove = self.currentBoardPosition - 1;
-  if (newBoardPosition > self.currentBoardPosition)
+  int boardPosition = self.currentBoardPosition;
+  // Make sure that we can return quickly to the position we are leaving
+  [self storeKeyframeForBoardPosition:boardPosition];
+
+  int keyframeBoardPosition = [self boardPositionOfKeyframeNearestTo:newBoardPosition];
+  if (-1 != keyframeBoardPosition &&
+      abs(newBoardPosition - keyframeBoardPosition) < abs(newBoardPosition - boardPosition))
   {
-    for (int indexOfMove = indexOfCurrentMove + 1; indexOfMove <= indexOfTargetMove; ++indexOfMove)
+    struct GoBoardPositionKeyframe* keyframe = &m_keyframes[keyframeBoardPosition / _keyframeInterval];
+    [self.game.board setStonesWithBlackStones:&keyframe->blackStones
+                                  whiteStones:&keyframe->whiteStones];
+    // Observers expect one notification per board position between the old
+    // and the new board position. Account for the positions that were skipped
+    // by restoring the keyframe.
+    int numberOfSkippedBoardPositions = (abs(newBoardPosition - boardPosition) -
+                                         abs(newBoardPosition - keyframeBoardPosition));
+    for (int counter = 0; counter < numberOfSkippedBoardPositions; ++counter)
+      [center postNotificationName:boardPositionChangeProgress object:nil];
+    boardPosition = keyframeBoardPosition;
+  }
+
+  // Board position N is reached by playing the move at index N-1, and left
+  // towards board position N-1 by undoing that same move
+  if (newBoardPosition > boardPosition)
+  {
+    for (++boardPosition; boardPosition <= newBoardPosition; ++boardPosition)
     {
-      GoMove* move = [moveModel moveAtIndex:indexOfMove];
+      GoMove* move = [moveModel moveAtIndex:boardPosition - 1];
       [move doIt];
+      [self storeKeyframeForBoardPosition:boardPosition];
       [center postNotificationName:boardPositionChangeProgress object:nil];
     }
   }
   else
   {
-    for (int indexOfMove = indexOfCurrentMove; indexOfMove > indexOfTargetMove; --indexOfMove)
+    for (; boardPosition > newBoardPosition; --boardPosition)
     {
-      GoMove* move = [moveModel moveAtIndex:indexOfMove];
+      GoMove* move = [moveModel moveAtIndex:boardPosition - 1];
       [move undo];
+      [self storeKeyframeForBoardPosition:boardPosition - 1];
       [center postNotificationName:boardPositionChangeProgress object:nil];
     }
   }
 }
 
+// -----------------------------------------------------------------------------
+/// @brief Stores a keyframe for @a boardPosition if @a boardPosition is a
+/// multiple of @e keyframeInterval, if no keyframe is stored yet for that
+/// position, and if the memory limit allows it.
+///
+/// The keyframe is made from the current state of the Go board, so the caller
+/// must make sure that the Go board actually displays @a boardPosition.
+///
+/// This is a private helper.
+// -----------------------------------------------------------------------------
+- (void) storeKeyframeForBoardPosition:(int)boardPosition
+{
+  if (0 != boardPosition % _keyframeInterval)
+    return;
+  int indexOfKeyframe = boardPosition / _keyframeInterval;
+  if (indexOfKeyframe >= m_numberOfKeyframes)
+  {
+    int maximumNumberOfKeyframes = (int)(_keyframeMemoryLimit / sizeof(struct GoBoardPositionKeyframe));
+    if (indexOfKeyframe >= maximumNumberOfKeyframes)
+      return;
+    // Grow in chunks so that we don't have to reallocate every time a new
+    // keyframe is stored during regular play
+    int newNumberOfKeyframes = MIN(indexOfKeyframe + 16, maximumNumberOfKeyframes);
+    m_keyframes = realloc(m_keyframes, newNumberOfKeyframes * sizeof(struct GoBoardPositionKeyframe));
+    for (int index = m_numberOfKeyframes; index < newNumberOfKeyframes; ++index)
+      m_keyframes[index].isValid = false;
+    m_numberOfKeyframes = newNumberOfKeyframes;
+  }
+  struct GoBoardPositionKeyframe* keyframe = &m_keyframes[indexOfKeyframe];
+  if (keyframe->isValid)
+    return;
+  struct GoBoardState* boardState = self.game.board.boardState;
+  keyframe->blackStones = boardState->blackStones;
+  keyframe->whiteStones = boardState->whiteStones;
+  keyframe->isValid = true;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns the board position of the stored keyframe that is nearest to
+/// @a boardPosition. Returns -1 if no keyframes are stored.
+///
+/// This is a private helper.
+// -----------------------------------------------------------------------------
+- (int) boardPositionOfKeyframeNearestTo:(int)boardPosition
+{
+  int nearestKeyframeBoardPosition = -1;
+  int nearestDistance = INT_MAX;
+  for (int indexOfKeyframe = 0; indexOfKeyframe < m_numberOfKeyframes; ++indexOfKeyframe)
+  {
+    if (! m_keyframes[indexOfKeyframe].isValid)
+      continue;
+    int keyframeBoardPosition = indexOfKeyframe * _keyframeInterval;
+    int distance = abs(boardPosition - keyframeBoardPosition);
+    if (distance < nearestDistance)
+    {
+      nearestDistance = distance;
+      nearestKeyframeBoardPosition = keyframeBoardPosition;
+    }
+  }
+  return nearestKeyframeBoardPosition;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Discards all keyframes for board positions that are greater than
+/// @a boardPosition. Specify -1 to discard all keyframes.
+///
+/// This is a private helper.
+// -----------------------------------------------------------------------------
+- (void) discardKeyframesAfterBoardPosition:(int)boardPosition
+{
+  for (int indexOfKeyframe = 0; indexOfKeyframe < m_numberOfKeyframes; ++indexOfKeyframe)
+  {
+    if (indexOfKeyframe * _keyframeInterval > boardPosition)
+      m_keyframes[indexOfKeyframe].isValid = false;
+  }
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns an immutable GoBoardSnapshot object that describes how the
+/// Go board looks like in board position @a boardPosition.
+///
+/// The snapshot is derived from the nearest snapshot that has already been
+/// created, or from the current state of the Go board, by applying the
+/// changes made by the moves in between. Every snapshot created along the way
+/// is cached, so repeated requests for the same board position return the
+/// same object. The current board position does not change.
+///
+/// This method must be invoked in the same thread that modifies the Go model
+/// objects. The returned snapshot may then be read from any thread.
+///
+/// Raises @e NSRangeException if @a boardPosition is <0 or exceeds the number
+/// of moves in the GoGame associated with this GoBoardPosition.
+// -----------------------------------------------------------------------------
+- (GoBoardSnapshot*) snapshotForBoardPosition:(int)boardPosition
+{
+  GoMoveModel* moveModel = self.game.moveModel;
+  int numberOfMoves = moveModel.numberOfMoves;
+  if (boardPosition < 0 || boardPosition > numberOfMoves)
+  {
+    NSString* errorMessage = [NSString stringWithFormat:@"Illegal board position %d is either <0 or exceeds number of moves (%d) in current game", boardPosition, numberOfMoves];
+    DDLogError(@"%@: %@", self, errorMessage);
+    NSException* exception = [NSException exceptionWithName:NSRangeException
+                                                     reason:errorMessage
+                                                   userInfo:nil];
+    @throw exception;
+  }
+
+  NSMutableArray* snapshots = self.snapshots;
+  while (snapshots.count <= numberOfMoves)
+    [snapshots addObject:[NSNull null]];
+  GoBoardSnapshot* snapshot = [snapshots objectAtIndex:boardPosition];
+  if ([snapshot isKindOfClass:[GoBoardSnapshot class]])
+    return snapshot;
+
+  // Find the nearest cached snapshot. If the current board position is nearer,
+  // the snapshot is made from the Go board instead.
+  int startBoardPosition = _currentBoardPosition;
+  for (int distance = 1; distance < abs(boardPosition - _currentBoardPosition); ++distance)
+  {
+    int candidateBoardPosition = boardPosition - distance;
+    if (candidateBoardPosition >= 0 &&
+        [[snapshots objectAtIndex:candidateBoardPosition] isKindOfClass:[GoBoardSnapshot class]])
+    {
+      startBoardPosition = candidateBoardPosition;
+      break;
+    }
+    candidateBoardPosition = boardPosition + distance;
+    if (candidateBoardPosition <= numberOfMoves &&
+        [[snapshots objectAtIndex:candidateBoardPosition] isKindOfClass:[GoBoardSnapshot class]])
+    {
+      startBoardPosition = candidateBoardPosition;
+      break;
+    }
+  }
+  snapshot = [snapshots objectAtIndex:startBoardPosition];
+  if (! [snapshot isKindOfClass:[GoBoardSnapshot class]])
+  {
+    snapshot = [GoBoardSnapshot snapshotWithBoardState:self.game.board.boardState
+                                         boardPosition:startBoardPosition];
+    [snapshots replaceObjectAtIndex:startBoardPosition withObject:snapshot];
+  }
+
+  // Board position N is reached by playing the move at index N-1, and left
+  // towards board position N-1 by undoing that same move
+  while (snapshot.boardPosition < boardPosition)
+  {
+    GoMove* move = [moveModel moveAtIndex:snapshot.boardPosition];
+    snapshot = [snapshot snapshotAfterMove:move];
+    [snapshots replaceObjectAtIndex:snapshot.boardPosition withObject:snapshot];
+  }
+  while (snapshot.boardPosition > boardPosition)
+  {
+    GoMove* move = [moveModel moveAtIndex:snapshot.boardPosition - 1];
+    snapshot = [snapshot snapshotBeforeMove:move];
+    [snapshots replaceObjectAtIndex:snapshot.boardPosition withObject:snapshot];
+  }
+  return snapshot;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Discards all cached snapshots for board positions that are greater
+/// than @a boardPosition. Specify -1 to discard all snapshots.
+///
+/// Snapshots that have already been handed out remain valid, they just no
+/// longer describe a board position of the current game.
+///
+/// This is a private helper.
+// -----------------------------------------------------------------------------
+- (void) discardSnapshotsAfterBoardPosition:(int)boardPosition
+{
+  NSMutableArray* snapshots = self.snapshots;
+  int numberOfSnapshotsToKeep = boardPosition + 1;
+  if (snapshots.count > numberOfSnapshotsToKeep)
+    [snapshots removeObjectsInRange:NSMakeRange(numberOfSnapshotsToKeep, snapshots.count - numberOfSnapshotsToKeep)];
+}
+
+// -----------------------------------------------------------------------------
+// Property is documented in the header file.
+// -----------------------------------------------------------------------------
+- (void) setKeyframeInterval:(int)newValue
+{
+  if (newValue <= 0)
+  {
+    NSString* errorMessage = [NSString stringWithFormat:@"Illegal keyframe interval %d, must be > 0", newValue];
+    DDLogError(@"%@: %@", self, errorMessage);
+    NSException* exception = [NSException exceptionWithName:NSInvalidArgumentException
+                                                     reason:errorMessage
+                                                   userInfo:nil];
+    @throw exception;
+  }
+  if (newValue == _keyframeInterval)
+    return;
+  // Stored keyframes were indexed with the old interval
+  [self discardKeyframesAfterBoardPosition:-1];
+  _keyframeInterval = newValue;
+}
+
+// -----------------------------------------------------------------------------
+// Property is documented in the header file.
+// -----------------------------------------------------------------------------
+- (void) setKeyframeMemoryLimit:(int)newValue
+{
+  if (newValue < 0)
+  {
+    NSString* errorMessage = [NSString stringWithFormat:@"Illegal keyframe memory limit %d, must be >= 0", newValue];
+    DDLogError(@"%@: %@", self, errorMessage);
+    NSException* exception = [NSException exceptionWithName:NSInvalidArgumentException
+                                                     reason:errorMessage
+                                                   userInfo:nil];
+    @throw exception;
+  }
+  if (newValue == _keyframeMemoryLimit)
+    return;
+  free(m_keyframes);
+  m_keyframes = NULL;
+  m_numberOfKeyframes = 0;
+  _keyframeMemoryLimit = newValue;
+}
+
 // -----------------------------------------------------------------------------
 // Property is documented in the header file.
 // -----------------------------------------------------------------------------
@@ -213,12 +496,14 @@
 ///   GoMoveModel, the current board position is adjusted so that it refers to
 ///   the last move in GoMoveModel. This is purely a safety mechanism, it is not
 ///   expected that this scenario actually occurs.
-/// - If the current board position refers to the previous-to-last move in
-///   GoMoveModel, then the current board position is advanced to refer to the
-///   last move in GoMoveModel. This covers the following "regular play"
-///   scenario: The Go board displays the most recent board position, a new
-///   move is made, the Go board should update itself to display the board
-///   position after the new move.
+/// - If moves were added to GoMoveModel and the current board position refers
+///   to the move that was the last move before the new moves were added, then
+///   the current board position is advanced to refer to the last move in
+///   GoMoveModel. This covers the following "regular play" scenario: The Go
+///   board displays the most recent board position, a new move is made, the
+///   Go board should update itself to display the board position after the
+///   new move. The scenario also covers the case where several moves are
+///   added in one go (see GoMoveModel::beginUpdates()).
 /// - If the current board position refers to any other move in GoMoveModel,
 ///   nothing happens and the KVO notification is ignored. This covers the
 ///   scenarios where 1) a new move is made while viewing a board position in
@@ -229,20 +514,43 @@
 {
   GoMoveModel* moveModel = object;
   int numberOfMoves = moveModel.numberOfMoves;
+  int previousNumberOfMoves = self.numberOfBoardPositions - 1;
+
+  // Keyframes for board positions after the first changed move must not be
+  // used anymore. The number of moves is not enough to find these board
+  // positions, because between GoMoveModel::beginUpdates() and
+  // GoMoveModel::endUpdates() moves may have been discarded and replaced by
+  // other moves. If all moves are gone, even the keyframe for board position 0
+  // is discarded because the handicap may now be changed.
+  if (0 == numberOfMoves)
+  {
+    [self discardKeyframesAfterBoardPosition:-1];
+    [self discardSnapshotsAfterBoardPosition:-1];
+  }
+  else
+  {
+    // The board position before the first changed move is the last one that
+    // is still valid
+    int lastValidBoardPosition = moveModel.indexOfFirstChangedMove;
+    [self discardKeyframesAfterBoardPosition:lastValidBoardPosition];
+    [self discardSnapshotsAfterBoardPosition:lastValidBoardPosition];
+  }
 
   // Trigger KVO notification for numberOfBoardPositions before notification
   // for currentBoardPosition. This order is defined in the class docs; it is
   // important for observers that observer both properties.
   self.numberOfBoardPositions = numberOfMoves + 1;
 
+  bool isRegularPlay = false;
   if (self.currentBoardPosition > numberOfMoves)
   {
     // Unexpected scenario (see method docs)
     DDLogWarn(@"Current board position %d is greater than the number of moves %d", self.currentBoardPosition, numberOfMoves);
   }
-  else if ((self.currentBoardPosition + 1) == numberOfMoves)
+  else if (numberOfMoves > previousNumberOfMoves && self.currentBoardPosition == previousNumberOfMoves)
   {
     // Scenario "regular play" (see method docs)
+    isRegularPlay = true;
   }
   else
   {
@@ -257,6 +565,10 @@
   [self willChangeValueForKey:@"currentBoardPosition"];
   _currentBoardPosition = numberOfMoves;
   [self didChangeValueForKey:@"currentBoardPosition"];
+  // In the "regular play" scenario the new move has already been played, so
+  // the Go board displays the new board position
+  if (isRegularPlay)
+    [self storeKeyframeForBoardPosition:numberOfMoves];
 }
 
 // -----------------------------------------------------------------------------
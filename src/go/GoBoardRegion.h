@@ -17,6 +17,7 @@
 
 // Forward declarations
 @class GoPoint;
+struct GoBitboard;
 
 
 // -----------------------------------------------------------------------------
@@ -66,10 +67,17 @@
 - (enum GoColor) color;
 - (int) liberties;
 - (NSArray*) adjacentRegions;
+- (const struct GoBitboard*) pointsBitboard;
 
 /// @brief List of GoPoint objects in this GoBoardRegion. The list is
 /// unordered.
 @property(nonatomic, readonly, retain) NSArray* points;
+/// @brief A number that uniquely identifies this GoBoardRegion for the lifetime
+/// of the application. The region ID is never 0 (zero).
+///
+/// The region ID is not archived, a new ID is assigned when a GoBoardRegion is
+/// unarchived. See GoBoardState for the purpose of region IDs.
+@property(nonatomic, readonly, assign) int regionID;
 /// @brief A random color that can be used to mark GoPoints in this
 /// GoBoardRegion. This is intended as a debugging aid.
 @property(nonatomic, retain) UIColor* randomColor;
@@ -17,6 +17,8 @@
 
 // Project includes
 #import "GoBoardRegion.h"
+#import "GoBoard.h"
+#import "GoBoardState.h"
 #import "GoPoint.h"
 #import "../utility/UIColorAdditions.h"
 
@@ -25,9 +27,18 @@
 /// @brief Class extension with private properties for GoBoardRegion.
 // -----------------------------------------------------------------------------
 @interface GoBoardRegion()
+{
+@private
+  /// @brief The point indexes of all GoPoint objects in this GoBoardRegion.
+  /// Valid only if m_pointsBitboardIsValid is true.
+  struct GoBitboard m_pointsBitboard;
+  /// @brief Is false if m_pointsBitboard must be rebuilt from @e points.
+  bool m_pointsBitboardIsValid;
+}
 /// @name Re-declaration of properties to make them readwrite privately
 //@{
 @property(nonatomic, retain, readwrite) NSArray* points;
+@property(nonatomic, assign, readwrite) int regionID;
 //@}
 /// @name Privately declared properties
 //@{
@@ -42,6 +53,18 @@
 
 @implementation GoBoardRegion
 
+// -----------------------------------------------------------------------------
+/// @brief Returns a new region ID that has never been handed out before.
+///
+/// This is an internal helper invoked during initialization.
+// -----------------------------------------------------------------------------
++ (int) nextRegionID
+{
+  // 0 is reserved for the border entries in GoBoardState
+  static int lastRegionID = 0;
+  return ++lastRegionID;
+}
+
 // -----------------------------------------------------------------------------
 /// @brief Convenience constructor. Creates a GoBoardRegion instance that
 /// contains no GoPoint objects.
@@ -97,7 +120,10 @@
   if (! self)
     return nil;
 
+  self.regionID = [GoBoardRegion nextRegionID];
   self.points = [NSMutableArray arrayWithCapacity:0];
+  GoBitboardClear(&m_pointsBitboard);
+  m_pointsBitboardIsValid = true;
   self.randomColor = [UIColor randomColor];
   _scoringMode = false;  // don't use self, otherwise we trigger the setter!
   self.territoryColor = GoColorNone;
@@ -119,7 +145,12 @@
 
   if ([decoder decodeIntForKey:nscodingVersionKey] != nscodingVersion)
     return nil;
+  // The region ID must be available before GoPoint objects are decoded
+  self.regionID = [GoBoardRegion nextRegionID];
   self.points = [decoder decodeObjectForKey:goBoardRegionPointsKey];
+  // The GoPoint objects may not be fully decoded yet, so we can't look at
+  // their point indexes
+  m_pointsBitboardIsValid = false;
   self.randomColor = [UIColor randomColor];
   // Don't use self.scoringMode, otherwise we trigger the setter!
   if ([decoder containsValueForKey:goBoardRegionScoringModeKey])
@@ -253,6 +284,8 @@
   if (previousRegion)
     [previousRegion removePoint:point];  // side-effect: sets point.region to nil
   [(NSMutableArray*)_points addObject:point];
+  if (m_pointsBitboardIsValid)
+    GoBitboardSetBit(&m_pointsBitboard, point.pointIndex);
   point.region = self;
 }
 
@@ -283,6 +316,8 @@
   }
 
   [(NSMutableArray*)_points removeObject:point];
+  if (m_pointsBitboardIsValid)
+    GoBitboardClearBit(&m_pointsBitboard, point.pointIndex);
   // Check _points array NOW because the next statement might deallocate this
   // GoBoardRegion, including the array
   bool lastPoint = (0 == _points.count);
@@ -329,17 +364,14 @@
     @throw exception;
   }
 
-  // Iterate over a copy of the array to be safe from modifications of the
-  // array. Such modifications occur because addPoint:() below causes the point
-  // to be removed from the other region.
-  // Note: The copy, by the way, also solves the problem that the array is
-  // deallocated when the last point is removed from the other region. If we
-  // were using the original array, the loop would access the deallocated array
-  // in its final iteration (the one where it would normally find out that the
-  // loop condition has been reached), causing the application to crash.
+  // All points of the other region are moved, so the other region cannot
+  // fragment. We can therefore use the light-weight bulk operation instead of
+  // adding the points one by one, which would needlessly check the other
+  // region for splits after each removed point.
+  // Note: We must use a copy of the array because the other region is
+  // deallocated when its last point is moved.
   NSArray* pointsCopy = [region.points copy];
-  for (GoPoint* point in pointsCopy)
-    [self addPoint:point];
+  [self moveSubRegion:pointsCopy fromMainRegion:region];
   [pointsCopy release];
 }
 
@@ -394,22 +426,11 @@
     @throw exception;
   }
 
-  NSMutableArray* libertyPoints = [NSMutableArray arrayWithCapacity:0];
-  for (GoPoint* point in _points)
-  {
-    for (GoPoint* neighbour in point.neighbours)
-    {
-      // Is it a liberty?
-      if ([neighbour hasStone])
-        continue;  // no
-      // Count the liberty if it hasn't been counted already
-      if (! [libertyPoints containsObject:neighbour])
-        [libertyPoints addObject:neighbour];
-    }
-  }
-  // Cast is required because NSUInteger and int differ in size in 64-bit. Cast
-  // is safe because a region's liberties can never exceed pow(2, 32).
-  return (int)[libertyPoints count];
+  // The board state tracks the liberties of all stone groups incrementally,
+  // so there is no need to count them here. A stone group and a GoBoardRegion
+  // that represents a stone group always consist of the same stones.
+  GoPoint* point = [_points objectAtIndex:0];
+  return GoBoardStateLibertiesOfGroup(point.board.boardState, point.pointIndex);
 }
 
 // -----------------------------------------------------------------------------
@@ -422,24 +443,52 @@
     return _cachedAdjacentRegions;
 
   NSMutableArray* adjacentRegions = [NSMutableArray arrayWithCapacity:0];
-  for (GoPoint* point in _points)
+  if (0 == _points.count)
+    return adjacentRegions;
+
+  // The border of this region consists of all points that are direct
+  // neighbours of our points, but that are not our points themselves. The
+  // border is calculated in one go with bitboard operations instead of
+  // examining the neighbours of each point.
+  GoBoard* board = ((GoPoint*)[_points objectAtIndex:0]).board;
+  struct GoBoardState* boardState = board.boardState;
+  struct GoBitboard border;
+  GoBitboardBorder(&border, [self pointsBitboard], boardState->rowStride, &boardState->onBoardMask);
+  for (int pointIndex = GoBitboardNextSetBit(&border, 0);
+       pointIndex != -1;
+       pointIndex = GoBitboardNextSetBit(&border, pointIndex + 1))
   {
-    for (GoPoint* neighbour in point.neighbours)
-    {
-      // Is the neighbour in an adjacent region?
-      GoBoardRegion* adjacentRegion = neighbour.region;
-      if (adjacentRegion == self)
-        continue;  // no
-      if (! adjacentRegion)
-        continue;  // no (this is weird, but at the moment we try to be graceful about it)
-      // Count the adjacent region if it hasn't been counted already
-      if (! [adjacentRegions containsObject:adjacentRegion])
-        [adjacentRegions addObject:adjacentRegion];
-    }
+    GoBoardRegion* adjacentRegion = [board pointAtIndex:pointIndex].region;
+    if (! adjacentRegion)
+      continue;  // this is weird, but at the moment we try to be graceful about it
+    [adjacentRegions addObject:adjacentRegion];
+    // Remove all points of the adjacent region from the border so that the
+    // adjacent region is counted only once, and so that we don't have to look
+    // at its other border points
+    GoBitboardAndNot(&border, &border, [adjacentRegion pointsBitboard]);
   }
   return adjacentRegions;
 }
 
+// -----------------------------------------------------------------------------
+/// @brief Returns a GoBitboard that contains the point indexes of all GoPoint
+/// objects in this GoBoardRegion.
+///
+/// The GoBitboard is maintained incrementally while points are added and
+/// removed. It is rebuilt only after this GoBoardRegion has been unarchived.
+// -----------------------------------------------------------------------------
+- (const struct GoBitboard*) pointsBitboard
+{
+  if (! m_pointsBitboardIsValid)
+  {
+    GoBitboardClear(&m_pointsBitboard);
+    for (GoPoint* point in _points)
+      GoBitboardSetBit(&m_pointsBitboard, point.pointIndex);
+    m_pointsBitboardIsValid = true;
+  }
+  return &m_pointsBitboard;
+}
+
 // -----------------------------------------------------------------------------
 /// @brief Splits this GoBoardRegion if any of the GoPoint objects within it
 /// are no longer adjacent after @a removedPoint has been removed.
@@ -466,88 +515,65 @@
   if (_points.count < 2)
     return;
 
+  // In the vast majority of cases the neighbours of the removed point are
+  // still connected to each other via the points that surround the removed
+  // point. This cheap local check saves us from examining the entire region.
+  GoBoard* board = removedPoint.board;
+  struct GoBoardState* boardState = board.boardState;
+  int regionID = self.regionID;
+  int removedPointIndex = removedPoint.pointIndex;
+  if (! GoBoardStateIsRegionSplitPossible(boardState, removedPointIndex, regionID))
+    return;
+
   // Because the point that has been removed is the splitting point, we iterate
-  // the point's neighbours to see if they are still connected
-  NSMutableArray* subRegions = [NSMutableArray arrayWithCapacity:0];
-  for (GoPoint* neighbourOfRemovedPoint in removedPoint.neighbours)
+  // the point's neighbours to see if they are still connected. A subregion is
+  // found by flood-filling the bitboard of self (the main region), starting
+  // at the neighbour. The flood fill processes all points of the board in
+  // parallel, so its cost depends on the diameter of the subregion, not on the
+  // number of points in it. The GoPoint objects of the subregion need to be
+  // looked up only if a split actually occurs.
+  int rowStride = boardState->rowStride;
+  for (int direction = 0; direction < 4; ++direction)
   {
-    // We are not interested in the neighbour if it is not in our region
-    if (neighbourOfRemovedPoint.region != self)
-      continue;
-    // Check if the current neighbour is connected to one of the other
-    // neighbours that have been previously processed
-    bool isNeighbourConnected = false;
-    for (NSArray* subRegion in subRegions)
-    {
-      if ([subRegion containsObject:neighbourOfRemovedPoint])
-      {
-        isNeighbourConnected = true;
-        break;
-      }
-    }
-    if (isNeighbourConnected)
+    int neighbourIndex = removedPointIndex + boardState->neighbourOffsets[direction];
+    // We are not interested in the neighbour if it is not in our region. This
+    // includes neighbours that have already been moved to a new subregion
+    // because they are connected to one of the other neighbours that have
+    // been previously processed.
+    if (boardState->regionIDs[neighbourIndex] != regionID)
       continue;
     // If the neighbour is not connected, we can create a new subregion that
     // contains the current neighbour and its neighbours that are also in self
     // (the main region)
-    NSMutableArray* newSubRegion = [NSMutableArray arrayWithCapacity:0];
-    [subRegions addObject:newSubRegion];
-    [self fillSubRegion:newSubRegion containingPoint:neighbourOfRemovedPoint];
-
-    // If the new subregion has the same size as self (the main region),
+    const struct GoBitboard* mainRegionBitboard = [self pointsBitboard];
+    struct GoBitboard seed;
+    GoBitboardClear(&seed);
+    GoBitboardSetBit(&seed, neighbourIndex);
+    struct GoBitboard subRegionBitboard;
+    GoBitboardFloodFill(&subRegionBitboard, &seed, rowStride, mainRegionBitboard);
+
+    // If the new subregion contains the same points as self (the main region),
     // then it effectively is the same thing as self. There won't be any more
     // splits, so we can skip processing the remaining neighbours.
-    if (_points.count == newSubRegion.count)
+    if (GoBitboardIsEqual(&subRegionBitboard, mainRegionBitboard))
       break;
 
     // At this point we know that newSubRegion does not contain all the points
     // of self (the main region), so a split is certain to occur. We need to
     // immediately remove the points of newSubRegion from self (the main region)
-    // so that in the next iteration the GoPoint.region property of those
-    // points is already correct.
+    // so that in the next iteration the region ID of those points is already
+    // correct.
+    NSMutableArray* newSubRegion = [NSMutableArray arrayWithCapacity:GoBitboardPopCount(&subRegionBitboard)];
+    for (int pointIndex = GoBitboardNextSetBit(&subRegionBitboard, 0);
+         pointIndex != -1;
+         pointIndex = GoBitboardNextSetBit(&subRegionBitboard, pointIndex + 1))
+    {
+      [newSubRegion addObject:[board pointAtIndex:pointIndex]];
+    }
     [[GoBoardRegion region] moveSubRegion:newSubRegion fromMainRegion:self];
   }
 }
 
-// -----------------------------------------------------------------------------
-/// @brief Recursively adds GoPoint objects to @a subRegion that are connected
-/// with @a point and that, together, form a subregion of this GoBoardRegion.
-///
-/// @note This is a private backend helper method for
-/// splitRegionAfterRemovingPoint:().
-///
-/// @note When a game is loaded from .sgf, this is the single-most
-/// time-consuming method. Example for the current implementation: When the
-/// "Ear-reddening game" (325 moves) is loaded on an iPhone 3GS, the total load
-/// time is ~3500ms. Roughly half of that time, or ~1700ms, is taken up by
-/// executing this method. This has been determined using the "Time Profiler"
-/// instrument and the ad-hoc distribution build. Optimization efforts that
-/// have been made so far:
-/// - Replacing recursion by a stack-based implementation significantly slows
-///   the implementation (by ~75%)
-/// - Assigning point.neighbours to a local variable and using that variable in
-///   the for-loop has no noticeable benefit
-/// - The order of the 2 checks inside the for-loop is important. The current
-///   order is significantly faster than if the order were reversed. The same
-///   instrumentation as above shows that on an iPhone 3GS the current order of
-///   checks makes this method ~15% faster (1678ms instead of 1956ms for the
-///   reversed order of checks).
-// -----------------------------------------------------------------------------
-- (void) fillSubRegion:(NSMutableArray*)subRegion containingPoint:(GoPoint*)point
-{
-  [subRegion addObject:point];
-  for (GoPoint* neighbour in point.neighbours)
-  {
-    // The order of the following 2 checks is important!!! See method docs for
-    // optimization notes.
-    if (neighbour.region != self)
-      continue;
-    if ([subRegion containsObject:neighbour])
-      continue;
-    [self fillSubRegion:subRegion containingPoint:neighbour];
-  }
-}
-
 // -----------------------------------------------------------------------------
 /// @brief Moves the GoPoint objects in @a subRegion to this GoBoardRegion. The
 /// GoPoint objects currently must be part of @a mainRegion.
@@ -577,7 +603,7 @@
 /// or if their @e stoneState property does not match the @e stoneState
 /// properties of other GoPoint objects already in this region.
 ///
-/// @note This is a private backend helper method for
+/// @note This is a private backend helper method for joinRegion:() and
 /// splitRegionAfterRemovingPoint:().
 // -----------------------------------------------------------------------------
 - (void) moveSubRegion:(NSArray*)subRegion fromMainRegion:(GoBoardRegion*)mainRegion
@@ -634,13 +660,25 @@
 
   // Bulk-remove subRegion. We directly access the _points member of the
   // mainRegion instance for efficiency reasons
-  [(NSMutableArray*)mainRegion->_points removeObjectsInArray:subRegion];
+  if (subRegion.count == mainRegion->_points.count)
+    [(NSMutableArray*)mainRegion->_points removeAllObjects];
+  else
+    [(NSMutableArray*)mainRegion->_points removeObjectsInArray:subRegion];
   // Bulk-add subRegion
   [(NSMutableArray*)_points addObjectsFromArray:subRegion];
-  // Update region references. Note that mainRegion may be deallocated by this
-  // operation, so we must not use it after the loop completes.
+  // Update bitboards and region references. Note that mainRegion may be
+  // deallocated when the region reference of the last point is updated, so we
+  // must not use it after the loop completes.
+  bool mainRegionBitboardIsValid = mainRegion->m_pointsBitboardIsValid;
   for (GoPoint* point in subRegion)
+  {
+    int pointIndex = point.pointIndex;
+    if (mainRegionBitboardIsValid)
+      GoBitboardClearBit(&mainRegion->m_pointsBitboard, pointIndex);
+    if (m_pointsBitboardIsValid)
+      GoBitboardSetBit(&m_pointsBitboard, pointIndex);
     point.region = self;
+  }
 }
 
 // -----------------------------------------------------------------------------
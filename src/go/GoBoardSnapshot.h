@@ -0,0 +1,105 @@
+// -----------------------------------------------------------------------------
+// Copyright 2014 Patrick Näf (herzbube@herzbube.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// -----------------------------------------------------------------------------
+
+
+
+// Project includes
+#import "GoBitboard.h"
+#import "GoVertexNumeric.h"
+
+// Forward declarations
+@class GoMove;
+struct GoBoardState;
+
+
+// -----------------------------------------------------------------------------
+/// @brief The GoBoardSnapshot class stores how the Go board looks like in a
+/// given board position. GoBoardSnapshot objects are immutable, i.e. they
+/// cannot be changed once they have been created.
+///
+/// @ingroup go
+///
+/// GoPoint and GoBoardRegion objects describe the Go board in the current
+/// board position only, and they are changed in place whenever a move is
+/// played or the board position changes. Code that runs in a secondary thread
+/// (e.g. background scoring, thumbnail rendering, analysis) therefore cannot
+/// safely read the state of GoPoint and GoBoardRegion objects. Such code should
+/// obtain a GoBoardSnapshot from GoBoardPosition::snapshotForBoardPosition:()
+/// instead, and then read the snapshot without any locking.
+///
+/// A GoBoardSnapshot is a value type: It consists of the bitboards of the
+/// black and white stones, and the geometry of the board. On a 19x19 board the
+/// entire stone state fits into 14 64-bit words, which is less than the
+/// bookkeeping that sharing parts of the state with other snapshots would
+/// require. A new snapshot is therefore derived from an existing snapshot by
+/// copying the bitboards and then applying only the changes made by a single
+/// move (the placed stone and the captured stones).
+///
+/// GoBoardSnapshot objects can only be created in the thread that modifies the
+/// Go model objects, because creating a snapshot reads GoBoardState and GoMove
+/// objects. Once created, a GoBoardSnapshot may be passed to and read from any
+/// thread.
+///
+///
+/// @par Regions
+///
+/// The snapshots handed out by GoBoardPosition contain only stones. Code that
+/// must examine regions (e.g. background scoring) obtains a snapshot that also
+/// contains the regions of the board position with snapshotWithRegions:().
+/// Regions are identified by their index in the array of GoBoardRegion objects
+/// that was passed to snapshotWithRegions:(). For each region the snapshot
+/// stores the points, the color, the stone group state and the indexes of the
+/// adjacent regions, i.e. everything that GoScore and GoDeadStoneEstimator
+/// need to know about a region. A snapshot with regions is not cached, because
+/// the stone group states change while the user marks dead stones.
+// -----------------------------------------------------------------------------
+@interface GoBoardSnapshot : NSObject
+{
+}
+
++ (GoBoardSnapshot*) snapshotWithBoardState:(const struct GoBoardState*)boardState boardPosition:(int)boardPosition;
+- (GoBoardSnapshot*) snapshotAfterMove:(GoMove*)move;
+- (GoBoardSnapshot*) snapshotBeforeMove:(GoMove*)move;
+- (enum GoColor) colorAtPointIndex:(int)pointIndex;
+- (enum GoColor) colorAtVertex:(struct GoVertexNumeric)vertex;
+- (int) pointIndexOfVertex:(struct GoVertexNumeric)vertex;
+- (void) getStones:(struct GoBitboard*)stones connectedToPointIndex:(int)pointIndex;
+- (GoBoardSnapshot*) snapshotWithRegions:(NSArray*)regions;
+- (int) regionIndexAtPointIndex:(int)pointIndex;
+- (const struct GoBitboard*) pointsOfRegion:(int)regionIndex;
+- (int) sizeOfRegion:(int)regionIndex;
+- (enum GoColor) colorOfRegion:(int)regionIndex;
+- (enum GoStoneGroupState) stoneGroupStateOfRegion:(int)regionIndex;
+- (const int*) adjacentRegionsOfRegion:(int)regionIndex count:(int*)numberOfAdjacentRegions;
+
+/// @brief The board position that this snapshot describes.
+@property(nonatomic, assign, readonly) int boardPosition;
+/// @brief The board dimension, e.g. 19.
+@property(nonatomic, assign, readonly) int boardSize;
+/// @brief The number of point indexes per row, including padding. Point indexes
+/// are the same as those used by GoBoardState.
+@property(nonatomic, assign, readonly) int rowStride;
+/// @brief Point indexes of all intersections on the board.
+@property(nonatomic, assign, readonly) const struct GoBitboard* onBoardMask;
+/// @brief Point indexes of all black stones.
+@property(nonatomic, assign, readonly) const struct GoBitboard* blackStones;
+/// @brief Point indexes of all white stones.
+@property(nonatomic, assign, readonly) const struct GoBitboard* whiteStones;
+/// @brief The number of regions in this snapshot. Is 0 if this snapshot was
+/// not created by snapshotWithRegions:().
+@property(nonatomic, assign, readonly) int numberOfRegions;
+
+@end
@@ -0,0 +1,522 @@
+// -----------------------------------------------------------------------------
+// Copyright 2014 Patrick Näf (herzbube@herzbube.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// -----------------------------------------------------------------------------
+
+
+
+// Project includes
+#import "GoBoardSnapshot.h"
+#import "GoBoardRegion.h"
+#import "GoBoardState.h"
+#import "GoMove.h"
+#import "GoPlayer.h"
+#import "GoPoint.h"
+
+
+/// @brief The number of point indexes covered by a GoBitboard.
+static const int numberOfBitboardPointIndexes = GoBitboardNumberOfWords * 64;
+
+
+// -----------------------------------------------------------------------------
+/// @brief The GoBoardSnapshotRegion struct stores what a GoBoardSnapshot knows
+/// about a single region.
+// -----------------------------------------------------------------------------
+struct GoBoardSnapshotRegion
+{
+  struct GoBitboard points;                ///< @brief Point indexes of the region.
+  int size;                                ///< @brief The number of points in the region.
+  enum GoColor color;                      ///< @brief The stone color, #GoColorNone for an empty region.
+  enum GoStoneGroupState stoneGroupState;  ///< @brief The stone group state at the time the snapshot was made.
+  int firstAdjacentRegion;                 ///< @brief Position of the first adjacent region in m_adjacentRegions.
+  int numberOfAdjacentRegions;             ///< @brief The number of adjacent regions.
+};
+
+
+// -----------------------------------------------------------------------------
+/// @brief Class extension with private properties for GoBoardSnapshot.
+// -----------------------------------------------------------------------------
+@interface GoBoardSnapshot()
+{
+@private
+  struct GoBitboard m_onBoardMask;
+  struct GoBitboard m_blackStones;
+  struct GoBitboard m_whiteStones;
+  /// @brief Array with @e numberOfRegions elements. NULL if the snapshot has
+  /// no regions.
+  struct GoBoardSnapshotRegion* m_regions;
+  /// @brief The region index of each point index, -1 for point indexes that
+  /// are not on the board. NULL if the snapshot has no regions.
+  int* m_regionIndexes;
+  /// @brief The indexes of the adjacent regions of all regions, one region
+  /// after the other. NULL if the snapshot has no regions.
+  int* m_adjacentRegions;
+}
+/// @name Re-declaration of properties to make them readwrite privately
+//@{
+@property(nonatomic, assign, readwrite) int boardPosition;
+@property(nonatomic, assign, readwrite) int boardSize;
+@property(nonatomic, assign, readwrite) int rowStride;
+@property(nonatomic, assign, readwrite) int numberOfRegions;
+//@}
+@end
+
+
+@implementation GoBoardSnapshot
+
+// -----------------------------------------------------------------------------
+/// @brief Convenience constructor. Creates a GoBoardSnapshot instance that
+/// describes the stones currently stored in @a boardState. The snapshot refers
+/// to board position @a boardPosition.
+///
+/// The caller must make sure that @a boardState actually displays
+/// @a boardPosition.
+// -----------------------------------------------------------------------------
++ (GoBoardSnapshot*) snapshotWithBoardState:(const struct GoBoardState*)boardState boardPosition:(int)boardPosition
+{
+  GoBoardSnapshot* snapshot = [[GoBoardSnapshot alloc] init];
+  if (snapshot)
+  {
+    snapshot.boardPosition = boardPosition;
+    snapshot.boardSize = boardState->boardSize;
+    snapshot.rowStride = boardState->rowStride;
+    snapshot->m_onBoardMask = boardState->onBoardMask;
+    snapshot->m_blackStones = boardState->blackStones;
+    snapshot->m_whiteStones = boardState->whiteStones;
+    [snapshot autorelease];
+  }
+  return snapshot;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Initializes a GoBoardSnapshot object with an empty board of size 0.
+///
+/// @note This is the designated initializer of GoBoardSnapshot.
+// -----------------------------------------------------------------------------
+- (id) init
+{
+  // Call designated initializer of superclass (NSObject)
+  self = [super init];
+  if (! self)
+    return nil;
+  _boardPosition = 0;
+  _boardSize = 0;
+  _rowStride = 0;
+  _numberOfRegions = 0;
+  GoBitboardClear(&m_onBoardMask);
+  GoBitboardClear(&m_blackStones);
+  GoBitboardClear(&m_whiteStones);
+  m_regions = NULL;
+  m_regionIndexes = NULL;
+  m_adjacentRegions = NULL;
+  return self;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Deallocates memory allocated by this GoBoardSnapshot object.
+// -----------------------------------------------------------------------------
+- (void) dealloc
+{
+  free(m_regions);
+  free(m_regionIndexes);
+  free(m_adjacentRegions);
+  [super dealloc];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns a new GoBoardSnapshot object that describes the board
+/// position after @a move has been played. @a move must be the move that leads
+/// from the board position described by this snapshot to the next board
+/// position.
+///
+/// This snapshot is not changed.
+// -----------------------------------------------------------------------------
+- (GoBoardSnapshot*) snapshotAfterMove:(GoMove*)move
+{
+  GoBoardSnapshot* snapshot = [self copyWithBoardPosition:_boardPosition + 1];
+  if (GoMoveTypePlay == move.type)
+  {
+    struct GoBitboard* playerStones;
+    struct GoBitboard* opponentStones;
+    [snapshot getPlayerStones:&playerStones opponentStones:&opponentStones forMove:move];
+    GoBitboardSetBit(playerStones, move.point.pointIndex);
+    for (GoPoint* capturedStone in move.capturedStones)
+      GoBitboardClearBit(opponentStones, capturedStone.pointIndex);
+  }
+  return [snapshot autorelease];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns a new GoBoardSnapshot object that describes the board
+/// position before @a move was played. @a move must be the move that led to
+/// the board position described by this snapshot.
+///
+/// This snapshot is not changed.
+// -----------------------------------------------------------------------------
+- (GoBoardSnapshot*) snapshotBeforeMove:(GoMove*)move
+{
+  GoBoardSnapshot* snapshot = [self copyWithBoardPosition:_boardPosition - 1];
+  if (GoMoveTypePlay == move.type)
+  {
+    struct GoBitboard* playerStones;
+    struct GoBitboard* opponentStones;
+    [snapshot getPlayerStones:&playerStones opponentStones:&opponentStones forMove:move];
+    GoBitboardClearBit(playerStones, move.point.pointIndex);
+    for (GoPoint* capturedStone in move.capturedStones)
+      GoBitboardSetBit(opponentStones, capturedStone.pointIndex);
+  }
+  return [snapshot autorelease];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns a new GoBoardSnapshot object that describes the same stones
+/// as this snapshot, and in addition the regions in @a regions, an array of
+/// GoBoardRegion objects. The index of a GoBoardRegion object in @a regions
+/// becomes its region index in the new snapshot.
+///
+/// @a regions must contain all regions of the board position that this
+/// snapshot describes, typically they are GoBoard::regions(). This method
+/// reads GoBoardRegion objects, so it must be invoked in the thread that
+/// modifies the Go model objects.
+///
+/// This snapshot is not changed.
+// -----------------------------------------------------------------------------
+- (GoBoardSnapshot*) snapshotWithRegions:(NSArray*)regions
+{
+  GoBoardSnapshot* snapshot = [self copyWithBoardPosition:_boardPosition];
+  // Cast is required because NSUInteger and int differ in size in 64-bit. Cast
+  // is safe because a board never has more than pow(2, 31) regions.
+  int numberOfRegions = (int)regions.count;
+  snapshot.numberOfRegions = numberOfRegions;
+  snapshot->m_regions = malloc(MAX(numberOfRegions, 1) * sizeof(struct GoBoardSnapshotRegion));
+  snapshot->m_regionIndexes = malloc(numberOfBitboardPointIndexes * sizeof(int));
+  for (int pointIndex = 0; pointIndex < numberOfBitboardPointIndexes; ++pointIndex)
+    snapshot->m_regionIndexes[pointIndex] = -1;
+
+  int maximumNumberOfAdjacentRegions = 0;
+  for (int regionIndex = 0; regionIndex < numberOfRegions; ++regionIndex)
+  {
+    GoBoardRegion* region = [regions objectAtIndex:regionIndex];
+    struct GoBoardSnapshotRegion* snapshotRegion = &snapshot->m_regions[regionIndex];
+    snapshotRegion->points = *[region pointsBitboard];
+    snapshotRegion->size = GoBitboardPopCount(&snapshotRegion->points);
+    if (GoBitboardIntersects(&snapshotRegion->points, &m_blackStones))
+      snapshotRegion->color = GoColorBlack;
+    else if (GoBitboardIntersects(&snapshotRegion->points, &m_whiteStones))
+      snapshotRegion->color = GoColorWhite;
+    else
+      snapshotRegion->color = GoColorNone;
+    snapshotRegion->stoneGroupState = region.stoneGroupState;
+    for (int pointIndex = GoBitboardNextSetBit(&snapshotRegion->points, 0);
+         pointIndex != -1;
+         pointIndex = GoBitboardNextSetBit(&snapshotRegion->points, pointIndex + 1))
+    {
+      snapshot->m_regionIndexes[pointIndex] = regionIndex;
+    }
+    // A region cannot have more adjacent regions than its border has points
+    struct GoBitboard border;
+    GoBitboardBorder(&border, &snapshotRegion->points, _rowStride, &m_onBoardMask);
+    maximumNumberOfAdjacentRegions += GoBitboardPopCount(&border);
+  }
+
+  // The marker array prevents that an adjacent region is recorded once for
+  // every point that it has on the border
+  snapshot->m_adjacentRegions = malloc(MAX(maximumNumberOfAdjacentRegions, 1) * sizeof(int));
+  int* lastRegionAdjacentTo = malloc(MAX(numberOfRegions, 1) * sizeof(int));
+  for (int regionIndex = 0; regionIndex < numberOfRegions; ++regionIndex)
+    lastRegionAdjacentTo[regionIndex] = -1;
+  int numberOfAdjacentRegions = 0;
+  for (int regionIndex = 0; regionIndex < numberOfRegions; ++regionIndex)
+  {
+    struct GoBoardSnapshotRegion* snapshotRegion = &snapshot->m_regions[regionIndex];
+    snapshotRegion->firstAdjacentRegion = numberOfAdjacentRegions;
+    struct GoBitboard border;
+    GoBitboardBorder(&border, &snapshotRegion->points, _rowStride, &m_onBoardMask);
+    for (int pointIndex = GoBitboardNextSetBit(&border, 0);
+         pointIndex != -1;
+         pointIndex = GoBitboardNextSetBit(&border, pointIndex + 1))
+    {
+      int adjacentRegionIndex = snapshot->m_regionIndexes[pointIndex];
+      if (-1 == adjacentRegionIndex || regionIndex == lastRegionAdjacentTo[adjacentRegionIndex])
+        continue;
+      lastRegionAdjacentTo[adjacentRegionIndex] = regionIndex;
+      snapshot->m_adjacentRegions[numberOfAdjacentRegions++] = adjacentRegionIndex;
+    }
+    snapshotRegion->numberOfAdjacentRegions = numberOfAdjacentRegions - snapshotRegion->firstAdjacentRegion;
+  }
+  free(lastRegionAdjacentTo);
+
+  return [snapshot autorelease];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns a new GoBoardSnapshot object with a retain count of 1 that
+/// is an exact copy of this snapshot, except that it refers to board position
+/// @a boardPosition. Regions are not copied.
+///
+/// This is a private helper.
+// -----------------------------------------------------------------------------
+- (GoBoardSnapshot*) copyWithBoardPosition:(int)boardPosition
+{
+  GoBoardSnapshot* snapshot = [[GoBoardSnapshot alloc] init];
+  snapshot.boardPosition = boardPosition;
+  snapshot.boardSize = _boardSize;
+  snapshot.rowStride = _rowStride;
+  snapshot->m_onBoardMask = m_onBoardMask;
+  snapshot->m_blackStones = m_blackStones;
+  snapshot->m_whiteStones = m_whiteStones;
+  return snapshot;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Fills the out parameters with pointers to the bitboard of the player
+/// who made @a move, and to the bitboard of that player's opponent.
+///
+/// This is a private helper. It must only be invoked on a snapshot that has
+/// not yet been handed out.
+// -----------------------------------------------------------------------------
+- (void) getPlayerStones:(struct GoBitboard**)playerStones
+          opponentStones:(struct GoBitboard**)opponentStones
+                 forMove:(GoMove*)move
+{
+  if (move.player.isBlack)
+  {
+    *playerStones = &m_blackStones;
+    *opponentStones = &m_whiteStones;
+  }
+  else
+  {
+    *playerStones = &m_whiteStones;
+    *opponentStones = &m_blackStones;
+  }
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns a description for this GoBoardSnapshot object.
+///
+/// This method is invoked when GoBoardSnapshot needs to be represented as a
+/// string, i.e. by NSLog, or when the debugger command "po" is used on the
+/// object.
+// -----------------------------------------------------------------------------
+- (NSString*) description
+{
+  return [NSString stringWithFormat:@"GoBoardSnapshot(%p): board position = %d, black stones = %d, white stones = %d",
+          self,
+          _boardPosition,
+          GoBitboardPopCount(&m_blackStones),
+          GoBitboardPopCount(&m_whiteStones)];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns the color of the stone at @a pointIndex, or #GoColorNone if
+/// the intersection is empty or if @a pointIndex does not refer to an
+/// intersection on the board.
+// -----------------------------------------------------------------------------
+- (enum GoColor) colorAtPointIndex:(int)pointIndex
+{
+  if (! [self isOnBoardPointIndex:pointIndex])
+    return GoColorNone;
+  else if (GoBitboardTestBit(&m_blackStones, pointIndex))
+    return GoColorBlack;
+  else if (GoBitboardTestBit(&m_whiteStones, pointIndex))
+    return GoColorWhite;
+  else
+    return GoColorNone;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns the color of the stone at @a vertex, or #GoColorNone if
+/// the intersection is empty.
+///
+/// Raises an @e NSRangeException if @a vertex is outside the board.
+// -----------------------------------------------------------------------------
+- (enum GoColor) colorAtVertex:(struct GoVertexNumeric)vertex
+{
+  return [self colorAtPointIndex:[self pointIndexOfVertex:vertex]];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns the point index of @a vertex.
+///
+/// Raises an @e NSRangeException if @a vertex is outside the board.
+// -----------------------------------------------------------------------------
+- (int) pointIndexOfVertex:(struct GoVertexNumeric)vertex
+{
+  if (vertex.x < 1 || vertex.x > _boardSize || vertex.y < 1 || vertex.y > _boardSize)
+  {
+    NSString* errorMessage = [NSString stringWithFormat:@"Vertex (%d, %d) is outside the board", vertex.x, vertex.y];
+    DDLogError(@"%@: %@", self, errorMessage);
+    NSException* exception = [NSException exceptionWithName:NSRangeException
+                                                     reason:errorMessage
+                                                   userInfo:nil];
+    @throw exception;
+  }
+  return vertex.y * _rowStride + vertex.x;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Fills @a stones with the point indexes of all intersections that
+/// are connected to @a pointIndex and have the same color. If @a pointIndex
+/// refers to an empty intersection, @a stones is filled with the area of empty
+/// intersections that @a pointIndex belongs to.
+///
+/// The result corresponds to the GoBoardRegion that the GoPoint at
+/// @a pointIndex belongs to in the board position described by this snapshot.
+/// @a stones is cleared if @a pointIndex does not refer to an intersection on
+/// the board.
+// -----------------------------------------------------------------------------
+- (void) getStones:(struct GoBitboard*)stones connectedToPointIndex:(int)pointIndex
+{
+  GoBitboardClear(stones);
+  if (! [self isOnBoardPointIndex:pointIndex])
+    return;
+  struct GoBitboard mask;
+  if (GoBitboardTestBit(&m_blackStones, pointIndex))
+  {
+    mask = m_blackStones;
+  }
+  else if (GoBitboardTestBit(&m_whiteStones, pointIndex))
+  {
+    mask = m_whiteStones;
+  }
+  else
+  {
+    GoBitboardOr(&mask, &m_blackStones, &m_whiteStones);
+    GoBitboardAndNot(&mask, &m_onBoardMask, &mask);
+  }
+  struct GoBitboard seed;
+  GoBitboardClear(&seed);
+  GoBitboardSetBit(&seed, pointIndex);
+  GoBitboardFloodFill(stones, &seed, _rowStride, &mask);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns true if @a pointIndex refers to an intersection on the
+/// board. Also guards against point indexes that are outside of the range
+/// covered by a bitboard.
+///
+/// This is a private helper.
+// -----------------------------------------------------------------------------
+- (bool) isOnBoardPointIndex:(int)pointIndex
+{
+  if (pointIndex < 0 || pointIndex >= GoBitboardNumberOfWords * 64)
+    return false;
+  return GoBitboardTestBit(&m_onBoardMask, pointIndex);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns the index of the region that contains @a pointIndex, or -1
+/// if @a pointIndex does not refer to an intersection on the board, or if this
+/// snapshot has no regions.
+// -----------------------------------------------------------------------------
+- (int) regionIndexAtPointIndex:(int)pointIndex
+{
+  if (! m_regionIndexes || pointIndex < 0 || pointIndex >= numberOfBitboardPointIndexes)
+    return -1;
+  return m_regionIndexes[pointIndex];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns the point indexes of the region with index @a regionIndex.
+// -----------------------------------------------------------------------------
+- (const struct GoBitboard*) pointsOfRegion:(int)regionIndex
+{
+  return &[self regionAtIndex:regionIndex]->points;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns the number of points in the region with index
+/// @a regionIndex.
+// -----------------------------------------------------------------------------
+- (int) sizeOfRegion:(int)regionIndex
+{
+  return [self regionAtIndex:regionIndex]->size;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns the color of the stones in the region with index
+/// @a regionIndex, or #GoColorNone if the region is empty.
+// -----------------------------------------------------------------------------
+- (enum GoColor) colorOfRegion:(int)regionIndex
+{
+  return [self regionAtIndex:regionIndex]->color;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns the stone group state that the region with index
+/// @a regionIndex had when snapshotWithRegions:() was invoked.
+// -----------------------------------------------------------------------------
+- (enum GoStoneGroupState) stoneGroupStateOfRegion:(int)regionIndex
+{
+  return [self regionAtIndex:regionIndex]->stoneGroupState;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns the indexes of the regions that are adjacent to the region
+/// with index @a regionIndex. The number of adjacent regions is filled into
+/// the out parameter @a numberOfAdjacentRegions.
+// -----------------------------------------------------------------------------
+- (const int*) adjacentRegionsOfRegion:(int)regionIndex count:(int*)numberOfAdjacentRegions
+{
+  const struct GoBoardSnapshotRegion* region = [self regionAtIndex:regionIndex];
+  *numberOfAdjacentRegions = region->numberOfAdjacentRegions;
+  return &m_adjacentRegions[region->firstAdjacentRegion];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns the region with index @a regionIndex.
+///
+/// Raises an @e NSRangeException if @a regionIndex is out of range.
+///
+/// This is a private helper.
+// -----------------------------------------------------------------------------
+- (const struct GoBoardSnapshotRegion*) regionAtIndex:(int)regionIndex
+{
+  if (regionIndex < 0 || regionIndex >= _numberOfRegions)
+  {
+    NSString* errorMessage = [NSString stringWithFormat:@"Region index %d is out of range", regionIndex];
+    DDLogError(@"%@: %@", self, errorMessage);
+    NSException* exception = [NSException exceptionWithName:NSRangeException
+                                                     reason:errorMessage
+                                                   userInfo:nil];
+    @throw exception;
+  }
+  return &m_regions[regionIndex];
+}
+
+// -----------------------------------------------------------------------------
+// Property is documented in the header file.
+// -----------------------------------------------------------------------------
+- (const struct GoBitboard*) onBoardMask
+{
+  return &m_onBoardMask;
+}
+
+// -----------------------------------------------------------------------------
+// Property is documented in the header file.
+// -----------------------------------------------------------------------------
+- (const struct GoBitboard*) blackStones
+{
+  return &m_blackStones;
+}
+
+// -----------------------------------------------------------------------------
+// Property is documented in the header file.
+// -----------------------------------------------------------------------------
+- (const struct GoBitboard*) whiteStones
+{
+  return &m_whiteStones;
+}
+
+@end
@@ -0,0 +1,149 @@
+// -----------------------------------------------------------------------------
+// Copyright 2014 Patrick Näf (herzbube@herzbube.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// -----------------------------------------------------------------------------
+
+
+// Project includes
+#import "GoBitboard.h"
+
+
+// -----------------------------------------------------------------------------
+/// @brief The GoBoardState struct stores the stone state of all intersections
+/// of a GoBoard in a flat array of integers.
+///
+/// @ingroup go
+///
+/// GoBoardState is intended for algorithms that must examine many
+/// intersections in a tight loop (e.g. legality checks, capture detection,
+/// drawing). Such algorithms can use simple integer arithmetic instead of
+/// sending messages to GoPoint objects.
+///
+/// The array is padded, i.e. each row and each column of the board is
+/// surrounded by an extra "border" intersection on both sides. For a board of
+/// size N there are (N + 2) * (N + 2) entries. Because of the padding, the
+/// index of a neighbouring intersection can always be calculated by adding one
+/// of the values in @e neighbourOffsets to the index of an intersection,
+/// without having to check first whether the intersection is located on the
+/// edge of the board. Border entries have the value #GoBoardStateBorder.
+///
+/// Point index 0 is a border entry, i.e. it is never the index of an actual
+/// intersection. Clients may therefore use 0 to mean "no intersection".
+///
+/// In addition to the stone state, GoBoardState also stores the region ID (see
+/// GoBoardRegion::regionID()) of each intersection. This allows to find out
+/// whether two intersections belong to the same GoBoardRegion by comparing
+/// two integers.
+///
+/// Finally, GoBoardState stores the territory statistics score (see
+/// GoPoint::territoryStatisticsScore()) of each intersection. The scores are
+/// written in one pass when a territory statistics evaluation is received from
+/// the GTP engine, and read in one pass when player influence is drawn.
+///
+/// GoBoard owns the GoBoardState instance. GoPoint keeps the state up-to-date
+/// whenever its stone state or its region changes.
+///
+///
+/// @par Stone groups
+///
+/// GoBoardState also tracks stone groups and their liberties, independently of
+/// GoBoardRegion. The goal is to be able to answer the question "how many
+/// liberties does the stone group at this intersection have?" in constant time
+/// (GoBoardStateLibertiesOfGroup()), because legality checks and capture
+/// detection ask this question very often.
+///
+/// Stone groups are organized as a union-find structure: Every stone points to
+/// a parent stone in the same group, and the root stone stores the data of the
+/// entire group, i.e. the number of stones, the liberty count and a bit set of
+/// liberties. The stones of a group are also linked into a circular list so
+/// that they can be iterated without examining the entire board.
+///
+/// - Placing a stone merges the groups of adjacent stones of the same color
+///   (union by size) and removes the intersection from the liberties of all
+///   adjacent groups. This is cheap and done immediately.
+/// - Removing a stone (capture, undo) is the difficult case because a group
+///   may fall apart. The group is therefore merely marked as "dirty" and is
+///   rebuilt from its own stones the next time it is accessed. The rebuild is
+///   bounded by the size of the group, it never touches the rest of the board.
+///   Removing all stones of a captured group therefore costs only a single
+///   rebuild, if any.
+///
+/// Clients must change the color of an intersection via GoBoardStateSetColor()
+/// so that stone groups are updated. Clients that cache information derived
+/// from the stone state can compare @e modificationCount to find out whether
+/// the board has changed in the meantime.
+///
+///
+/// @par Bitboards
+///
+/// @e onBoardMask is a GoBitboard that contains the point indexes of all
+/// intersections on the board. Algorithms that use GoBitboard operations
+/// (e.g. GoBitboardDilate()) use it to discard the border entries.
+///
+/// @e blackStones and @e whiteStones are GoBitboards that contain the point
+/// indexes of all black and white stones. They are kept up-to-date together
+/// with @e colors. Together they are a compact snapshot of the stone state of
+/// the entire board.
+// -----------------------------------------------------------------------------
+struct GoBoardState
+{
+  int boardSize;             ///< @brief The board dimension, e.g. 19.
+  int rowStride;             ///< @brief The number of entries per row, including padding.
+  int numberOfPointIndexes;  ///< @brief The number of entries in @e colors, including padding.
+  int neighbourOffsets[4];   ///< @brief Offsets to the left, right, upper and lower neighbour.
+  unsigned char* colors;     ///< @brief Values from enum GoColor, or #GoBoardStateBorder.
+  int* regionIDs;            ///< @brief GoBoardRegion::regionID() of each intersection, 0 for border entries.
+  float* territoryStatisticsScores;  ///< @brief GoPoint::territoryStatisticsScore() of each intersection, 0 for border entries.
+  int* groupParents;         ///< @brief Union-find parent of each stone. Empty intersections are their own parent.
+  int* groupNextStones;      ///< @brief Next stone in the circular list of stones of the same group.
+  int* groupSizes;           ///< @brief Number of stones in a group. Valid only for root stones.
+  int* groupLibertyCounts;   ///< @brief Number of liberties of a group. Valid only for root stones.
+  unsigned long long* groupLibertySets;  ///< @brief Liberty bit sets, @e numberOfLibertyWords per point index. Valid only for root stones.
+  int numberOfLibertyWords;  ///< @brief The number of 64-bit words in a liberty bit set.
+  unsigned char* groupIsDirty;  ///< @brief Is non-zero if a group must be rebuilt. Valid only for root stones.
+  int* markers;              ///< @brief Scratch array for algorithms that must mark visited intersections.
+  int markerGeneration;      ///< @brief The value that counts as "marked" in @e markers.
+  int* scratchPointIndexes;  ///< @brief Scratch array with room for @e numberOfPointIndexes entries.
+  struct GoBitboard onBoardMask;  ///< @brief Point indexes of all intersections on the board.
+  struct GoBitboard blackStones;  ///< @brief Point indexes of all black stones.
+  struct GoBitboard whiteStones;  ///< @brief Point indexes of all white stones.
+  int modificationCount;     ///< @brief Is incremented by GoBoardStateSetColor() whenever the color of an intersection changes.
+};
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/// @brief Value that marks an entry in GoBoardState.colors that is not an
+/// intersection on the board.
+extern const unsigned char GoBoardStateBorder;
+
+// Helper functions
+extern struct GoBoardState* GoBoardStateCreate(int boardSize);
+extern void GoBoardStateFree(struct GoBoardState* boardState);
+extern int GoBoardStatePointIndexOfVertex(const struct GoBoardState* boardState, int x, int y);
+extern int GoBoardStateXOfPointIndex(const struct GoBoardState* boardState, int pointIndex);
+extern int GoBoardStateYOfPointIndex(const struct GoBoardState* boardState, int pointIndex);
+extern int GoBoardStateNumberOfEmptyNeighbours(const struct GoBoardState* boardState, int pointIndex);
+extern void GoBoardStateSetColor(struct GoBoardState* boardState, int pointIndex, enum GoColor color);
+extern int GoBoardStateLibertiesOfGroup(struct GoBoardState* boardState, int pointIndex);
+extern int GoBoardStateSizeOfGroup(struct GoBoardState* boardState, int pointIndex);
+extern void GoBoardStateRebuildGroups(struct GoBoardState* boardState);
+extern int GoBoardStateNextMarkerGeneration(struct GoBoardState* boardState);
+extern bool GoBoardStateIsRegionSplitPossible(const struct GoBoardState* boardState, int pointIndex, int regionID);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
@@ -0,0 +1,584 @@
+// -----------------------------------------------------------------------------
+// Copyright 2014 Patrick Näf (herzbube@herzbube.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// -----------------------------------------------------------------------------
+
+
+
+// Project includes
+#import "GoBoardState.h"
+
+
+const unsigned char GoBoardStateBorder = 0xff;
+
+// Forward declarations of private helpers
+static void GoBoardStateResetGroup(struct GoBoardState* boardState, int pointIndex);
+static void GoBoardStateRegroupStones(struct GoBoardState* boardState, int* pointIndexes, int numberOfPointIndexes);
+
+
+// -----------------------------------------------------------------------------
+/// @brief Allocates and returns a new GoBoardState for a board of size
+/// @a boardSize. All intersections are initially empty (#GoColorNone).
+///
+/// The caller is responsible for releasing the memory by invoking
+/// GoBoardStateFree().
+// -----------------------------------------------------------------------------
+struct GoBoardState* GoBoardStateCreate(int boardSize)
+{
+  struct GoBoardState* boardState = malloc(sizeof(struct GoBoardState));
+  boardState->boardSize = boardSize;
+  boardState->rowStride = boardSize + 2;
+  boardState->numberOfPointIndexes = boardState->rowStride * boardState->rowStride;
+  boardState->neighbourOffsets[0] = -1;                      // left
+  boardState->neighbourOffsets[1] = 1;                       // right
+  boardState->neighbourOffsets[2] = boardState->rowStride;   // up
+  boardState->neighbourOffsets[3] = -boardState->rowStride;  // down
+  boardState->colors = malloc(boardState->numberOfPointIndexes * sizeof(unsigned char));
+  memset(boardState->colors, GoBoardStateBorder, boardState->numberOfPointIndexes);
+  boardState->regionIDs = calloc(boardState->numberOfPointIndexes, sizeof(int));
+  boardState->territoryStatisticsScores = calloc(boardState->numberOfPointIndexes, sizeof(float));
+  boardState->groupParents = malloc(boardState->numberOfPointIndexes * sizeof(int));
+  boardState->groupNextStones = malloc(boardState->numberOfPointIndexes * sizeof(int));
+  boardState->groupSizes = malloc(boardState->numberOfPointIndexes * sizeof(int));
+  boardState->groupLibertyCounts = malloc(boardState->numberOfPointIndexes * sizeof(int));
+  boardState->numberOfLibertyWords = (boardState->numberOfPointIndexes + 63) / 64;
+  boardState->groupLibertySets = malloc(boardState->numberOfPointIndexes * boardState->numberOfLibertyWords * sizeof(unsigned long long));
+  boardState->groupIsDirty = malloc(boardState->numberOfPointIndexes * sizeof(unsigned char));
+  boardState->markers = calloc(boardState->numberOfPointIndexes, sizeof(int));
+  boardState->markerGeneration = 0;
+  boardState->scratchPointIndexes = malloc(boardState->numberOfPointIndexes * sizeof(int));
+  boardState->modificationCount = 0;
+  GoBitboardClear(&boardState->onBoardMask);
+  GoBitboardClear(&boardState->blackStones);
+  GoBitboardClear(&boardState->whiteStones);
+  for (int pointIndex = 0; pointIndex < boardState->numberOfPointIndexes; ++pointIndex)
+    GoBoardStateResetGroup(boardState, pointIndex);
+  for (int y = 1; y <= boardSize; ++y)
+  {
+    for (int x = 1; x <= boardSize; ++x)
+    {
+      int pointIndex = GoBoardStatePointIndexOfVertex(boardState, x, y);
+      boardState->colors[pointIndex] = GoColorNone;
+      GoBitboardSetBit(&boardState->onBoardMask, pointIndex);
+    }
+  }
+  return boardState;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Releases the memory of @a boardState. Does nothing if
+/// @a boardState is NULL.
+// -----------------------------------------------------------------------------
+void GoBoardStateFree(struct GoBoardState* boardState)
+{
+  if (! boardState)
+    return;
+  free(boardState->colors);
+  free(boardState->regionIDs);
+  free(boardState->territoryStatisticsScores);
+  free(boardState->groupParents);
+  free(boardState->groupNextStones);
+  free(boardState->groupSizes);
+  free(boardState->groupLibertyCounts);
+  free(boardState->groupLibertySets);
+  free(boardState->groupIsDirty);
+  free(boardState->markers);
+  free(boardState->scratchPointIndexes);
+  free(boardState);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns the point index of the intersection identified by the
+/// numeric vertex compounds @a x and @a y. Both compounds are 1-based.
+// -----------------------------------------------------------------------------
+int GoBoardStatePointIndexOfVertex(const struct GoBoardState* boardState, int x, int y)
+{
+  return y * boardState->rowStride + x;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns the 1-based horizontal vertex compound of the intersection
+/// identified by @a pointIndex.
+// -----------------------------------------------------------------------------
+int GoBoardStateXOfPointIndex(const struct GoBoardState* boardState, int pointIndex)
+{
+  return pointIndex % boardState->rowStride;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns the 1-based vertical vertex compound of the intersection
+/// identified by @a pointIndex.
+// -----------------------------------------------------------------------------
+int GoBoardStateYOfPointIndex(const struct GoBoardState* boardState, int pointIndex)
+{
+  return pointIndex / boardState->rowStride;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns the number of empty intersections that are direct neighbours
+/// of the intersection identified by @a pointIndex.
+// -----------------------------------------------------------------------------
+int GoBoardStateNumberOfEmptyNeighbours(const struct GoBoardState* boardState, int pointIndex)
+{
+  int numberOfEmptyNeighbours = 0;
+  for (int direction = 0; direction < 4; ++direction)
+  {
+    if (GoColorNone == boardState->colors[pointIndex + boardState->neighbourOffsets[direction]])
+      numberOfEmptyNeighbours++;
+  }
+  return numberOfEmptyNeighbours;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns a new marker generation. After this function returns, no
+/// entry in GoBoardState.markers is marked.
+///
+/// Algorithms mark an intersection by assigning the returned value to its
+/// entry in GoBoardState.markers. This avoids having to clear the array before
+/// each use.
+// -----------------------------------------------------------------------------
+int GoBoardStateNextMarkerGeneration(struct GoBoardState* boardState)
+{
+  boardState->markerGeneration++;
+  if (boardState->markerGeneration <= 0)
+  {
+    // Overflow: Start over with a clean array
+    memset(boardState->markers, 0, boardState->numberOfPointIndexes * sizeof(int));
+    boardState->markerGeneration = 1;
+  }
+  return boardState->markerGeneration;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Turns the intersection identified by @a pointIndex into a group of
+/// its own that has no liberties.
+///
+/// This is a private helper.
+// -----------------------------------------------------------------------------
+static void GoBoardStateResetGroup(struct GoBoardState* boardState, int pointIndex)
+{
+  boardState->groupParents[pointIndex] = pointIndex;
+  boardState->groupNextStones[pointIndex] = pointIndex;
+  boardState->groupSizes[pointIndex] = 1;
+  boardState->groupLibertyCounts[pointIndex] = 0;
+  boardState->groupIsDirty[pointIndex] = 0;
+  memset(boardState->groupLibertySets + pointIndex * boardState->numberOfLibertyWords,
+         0,
+         boardState->numberOfLibertyWords * sizeof(unsigned long long));
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns the root of the group that the intersection identified by
+/// @a pointIndex belongs to. Compresses the path to the root along the way.
+///
+/// This is a private helper.
+// -----------------------------------------------------------------------------
+static int GoBoardStateFindGroup(struct GoBoardState* boardState, int pointIndex)
+{
+  int* groupParents = boardState->groupParents;
+  int root = pointIndex;
+  while (groupParents[root] != root)
+    root = groupParents[root];
+  while (groupParents[pointIndex] != root)
+  {
+    int parent = groupParents[pointIndex];
+    groupParents[pointIndex] = root;
+    pointIndex = parent;
+  }
+  return root;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Adds the liberty @a libertyIndex to the group whose root is
+/// @a root. Does nothing if the group already has that liberty.
+///
+/// This is a private helper.
+// -----------------------------------------------------------------------------
+static void GoBoardStateAddLiberty(struct GoBoardState* boardState, int root, int libertyIndex)
+{
+  unsigned long long* word = boardState->groupLibertySets + root * boardState->numberOfLibertyWords + libertyIndex / 64;
+  unsigned long long bit = 1ULL << (libertyIndex % 64);
+  if (*word & bit)
+    return;
+  *word |= bit;
+  boardState->groupLibertyCounts[root]++;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Removes the liberty @a libertyIndex from the group whose root is
+/// @a root. Does nothing if the group does not have that liberty.
+///
+/// This is a private helper.
+// -----------------------------------------------------------------------------
+static void GoBoardStateRemoveLiberty(struct GoBoardState* boardState, int root, int libertyIndex)
+{
+  unsigned long long* word = boardState->groupLibertySets + root * boardState->numberOfLibertyWords + libertyIndex / 64;
+  unsigned long long bit = 1ULL << (libertyIndex % 64);
+  if (! (*word & bit))
+    return;
+  *word &= ~bit;
+  boardState->groupLibertyCounts[root]--;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Merges the two different groups whose roots are @a root1 and
+/// @a root2. Returns the root of the merged group.
+///
+/// This is a private helper.
+// -----------------------------------------------------------------------------
+static int GoBoardStateUnionGroups(struct GoBoardState* boardState, int root1, int root2)
+{
+  // Union by size: The smaller group is attached to the larger group
+  if (boardState->groupSizes[root1] < boardState->groupSizes[root2])
+  {
+    int root = root1;
+    root1 = root2;
+    root2 = root;
+  }
+  boardState->groupParents[root2] = root1;
+  boardState->groupSizes[root1] += boardState->groupSizes[root2];
+
+  int numberOfLibertyWords = boardState->numberOfLibertyWords;
+  unsigned long long* libertySet1 = boardState->groupLibertySets + root1 * numberOfLibertyWords;
+  unsigned long long* libertySet2 = boardState->groupLibertySets + root2 * numberOfLibertyWords;
+  int libertyCount = 0;
+  for (int indexOfWord = 0; indexOfWord < numberOfLibertyWords; ++indexOfWord)
+  {
+    libertySet1[indexOfWord] |= libertySet2[indexOfWord];
+    libertyCount += __builtin_popcountll(libertySet1[indexOfWord]);
+  }
+  boardState->groupLibertyCounts[root1] = libertyCount;
+
+  // Splice the two circular lists of stones
+  int nextStone = boardState->groupNextStones[root1];
+  boardState->groupNextStones[root1] = boardState->groupNextStones[root2];
+  boardState->groupNextStones[root2] = nextStone;
+
+  return root1;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Rebuilds the group whose root is @a root if it is marked dirty.
+/// Returns the new root of the group that contains @a pointIndex.
+///
+/// This is a private helper.
+// -----------------------------------------------------------------------------
+static int GoBoardStateCleanGroup(struct GoBoardState* boardState, int root, int pointIndex)
+{
+  if (! boardState->groupIsDirty[root])
+    return root;
+
+  // Collect all stones that were part of the group when it was marked dirty,
+  // including those that have been removed since then. The latter will become
+  // empty intersections again.
+  int* stones = boardState->scratchPointIndexes;
+  int numberOfStones = 0;
+  int stone = root;
+  do
+  {
+    stones[numberOfStones++] = stone;
+    stone = boardState->groupNextStones[stone];
+  }
+  while (stone != root);
+
+  GoBoardStateRegroupStones(boardState, stones, numberOfStones);
+  return GoBoardStateFindGroup(boardState, pointIndex);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Forms new groups from the intersections in @a pointIndexes. Empty
+/// intersections are reset to their initial state.
+///
+/// The stones in @a pointIndexes must not belong to a group that also contains
+/// stones not in @a pointIndexes.
+///
+/// This is a private helper.
+// -----------------------------------------------------------------------------
+static void GoBoardStateRegroupStones(struct GoBoardState* boardState, int* pointIndexes, int numberOfPointIndexes)
+{
+  unsigned char* colors = boardState->colors;
+  int* markers = boardState->markers;
+
+  for (int index = 0; index < numberOfPointIndexes; ++index)
+    GoBoardStateResetGroup(boardState, pointIndexes[index]);
+
+  int markerGeneration = GoBoardStateNextMarkerGeneration(boardState);
+  for (int index = 0; index < numberOfPointIndexes; ++index)
+  {
+    int pointIndex = pointIndexes[index];
+    enum GoColor color = colors[pointIndex];
+    if (GoColorNone == color)
+      continue;
+    for (int direction = 0; direction < 4; ++direction)
+    {
+      int neighbourIndex = pointIndex + boardState->neighbourOffsets[direction];
+      if (GoColorNone == colors[neighbourIndex])
+      {
+        GoBoardStateAddLiberty(boardState, GoBoardStateFindGroup(boardState, pointIndex), neighbourIndex);
+      }
+      else if (color == colors[neighbourIndex] && markerGeneration == markers[neighbourIndex])
+      {
+        // Only neighbours that have already been processed are merged. The
+        // others will merge with us when it's their turn.
+        int root1 = GoBoardStateFindGroup(boardState, pointIndex);
+        int root2 = GoBoardStateFindGroup(boardState, neighbourIndex);
+        if (root1 != root2)
+          GoBoardStateUnionGroups(boardState, root1, root2);
+      }
+    }
+    markers[pointIndex] = markerGeneration;
+  }
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Places a stone of color @a color on the empty intersection
+/// @a pointIndex.
+///
+/// The intersection must not be a member of a dirty group.
+///
+/// This is a private helper.
+// -----------------------------------------------------------------------------
+static void GoBoardStatePlaceStone(struct GoBoardState* boardState, int pointIndex, enum GoColor color)
+{
+  unsigned char* colors = boardState->colors;
+  colors[pointIndex] = color;
+  if (GoColorBlack == color)
+    GoBitboardSetBit(&boardState->blackStones, pointIndex);
+  else
+    GoBitboardSetBit(&boardState->whiteStones, pointIndex);
+  GoBoardStateResetGroup(boardState, pointIndex);
+
+  // Pass 1: Collect our own liberties, and take away a liberty from adjacent
+  // groups. Adjacent groups that are dirty are rebuilt, so that in pass 2 we
+  // never merge with a dirty group.
+  for (int direction = 0; direction < 4; ++direction)
+  {
+    int neighbourIndex = pointIndex + boardState->neighbourOffsets[direction];
+    unsigned char neighbourColor = colors[neighbourIndex];
+    if (GoColorNone == neighbourColor)
+    {
+      GoBoardStateAddLiberty(boardState, pointIndex, neighbourIndex);
+    }
+    else if (GoBoardStateBorder != neighbourColor)
+    {
+      int root = GoBoardStateFindGroup(boardState, neighbourIndex);
+      root = GoBoardStateCleanGroup(boardState, root, neighbourIndex);
+      GoBoardStateRemoveLiberty(boardState, root, pointIndex);
+    }
+  }
+
+  // Pass 2: Merge with adjacent groups of the same color
+  for (int direction = 0; direction < 4; ++direction)
+  {
+    int neighbourIndex = pointIndex + boardState->neighbourOffsets[direction];
+    if (color != colors[neighbourIndex])
+      continue;
+    int root1 = GoBoardStateFindGroup(boardState, pointIndex);
+    int root2 = GoBoardStateFindGroup(boardState, neighbourIndex);
+    if (root1 != root2)
+      GoBoardStateUnionGroups(boardState, root1, root2);
+  }
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Removes the stone from the intersection @a pointIndex.
+///
+/// The group that the stone belongs to is not rebuilt immediately, it is only
+/// marked dirty. See the GoBoardState documentation for details.
+///
+/// This is a private helper.
+// -----------------------------------------------------------------------------
+static void GoBoardStateRemoveStone(struct GoBoardState* boardState, int pointIndex)
+{
+  unsigned char* colors = boardState->colors;
+  enum GoColor removedColor = colors[pointIndex];
+  colors[pointIndex] = GoColorNone;
+  GoBitboardClearBit(&boardState->blackStones, pointIndex);
+  GoBitboardClearBit(&boardState->whiteStones, pointIndex);
+
+  int root = GoBoardStateFindGroup(boardState, pointIndex);
+  if (1 == boardState->groupSizes[root])
+    GoBoardStateResetGroup(boardState, pointIndex);
+  else
+    boardState->groupIsDirty[root] = 1;
+
+  // The intersection becomes a liberty of adjacent groups of the other color.
+  // Dirty groups don't need to be updated because they are going to be
+  // rebuilt anyway.
+  for (int direction = 0; direction < 4; ++direction)
+  {
+    int neighbourIndex = pointIndex + boardState->neighbourOffsets[direction];
+    unsigned char neighbourColor = colors[neighbourIndex];
+    if (GoColorNone == neighbourColor || GoBoardStateBorder == neighbourColor || removedColor == neighbourColor)
+      continue;
+    int neighbourRoot = GoBoardStateFindGroup(boardState, neighbourIndex);
+    if (! boardState->groupIsDirty[neighbourRoot])
+      GoBoardStateAddLiberty(boardState, neighbourRoot, pointIndex);
+  }
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Sets the color of the intersection identified by @a pointIndex to
+/// @a color and incrementally updates the stone groups.
+// -----------------------------------------------------------------------------
+void GoBoardStateSetColor(struct GoBoardState* boardState, int pointIndex, enum GoColor color)
+{
+  enum GoColor oldColor = boardState->colors[pointIndex];
+  if (oldColor == color)
+    return;
+  ++boardState->modificationCount;
+  if (GoColorNone != oldColor)
+    GoBoardStateRemoveStone(boardState, pointIndex);
+  if (GoColorNone != color)
+  {
+    // The intersection may still be a member of a dirty group. Cleaning the
+    // group turns the intersection back into a group of its own.
+    int root = GoBoardStateFindGroup(boardState, pointIndex);
+    GoBoardStateCleanGroup(boardState, root, pointIndex);
+    GoBoardStatePlaceStone(boardState, pointIndex, color);
+  }
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns the number of liberties of the stone group that the stone
+/// on the intersection identified by @a pointIndex belongs to.
+///
+/// The result is undefined if the intersection has no stone.
+// -----------------------------------------------------------------------------
+int GoBoardStateLibertiesOfGroup(struct GoBoardState* boardState, int pointIndex)
+{
+  int root = GoBoardStateFindGroup(boardState, pointIndex);
+  root = GoBoardStateCleanGroup(boardState, root, pointIndex);
+  return boardState->groupLibertyCounts[root];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns the number of stones in the stone group that the stone on
+/// the intersection identified by @a pointIndex belongs to.
+///
+/// The result is undefined if the intersection has no stone.
+// -----------------------------------------------------------------------------
+int GoBoardStateSizeOfGroup(struct GoBoardState* boardState, int pointIndex)
+{
+  int root = GoBoardStateFindGroup(boardState, pointIndex);
+  root = GoBoardStateCleanGroup(boardState, root, pointIndex);
+  return boardState->groupSizes[root];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Discards all stone group information and rebuilds it from scratch
+/// from the colors currently stored in @a boardState. The stone bitboards are
+/// also rebuilt.
+///
+/// This is intended to be used after the colors were populated without using
+/// GoBoardStateSetColor(), e.g. after an NSCoding archive has been decoded.
+// -----------------------------------------------------------------------------
+void GoBoardStateRebuildGroups(struct GoBoardState* boardState)
+{
+  int* pointIndexes = boardState->scratchPointIndexes;
+  int numberOfPointIndexes = 0;
+  GoBitboardClear(&boardState->blackStones);
+  GoBitboardClear(&boardState->whiteStones);
+  for (int pointIndex = 0; pointIndex < boardState->numberOfPointIndexes; ++pointIndex)
+  {
+    unsigned char color = boardState->colors[pointIndex];
+    if (GoBoardStateBorder == color)
+    {
+      GoBoardStateResetGroup(boardState, pointIndex);
+      continue;
+    }
+    pointIndexes[numberOfPointIndexes++] = pointIndex;
+    if (GoColorBlack == color)
+      GoBitboardSetBit(&boardState->blackStones, pointIndex);
+    else if (GoColorWhite == color)
+      GoBitboardSetBit(&boardState->whiteStones, pointIndex);
+  }
+  GoBoardStateRegroupStones(boardState, pointIndexes, numberOfPointIndexes);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns false if it is certain that the region with ID @a regionID
+/// does not split into several parts after the intersection identified by
+/// @a pointIndex has been removed from the region. Returns true if a split is
+/// possible, in which case the caller must perform a full connectivity check.
+///
+/// The check is strictly local: It examines the 8 intersections surrounding
+/// the removed intersection. If all direct neighbours that are still part of
+/// the region are connected to each other via intersections in that
+/// surrounding ring, the region cannot split.
+// -----------------------------------------------------------------------------
+bool GoBoardStateIsRegionSplitPossible(const struct GoBoardState* boardState, int pointIndex, int regionID)
+{
+  int rowStride = boardState->rowStride;
+  // The ring of intersections around pointIndex, in circular order. Even
+  // positions are direct neighbours, odd positions are diagonal neighbours.
+  int ring[8] =
+  {
+    pointIndex - 1,              // left
+    pointIndex - 1 + rowStride,  // upper-left
+    pointIndex + rowStride,      // up
+    pointIndex + 1 + rowStride,  // upper-right
+    pointIndex + 1,              // right
+    pointIndex + 1 - rowStride,  // lower-right
+    pointIndex - rowStride,      // down
+    pointIndex - 1 - rowStride,  // lower-left
+  };
+  bool isInRegion[8];
+  int numberOfDirectNeighboursInRegion = 0;
+  for (int indexInRing = 0; indexInRing < 8; ++indexInRing)
+  {
+    isInRegion[indexInRing] = (boardState->regionIDs[ring[indexInRing]] == regionID);
+    if (isInRegion[indexInRing] && 0 == indexInRing % 2)
+      numberOfDirectNeighboursInRegion++;
+  }
+  if (numberOfDirectNeighboursInRegion < 2)
+    return false;
+
+  // Count the runs of consecutive intersections in the ring that belong to the
+  // region and contain at least one direct neighbour. Find a start position
+  // that is not in the region so that runs don't wrap around.
+  int startIndexInRing = -1;
+  for (int indexInRing = 0; indexInRing < 8; ++indexInRing)
+  {
+    if (! isInRegion[indexInRing])
+    {
+      startIndexInRing = indexInRing;
+      break;
+    }
+  }
+  if (-1 == startIndexInRing)
+    return false;  // the entire ring is in the region
+
+  int numberOfRunsWithDirectNeighbours = 0;
+  bool isInRun = false;
+  bool runHasDirectNeighbour = false;
+  for (int offset = 1; offset <= 8; ++offset)
+  {
+    int indexInRing = (startIndexInRing + offset) % 8;
+    if (isInRegion[indexInRing])
+    {
+      isInRun = true;
+      if (0 == indexInRing % 2)
+        runHasDirectNeighbour = true;
+    }
+    else if (isInRun)
+    {
+      if (runHasDirectNeighbour)
+        numberOfRunsWithDirectNeighbours++;
+      isInRun = false;
+      runHasDirectNeighbour = false;
+    }
+  }
+  return (numberOfRunsWithDirectNeighbours > 1);
+}
@@ -0,0 +1,69 @@
+// -----------------------------------------------------------------------------
+// Copyright 2014 Patrick Näf (herzbube@herzbube.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// -----------------------------------------------------------------------------
+
+
+
+// Forward declarations
+@class GoBoardSnapshot;
+
+
+// -----------------------------------------------------------------------------
+/// @brief The GoDeadStoneEstimator class provides a fast, in-process estimate
+/// of which stone groups on the board are dead.
+///
+/// @ingroup go
+///
+/// The estimate is intended to be a starting point for scoring, at a time when
+/// the game has ended and the board is mostly settled. It is a heuristic and
+/// can be wrong, the user is expected to correct it. Its main advantage is
+/// that it takes only a few milliseconds, even on a 19x19 board, whereas the
+/// GTP engine may need several seconds to answer the same question.
+///
+/// The estimate is made while scoring is in progress, i.e. in a secondary
+/// thread, so it must not read GoPoint or GoBoardRegion objects. Instead it
+/// operates exclusively on a GoBoardSnapshot that was created with
+/// GoBoardSnapshot::snapshotWithRegions:(). Stone groups are identified by
+/// their region index in that snapshot.
+///
+/// The estimate is made in three steps:
+/// - Step 1: Benson's algorithm finds the stone groups of each color that are
+///   unconditionally alive, i.e. that cannot be captured even if the owner
+///   always passes. Enclosed regions that are bordered only by such stone
+///   groups, and whose empty intersections are all adjacent to them, are
+///   unconditional territory. Opposing stone groups in unconditional
+///   territory are dead.
+/// - Step 2: Eye space heuristic. An empty region that is bordered only by
+///   stone groups of one color (ignoring opposing stone groups found dead in
+///   step 1) is an eye for these stone groups. An eye with seven or more
+///   intersections is large enough to make two eyes. Stone groups with two or
+///   more eyes are alive.
+/// - Step 3: Territory heuristic. A stone group that is neither alive nor
+///   dead after steps 1 and 2 is dead if all empty regions adjacent to it
+///   are also adjacent to alive opposing stone groups, and if none of them is
+///   adjacent to an alive stone group of its own color.
+///
+/// All functions in GoDeadStoneEstimator are class methods, so there is no
+/// need to create an instance of GoDeadStoneEstimator.
+// -----------------------------------------------------------------------------
+@interface GoDeadStoneEstimator : NSObject
+{
+}
+
++ (NSIndexSet*) deadStoneGroupsInBoardSnapshot:(GoBoardSnapshot*)boardSnapshot;
++ (NSIndexSet*) unconditionallyAliveStoneGroupsOfColor:(enum GoColor)color
+                                       inBoardSnapshot:(GoBoardSnapshot*)boardSnapshot;
+
+@end
@@ -0,0 +1,347 @@
+// -----------------------------------------------------------------------------
+// Copyright 2014 Patrick Näf (herzbube@herzbube.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// -----------------------------------------------------------------------------
+
+
+
+// Project includes
+#import "GoDeadStoneEstimator.h"
+#import "GoBitboard.h"
+#import "GoBoardSnapshot.h"
+
+
+/// @brief Empty regions of at least this size are large enough to make two
+/// eyes.
+static const int largeEyeSpaceSize = 7;
+
+
+@implementation GoDeadStoneEstimator
+
+// -----------------------------------------------------------------------------
+/// @brief Returns an estimate of the stone groups in @a boardSnapshot that are
+/// dead. The index set contains region indexes of @a boardSnapshot, it is
+/// empty if no stone groups are estimated to be dead. @a boardSnapshot must
+/// have been created by GoBoardSnapshot::snapshotWithRegions:().
+///
+/// See the class documentation for details about how the estimate is made.
+// -----------------------------------------------------------------------------
++ (NSIndexSet*) deadStoneGroupsInBoardSnapshot:(GoBoardSnapshot*)boardSnapshot
+{
+  int numberOfRegions = boardSnapshot.numberOfRegions;
+  if (0 == numberOfRegions)
+    return [NSIndexSet indexSet];
+
+  // Step 1: Benson's algorithm for both colors
+  struct GoBitboard blackTerritory;
+  struct GoBitboard whiteTerritory;
+  NSMutableIndexSet* aliveStoneGroups = [NSMutableIndexSet indexSet];
+  [aliveStoneGroups addIndexes:[GoDeadStoneEstimator unconditionallyAliveStoneGroupsOfColor:GoColorBlack
+                                                                            inBoardSnapshot:boardSnapshot
+                                                                     unconditionalTerritory:&blackTerritory]];
+  [aliveStoneGroups addIndexes:[GoDeadStoneEstimator unconditionallyAliveStoneGroupsOfColor:GoColorWhite
+                                                                            inBoardSnapshot:boardSnapshot
+                                                                     unconditionalTerritory:&whiteTerritory]];
+  NSMutableIndexSet* deadStoneGroups = [NSMutableIndexSet indexSet];
+  for (int regionIndex = 0; regionIndex < numberOfRegions; ++regionIndex)
+  {
+    enum GoColor color = [boardSnapshot colorOfRegion:regionIndex];
+    if (GoColorNone == color || [aliveStoneGroups containsIndex:regionIndex])
+      continue;
+    const struct GoBitboard* opposingTerritory = (GoColorBlack == color) ? &whiteTerritory : &blackTerritory;
+    if (GoBitboardIntersects([boardSnapshot pointsOfRegion:regionIndex], opposingTerritory))
+      [deadStoneGroups addIndex:regionIndex];
+  }
+
+  // Step 2: Eye space heuristic. Stone groups found alive in this step are
+  // collected separately so that the result does not depend on the order in
+  // which stone groups are examined.
+  NSMutableIndexSet* stoneGroupsWithTwoEyes = [NSMutableIndexSet indexSet];
+  for (int regionIndex = 0; regionIndex < numberOfRegions; ++regionIndex)
+  {
+    enum GoColor color = [boardSnapshot colorOfRegion:regionIndex];
+    if (GoColorNone == color || [aliveStoneGroups containsIndex:regionIndex] || [deadStoneGroups containsIndex:regionIndex])
+      continue;
+    int numberOfEyes = 0;
+    int numberOfAdjacentRegions;
+    const int* adjacentRegions = [boardSnapshot adjacentRegionsOfRegion:regionIndex count:&numberOfAdjacentRegions];
+    for (int indexOfAdjacentRegion = 0; indexOfAdjacentRegion < numberOfAdjacentRegions; ++indexOfAdjacentRegion)
+    {
+      int adjacentRegion = adjacentRegions[indexOfAdjacentRegion];
+      if (GoColorNone != [boardSnapshot colorOfRegion:adjacentRegion])
+        continue;
+      if (! [GoDeadStoneEstimator isEye:adjacentRegion ofColor:color deadStoneGroups:deadStoneGroups boardSnapshot:boardSnapshot])
+        continue;
+      numberOfEyes += ([boardSnapshot sizeOfRegion:adjacentRegion] >= largeEyeSpaceSize) ? 2 : 1;
+    }
+    if (numberOfEyes >= 2)
+      [stoneGroupsWithTwoEyes addIndex:regionIndex];
+  }
+  [aliveStoneGroups addIndexes:stoneGroupsWithTwoEyes];
+
+  // Step 3: Territory heuristic
+  NSMutableIndexSet* surroundedStoneGroups = [NSMutableIndexSet indexSet];
+  for (int regionIndex = 0; regionIndex < numberOfRegions; ++regionIndex)
+  {
+    enum GoColor color = [boardSnapshot colorOfRegion:regionIndex];
+    if (GoColorNone == color || [aliveStoneGroups containsIndex:regionIndex] || [deadStoneGroups containsIndex:regionIndex])
+      continue;
+    bool isSurrounded = false;
+    int numberOfAdjacentRegions;
+    const int* adjacentRegions = [boardSnapshot adjacentRegionsOfRegion:regionIndex count:&numberOfAdjacentRegions];
+    for (int indexOfAdjacentRegion = 0; indexOfAdjacentRegion < numberOfAdjacentRegions; ++indexOfAdjacentRegion)
+    {
+      int adjacentRegion = adjacentRegions[indexOfAdjacentRegion];
+      if (GoColorNone != [boardSnapshot colorOfRegion:adjacentRegion])
+        continue;
+      bool aliveOpposingStoneGroupSeen = false;
+      bool aliveOwnStoneGroupSeen = false;
+      int numberOfStoneGroupsAdjacentToRegion;
+      const int* stoneGroupsAdjacentToRegion = [boardSnapshot adjacentRegionsOfRegion:adjacentRegion count:&numberOfStoneGroupsAdjacentToRegion];
+      for (int indexOfStoneGroup = 0; indexOfStoneGroup < numberOfStoneGroupsAdjacentToRegion; ++indexOfStoneGroup)
+      {
+        int stoneGroupAdjacentToRegion = stoneGroupsAdjacentToRegion[indexOfStoneGroup];
+        if (! [aliveStoneGroups containsIndex:stoneGroupAdjacentToRegion])
+          continue;
+        if ([boardSnapshot colorOfRegion:stoneGroupAdjacentToRegion] == color)
+          aliveOwnStoneGroupSeen = true;
+        else
+          aliveOpposingStoneGroupSeen = true;
+      }
+      if (! aliveOpposingStoneGroupSeen || aliveOwnStoneGroupSeen)
+      {
+        isSurrounded = false;
+        break;
+      }
+      isSurrounded = true;
+    }
+    if (isSurrounded)
+      [surroundedStoneGroups addIndex:regionIndex];
+  }
+  [deadStoneGroups addIndexes:surroundedStoneGroups];
+
+  return deadStoneGroups;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns the stone groups of color @a color in @a boardSnapshot that
+/// are unconditionally alive according to Benson's algorithm. The index set
+/// contains region indexes of @a boardSnapshot, which must have been created
+/// by GoBoardSnapshot::snapshotWithRegions:().
+// -----------------------------------------------------------------------------
++ (NSIndexSet*) unconditionallyAliveStoneGroupsOfColor:(enum GoColor)color
+                                       inBoardSnapshot:(GoBoardSnapshot*)boardSnapshot
+{
+  struct GoBitboard unconditionalTerritory;
+  return [GoDeadStoneEstimator unconditionallyAliveStoneGroupsOfColor:color
+                                                      inBoardSnapshot:boardSnapshot
+                                               unconditionalTerritory:&unconditionalTerritory];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Implements Benson's algorithm for stone groups of color @a color in
+/// @a boardSnapshot. Returns the region indexes of the stone groups that are
+/// unconditionally alive, and fills the out variable @a unconditionalTerritory
+/// with the intersections that are unconditionally controlled by these stone
+/// groups.
+///
+/// Terminology follows Benson: A "chain" is a stone group of color @a color.
+/// An "enclosed region" is a connected set of intersections that are not
+/// occupied by stones of color @a color, i.e. it consists of empty
+/// intersections and opposing stones. An enclosed region is "vital" to a
+/// chain if the chain is adjacent to the region, and if all empty
+/// intersections of the region are liberties of the chain. The algorithm
+/// repeats these two steps until nothing changes anymore:
+/// - Remove all chains that have less than two vital enclosed regions.
+/// - Remove all enclosed regions that are adjacent to a removed chain.
+/// The remaining chains are unconditionally alive.
+///
+/// This is a private helper.
+// -----------------------------------------------------------------------------
++ (NSIndexSet*) unconditionallyAliveStoneGroupsOfColor:(enum GoColor)color
+                                       inBoardSnapshot:(GoBoardSnapshot*)boardSnapshot
+                                unconditionalTerritory:(struct GoBitboard*)unconditionalTerritory
+{
+  int rowStride = boardSnapshot.rowStride;
+  const struct GoBitboard* onBoardMask = boardSnapshot.onBoardMask;
+  const struct GoBitboard* ownStones = (GoColorBlack == color) ? boardSnapshot.blackStones : boardSnapshot.whiteStones;
+  struct GoBitboard emptyPoints;
+  GoBitboardAndNot(&emptyPoints, onBoardMask, boardSnapshot.blackStones);
+  GoBitboardAndNot(&emptyPoints, &emptyPoints, boardSnapshot.whiteStones);
+  GoBitboardClear(unconditionalTerritory);
+
+  int numberOfRegionsInSnapshot = boardSnapshot.numberOfRegions;
+  int* chains = malloc(MAX(numberOfRegionsInSnapshot, 1) * sizeof(int));
+  int numberOfChains = 0;
+  for (int regionIndex = 0; regionIndex < numberOfRegionsInSnapshot; ++regionIndex)
+  {
+    if ([boardSnapshot colorOfRegion:regionIndex] == color)
+      chains[numberOfChains++] = regionIndex;
+  }
+  if (0 == numberOfChains)
+  {
+    free(chains);
+    return [NSIndexSet indexSet];
+  }
+
+  bool* chainIsAlive = malloc(numberOfChains * sizeof(bool));
+  struct GoBitboard* chainLiberties = malloc(numberOfChains * sizeof(struct GoBitboard));
+  for (int indexOfChain = 0; indexOfChain < numberOfChains; ++indexOfChain)
+  {
+    chainIsAlive[indexOfChain] = true;
+    GoBitboardBorder(&chainLiberties[indexOfChain], [boardSnapshot pointsOfRegion:chains[indexOfChain]], rowStride, onBoardMask);
+    GoBitboardAnd(&chainLiberties[indexOfChain], &chainLiberties[indexOfChain], &emptyPoints);
+  }
+
+  // Find the enclosed regions. There cannot be more enclosed regions than
+  // there are intersections that are not occupied by own stones.
+  struct GoBitboard notOwnStones;
+  GoBitboardAndNot(&notOwnStones, onBoardMask, ownStones);
+  int maximumNumberOfRegions = MAX(GoBitboardPopCount(&notOwnStones), 1);
+  struct GoBitboard* regionPoints = malloc(maximumNumberOfRegions * sizeof(struct GoBitboard));
+  struct GoBitboard* regionEmptyPoints = malloc(maximumNumberOfRegions * sizeof(struct GoBitboard));
+  struct GoBitboard* regionBorders = malloc(maximumNumberOfRegions * sizeof(struct GoBitboard));
+  bool* regionIsHealthy = malloc(maximumNumberOfRegions * sizeof(bool));
+  int numberOfRegions = 0;
+  struct GoBitboard remainingPoints = notOwnStones;
+  for (int pointIndex = GoBitboardNextSetBit(&remainingPoints, 0);
+       pointIndex != -1;
+       pointIndex = GoBitboardNextSetBit(&remainingPoints, pointIndex + 1))
+  {
+    struct GoBitboard seed;
+    GoBitboardClear(&seed);
+    GoBitboardSetBit(&seed, pointIndex);
+    GoBitboardFloodFill(&regionPoints[numberOfRegions], &seed, rowStride, &notOwnStones);
+    GoBitboardAndNot(&remainingPoints, &remainingPoints, &regionPoints[numberOfRegions]);
+    GoBitboardAnd(&regionEmptyPoints[numberOfRegions], &regionPoints[numberOfRegions], &emptyPoints);
+    GoBitboardBorder(&regionBorders[numberOfRegions], &regionPoints[numberOfRegions], rowStride, onBoardMask);
+    regionIsHealthy[numberOfRegions] = true;
+    ++numberOfRegions;
+  }
+
+  bool didChange = true;
+  while (didChange)
+  {
+    didChange = false;
+
+    for (int indexOfChain = 0; indexOfChain < numberOfChains; ++indexOfChain)
+    {
+      if (! chainIsAlive[indexOfChain])
+        continue;
+      const struct GoBitboard* chainPoints = [boardSnapshot pointsOfRegion:chains[indexOfChain]];
+      int numberOfVitalRegions = 0;
+      for (int indexOfRegion = 0; indexOfRegion < numberOfRegions && numberOfVitalRegions < 2; ++indexOfRegion)
+      {
+        if (! regionIsHealthy[indexOfRegion])
+          continue;
+        if (! GoBitboardIntersects(&regionBorders[indexOfRegion], chainPoints))
+          continue;
+        struct GoBitboard emptyPointsThatAreNotLiberties;
+        GoBitboardAndNot(&emptyPointsThatAreNotLiberties, &regionEmptyPoints[indexOfRegion], &chainLiberties[indexOfChain]);
+        if (GoBitboardIsEmpty(&emptyPointsThatAreNotLiberties))
+          ++numberOfVitalRegions;
+      }
+      if (numberOfVitalRegions < 2)
+      {
+        chainIsAlive[indexOfChain] = false;
+        didChange = true;
+      }
+    }
+
+    struct GoBitboard removedChainStones;
+    GoBitboardClear(&removedChainStones);
+    for (int indexOfChain = 0; indexOfChain < numberOfChains; ++indexOfChain)
+    {
+      if (! chainIsAlive[indexOfChain])
+        GoBitboardOr(&removedChainStones, &removedChainStones, [boardSnapshot pointsOfRegion:chains[indexOfChain]]);
+    }
+    for (int indexOfRegion = 0; indexOfRegion < numberOfRegions; ++indexOfRegion)
+    {
+      if (! regionIsHealthy[indexOfRegion])
+        continue;
+      if (GoBitboardIntersects(&regionBorders[indexOfRegion], &removedChainStones))
+      {
+        regionIsHealthy[indexOfRegion] = false;
+        didChange = true;
+      }
+    }
+  }
+
+  NSMutableIndexSet* aliveChains = [NSMutableIndexSet indexSet];
+  struct GoBitboard aliveChainStones;
+  GoBitboardClear(&aliveChainStones);
+  for (int indexOfChain = 0; indexOfChain < numberOfChains; ++indexOfChain)
+  {
+    if (! chainIsAlive[indexOfChain])
+      continue;
+    [aliveChains addIndex:chains[indexOfChain]];
+    GoBitboardOr(&aliveChainStones, &aliveChainStones, [boardSnapshot pointsOfRegion:chains[indexOfChain]]);
+  }
+
+  // A remaining enclosed region is unconditional territory if all of its
+  // empty intersections are adjacent to alive chains. The opponent cannot
+  // make an eye in such a region.
+  if (aliveChains.count > 0)
+  {
+    struct GoBitboard pointsAdjacentToAliveChains;
+    GoBitboardBorder(&pointsAdjacentToAliveChains, &aliveChainStones, rowStride, onBoardMask);
+    for (int indexOfRegion = 0; indexOfRegion < numberOfRegions; ++indexOfRegion)
+    {
+      if (! regionIsHealthy[indexOfRegion])
+        continue;
+      struct GoBitboard emptyPointsNotAdjacentToAliveChains;
+      GoBitboardAndNot(&emptyPointsNotAdjacentToAliveChains, &regionEmptyPoints[indexOfRegion], &pointsAdjacentToAliveChains);
+      if (GoBitboardIsEmpty(&emptyPointsNotAdjacentToAliveChains))
+        GoBitboardOr(unconditionalTerritory, unconditionalTerritory, &regionPoints[indexOfRegion]);
+    }
+  }
+
+  free(chains);
+  free(chainIsAlive);
+  free(chainLiberties);
+  free(regionPoints);
+  free(regionEmptyPoints);
+  free(regionBorders);
+  free(regionIsHealthy);
+
+  return aliveChains;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns true if the empty region with index @a emptyRegion is an
+/// eye for stone groups of color @a color, i.e. if all stone groups adjacent
+/// to @a emptyRegion either have color @a color, or are in @a deadStoneGroups.
+///
+/// This is a private helper.
+// -----------------------------------------------------------------------------
++ (bool) isEye:(int)emptyRegion
+       ofColor:(enum GoColor)color
+deadStoneGroups:(NSIndexSet*)deadStoneGroups
+ boardSnapshot:(GoBoardSnapshot*)boardSnapshot
+{
+  int numberOfAdjacentRegions;
+  const int* adjacentRegions = [boardSnapshot adjacentRegionsOfRegion:emptyRegion count:&numberOfAdjacentRegions];
+  for (int indexOfAdjacentRegion = 0; indexOfAdjacentRegion < numberOfAdjacentRegions; ++indexOfAdjacentRegion)
+  {
+    int adjacentRegion = adjacentRegions[indexOfAdjacentRegion];
+    if ([boardSnapshot colorOfRegion:adjacentRegion] == color)
+      continue;
+    if ([deadStoneGroups containsIndex:adjacentRegion])
+      continue;
+    return false;
+  }
+  return true;
+}
+
+@end
@@ -25,6 +25,23 @@
 @class GoPlayer;
 @class GoPoint;
 @class GoScore;
+struct GoBitboard;
+
+
+// -----------------------------------------------------------------------------
+/// @brief The GoGameReplayMove struct describes a single move that is replayed
+/// by GoGame::replayMoves:numberOfMoves:isIllegalReason:().
+///
+/// @ingroup go
+///
+/// The move is always made by the player whose turn it is, therefore the
+/// struct does not record a player.
+// -----------------------------------------------------------------------------
+struct GoGameReplayMove
+{
+  enum GoMoveType type;  ///< @brief The type of the move.
+  int pointIndex;        ///< @brief The GoPoint::pointIndex() of the intersection that is played. Is ignored for #GoMoveTypePass.
+};
 
 
 // -----------------------------------------------------------------------------
@@ -63,10 +80,14 @@
 + (GoGame*) sharedGame;
 - (void) play:(GoPoint*)point;
 - (void) pass;
+- (int) replayMoves:(const struct GoGameReplayMove*)moves
+      numberOfMoves:(int)numberOfMoves
+    isIllegalReason:(enum GoMoveIsIllegalReason*)reason;
 - (void) resign;
 - (void) pause;
 - (void) continue;
 - (bool) isLegalMove:(GoPoint*)point isIllegalReason:(enum GoMoveIsIllegalReason*)reason;
+- (const struct GoBitboard*) legalMoveMask;
 - (bool) isComputerPlayersTurn;
 - (void) revertStateFromEndedToInProgress;
 
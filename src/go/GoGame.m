@@ -20,6 +20,7 @@
 #import "GoBoard.h"
 #import "GoBoardPosition.h"
 #import "GoBoardRegion.h"
+#import "GoBoardState.h"
 #import "GoGameDocument.h"
 #import "GoGameRules.h"
 #import "GoMove.h"
@@ -33,6 +34,48 @@
 #import "../main/ApplicationDelegate.h"
 
 
+// -----------------------------------------------------------------------------
+/// @brief The GoGameLegalMoveMaskKey struct identifies the game situation for
+/// which GoGame's legal move mask was calculated.
+///
+/// The legal move mask remains valid as long as none of the values in this
+/// struct change. GoBoardState.modificationCount changes whenever a stone is
+/// placed or removed, the remaining values change when a move is made or
+/// discarded (even a pass move), or when the board position changes.
+// -----------------------------------------------------------------------------
+struct GoGameLegalMoveMaskKey
+{
+  GoBoard* board;
+  int boardStateModificationCount;
+  GoMove* lastMove;
+  int numberOfMoves;
+  int currentBoardPosition;
+  enum GoColor nextMoveColor;
+  enum GoKoRule koRule;
+};
+
+
+// -----------------------------------------------------------------------------
+/// @brief Class extension with private member variables for GoGame.
+// -----------------------------------------------------------------------------
+@interface GoGame()
+{
+@private
+  /// @brief Point indexes of all intersections on which the current player
+  /// can legally play. Valid only if m_legalMoveMaskIsValid is true and
+  /// m_legalMoveMaskKey matches the current game situation.
+  struct GoBitboard m_legalMoveMask;
+  /// @brief Values from enum GoMoveIsIllegalReason for all point indexes that
+  /// are not in m_legalMoveMask.
+  unsigned char m_illegalReasons[GoBitboardNumberOfWords * 64];
+  /// @brief The game situation for which m_legalMoveMask was calculated.
+  struct GoGameLegalMoveMaskKey m_legalMoveMaskKey;
+  /// @brief Is false if m_legalMoveMask has never been calculated.
+  bool m_legalMoveMaskIsValid;
+}
+@end
+
+
 @implementation GoGame
 
 // -----------------------------------------------------------------------------
@@ -74,6 +117,7 @@
   _rules = [[GoGameRules alloc] init];
   _document = [[GoGameDocument alloc] init];
   _score = [[GoScore alloc] initWithGame:self];
+  m_legalMoveMaskIsValid = false;
   return self;
 }
 
@@ -104,6 +148,7 @@
   _rules = [[decoder decodeObjectForKey:goGameRulesKey] retain];
   _document = [[decoder decodeObjectForKey:goGameDocumentKey] retain];
   _score = [[decoder decodeObjectForKey:goGameScoreKey] retain];
+  m_legalMoveMaskIsValid = false;
 
   return self;
 }
@@ -265,6 +310,136 @@
   }
 }
 
+// -----------------------------------------------------------------------------
+/// @brief Replays the @a numberOfMoves moves in the C array @a moves, as if
+/// play:() or pass() had been invoked for each move, but as a single
+/// transaction.
+///
+/// Returns -1 if all moves were replayed. Otherwise returns the index
+/// position in @a moves of the first move that is illegal, and fills the out
+/// variable @a reason with the reason why the move is illegal. In this case
+/// the game is left in the state it had before this method was invoked, i.e.
+/// none of the moves are replayed.
+///
+/// This is much faster than invoking play:() or pass() for every move,
+/// because GoMoveModel is updated only once at the end, which means that the
+/// document dirty flag is set and KVO observers of GoMoveModel are notified
+/// only once. GoBoardPosition observers in turn see only a single change of
+/// the current board position, and no #boardPositionChangeProgress
+/// notifications are posted.
+///
+/// If the last two moves replayed are both pass moves, the game ends the same
+/// way as if pass() had been invoked.
+///
+/// Raises an @e NSInternalInconsistencyException if this method is invoked
+/// while this GoGame object is not in state #GoGameStateGameHasStarted or
+/// #GoGameStateGameIsPaused. Raises @e NSRangeException if the point index of
+/// a move does not refer to an intersection on the board. In both cases none
+/// of the moves are replayed.
+// -----------------------------------------------------------------------------
+- (int) replayMoves:(const struct GoGameReplayMove*)moves
+      numberOfMoves:(int)numberOfMoves
+    isIllegalReason:(enum GoMoveIsIllegalReason*)reason
+{
+  if (GoGameStateGameHasStarted != self.state && GoGameStateGameIsPaused != self.state)
+  {
+    NSString* errorMessage = @"Replay is possible only while GoGame object is either in state GoGameStateGameHasStarted or GoGameStateGameIsPaused";
+    DDLogError(@"%@: %@", self, errorMessage);
+    NSException* exception = [NSException exceptionWithName:NSInternalInconsistencyException
+                                                     reason:errorMessage
+                                                   userInfo:nil];
+    @throw exception;
+  }
+
+  GoMoveModel* moveModel = self.moveModel;
+  GoBoard* board = self.board;
+  int indexOfFirstReplayedMove = moveModel.numberOfMoves;
+  int indexOfIllegalMove = -1;
+  [moveModel beginUpdates];
+  @try
+  {
+    for (int indexOfMove = 0; indexOfMove < numberOfMoves; ++indexOfMove)
+    {
+      const struct GoGameReplayMove* replayMove = &moves[indexOfMove];
+      GoMove* move;
+      if (GoMoveTypePlay == replayMove->type)
+      {
+        GoPoint* point = [board pointAtIndex:replayMove->pointIndex];
+        if (! point)
+        {
+          NSString* errorMessage = [NSString stringWithFormat:@"Point index %d of move %d does not refer to an intersection", replayMove->pointIndex, indexOfMove];
+          DDLogError(@"%@: %@", self, errorMessage);
+          NSException* exception = [NSException exceptionWithName:NSRangeException
+                                                           reason:errorMessage
+                                                         userInfo:nil];
+          @throw exception;
+        }
+        // GoBoardPosition does not advance until endUpdates, so its notion of
+        // the current player is stale while we replay. The player whose turn
+        // it is must be derived from the last move instead.
+        GoPlayer* currentPlayer = self.currentPlayer;
+        enum GoColor nextMoveColor = (currentPlayer.isBlack ? GoColorBlack : GoColorWhite);
+        if (! [self isLegalMove:point nextMoveColor:nextMoveColor isIllegalReason:reason])
+        {
+          indexOfIllegalMove = indexOfMove;
+          break;
+        }
+        move = [GoMove move:GoMoveTypePlay by:currentPlayer after:self.lastMove];
+        move.point = point;
+      }
+      else
+      {
+        move = [GoMove move:GoMoveTypePass by:self.currentPlayer after:self.lastMove];
+      }
+      [move doIt];
+      [moveModel appendMove:move];
+    }
+  }
+  @catch (NSException* exception)
+  {
+    [self undoReplayedMovesFromIndex:indexOfFirstReplayedMove];
+    [moveModel endUpdates];
+    @throw;
+  }
+
+  if (-1 != indexOfIllegalMove)
+  {
+    [self undoReplayedMovesFromIndex:indexOfFirstReplayedMove];
+    [moveModel endUpdates];
+    return indexOfIllegalMove;
+  }
+
+  [moveModel endUpdates];
+
+  // Game state must change after any of the other things; this order is
+  // important for observer notifications
+  GoMove* lastMove = self.lastMove;
+  if (numberOfMoves > 0 &&
+      GoMoveTypePass == lastMove.type &&
+      GoMoveTypePass == lastMove.previous.type)
+  {
+    self.reasonForGameHasEnded = GoGameHasEndedReasonTwoPasses;
+    self.state = GoGameStateGameHasEnded;
+  }
+  return -1;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Private helper for replayMoves:numberOfMoves:isIllegalReason:().
+/// Undoes and discards all moves starting with the move at index position
+/// @a index, in reverse order.
+// -----------------------------------------------------------------------------
+- (void) undoReplayedMovesFromIndex:(int)index
+{
+  GoMoveModel* moveModel = self.moveModel;
+  int numberOfMoves = moveModel.numberOfMoves;
+  if (index >= numberOfMoves)
+    return;
+  for (int indexOfMove = numberOfMoves - 1; indexOfMove >= index; --indexOfMove)
+    [[moveModel moveAtIndex:indexOfMove] undo];
+  [moveModel discardMovesFromIndex:index];
+}
+
 // -----------------------------------------------------------------------------
 /// @brief Updates the state of this GoGame and all associated objects in
 /// response to one of the players resigning the game.
@@ -382,6 +557,12 @@
 /// the reason why the move is not legal. If this method returns true, the
 /// value of @a reason is undefined.
 ///
+/// If the legal move mask (see legalMoveMask()) has already been calculated
+/// for the current board position, the answer is looked up in the mask.
+/// Otherwise only the intersection represented by @a point is examined. This
+/// keeps a single query cheap, e.g. while a game is loaded from .sgf and every
+/// move is checked once.
+///
 /// Raises @e NSInvalidArgumentException if @a aPoint is nil.
 // -----------------------------------------------------------------------------
 - (bool) isLegalMove:(GoPoint*)point isIllegalReason:(enum GoMoveIsIllegalReason*)reason
@@ -396,6 +577,134 @@
     @throw exception;
   }
 
+  enum GoColor nextMoveColor = (self.boardPosition.currentPlayer.isBlack ? GoColorBlack : GoColorWhite);
+  return [self isLegalMove:point nextMoveColor:nextMoveColor isIllegalReason:reason];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns true if playing a stone of color @a nextMoveColor on the
+/// intersection @a point would be legal in the current board position. Makes
+/// use of the cached legal move mask if it was calculated for the same game
+/// situation and @a nextMoveColor.
+///
+/// This is a private helper for isLegalMove:isIllegalReason:() and
+/// replayMoves:numberOfMoves:isIllegalReason:().
+// -----------------------------------------------------------------------------
+- (bool) isLegalMove:(GoPoint*)point
+       nextMoveColor:(enum GoColor)nextMoveColor
+     isIllegalReason:(enum GoMoveIsIllegalReason*)reason
+{
+  int pointIndex = point.pointIndex;
+  struct GoGameLegalMoveMaskKey legalMoveMaskKey = [self currentLegalMoveMaskKey];
+  legalMoveMaskKey.nextMoveColor = nextMoveColor;
+  if ([self isLegalMoveMaskValidForKey:&legalMoveMaskKey])
+  {
+    if (GoBitboardTestBit(&m_legalMoveMask, pointIndex))
+      return true;
+    *reason = m_illegalReasons[pointIndex];
+    return false;
+  }
+  return [self isLegalMoveAtPointIndex:pointIndex
+                         nextMoveColor:legalMoveMaskKey.nextMoveColor
+                       isIllegalReason:reason];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns a GoBitboard with the point indexes of all intersections on
+/// which the current player can legally play in the current board position.
+///
+/// The mask is calculated in a single pass over the board, which examines
+/// every empty intersection with the same algorithm that isLegalMove:() uses.
+/// The result, including the reason why a move is illegal, is cached until a
+/// move is made or discarded, or until the board position changes. Clients
+/// that must know the legality of many intersections (e.g. while the user
+/// moves the cross-hair over the board) should therefore invoke this method
+/// once, and then query the mask. isLegalMove:() also makes use of the cached
+/// mask.
+///
+/// The returned pointer remains valid for the lifetime of this GoGame, but
+/// the content it points to is changed by the next invocation of this method
+/// that follows a change of the board position.
+// -----------------------------------------------------------------------------
+- (const struct GoBitboard*) legalMoveMask
+{
+  struct GoGameLegalMoveMaskKey legalMoveMaskKey = [self currentLegalMoveMaskKey];
+  if (! [self isLegalMoveMaskValidForKey:&legalMoveMaskKey])
+  {
+    struct GoBoardState* boardState = legalMoveMaskKey.board.boardState;
+    GoBitboardClear(&m_legalMoveMask);
+    for (int pointIndex = GoBitboardNextSetBit(&boardState->onBoardMask, 0);
+         pointIndex != -1;
+         pointIndex = GoBitboardNextSetBit(&boardState->onBoardMask, pointIndex + 1))
+    {
+      enum GoMoveIsIllegalReason reason;
+      bool isLegalMove = [self isLegalMoveAtPointIndex:pointIndex
+                                         nextMoveColor:legalMoveMaskKey.nextMoveColor
+                                       isIllegalReason:&reason];
+      if (isLegalMove)
+        GoBitboardSetBit(&m_legalMoveMask, pointIndex);
+      else
+        m_illegalReasons[pointIndex] = reason;
+    }
+    m_legalMoveMaskKey = legalMoveMaskKey;
+    m_legalMoveMaskIsValid = true;
+  }
+  return &m_legalMoveMask;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns a GoGameLegalMoveMaskKey that describes the current game
+/// situation.
+///
+/// This is a private helper.
+// -----------------------------------------------------------------------------
+- (struct GoGameLegalMoveMaskKey) currentLegalMoveMaskKey
+{
+  struct GoGameLegalMoveMaskKey legalMoveMaskKey;
+  legalMoveMaskKey.board = self.board;
+  legalMoveMaskKey.boardStateModificationCount = self.board.boardState->modificationCount;
+  legalMoveMaskKey.lastMove = self.lastMove;
+  legalMoveMaskKey.numberOfMoves = self.moveModel.numberOfMoves;
+  legalMoveMaskKey.currentBoardPosition = self.boardPosition.currentBoardPosition;
+  legalMoveMaskKey.nextMoveColor = (self.boardPosition.currentPlayer.isBlack ? GoColorBlack : GoColorWhite);
+  legalMoveMaskKey.koRule = self.rules.koRule;
+  return legalMoveMaskKey;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns true if the cached legal move mask was calculated for the
+/// game situation described by @a legalMoveMaskKey.
+///
+/// This is a private helper.
+// -----------------------------------------------------------------------------
+- (bool) isLegalMoveMaskValidForKey:(const struct GoGameLegalMoveMaskKey*)legalMoveMaskKey
+{
+  if (! m_legalMoveMaskIsValid)
+    return false;
+  return (m_legalMoveMaskKey.board == legalMoveMaskKey->board &&
+          m_legalMoveMaskKey.boardStateModificationCount == legalMoveMaskKey->boardStateModificationCount &&
+          m_legalMoveMaskKey.lastMove == legalMoveMaskKey->lastMove &&
+          m_legalMoveMaskKey.numberOfMoves == legalMoveMaskKey->numberOfMoves &&
+          m_legalMoveMaskKey.currentBoardPosition == legalMoveMaskKey->currentBoardPosition &&
+          m_legalMoveMaskKey.nextMoveColor == legalMoveMaskKey->nextMoveColor &&
+          m_legalMoveMaskKey.koRule == legalMoveMaskKey->koRule);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns true if playing a stone of color @a nextMoveColor on the
+/// intersection identified by @a pointIndex would be legal. If this method
+/// returns false, the out parameter @a reason is filled with the reason why the
+/// move is not legal.
+///
+/// Whether the ko rule makes the move illegal is decided by
+/// isKoMove:checkSuperkoOnly:isSuperko:().
+///
+/// This is the backend for isLegalMove:() and legalMoveMask().
+// -----------------------------------------------------------------------------
+- (bool) isLegalMoveAtPointIndex:(int)pointIndex
+                   nextMoveColor:(enum GoColor)nextMoveColor
+                 isIllegalReason:(enum GoMoveIsIllegalReason*)reason
+{
   // We could use the Fuego-specific GTP command "go_point_info" to obtain
   // the desired information, but parsing the response would require some
   // effort, is prone to fail when Fuego changes its response format, and
@@ -403,17 +712,22 @@
   // by a Ko, so we would have to derive this information from the other parts
   // of the response.
   // -> it's better to implement this in our own terms
-  if ([point hasStone])
+  //
+  // The first two checks are by far the most common outcomes, so we perform
+  // them on the flat board state
+  struct GoBoardState* boardState = self.board.boardState;
+  if (GoColorNone != boardState->colors[pointIndex])
   {
     *reason = GoMoveIsIllegalReasonIntersectionOccupied;
     return false;
   }
   // Point is an empty intersection, possibly with other empty intersections as
   // neighbours
-  else if ([point liberties] > 0)
+  else if (GoBoardStateNumberOfEmptyNeighbours(boardState, pointIndex) > 0)
   {
+    // Only superko can make this move illegal
     bool isSuperko;
-    bool isKoMove = [self isKoMove:point checkSuperkoOnly:true isSuperko:&isSuperko];
+    bool isKoMove = [self isKoMove:[self.board pointAtIndex:pointIndex] checkSuperkoOnly:true isSuperko:&isSuperko];
     if (isKoMove)
       *reason = isSuperko ? GoMoveIsIllegalReasonSuperko : GoMoveIsIllegalReasonSimpleKo;
     return !isKoMove;
@@ -421,23 +735,30 @@
   // Point is an empty intersection that is surrounded by stones
   else
   {
-    bool nextMoveIsBlack = self.boardPosition.currentPlayer.isBlack;
-    enum GoColor nextMoveColor = (nextMoveIsBlack ? GoColorBlack : GoColorWhite);
-    enum GoColor nextMoveOpponentColor = (nextMoveIsBlack ? GoColorWhite : GoColorBlack);
+    enum GoColor nextMoveOpponentColor = (GoColorBlack == nextMoveColor ? GoColorWhite : GoColorBlack);
+
+    // The board state knows the liberties of every stone group, so we can
+    // examine the neighbours directly instead of collecting their
+    // GoBoardRegion objects first. Examining the same stone group twice (if it
+    // is adjacent on more than one side) does no harm.
 
     // Pass 1: Check if we can connect to a friendly colored stone group
     // without killing it
-    NSArray* neighbourRegionsFriendly = [point neighbourRegionsWithColor:nextMoveColor];
-    for (GoBoardRegion* neighbourRegion in neighbourRegionsFriendly)
+    bool hasFriendlyNeighbour = false;
+    for (int direction = 0; direction < 4; ++direction)
     {
+      int neighbourIndex = pointIndex + boardState->neighbourOffsets[direction];
+      if (nextMoveColor != boardState->colors[neighbourIndex])
+        continue;
+      hasFriendlyNeighbour = true;
       // If the friendly stone group has more than one liberty, we are sure that
       // we are not killing it. The only thing that can still make the move
       // illegal is a ko (but since we are connecting, a simple ko is not
       // possible here).
-      if ([neighbourRegion liberties] > 1)
+      if (GoBoardStateLibertiesOfGroup(boardState, neighbourIndex) > 1)
       {
         bool isSuperko;
-        bool isKoMove = [self isKoMove:point checkSuperkoOnly:true isSuperko:&isSuperko];
+        bool isKoMove = [self isKoMove:[self.board pointAtIndex:pointIndex] checkSuperkoOnly:true isSuperko:&isSuperko];
         if (isKoMove)
           *reason = isSuperko ? GoMoveIsIllegalReasonSuperko : GoMoveIsIllegalReasonSimpleKo;
         return !isKoMove;
@@ -445,17 +766,19 @@
     }
 
     // Pass 2: Check if we can capture opposing stone groups
-    NSArray* neighbourRegionsOpponent = [point neighbourRegionsWithColor:nextMoveOpponentColor];
-    for (GoBoardRegion* neighbourRegion in neighbourRegionsOpponent)
+    for (int direction = 0; direction < 4; ++direction)
     {
+      int neighbourIndex = pointIndex + boardState->neighbourOffsets[direction];
+      if (nextMoveOpponentColor != boardState->colors[neighbourIndex])
+        continue;
       // If the opposing stone group has only one liberty left we can capture
       // it. The only thing that can still make the move illegal is a ko.
-      if ([neighbourRegion liberties] == 1)
+      if (GoBoardStateLibertiesOfGroup(boardState, neighbourIndex) == 1)
       {
         // A simple Ko situation is possible only if we are NOT connecting
-        bool isSimpleKoStillPossible = (0 == neighbourRegionsFriendly.count);
+        bool isSimpleKoStillPossible = ! hasFriendlyNeighbour;
         bool isSuperko;
-        bool isKoMove = [self isKoMove:point checkSuperkoOnly:!isSimpleKoStillPossible isSuperko:&isSuperko];
+        bool isKoMove = [self isKoMove:[self.board pointAtIndex:pointIndex] checkSuperkoOnly:!isSimpleKoStillPossible isSuperko:&isSuperko];
         if (isKoMove)
           *reason = isSuperko ? GoMoveIsIllegalReasonSuperko : GoMoveIsIllegalReasonSimpleKo;
         return !isKoMove;
@@ -490,8 +813,13 @@
 
   // Even if we use one of the superko rules, we still want to check for simple
   // ko first so that we can distinguish between simple ko and superko.
-  long long zobristHashOfHypotheticalMove = [self zobristHashOfHypotheticalMoveAtPoint:point];
-  bool isSimpleKo = (zobristHashOfHypotheticalMove == previousMoveOfSamePlayer.zobristHash);
+  long long zobristHashOfHypotheticalMove;
+  long long zobristHashHighOfHypotheticalMove;
+  [self getZobristHash:&zobristHashOfHypotheticalMove
+       zobristHashHigh:&zobristHashHighOfHypotheticalMove
+ofHypotheticalMoveAtPoint:point];
+  bool isSimpleKo = (zobristHashOfHypotheticalMove == previousMoveOfSamePlayer.zobristHash &&
+                     zobristHashHighOfHypotheticalMove == previousMoveOfSamePlayer.zobristHashHigh);
   if (isSimpleKo)
   {
     *isSuperko = false;
@@ -509,16 +837,23 @@
     case GoKoRuleSuperkoPositional:
     case GoKoRuleSuperkoSituational:
     {
-      GoPlayer* currentPlayer = self.currentPlayer;
-      for (GoMove* move = previousMoveOfSamePlayer.previous; move != nil; move = move.previous)
+      // Simple ko has already been checked above against the move made by the
+      // same player before the last move, so we only look at moves before
+      // that one. The lookup is made in a hash index maintained by
+      // GoMoveModel, so we don't have to iterate over all moves.
+      GoMoveModel* moveModel = self.moveModel;
+      int indexOfPreviousMoveOfSamePlayer = moveModel.numberOfMoves - 2;
+      GoPlayer* player = nil;
+      if (GoKoRuleSuperkoSituational == koRule)
+        player = self.currentPlayer;
+      int moveIndex = [moveModel indexOfMoveWithZobristHash:zobristHashOfHypotheticalMove
+                                            zobristHashHigh:zobristHashHighOfHypotheticalMove
+                                                beforeIndex:indexOfPreviousMoveOfSamePlayer
+                                                     player:player];
+      if (-1 != moveIndex)
       {
-        if (GoKoRuleSuperkoSituational == koRule && move.player != currentPlayer)
-            continue;
-        if (zobristHashOfHypotheticalMove == move.zobristHash)
-        {
-          *isSuperko = true;
-          return true;
-        }
+        *isSuperko = true;
+        return true;
       }
       return false;
     }
@@ -537,16 +872,24 @@
 // -----------------------------------------------------------------------------
 /// Private helper
 // -----------------------------------------------------------------------------
-- (long long) zobristHashOfHypotheticalMoveAtPoint:(GoPoint*)point
+- (void) getZobristHash:(long long*)zobristHash
+        zobristHashHigh:(long long*)zobristHashHigh
+ofHypotheticalMoveAtPoint:(GoPoint*)point
 {
   GoPlayer* currentPlayer = self.currentPlayer;
   bool nextMoveIsBlack = currentPlayer.isBlack;
   enum GoColor nextMoveOpponentColor = (nextMoveIsBlack ? GoColorWhite : GoColorBlack);
   NSArray* stonesWithOneLiberty = [self stonesWithColor:nextMoveOpponentColor withSingleLibertyAt:point];
-  return [self.board.zobristTable hashForStonePlayedBy:currentPlayer
-                                               atPoint:point
-                                       capturingStones:stonesWithOneLiberty
-                                             afterMove:self.lastMove];
+  GoZobristTable* zobristTable = self.board.zobristTable;
+  GoMove* lastMove = self.lastMove;
+  *zobristHash = [zobristTable hashForStonePlayedBy:currentPlayer
+                                            atPoint:point
+                                    capturingStones:stonesWithOneLiberty
+                                          afterMove:lastMove];
+  *zobristHashHigh = [zobristTable highHashForStonePlayedBy:currentPlayer
+                                                    atPoint:point
+                                            capturingStones:stonesWithOneLiberty
+                                                  afterMove:lastMove];
 }
 
 // -----------------------------------------------------------------------------
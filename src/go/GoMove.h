@@ -89,6 +89,13 @@
 @property(nonatomic, assign, readonly) int moveNumber;
 /// @brief Zobrist hash that identifies the board position created by this move.
 /// Zobrist hashes are used to detect superko.
+///
+/// Zobrist hashes are stable across application launches, therefore they are
+/// archived together with the move.
 @property(nonatomic, assign) long long zobristHash;
+/// @brief The upper 64 bits of the 128-bit Zobrist hash that identifies the
+/// board position created by this move. Is 0 (zero) if the GoZobristTable of
+/// the board does not use 128-bit hashes.
+@property(nonatomic, assign) long long zobristHashHigh;
 
 @end
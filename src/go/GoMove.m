@@ -21,6 +21,7 @@
 #import "GoPlayer.h"
 #import "GoPoint.h"
 #import "GoBoardRegion.h"
+#import "GoBoardState.h"
 #import "GoUtilities.h"
 #import "GoZobristTable.h"
 
@@ -43,6 +44,21 @@
 
 @implementation GoMove
 
+/// @brief Is returned by capturedStones() for all GoMove objects that did not
+/// capture any stones. Sharing this object avoids allocating an empty array
+/// for each move, which matters because most moves do not capture anything.
+static NSArray* noCapturedStones = nil;
+
+// -----------------------------------------------------------------------------
+/// @brief Initializes the shared empty array of captured stones.
+// -----------------------------------------------------------------------------
++ (void) initialize
+{
+  if (self != [GoMove class])
+    return;
+  noCapturedStones = [[NSArray alloc] init];
+}
+
 // -----------------------------------------------------------------------------
 /// @brief Convenience constructor. Creates a GoMove instance of type @a type,
 /// which is associated with @a player, and whose predecessor is @a move.
@@ -115,9 +131,10 @@
   _point = nil;  // don't use self, otherwise we trigger the setter!
   self.previous = nil;
   self.next = nil;
-  self.capturedStones = [NSMutableArray arrayWithCapacity:0];
+  _capturedStones = nil;  // allocated when the first stone is captured
   self.moveNumber = 1;
   self.zobristHash = 0;
+  self.zobristHashHigh = 0;
 
   return self;
 }
@@ -138,8 +155,12 @@
   _point = [decoder decodeObjectForKey:goMovePointKey];  // don't use self, otherwise we trigger the setter!
   self.previous = [decoder decodeObjectForKey:goMovePreviousKey];
   self.next = [decoder decodeObjectForKey:goMoveNextKey];
-  self.capturedStones = [decoder decodeObjectForKey:goMoveCapturedStonesKey];
+  NSArray* capturedStones = [decoder decodeObjectForKey:goMoveCapturedStonesKey];
+  if (capturedStones.count > 0)
+    self.capturedStones = [NSMutableArray arrayWithArray:capturedStones];
   self.moveNumber = [decoder decodeIntForKey:goMoveMoveNumberKey];
+  self.zobristHash = [decoder decodeInt64ForKey:goMoveZobristHashKey];
+  self.zobristHashHigh = [decoder decodeInt64ForKey:goMoveZobristHashHighKey];
 
   return self;
 }
@@ -178,6 +199,17 @@
   return [NSString stringWithFormat:@"GoMove(%p): type = %d, move number = %d", self, _type, _moveNumber];
 }
 
+// -----------------------------------------------------------------------------
+// Property is documented in the header file.
+// -----------------------------------------------------------------------------
+- (NSArray*) capturedStones
+{
+  if (_capturedStones)
+    return _capturedStones;
+  else
+    return noCapturedStones;
+}
+
 // -----------------------------------------------------------------------------
 /// @brief Associates the GoPoint @a newValue with this GoMove.
 ///
@@ -232,7 +264,10 @@
   if (GoMoveTypePass == self.type)
   {
     if (self.previous)
+    {
       self.zobristHash = self.previous.zobristHash;
+      self.zobristHashHigh = self.previous.zobristHashHigh;
+    }
     return;
   }
 
@@ -255,27 +290,32 @@
     @throw exception;
   }
 
+  GoPoint* thePoint = self.point;
+  GoBoard* board = thePoint.board;
+  enum GoColor playedStoneColor = (self.player.black ? GoColorBlack : GoColorWhite);
+  enum GoColor capturedStoneColor = (self.player.black ? GoColorWhite : GoColorBlack);
+
   // Update the point's stone state *BEFORE* moving it to a new region
-  if (self.player.black)
-    self.point.stoneState = GoColorBlack;
-  else
-    self.point.stoneState = GoColorWhite;
-  [GoUtilities movePointToNewRegion:self.point];
+  thePoint.stoneState = playedStoneColor;
+  [GoUtilities movePointToNewRegion:thePoint];
 
   // If the captured stones array already contains entries we assume that this
   // invocation of doIt() is actually a "redo", i.e. undo() has previously been
   // invoked for this GoMove
   bool redo = (_capturedStones.count > 0);
 
-  // Check neighbours for captures
-  for (GoPoint* neighbour in self.point.neighbours)
+  // Check neighbours for captures. Work with the flat board state so that we
+  // don't have to examine GoPoint objects that cannot possibly be captured.
+  struct GoBoardState* boardState = board.boardState;
+  int pointIndex = thePoint.pointIndex;
+  for (int direction = 0; direction < 4; ++direction)
   {
-    if (! neighbour.hasStone)
-      continue;
-    if (neighbour.blackStone == self.point.blackStone)
+    int neighbourIndex = pointIndex + boardState->neighbourOffsets[direction];
+    if (capturedStoneColor != boardState->colors[neighbourIndex])
       continue;
-    if ([neighbour liberties] > 0)
+    if (GoBoardStateLibertiesOfGroup(boardState, neighbourIndex) > 0)
       continue;
+    GoPoint* neighbour = [board pointAtIndex:neighbourIndex];
     // The stone made a capture!!!
     for (GoPoint* capture in neighbour.region.points)
     {
@@ -297,12 +337,16 @@
       }
       else
       {
+        if (! _capturedStones)
+          self.capturedStones = [NSMutableArray arrayWithCapacity:1];
         [(NSMutableArray*)_capturedStones addObject:capture];
       }
     }
   }
 
-  self.zobristHash = [self.point.board.zobristTable hashForMove:self];
+  GoZobristTable* zobristTable = board.zobristTable;
+  self.zobristHash = [zobristTable hashForMove:self];
+  self.zobristHashHigh = [zobristTable highHashForMove:self];
 }
 
 // -----------------------------------------------------------------------------
@@ -378,8 +422,11 @@
   [encoder encodeObject:self.point forKey:goMovePointKey];
   [encoder encodeObject:self.previous forKey:goMovePreviousKey];
   [encoder encodeObject:self.next forKey:goMoveNextKey];
-  [encoder encodeObject:self.capturedStones forKey:goMoveCapturedStonesKey];
+  if (_capturedStones)
+    [encoder encodeObject:_capturedStones forKey:goMoveCapturedStonesKey];
   [encoder encodeInt:self.moveNumber forKey:goMoveMoveNumberKey];
+  [encoder encodeInt64:self.zobristHash forKey:goMoveZobristHashKey];
+  [encoder encodeInt64:self.zobristHashHigh forKey:goMoveZobristHashHighKey];
 }
 
 @end
@@ -18,6 +18,54 @@
 // Forward declarations
 @class GoGame;
 @class GoMove;
+@class GoPlayer;
+
+
+// -----------------------------------------------------------------------------
+/// @brief The GoMoveRecord struct is a compact, fixed-size copy of the data of
+/// a GoMove object.
+///
+/// @ingroup go
+///
+/// GoMoveModel stores the records of all moves in a contiguous C array. Code
+/// that needs to examine many moves should walk the records instead of the
+/// linked list of GoMove objects.
+///
+/// The GoPoint objects captured by a move are not stored in the record itself.
+/// Instead the record refers to a range of the point indexes returned by
+/// GoMoveModel::capturedStonePointIndexes().
+// -----------------------------------------------------------------------------
+struct GoMoveRecord
+{
+  long long zobristHash;        ///< @brief GoMove::zobristHash().
+  long long zobristHashHigh;    ///< @brief GoMove::zobristHashHigh().
+  int moveNumber;               ///< @brief GoMove::moveNumber().
+  int pointIndex;               ///< @brief The GoPoint::pointIndex() of GoMove::point(). Is -1 if the move is not a #GoMoveTypePlay.
+  int capturedStonesOffset;     ///< @brief The index of the first captured stone in GoMoveModel::capturedStonePointIndexes().
+  int numberOfCapturedStones;   ///< @brief The number of stones captured by the move.
+  unsigned char type;           ///< @brief GoMove::type(), an #GoMoveType value.
+  unsigned char color;          ///< @brief The color of GoMove::player(), an #GoColor value.
+};
+
+
+// -----------------------------------------------------------------------------
+/// @brief The GoMoveStatistics struct counts what the players did in the moves
+/// that lead up to a board position.
+///
+/// @ingroup go
+///
+/// GoMoveModel maintains these counts incrementally for every board position,
+/// see GoMoveModel::getStatistics:forBoardPosition:().
+// -----------------------------------------------------------------------------
+struct GoMoveStatistics
+{
+  int capturedByBlack;       ///< @brief The number of stones captured by black.
+  int capturedByWhite;       ///< @brief The number of stones captured by white.
+  int stonesPlayedByBlack;   ///< @brief The number of #GoMoveTypePlay moves made by black.
+  int stonesPlayedByWhite;   ///< @brief The number of #GoMoveTypePlay moves made by white.
+  int passesPlayedByBlack;   ///< @brief The number of #GoMoveTypePass moves made by black.
+  int passesPlayedByWhite;   ///< @brief The number of #GoMoveTypePass moves made by white.
+};
 
 
 // -----------------------------------------------------------------------------
@@ -27,7 +75,14 @@
 /// All indexes in GoMoveModel are zero-based.
 ///
 /// Invoking GoMoveModel methods that add or discard moves generally sets the
-/// GoGameDocument dirty flag.
+/// GoGameDocument dirty flag. Clients that add or discard many moves in one go
+/// can bracket the changes with beginUpdates() and endUpdates(), so that the
+/// dirty flag is set and KVO observers are notified only once.
+///
+/// Besides the GoMove objects, GoMoveModel also keeps a GoMoveRecord for each
+/// move. The records are kept in sync when moves are added or discarded. The
+/// pointers returned by moveRecords() and capturedStonePointIndexes() remain
+/// valid only until the next time the model is modified.
 // -----------------------------------------------------------------------------
 @interface GoMoveModel : NSObject <NSCoding>
 {
@@ -39,11 +94,30 @@
 - (void) discardLastMove;
 - (void) discardMovesFromIndex:(int)index;
 - (void) discardAllMoves;
+- (void) beginUpdates;
+- (void) endUpdates;
 - (GoMove*) moveAtIndex:(int)index;
+- (int) indexOfMoveWithZobristHash:(long long)zobristHash
+                   zobristHashHigh:(long long)zobristHashHigh
+                       beforeIndex:(int)index
+                            player:(GoPlayer*)player;
+- (void) invalidateZobristHashIndex;
+- (const struct GoMoveRecord*) moveRecords;
+- (const int*) capturedStonePointIndexes;
+- (void) getStatistics:(struct GoMoveStatistics*)statistics forBoardPosition:(int)boardPosition;
 
 /// @brief Returns the number of moves in the current game. Returns 0 if there
 /// are no moves.
 @property(nonatomic, assign, readonly) int numberOfMoves;
+/// @brief The lowest index of a move that was added or discarded by the most
+/// recent change of @e numberOfMoves. Is 0 if no moves were added or discarded
+/// yet.
+///
+/// KVO observers of @e numberOfMoves use this to find out from which index on
+/// the moves are different. @e numberOfMoves alone does not tell, because
+/// between beginUpdates() and endUpdates() moves may be discarded and then
+/// replaced by other moves.
+@property(nonatomic, assign, readonly) int indexOfFirstChangedMove;
 /// @brief The GoMove object that represents the first move of the game. nil if
 /// the game currently has no move.
 @property(nonatomic, assign, readonly) GoMove* firstMove;
@@ -0,0 +1,612 @@
+// -----------------------------------------------------------------------------
+// Copyright 2012-2013 Patrick Näf (herzbube@herzbube.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// -----------------------------------------------------------------------------
+
+
+// Project includes
+#import "GoMoveModel.h"
+#import "GoGame.h"
+#import "GoGameDocument.h"
+#import "../go/GoMove.h"
+#import "../go/GoPlayer.h"
+#import "../go/GoPoint.h"
+
+// C++ standard library
+#include <map>
+#include <vector>
+
+
+/// @brief Maps Zobrist hashes to the indexes of the moves that produced the
+/// board position with that hash. The indexes of each hash are stored in
+/// ascending order.
+typedef std::map<long long, std::vector<int> > ZobristHashIndex;
+/// @brief Holds one GoMoveRecord per move, in the order in which the moves
+/// were played.
+typedef std::vector<GoMoveRecord> MoveRecordList;
+/// @brief Holds one GoMoveStatistics per move. The statistics at index
+/// position n count the moves up to and including the move at index position
+/// n.
+typedef std::vector<GoMoveStatistics> MoveStatisticsList;
+/// @brief Holds the point indexes of the stones captured by all moves. Each
+/// GoMoveRecord refers to a contiguous range in this list.
+typedef std::vector<int> CapturedStonesArena;
+
+
+// -----------------------------------------------------------------------------
+/// @brief Class extension with private properties for GoMoveModel.
+// -----------------------------------------------------------------------------
+@interface GoMoveModel()
+{
+  /// @brief The Zobrist hash index. Is valid only if
+  /// m_zobristHashIndexIsValid is true.
+  ZobristHashIndex m_zobristHashIndex;
+  /// @brief Is false if m_zobristHashIndex must be rebuilt before it can be
+  /// used.
+  bool m_zobristHashIndexIsValid;
+  /// @brief The move records. Are valid only if m_moveRecordsAreValid is
+  /// true.
+  MoveRecordList m_moveRecords;
+  /// @brief The running move statistics. Are valid only if
+  /// m_moveRecordsAreValid is true.
+  MoveStatisticsList m_moveStatistics;
+  /// @brief The captured stones referred to by the move records in
+  /// m_moveRecords.
+  CapturedStonesArena m_capturedStonesArena;
+  /// @brief Is false if m_moveRecords, m_moveStatistics and
+  /// m_capturedStonesArena must be rebuilt before they can be used.
+  bool m_moveRecordsAreValid;
+  /// @brief Is true between beginUpdates() and endUpdates().
+  bool m_isUpdating;
+  /// @brief The number of moves at the time beginUpdates() was invoked.
+  int m_numberOfMovesBeforeUpdates;
+  /// @brief The lowest index of a move that was added or discarded since
+  /// beginUpdates() was invoked. Is INT_MAX if no moves were added or
+  /// discarded.
+  int m_indexOfFirstMoveChangedDuringUpdates;
+}
+/// @name Private properties
+//@{
+@property(nonatomic, assign) GoGame* game;
+@property(nonatomic, retain) NSMutableArray* moveList;
+//@}
+/// @name Re-declaration of properties to make them readwrite privately
+//@{
+@property(nonatomic, assign, readwrite) int numberOfMoves;
+@property(nonatomic, assign, readwrite) int indexOfFirstChangedMove;
+//@}
+@end
+
+
+@implementation GoMoveModel
+
+// -----------------------------------------------------------------------------
+/// @brief Initializes a GoMoveModel object that is associated with @a game.
+///
+/// @note This is the designated initializer of GoMoveModel.
+// -----------------------------------------------------------------------------
+- (id) initWithGame:(GoGame*)game
+{
+  // Call designated initializer of superclass (NSObject)
+  self = [super init];
+  if (! self)
+    return nil;
+  self.game = game;
+  self.moveList = [NSMutableArray arrayWithCapacity:0];
+  self.numberOfMoves = 0;
+  self.indexOfFirstChangedMove = 0;
+  m_zobristHashIndexIsValid = true;
+  m_moveRecordsAreValid = true;
+  m_isUpdating = false;
+  return self;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief NSCoding protocol method.
+// -----------------------------------------------------------------------------
+- (id) initWithCoder:(NSCoder*)decoder
+{
+  self = [super init];
+  if (! self)
+    return nil;
+
+  if ([decoder decodeIntForKey:nscodingVersionKey] != nscodingVersion)
+    return nil;
+  self.game = [decoder decodeObjectForKey:goMoveModelGameKey];
+  self.moveList = [decoder decodeObjectForKey:goMoveModelMoveListKey];
+  self.numberOfMoves = [decoder decodeIntForKey:goMoveModelNumberOfMovesKey];
+  self.indexOfFirstChangedMove = 0;
+  // The index and the move records are not archived, but the GoMove objects
+  // are. We build the index and the records from them when they are first
+  // needed.
+  m_zobristHashIndexIsValid = false;
+  m_moveRecordsAreValid = false;
+  m_isUpdating = false;
+
+  return self;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Deallocates memory allocated by this GoMoveModel object.
+// -----------------------------------------------------------------------------
+- (void) dealloc
+{
+  self.game = nil;
+  self.moveList = nil;
+  [super dealloc];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Adds the GoMove object @a move to this model.
+///
+/// Raises @e NSInvalidArgumentException if @a move is nil.
+///
+/// Invoking this method sets the GoGameDocument dirty flag, unless it is
+/// invoked between beginUpdates() and endUpdates().
+// -----------------------------------------------------------------------------
+- (void) appendMove:(GoMove*)move
+{
+  [_moveList addObject:move];
+  // Cast is required because NSUInteger and int differ in size in 64-bit. Cast
+  // is safe because this app was not made to handle more than pow(2, 31) moves.
+  int indexOfMove = (int)_moveList.count - 1;
+  if (m_zobristHashIndexIsValid)
+    m_zobristHashIndex[move.zobristHash].push_back(indexOfMove);
+  if (m_moveRecordsAreValid)
+    [self appendMoveRecordForMove:move];
+  [self moveListDidChangeFromIndex:indexOfMove];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Discards the last GoMove object in this model.
+///
+/// Raises @e NSRangeException if there are no GoMove objects in this model.
+///
+/// Invoking this method sets the GoGameDocument dirty flag.
+// -----------------------------------------------------------------------------
+- (void) discardLastMove
+{
+  // Cast is required because NSUInteger and int differ in size in 64-bit. Cast
+  // is safe because this app was not made to handle more than pow(2, 31) moves.
+  [self discardMovesFromIndex:((int)_moveList.count - 1)];  // raises exception and posts notification for us
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Discards all GoMove objects in this model starting with the object
+/// at position @a index.
+///
+/// Raises @e NSRangeException if @a index is <0 or exceeds the number of
+/// GoMove objects in this model.
+///
+/// Invoking this method sets the GoGameDocument dirty flag, unless it is
+/// invoked between beginUpdates() and endUpdates().
+// -----------------------------------------------------------------------------
+- (void) discardMovesFromIndex:(int)index
+{
+  if (index < 0)
+  {
+    NSString* errorMessage = [NSString stringWithFormat:@"Index %d must not be <0", index];
+    DDLogError(@"%@: %@", self, errorMessage);
+    NSException* exception = [NSException exceptionWithName:NSRangeException
+                                                     reason:errorMessage
+                                                   userInfo:nil];
+    @throw exception;
+  }
+  if (index >= _moveList.count)
+  {
+    NSString* errorMessage = [NSString stringWithFormat:@"Index %d must not exceed number of moves %lu", index, (unsigned long)_moveList.count];
+    DDLogError(@"%@: %@", self, errorMessage);
+    NSException* exception = [NSException exceptionWithName:NSRangeException
+                                                     reason:errorMessage
+                                                   userInfo:nil];
+    @throw exception;
+  }
+
+  NSUInteger numberOfMovesToDiscard = _moveList.count - index;
+  while (numberOfMovesToDiscard > 0)
+  {
+    if (m_zobristHashIndexIsValid)
+    {
+      // The discarded move always has the highest index for its hash
+      GoMove* move = [_moveList lastObject];
+      ZobristHashIndex::iterator it = m_zobristHashIndex.find(move.zobristHash);
+      if (it != m_zobristHashIndex.end())
+      {
+        it->second.pop_back();
+        if (it->second.empty())
+          m_zobristHashIndex.erase(it);
+      }
+    }
+    [_moveList removeLastObject];
+    --numberOfMovesToDiscard;
+  }
+  if (m_moveRecordsAreValid)
+  {
+    // Captured stones of later moves are always located after the captured
+    // stones of earlier moves
+    m_capturedStonesArena.resize(m_moveRecords[index].capturedStonesOffset);
+    m_moveRecords.resize(index);
+    m_moveStatistics.resize(index);
+  }
+
+  [self moveListDidChangeFromIndex:index];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Private helper for methods that add or discard moves. @a index is
+/// the lowest index of a move that was added or discarded.
+///
+/// Sets the GoGameDocument dirty flag, and updates @e indexOfFirstChangedMove
+/// and @e numberOfMoves, which triggers KVO observers. Between beginUpdates()
+/// and endUpdates() only @e numberOfMoves is updated, without triggering KVO
+/// observers, and @a index is remembered for endUpdates().
+// -----------------------------------------------------------------------------
+- (void) moveListDidChangeFromIndex:(int)index
+{
+  if (m_isUpdating)
+  {
+    m_indexOfFirstMoveChangedDuringUpdates = MIN(m_indexOfFirstMoveChangedDuringUpdates, index);
+    // Cast is required because NSUInteger and int differ in size in 64-bit.
+    // Cast is safe because this app was not made to handle more than
+    // pow(2, 31) moves.
+    _numberOfMoves = (int)_moveList.count;  // don't use self, we don't want to trigger KVO observers
+    return;
+  }
+  self.game.document.dirty = true;
+  self.indexOfFirstChangedMove = index;
+  // Cast is required because NSUInteger and int differ in size in 64-bit. Cast
+  // is safe because this app was not made to handle more than pow(2, 31) moves.
+  self.numberOfMoves = (int)_moveList.count;  // triggers KVO observers
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Starts a series of changes to this model that clients observe as a
+/// single change.
+///
+/// Until endUpdates() is invoked, methods that add or discard moves do not set
+/// the GoGameDocument dirty flag, and KVO observers of @e numberOfMoves are not
+/// notified. The @e numberOfMoves property itself always has the correct
+/// value, though.
+///
+/// Raises @e NSInternalInconsistencyException if this method is invoked while
+/// a series of changes is already in progress.
+// -----------------------------------------------------------------------------
+- (void) beginUpdates
+{
+  if (m_isUpdating)
+  {
+    NSString* errorMessage = @"beginUpdates invoked while updates are already in progress";
+    DDLogError(@"%@: %@", self, errorMessage);
+    NSException* exception = [NSException exceptionWithName:NSInternalInconsistencyException
+                                                     reason:errorMessage
+                                                   userInfo:nil];
+    @throw exception;
+  }
+  m_isUpdating = true;
+  m_numberOfMovesBeforeUpdates = _numberOfMoves;
+  m_indexOfFirstMoveChangedDuringUpdates = INT_MAX;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Ends a series of changes to this model that was started with
+/// beginUpdates().
+///
+/// If the moves in this model are different from the moves at the time
+/// beginUpdates() was invoked, this method sets the GoGameDocument dirty flag
+/// and notifies KVO observers of @e numberOfMoves once. Moves that were added
+/// and then discarded again do not count as a difference. The KVO observers
+/// find the lowest index of all moves that were added or discarded in the
+/// series of changes in @e indexOfFirstChangedMove.
+///
+/// Raises @e NSInternalInconsistencyException if this method is invoked
+/// without a preceding beginUpdates().
+// -----------------------------------------------------------------------------
+- (void) endUpdates
+{
+  if (! m_isUpdating)
+  {
+    NSString* errorMessage = @"endUpdates invoked without beginUpdates";
+    DDLogError(@"%@: %@", self, errorMessage);
+    NSException* exception = [NSException exceptionWithName:NSInternalInconsistencyException
+                                                     reason:errorMessage
+                                                   userInfo:nil];
+    @throw exception;
+  }
+  m_isUpdating = false;
+  bool didChange = (_numberOfMoves != m_numberOfMovesBeforeUpdates ||
+                    m_indexOfFirstMoveChangedDuringUpdates < m_numberOfMovesBeforeUpdates);
+  if (didChange)
+    [self moveListDidChangeFromIndex:m_indexOfFirstMoveChangedDuringUpdates];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Discards all GoMove objects in this model.
+///
+/// Raises @e NSRangeException if there are no GoMove objects in this model.
+///
+/// Invoking this method sets the GoGameDocument dirty flag.
+// -----------------------------------------------------------------------------
+- (void) discardAllMoves
+{
+  [self discardMovesFromIndex:0];  // raises exception and posts notification for us
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns the GoMove object located at index position @a index.
+///
+/// Raises @e NSRangeException if @a index is <0 or exceeds the number of
+/// GoMove objects in this model.
+// -----------------------------------------------------------------------------
+- (GoMove*) moveAtIndex:(int)index
+{
+  return [_moveList objectAtIndex:index];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns the index of the most recent move that is located before
+/// index position @a index and that produced a board position whose Zobrist
+/// hash is @a zobristHash. Returns -1 if there is no such move.
+///
+/// The upper 64 bits of the move's 128-bit Zobrist hash must be equal to
+/// @a zobristHashHigh. If 128-bit hashes are not used, @a zobristHashHigh must
+/// be 0 (zero).
+///
+/// If @a player is not nil, only moves made by @a player are considered. This
+/// is useful to detect situational superko. If @a player is nil, moves made by
+/// both players are considered. This is useful to detect positional superko.
+///
+/// The lookup is made in a hash index, therefore this method in general does
+/// not have to examine all moves. The index is kept up-to-date by
+/// appendMove:() and discardMovesFromIndex:().
+///
+/// @note The index relies on the fact that the Zobrist hash of a GoMove does
+/// not change after the GoMove has been added to this model. If Zobrist
+/// hashes are recalculated for some reason, invalidateZobristHashIndex() must
+/// be invoked.
+// -----------------------------------------------------------------------------
+- (int) indexOfMoveWithZobristHash:(long long)zobristHash
+                   zobristHashHigh:(long long)zobristHashHigh
+                       beforeIndex:(int)index
+                            player:(GoPlayer*)player
+{
+  if (! m_zobristHashIndexIsValid)
+    [self rebuildZobristHashIndex];
+  if (! m_moveRecordsAreValid)
+    [self rebuildMoveRecords];
+  enum GoColor playerColor = (player.isBlack ? GoColorBlack : GoColorWhite);
+
+  ZobristHashIndex::const_iterator it = m_zobristHashIndex.find(zobristHash);
+  if (it == m_zobristHashIndex.end())
+    return -1;
+  const std::vector<int>& moveIndexes = it->second;
+  for (std::vector<int>::const_reverse_iterator itMoveIndex = moveIndexes.rbegin();
+       itMoveIndex != moveIndexes.rend();
+       ++itMoveIndex)
+  {
+    int moveIndex = *itMoveIndex;
+    if (moveIndex >= index)
+      continue;
+    const GoMoveRecord& moveRecord = m_moveRecords[moveIndex];
+    if (moveRecord.zobristHashHigh != zobristHashHigh)
+      continue;
+    if (player && moveRecord.color != playerColor)
+      continue;
+    return moveIndex;
+  }
+  return -1;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Discards the Zobrist hash index and the move records. Both are
+/// rebuilt from scratch the next time they are needed.
+///
+/// Clients must invoke this method if they change the Zobrist hash of a GoMove
+/// after it has been added to this model.
+// -----------------------------------------------------------------------------
+- (void) invalidateZobristHashIndex
+{
+  m_zobristHashIndex.clear();
+  m_zobristHashIndexIsValid = false;
+  m_moveRecords.clear();
+  m_moveStatistics.clear();
+  m_capturedStonesArena.clear();
+  m_moveRecordsAreValid = false;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Builds the Zobrist hash index from scratch.
+///
+/// This is an internal helper.
+// -----------------------------------------------------------------------------
+- (void) rebuildZobristHashIndex
+{
+  m_zobristHashIndex.clear();
+  int moveIndex = 0;
+  for (GoMove* move in _moveList)
+    m_zobristHashIndex[move.zobristHash].push_back(moveIndex++);
+  m_zobristHashIndexIsValid = true;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns a C array with one GoMoveRecord for each move in this model,
+/// in the same order as the GoMove objects. The array has @e numberOfMoves
+/// elements. Returns NULL if there are no moves.
+///
+/// The array is owned by this model and must not be freed. It becomes invalid
+/// the next time a move is added or discarded.
+// -----------------------------------------------------------------------------
+- (const struct GoMoveRecord*) moveRecords
+{
+  if (! m_moveRecordsAreValid)
+    [self rebuildMoveRecords];
+  if (m_moveRecords.empty())
+    return NULL;
+  return &m_moveRecords[0];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns a C array with the point indexes of the stones captured by
+/// all moves in this model. GoMoveRecord::capturedStonesOffset and
+/// GoMoveRecord::numberOfCapturedStones identify the elements that belong to
+/// a given move. Returns NULL if no move has captured any stones.
+///
+/// The array is owned by this model and must not be freed. It becomes invalid
+/// the next time a move is added or discarded.
+// -----------------------------------------------------------------------------
+- (const int*) capturedStonePointIndexes
+{
+  if (! m_moveRecordsAreValid)
+    [self rebuildMoveRecords];
+  if (m_capturedStonesArena.empty())
+    return NULL;
+  return &m_capturedStonesArena[0];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Fills the out variable @a statistics with the statistics of the
+/// moves that lead up to board position @a boardPosition. Board position 0
+/// (zero) has no moves, board position n counts the first n moves.
+///
+/// The statistics are maintained incrementally when moves are added or
+/// discarded, therefore this method takes constant time.
+///
+/// Raises @e NSRangeException if @a boardPosition is <0 or exceeds the number
+/// of moves in this model.
+// -----------------------------------------------------------------------------
+- (void) getStatistics:(struct GoMoveStatistics*)statistics forBoardPosition:(int)boardPosition
+{
+  if (boardPosition < 0 || boardPosition > _numberOfMoves)
+  {
+    NSString* errorMessage = [NSString stringWithFormat:@"Board position %d is out of range, number of moves is %d", boardPosition, _numberOfMoves];
+    DDLogError(@"%@: %@", self, errorMessage);
+    NSException* exception = [NSException exceptionWithName:NSRangeException
+                                                     reason:errorMessage
+                                                   userInfo:nil];
+    @throw exception;
+  }
+  if (0 == boardPosition)
+  {
+    memset(statistics, 0, sizeof(*statistics));
+    return;
+  }
+  if (! m_moveRecordsAreValid)
+    [self rebuildMoveRecords];
+  *statistics = m_moveStatistics[boardPosition - 1];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Adds a GoMoveRecord for @a move to the end of the move records, and
+/// the running statistics that include @a move to the end of the move
+/// statistics.
+///
+/// This is an internal helper.
+// -----------------------------------------------------------------------------
+- (void) appendMoveRecordForMove:(GoMove*)move
+{
+  GoMoveRecord moveRecord;
+  moveRecord.zobristHash = move.zobristHash;
+  moveRecord.zobristHashHigh = move.zobristHashHigh;
+  moveRecord.moveNumber = move.moveNumber;
+  moveRecord.pointIndex = (move.point ? move.point.pointIndex : -1);
+  // Cast is required because size_t and int differ in size in 64-bit. Cast
+  // is safe because there are never more than pow(2, 31) captured stones.
+  moveRecord.capturedStonesOffset = (int)m_capturedStonesArena.size();
+  moveRecord.numberOfCapturedStones = 0;
+  moveRecord.type = move.type;
+  moveRecord.color = (move.player.isBlack ? GoColorBlack : GoColorWhite);
+  for (GoPoint* capturedStone in move.capturedStones)
+  {
+    m_capturedStonesArena.push_back(capturedStone.pointIndex);
+    ++moveRecord.numberOfCapturedStones;
+  }
+  m_moveRecords.push_back(moveRecord);
+
+  GoMoveStatistics moveStatistics;
+  if (m_moveStatistics.empty())
+    memset(&moveStatistics, 0, sizeof(moveStatistics));
+  else
+    moveStatistics = m_moveStatistics.back();
+  bool moveByBlack = (GoColorBlack == moveRecord.color);
+  if (GoMoveTypePlay == moveRecord.type)
+  {
+    if (moveByBlack)
+    {
+      moveStatistics.capturedByBlack += moveRecord.numberOfCapturedStones;
+      ++moveStatistics.stonesPlayedByBlack;
+    }
+    else
+    {
+      moveStatistics.capturedByWhite += moveRecord.numberOfCapturedStones;
+      ++moveStatistics.stonesPlayedByWhite;
+    }
+  }
+  else if (GoMoveTypePass == moveRecord.type)
+  {
+    if (moveByBlack)
+      ++moveStatistics.passesPlayedByBlack;
+    else
+      ++moveStatistics.passesPlayedByWhite;
+  }
+  m_moveStatistics.push_back(moveStatistics);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Builds the move records from scratch.
+///
+/// This is an internal helper.
+// -----------------------------------------------------------------------------
+- (void) rebuildMoveRecords
+{
+  m_moveRecords.clear();
+  m_moveStatistics.clear();
+  m_capturedStonesArena.clear();
+  m_moveRecords.reserve(_moveList.count);
+  m_moveStatistics.reserve(_moveList.count);
+  for (GoMove* move in _moveList)
+    [self appendMoveRecordForMove:move];
+  m_moveRecordsAreValid = true;
+}
+
+// -----------------------------------------------------------------------------
+// Property is documented in the header file.
+// -----------------------------------------------------------------------------
+- (GoMove*) firstMove
+{
+  if (0 == _moveList.count)
+    return nil;
+  return [_moveList objectAtIndex:0];
+}
+          
+// -----------------------------------------------------------------------------
+// Property is documented in the header file.
+// -----------------------------------------------------------------------------
+- (GoMove*) lastMove
+{
+  if (0 == _moveList.count)
+    return nil;
+  return [_moveList lastObject];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief NSCoding protocol method.
+// -----------------------------------------------------------------------------
+- (void) encodeWithCoder:(NSCoder*)encoder
+{
+  [encoder encodeInt:nscodingVersion forKey:nscodingVersionKey];
+  [encoder encodeObject:self.game forKey:goMoveModelGameKey];
+  [encoder encodeObject:self.moveList forKey:goMoveModelMoveListKey];
+  [encoder encodeInt:self.numberOfMoves forKey:goMoveModelNumberOfMovesKey];
+}
+
+@end
@@ -40,6 +40,10 @@
 /// occupied, the method returns the number of liberties of just that one
 /// intersection.
 ///
+/// Every GoPoint is identified by a point index, an integer that refers to the
+/// intersection's entry in the flat GoBoardState maintained by GoBoard. Setting
+/// the @e stoneState or @e region properties updates the GoBoardState.
+///
 /// isLegalMove() is a convenient way to check whether placing a stone on the
 /// GoPoint would be legal. This includes checking for suicide moves and Ko
 /// situations.
@@ -61,6 +65,9 @@
 @property(nonatomic, retain) GoVertex* vertex;
 /// @brief The GoBoard object that the GoPoint is associated with.
 @property(nonatomic, assign) GoBoard* board;
+/// @brief The index of the entry in GoBoard::boardState() that represents the
+/// intersection of this GoPoint.
+@property(nonatomic, assign, readonly) int pointIndex;
 @property(nonatomic, assign, readonly) GoPoint* left;
 @property(nonatomic, assign, readonly) GoPoint* right;
 @property(nonatomic, assign, readonly) GoPoint* above;
@@ -75,6 +82,9 @@
 @property(nonatomic, assign) enum GoColor stoneState;
 /// @brief The score assigned to this point by the most recent territory
 /// statistics evaluation.
+///
+/// The score is stored in GoBoard's GoBoardState so that code which processes
+/// the scores of all intersections can access them as a flat array.
 @property(nonatomic, assign) float territoryStatisticsScore;
 /// @brief The region that the GoPoint belongs to. Is never nil.
 ///
@@ -18,6 +18,8 @@
 // Project includes
 #import "GoPoint.h"
 #import "GoBoard.h"
+#import "GoBoardRegion.h"
+#import "GoBoardState.h"
 #import "GoVertex.h"
 
 
@@ -31,6 +33,10 @@
 @property(nonatomic, assign) bool isBelowValid;
 @property(nonatomic, assign) bool isNextValid;
 @property(nonatomic, assign) bool isPreviousValid;
+/// @name Re-declaration of properties to make them readwrite privately
+//@{
+@property(nonatomic, assign, readwrite) int pointIndex;
+//@}
 @end
 
 
@@ -43,6 +49,8 @@
 @synthesize neighbours=_neighbours;
 @synthesize next=_next;
 @synthesize previous=_previous;
+@synthesize stoneState=_stoneState;
+@synthesize region=_region;
 
 
 // -----------------------------------------------------------------------------
@@ -89,8 +97,12 @@
 
   self.vertex = aVertex;
   self.board = aBoard;
+  [self setupPointIndex];
   self.starPoint = false;
-  self.stoneState = GoColorNone;
+  // Don't use self, otherwise we trigger the setter which updates the board
+  // state. At this point we don't know yet whether the board has registered
+  // us as its GoPoint.
+  _stoneState = GoColorNone;
   self.territoryStatisticsScore = 0.0f;
   _left = nil;
   _right = nil;
@@ -124,6 +136,7 @@
   // GoVertex
   self.vertex = [GoVertex vertexFromString:[decoder decodeObjectForKey:goPointVertexKey]];
   self.board = [decoder decodeObjectForKey:goPointBoardKey];
+  [self setupPointIndex];
   if ([decoder containsValueForKey:goPointIsStarPointKey])
     self.starPoint = true;
   else
@@ -166,6 +179,18 @@
   [super dealloc];
 }
 
+// -----------------------------------------------------------------------------
+/// @brief Calculates the point index from the @e vertex and @e board
+/// properties.
+///
+/// This is an internal helper invoked during initialization.
+// -----------------------------------------------------------------------------
+- (void) setupPointIndex
+{
+  struct GoVertexNumeric numericVertex = self.vertex.numeric;
+  self.pointIndex = GoBoardStatePointIndexOfVertex(self.board.boardState, numericVertex.x, numericVertex.y);
+}
+
 // -----------------------------------------------------------------------------
 /// @brief Prepares this GoPoint object for deallocation. This method breaks all
 /// retain cycles, making it possible to deallocate GoPoint objects in the first
@@ -177,6 +202,9 @@
   // mean to mark up the property GoPoint.region with "assign" instead of
   // "retain", but then nobody retains GoBoardRegion...
   self.region = nil;
+  // The board is about to go away, from now on there is no board state that
+  // could be updated
+  self.board = nil;
   // GoPoint objects reference each other via their _neighbours arrays.
   // Unfortunately it is not possible to tell NSArray/NSMutableArray not to
   // retain their objects.
@@ -309,6 +337,48 @@
   return _previous;
 }
 
+// -----------------------------------------------------------------------------
+// Property is documented in the header file.
+// -----------------------------------------------------------------------------
+- (void) setStoneState:(enum GoColor)newValue
+{
+  _stoneState = newValue;
+  if (_board)
+    GoBoardStateSetColor(_board.boardState, _pointIndex, newValue);
+}
+
+// -----------------------------------------------------------------------------
+// Property is documented in the header file.
+// -----------------------------------------------------------------------------
+- (float) territoryStatisticsScore
+{
+  if (! _board)
+    return 0.0f;
+  return _board.boardState->territoryStatisticsScores[_pointIndex];
+}
+
+// -----------------------------------------------------------------------------
+// Property is documented in the header file.
+// -----------------------------------------------------------------------------
+- (void) setTerritoryStatisticsScore:(float)newValue
+{
+  if (_board)
+    _board.boardState->territoryStatisticsScores[_pointIndex] = newValue;
+}
+
+// -----------------------------------------------------------------------------
+// Property is documented in the header file.
+// -----------------------------------------------------------------------------
+- (void) setRegion:(GoBoardRegion*)newValue
+{
+  if (_region == newValue)
+    return;
+  [_region release];
+  _region = [newValue retain];
+  if (_board)
+    _board.boardState->regionIDs[_pointIndex] = newValue.regionID;
+}
+
 // -----------------------------------------------------------------------------
 /// @brief Returns true if the intersection represented by this GoPoint is
 /// occupied by a stone.
@@ -342,15 +412,7 @@
   if ([self hasStone])
     return [self.region liberties];
   else
-  {
-    int liberties = 0;
-    for (GoPoint* neighbour in self.neighbours)
-    {
-      if (! [neighbour hasStone])
-        liberties++;
-    }
-    return liberties;
-  }
+    return GoBoardStateNumberOfEmptyNeighbours(self.board.boardState, _pointIndex);
 }
 
 // -----------------------------------------------------------------------------
@@ -378,14 +440,30 @@
 - (NSArray*) neighbourRegionsWithColor:(enum GoColor)color
 {
   NSMutableArray* neighbourRegions = [NSMutableArray arrayWithCapacity:0];
-  for (GoPoint* neighbour in self.neighbours)
+  GoBoard* board = self.board;
+  struct GoBoardState* boardState = board.boardState;
+  int neighbourRegionIDs[4];
+  int numberOfNeighbourRegions = 0;
+  for (int direction = 0; direction < 4; ++direction)
   {
-    if (neighbour.stoneState != color)
+    int neighbourIndex = _pointIndex + boardState->neighbourOffsets[direction];
+    if (boardState->colors[neighbourIndex] != color)
       continue;
-    GoBoardRegion* neighbourRegion = neighbour.region;
-    if ([neighbourRegions containsObject:neighbourRegion])
+    // Border entries never match because GoBoardStateBorder is not a GoColor
+    int neighbourRegionID = boardState->regionIDs[neighbourIndex];
+    bool isDuplicate = false;
+    for (int indexOfRegionID = 0; indexOfRegionID < numberOfNeighbourRegions; ++indexOfRegionID)
+    {
+      if (neighbourRegionIDs[indexOfRegionID] == neighbourRegionID)
+      {
+        isDuplicate = true;
+        break;
+      }
+    }
+    if (isDuplicate)
       continue;
-    [neighbourRegions addObject:neighbourRegion];
+    neighbourRegionIDs[numberOfNeighbourRegions++] = neighbourRegionID;
+    [neighbourRegions addObject:[board pointAtIndex:neighbourIndex].region];
   }
   return neighbourRegions;
 }
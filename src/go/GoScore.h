@@ -87,11 +87,13 @@
 ///   two more steps.
 /// # updateTerritoryColor() (a private helper method invoked as part of the
 ///   scoring process) calculates the color that "owns" each GoBoardRegion
-///   - updateTerritoryColor() stores the "owning" color in GoBoardRegion
-///     objects' @e territoryColor property.
+///   - updateTerritoryColor() works on a GoBoardSnapshot that includes the
+///     regions of the board, the "owning" color is stored in GoBoardRegion
+///     objects' @e territoryColor property only when the calculation is
+///     finished.
 ///   - Calculation of the territory color entirely depends on the
 ///     @e stoneGroupState property of all GoBoardRegion objects having been
-///     set up correctly before.
+///     set up correctly before the calculation was requested.
 ///   - See the section "Determining territory color" below for details on how
 ///     the calculation works
 /// # updateScoringProperties:() (a private helper method invoked as part of
@@ -99,10 +101,36 @@
 ///   stores the values in GoScore's publicly accessible scoring and statistics
 ///   properties
 ///
-/// @note When GoScore calculates a score for the first time, it asks the GTP
-/// engine for an initial list of dead stones. It is expected that the GTP
-/// engine at least detects dead stones surrounded by unconditionally alive
-/// groups. This query can be suppressed by the user in the user preferences.
+/// After the first calculation the scoring process is incremental: The two
+/// toggle methods remember which stone groups they changed, and the next
+/// calculation recalculates the territory color only of these stone groups and
+/// of the empty regions adjacent to them. The scoring values are adjusted by
+/// the difference. Any other change (e.g. enabling scoring, or changing the
+/// board position) causes the next calculation to be a full one again.
+///
+/// The calculation runs in a secondary thread and never touches GoPoint or
+/// GoBoardRegion objects. It works exclusively on a GoBoardSnapshot that is
+/// made when the calculation is requested, and its results are applied to the
+/// GoBoardRegion objects in the context of the main thread. The user may
+/// therefore continue to toggle stone groups while a calculation is in
+/// progress, the toggles take effect immediately. Each request to calculate
+/// is assigned a generation number, and a calculation that notices that a
+/// newer generation has been requested abandons its work and starts over.
+/// Only the score of the newest generation is published. See
+/// calculateWaitUntilDone:() for details.
+///
+/// @note When GoScore calculates a score for the first time, it sets up an
+/// initial list of dead stones that is estimated by GoDeadStoneEstimator. The
+/// estimate takes only a few milliseconds, so the first score is available
+/// almost immediately. At the same time GoScore asks the GTP engine for dead
+/// stones in the background. When the GTP engine responds, its list replaces
+/// the estimate and the score is calculated again - unless the user has already
+/// marked stones in the meantime, in which case the response is ignored. If
+/// the query is no longer needed before the GTP engine responds, e.g. because
+/// the user leaves scoring mode or starts a new game, GoScore cancels the
+/// query's GtpCancellationToken so that the GTP engine stops working on it.
+/// Both the estimate and the query can be suppressed by the user in the user
+/// preferences.
 ///
 ///
 /// @par Mark dead stones intelligently
@@ -193,9 +221,8 @@
 /// Setting this property to true puts all GoBoardRegion objects that currently
 /// exist into scoring mode (see the GoBoardRegion class documentation for
 /// details) and initializes them to belong to no territory. Also, when
-/// calculateWaitUntilDone:() is invoked the next time, the GTP engine will be
-/// queried for an initial set of dead stones (unless suppressed by the user
-/// preference).
+/// calculateWaitUntilDone:() is invoked the next time, an initial set of dead
+/// stones will be set up (unless suppressed by the user preference).
 ///
 /// Setting this property to false puts all GoBoardRegion objects that currently
 /// exist into normal mode, i.e. "not scoring" mode.
@@ -20,26 +20,165 @@
 #import "GoBoard.h"
 #import "GoBoardPosition.h"
 #import "GoBoardRegion.h"
+#import "GoBoardSnapshot.h"
+#import "GoDeadStoneEstimator.h"
 #import "GoGame.h"
 #import "GoGameRules.h"
-#import "GoMove.h"
+#import "GoMoveModel.h"
 #import "GoPlayer.h"
 #import "GoPoint.h"
 #import "../main/ApplicationDelegate.h"
+#import "../gtp/GtpAnalysisCache.h"
+#import "../gtp/GtpCancellationToken.h"
 #import "../gtp/GtpCommand.h"
 #import "../gtp/GtpResponse.h"
+#import "../gtp/GtpUtilities.h"
 #import "../utility/NSStringAdditions.h"
 #import "../play/model/ScoringModel.h"
 
 
+// -----------------------------------------------------------------------------
+/// @brief The GoScoreRegionCounts struct collects the number of intersections
+/// that GoBoardRegion objects contribute to the area, territory and dead
+/// stones scoring properties of GoScore.
+// -----------------------------------------------------------------------------
+struct GoScoreRegionCounts
+{
+  int territoryBlack;
+  int territoryWhite;
+  int aliveBlack;
+  int aliveWhite;
+  int deadBlack;
+  int deadWhite;
+};
+
+// -----------------------------------------------------------------------------
+/// @brief The GoScoreAdjacentStoneGroups struct records which kinds of stone
+/// groups are adjacent to an empty GoBoardRegion.
+// -----------------------------------------------------------------------------
+struct GoScoreAdjacentStoneGroups
+{
+  bool blackAliveSeen;
+  bool whiteAliveSeen;
+  bool blackDeadSeen;
+  bool whiteDeadSeen;
+  bool blackSekiSeen;
+  bool whiteSekiSeen;
+};
+
+// -----------------------------------------------------------------------------
+/// @brief The GoScoreCalculationParameters struct collects everything that a
+/// score calculation needs to know about GoScore and GoGame, apart from the
+/// GoBoardSnapshot that it works on. The values are captured in the context of
+/// the main thread when the calculation is requested, so that the calculation
+/// does not have to access GoScore or GoGame properties while it runs in a
+/// secondary thread.
+// -----------------------------------------------------------------------------
+struct GoScoreCalculationParameters
+{
+  bool scoringEnabled;
+  /// @brief True if the calculation sets up the initial set of dead stones.
+  bool setupInitialDeadStones;
+  /// @brief True if the calculation estimates the initial set of dead stones.
+  bool estimateDeadStones;
+  bool calculateIncrementally;
+  enum GoScoringSystem scoringSystem;
+  /// @brief A copy of m_pendingRegionCounts. Is used only if
+  /// @e calculateIncrementally is true.
+  struct GoScoreRegionCounts pendingRegionCounts;
+};
+
+/// @brief Number of seconds after which the query for dead stones is
+/// abandoned. The estimate made by GoDeadStoneEstimator is kept in that case.
+static const NSTimeInterval deadStonesGtpCommandTimeout = 10.0;
+
+
 // -----------------------------------------------------------------------------
 /// @brief Class extension with private properties for GoScore.
 // -----------------------------------------------------------------------------
 @interface GoScore()
+{
+  /// @brief The negative counts of the GoBoardRegion objects in
+  /// @e regionsToRescore, as they were when the score was last calculated.
+  struct GoScoreRegionCounts m_pendingRegionCounts;
+  /// @brief Is incremented every time that a new score calculation is
+  /// requested. Is protected by @synchronized(self).
+  int m_requestedGeneration;
+  /// @brief The value of m_requestedGeneration that the calculation currently
+  /// in progress is working on.
+  int m_calculationGeneration;
+  /// @brief Is incremented every time that the answer to a query for dead
+  /// stones becomes obsolete, because the board position, the scoring mode or
+  /// the state of a stone group changed after the query was made.
+  int m_deadStonesGeneration;
+  /// @brief The parameters of the newest requested generation. Is protected by
+  /// @synchronized(self).
+  struct GoScoreCalculationParameters m_requestedParameters;
+  /// @brief The parameters of the calculation currently in progress.
+  struct GoScoreCalculationParameters m_calculationParameters;
+  /// @name Results of the calculation currently in progress
+  ///
+  /// @brief The arrays have one element for each region of @e boardSnapshot,
+  /// indexed by region index. They are written by calculate() and read by
+  /// publishCalculation().
+  //@{
+  int m_numberOfCalculatedRegions;
+  enum GoStoneGroupState* m_stoneGroupStates;
+  enum GoColor* m_territoryColors;
+  bool* m_territoryInconsistencies;
+  struct GoScoreRegionCounts m_calculatedRegionCounts;
+  bool m_calculationHadError;
+  //@}
+}
 @property(nonatomic, assign) GoGame* game;
 @property(nonatomic, retain) NSOperationQueue* operationQueue;
-@property(nonatomic, assign) bool didAskGtpEngineForDeadStones;
+/// @brief Is true if the initial set of dead stones has been set up for the
+/// current board position.
+@property(nonatomic, assign) bool didSetupInitialDeadStones;
+/// @brief The "final_status_list dead" command that was most recently
+/// submitted to the GTP engine, and whose response has not yet been received.
+/// Is nil if no query is in progress.
+@property(nonatomic, retain) GtpCommand* deadStonesGtpCommand;
+/// @brief The token that abandons @e deadStonesGtpCommand when the query is
+/// no longer needed. Is nil if no query is in progress.
+@property(nonatomic, retain) GtpCancellationToken* deadStonesCancellationToken;
+/// @brief The GtpAnalysisCache key of the board position for which
+/// @e deadStonesGtpCommand was submitted.
+@property(nonatomic, retain) NSString* deadStonesCacheKey;
+/// @brief The value of m_deadStonesGeneration when the dead stones for
+/// @e deadStonesCacheKey were requested. The answer is applied only if
+/// m_deadStonesGeneration still has this value when the answer arrives.
+@property(nonatomic, assign) int deadStonesQueryGeneration;
 @property(nonatomic, assign) bool lastCalculationHadError;
+/// @brief Is true if the current scoring values can be updated by rescoring
+/// only the GoBoardRegion objects in @e regionsToRescore.
+@property(nonatomic, assign) bool canCalculateIncrementally;
+/// @brief The GoBoardRegion objects whose territory color must be recalculated
+/// because the state of a stone group was toggled since the score was last
+/// calculated.
+@property(nonatomic, retain) NSMutableArray* regionsToRescore;
+/// @brief The snapshot of the board position for which the newest score
+/// calculation was requested. If scoring is enabled the snapshot includes the
+/// regions of the board. Is nil if the request was discarded. Is protected by
+/// @synchronized(self).
+@property(nonatomic, retain) GoBoardSnapshot* requestedBoardSnapshot;
+/// @brief The GoBoardRegion objects that correspond to the region indexes of
+/// @e requestedBoardSnapshot. Must only be accessed in the context of the main
+/// thread. Is protected by @synchronized(self).
+@property(nonatomic, retain) NSArray* requestedBoardRegions;
+/// @brief The region indexes of @e requestedBoardSnapshot that correspond to
+/// @e regionsToRescore. Is nil if the requested calculation is not
+/// incremental. Is protected by @synchronized(self).
+@property(nonatomic, retain) NSIndexSet* requestedRegionIndexesToRescore;
+/// @brief The snapshot of the board position that the calculation currently in
+/// progress works on. The calculation reads stone colors, regions and stone
+/// group states from this snapshot instead of from the live GoBoard and its
+/// GoBoardRegion objects, which may be modified by the main thread while the
+/// calculation is running.
+@property(nonatomic, retain) GoBoardSnapshot* boardSnapshot;
+/// @brief The region indexes that the incremental calculation currently in
+/// progress rescores.
+@property(nonatomic, retain) NSIndexSet* regionIndexesToRescore;
 @end
 
 
@@ -62,8 +201,31 @@
   _askGtpEngineForDeadStonesInProgress = false;  // ditto
   _game = game;
   _operationQueue = [[NSOperationQueue alloc] init];
-  _didAskGtpEngineForDeadStones = false;
+  _didSetupInitialDeadStones = false;
+  _deadStonesGtpCommand = nil;
+  _deadStonesCancellationToken = nil;
+  _deadStonesCacheKey = nil;
+  _deadStonesQueryGeneration = 0;
+  m_deadStonesGeneration = 0;
   _lastCalculationHadError = false;
+  _canCalculateIncrementally = false;
+  _regionsToRescore = [[NSMutableArray alloc] initWithCapacity:0];
+  _requestedBoardSnapshot = nil;
+  _requestedBoardRegions = nil;
+  _requestedRegionIndexesToRescore = nil;
+  _boardSnapshot = nil;
+  _regionIndexesToRescore = nil;
+  memset(&m_pendingRegionCounts, 0, sizeof(m_pendingRegionCounts));
+  m_requestedGeneration = 0;
+  m_calculationGeneration = 0;
+  memset(&m_requestedParameters, 0, sizeof(m_requestedParameters));
+  memset(&m_calculationParameters, 0, sizeof(m_calculationParameters));
+  m_numberOfCalculatedRegions = 0;
+  m_stoneGroupStates = NULL;
+  m_territoryColors = NULL;
+  m_territoryInconsistencies = NULL;
+  memset(&m_calculatedRegionCounts, 0, sizeof(m_calculatedRegionCounts));
+  m_calculationHadError = false;
   [self resetValues];
 
   return self;
@@ -101,7 +263,7 @@
   _passesPlayedByBlack = [decoder decodeIntForKey:goScorePassesPlayedByBlackKey];
   _passesPlayedByWhite = [decoder decodeIntForKey:goScorePassesPlayedByWhiteKey];
   _game = [decoder decodeObjectForKey:goScoreGameKey];
-  _didAskGtpEngineForDeadStones = [decoder decodeBoolForKey:goScoreDidAskGtpEngineForDeadStonesKey];
+  _didSetupInitialDeadStones = [decoder decodeBoolForKey:goScoreDidSetupInitialDeadStonesKey];
   _lastCalculationHadError = [decoder decodeBoolForKey:goScoreLastCalculationHadErrorKey];
 
   // If we wanted to restore the two "in progress" states we would need to
@@ -111,7 +273,32 @@
   // saving/restoring the two "in progress" states.
   _scoringInProgress = false;
   _askGtpEngineForDeadStonesInProgress = false;
+  _deadStonesGtpCommand = nil;
+  _deadStonesCancellationToken = nil;
+  _deadStonesCacheKey = nil;
+  _deadStonesQueryGeneration = 0;
+  m_deadStonesGeneration = 0;
   _operationQueue = [[NSOperationQueue alloc] init];
+  // The GoBoardRegion objects are archived without scoring mode, so the next
+  // calculation must be a full one
+  _canCalculateIncrementally = false;
+  _regionsToRescore = [[NSMutableArray alloc] initWithCapacity:0];
+  _requestedBoardSnapshot = nil;
+  _requestedBoardRegions = nil;
+  _requestedRegionIndexesToRescore = nil;
+  _boardSnapshot = nil;
+  _regionIndexesToRescore = nil;
+  memset(&m_pendingRegionCounts, 0, sizeof(m_pendingRegionCounts));
+  m_requestedGeneration = 0;
+  m_calculationGeneration = 0;
+  memset(&m_requestedParameters, 0, sizeof(m_requestedParameters));
+  memset(&m_calculationParameters, 0, sizeof(m_calculationParameters));
+  m_numberOfCalculatedRegions = 0;
+  m_stoneGroupStates = NULL;
+  m_territoryColors = NULL;
+  m_territoryInconsistencies = NULL;
+  memset(&m_calculatedRegionCounts, 0, sizeof(m_calculatedRegionCounts));
+  m_calculationHadError = false;
 
   return self;
 }
@@ -123,6 +310,16 @@
 {
   [[NSNotificationCenter defaultCenter] removeObserver:self];
   self.operationQueue = nil;
+  self.regionsToRescore = nil;
+  self.deadStonesGtpCommand = nil;
+  self.deadStonesCancellationToken = nil;
+  self.deadStonesCacheKey = nil;
+  self.requestedBoardSnapshot = nil;
+  self.requestedBoardRegions = nil;
+  self.requestedRegionIndexesToRescore = nil;
+  self.boardSnapshot = nil;
+  self.regionIndexesToRescore = nil;
+  [self freeCalculationResults];
   [super dealloc];
 }
 
@@ -161,10 +358,13 @@
   if (_scoringEnabled == newState)
     return;
   _scoringEnabled = newState;
+  [self discardIncrementalCalculationState];
+  [self discardRequestedCalculation];
+  [self discardDeadStonesQuery];
   if (newState)
   {
     [self initializeRegions];
-    self.didAskGtpEngineForDeadStones = false;
+    self.didSetupInitialDeadStones = false;
   }
   else
   {
@@ -216,6 +416,9 @@
 {
   if (! self.scoringEnabled)
     return;
+  [self discardIncrementalCalculationState];
+  [self discardRequestedCalculation];
+  [self discardDeadStonesQuery];
   [self uninitializeRegions];
 }
 
@@ -233,7 +436,7 @@
   if (! self.scoringEnabled)
     return;
   [self initializeRegions];
-  self.didAskGtpEngineForDeadStones = false;
+  self.didSetupInitialDeadStones = false;
 }
 
 // -----------------------------------------------------------------------------
@@ -247,8 +450,35 @@
 /// are posted on the application's default NSNotificationCentre in the context
 /// of the main thread.
 ///
-/// @note This method does nothing if a scoring operation is already in
-/// progress.
+/// This method takes a GoBoardSnapshot of the current board position that
+/// includes the regions of the board and the current state of all stone
+/// groups. The calculation works on that snapshot only, it never reads or
+/// writes GoPoint or GoBoardRegion objects while it runs in a secondary
+/// thread. When it is finished, its results are applied to the GoBoardRegion
+/// objects and to the scoring properties of this GoScore object in the context
+/// of the main thread, just before #goScoreCalculationEnds is posted.
+///
+/// If the only thing that has changed since the score was last calculated is
+/// the state of some stone groups (see toggleDeadStateOfStoneGroup:() and
+/// toggleSekiStateOfStoneGroup:()), the calculation is incremental: Only the
+/// territory color of the toggled stone groups and of the empty regions
+/// adjacent to them is recalculated, and the scoring values are adjusted by
+/// the difference. The cost of an incremental calculation therefore does not
+/// depend on the number of regions on the board.
+///
+/// Each invocation of this method requests a new generation of the score. If
+/// a scoring operation is already in progress, this method does not start
+/// another one. Instead the operation in progress notices that a newer
+/// generation was requested, abandons its current work at the next safe point
+/// and starts over with the newest snapshot. Many requests in quick
+/// succession are therefore coalesced into a few calculations. Only the
+/// results of the newest generation are applied, and #goScoreCalculationEnds
+/// is posted only once.
+///
+/// @note If a scoring operation is already in progress, this method returns
+/// immediately even if @a waitUntilDone is true.
+///
+/// @note This method must be invoked in the context of the main thread.
 // -----------------------------------------------------------------------------
 - (void) calculateWaitUntilDone:(bool)waitUntilDone
 {
@@ -257,9 +487,46 @@
                waitUntilDone,
                self.scoringInProgress,
                self.game);
-  if (self.scoringInProgress)
+  // Snapshots must be made in the thread that modifies the Go model objects
+  GoBoardPosition* boardPosition = self.game.boardPosition;
+  GoBoardSnapshot* boardSnapshot = [boardPosition snapshotForBoardPosition:boardPosition.currentBoardPosition];
+  NSArray* boardRegions = nil;
+  NSIndexSet* regionIndexesToRescore = nil;
+  struct GoScoreCalculationParameters parameters;
+  memset(&parameters, 0, sizeof(parameters));
+  parameters.scoringEnabled = self.scoringEnabled;
+  if (parameters.scoringEnabled)
+  {
+    boardRegions = [NSArray arrayWithArray:self.game.board.regions];
+    boardSnapshot = [boardSnapshot snapshotWithRegions:boardRegions];
+    parameters.setupInitialDeadStones = ! self.didSetupInitialDeadStones;
+    parameters.estimateDeadStones = (parameters.setupInitialDeadStones &&
+                                     [ApplicationDelegate sharedDelegate].scoringModel.askGtpEngineForDeadStones);
+    parameters.scoringSystem = self.game.rules.scoringSystem;
+    if ([self shouldCalculateIncrementally])
+    {
+      regionIndexesToRescore = [self indexesOfRegionsToRescoreInBoardRegions:boardRegions];
+      parameters.calculateIncrementally = (regionIndexesToRescore != nil);
+      parameters.pendingRegionCounts = m_pendingRegionCounts;
+    }
+  }
+
+  bool isOperationInProgress;
+  @synchronized(self)
+  {
+    ++m_requestedGeneration;
+    m_requestedParameters = parameters;
+    self.requestedBoardSnapshot = boardSnapshot;
+    self.requestedBoardRegions = boardRegions;
+    self.requestedRegionIndexesToRescore = regionIndexesToRescore;
+    isOperationInProgress = _scoringInProgress;
+    if (! isOperationInProgress)
+      _scoringInProgress = true;
+  }
+  // The operation in progress picks up the new generation before it ends
+  if (isOperationInProgress)
     return;
-  self.scoringInProgress = true;  // notify while we're still in the main thread context
+  [self postScoringInProgressNotification:true];  // notify while we're still in the main thread context
 
   if (waitUntilDone)
     [self doCalculate];
@@ -274,7 +541,51 @@
 }
 
 // -----------------------------------------------------------------------------
-/// @brief Calculates a new score.
+/// @brief Returns the indexes in @a boardRegions of the GoBoardRegion objects
+/// in @e regionsToRescore. Returns nil if one of the GoBoardRegion objects is
+/// not in @a boardRegions, in which case the calculation cannot be
+/// incremental.
+///
+/// This is a private helper for calculateWaitUntilDone:().
+// -----------------------------------------------------------------------------
+- (NSIndexSet*) indexesOfRegionsToRescoreInBoardRegions:(NSArray*)boardRegions
+{
+  NSMutableIndexSet* regionIndexesToRescore = [NSMutableIndexSet indexSet];
+  for (GoBoardRegion* region in self.regionsToRescore)
+  {
+    NSUInteger regionIndex = [boardRegions indexOfObjectIdenticalTo:region];
+    if (NSNotFound == regionIndex)
+    {
+      DDLogError(@"%@: Region to rescore is no longer on the board, region = %@", self, region);
+      return nil;
+    }
+    [regionIndexesToRescore addIndex:regionIndex];
+  }
+  return regionIndexesToRescore;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Makes sure that the results of the calculation in progress, or of a
+/// calculation that was requested but has not yet started, are never applied.
+/// Is invoked when the GoBoardRegion objects are about to change in a way that
+/// invalidates the snapshot that the calculation works on.
+///
+/// This is a private helper.
+// -----------------------------------------------------------------------------
+- (void) discardRequestedCalculation
+{
+  @synchronized(self)
+  {
+    ++m_requestedGeneration;
+    self.requestedBoardSnapshot = nil;
+    self.requestedBoardRegions = nil;
+    self.requestedRegionIndexesToRescore = nil;
+  }
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Performs a scoring operation. Calculates new scores until the score
+/// for the newest requested generation has been calculated and applied.
 ///
 /// This method runs in the main thread context if calculateWaitUntilDone:()
 /// was invoked with value @e true for the @e waitUntilDone argument. If the
@@ -283,29 +594,175 @@
 // -----------------------------------------------------------------------------
 - (void) doCalculate
 {
-  @try
+  bool scoringInProgress = true;
+  while (scoringInProgress)
   {
-    self.lastCalculationHadError = false;
-    [self resetValues];
-
-    if (self.scoringEnabled)
+    bool didFinishCalculation = false;
+    @try
+    {
+      @synchronized(self)
+      {
+        m_calculationGeneration = m_requestedGeneration;
+        m_calculationParameters = m_requestedParameters;
+        self.boardSnapshot = self.requestedBoardSnapshot;
+        self.regionIndexesToRescore = self.requestedRegionIndexesToRescore;
+      }
+      // There is no snapshot if the request was discarded
+      if (self.boardSnapshot)
+      {
+        [self calculate];
+        if (! [self isCalculationObsolete])
+        {
+          [self performSelector:@selector(publishCalculation)
+                       onThread:[NSThread mainThread]
+                     withObject:nil
+                  waitUntilDone:YES];
+        }
+      }
+      didFinishCalculation = true;
+    }
+    @finally
     {
-      [self askGtpEngineForDeadStones];
-      bool success = [self updateTerritoryColor];
-      DDLogVerbose(@"%@: updateTerritoryColor returned with result = %d", self, success);
-      if (! success)
+      // The flag must be cleared under the same lock as the generation check,
+      // otherwise calculateWaitUntilDone:() could see the flag still set after
+      // the check, and its request would be lost. An exception ends the
+      // scoring operation regardless of newer requests.
+      @synchronized(self)
       {
-        self.lastCalculationHadError = true;
-        return;
+        if (! didFinishCalculation || m_calculationGeneration == m_requestedGeneration)
+          _scoringInProgress = false;
+        scoringInProgress = _scoringInProgress;
       }
+      if (! scoringInProgress)
+        [self postScoringInProgressNotification:scoringInProgress];
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Calculates a new score for generation m_calculationGeneration.
+/// Returns early without finishing the calculation if a newer generation is
+/// requested in the meantime.
+///
+/// The calculation works exclusively on @e boardSnapshot and
+/// m_calculationParameters. It stores its results in m_stoneGroupStates,
+/// m_territoryColors, m_territoryInconsistencies, m_calculatedRegionCounts and
+/// m_calculationHadError, from where publishCalculation() picks them up.
+///
+/// This is a private helper for doCalculate().
+// -----------------------------------------------------------------------------
+- (void) calculate
+{
+  [self freeCalculationResults];
+  m_calculationHadError = false;
+  memset(&m_calculatedRegionCounts, 0, sizeof(m_calculatedRegionCounts));
+
+  const struct GoScoreCalculationParameters* parameters = &m_calculationParameters;
+  if (! parameters->scoringEnabled)
+    return;
+
+  // Preliminary sanity check. The fact that only two scoring systems can occur
+  // makes some of the logic further down a lot simpler.
+  if (GoScoringSystemAreaScoring != parameters->scoringSystem &&
+      GoScoringSystemTerritoryScoring != parameters->scoringSystem)
+  {
+    DDLogError(@"%@: Unknown scoring system = %d", self, parameters->scoringSystem);
+    m_calculationHadError = true;
+    return;
+  }
+
+  GoBoardSnapshot* boardSnapshot = self.boardSnapshot;
+  int numberOfRegions = boardSnapshot.numberOfRegions;
+  m_numberOfCalculatedRegions = numberOfRegions;
+  m_stoneGroupStates = malloc(MAX(numberOfRegions, 1) * sizeof(enum GoStoneGroupState));
+  m_territoryColors = malloc(MAX(numberOfRegions, 1) * sizeof(enum GoColor));
+  m_territoryInconsistencies = malloc(MAX(numberOfRegions, 1) * sizeof(bool));
+  for (int regionIndex = 0; regionIndex < numberOfRegions; ++regionIndex)
+  {
+    m_stoneGroupStates[regionIndex] = [boardSnapshot stoneGroupStateOfRegion:regionIndex];
+    m_territoryColors[regionIndex] = GoColorNone;
+    m_territoryInconsistencies[regionIndex] = false;
+  }
+
+  if (parameters->calculateIncrementally)
+  {
+    bool success = [self updateTerritoryColorIncrementally];
+    DDLogVerbose(@"%@: updateTerritoryColorIncrementally returned with result = %d", self, success);
+    if (! success)
+    {
+      m_calculationHadError = true;
+      return;
+    }
+    m_calculatedRegionCounts = parameters->pendingRegionCounts;
+    NSIndexSet* regionIndexesToRescore = self.regionIndexesToRescore;
+    for (NSUInteger index = regionIndexesToRescore.firstIndex;
+         index != NSNotFound;
+         index = [regionIndexesToRescore indexGreaterThanIndex:index])
+    {
+      [self countRegionAtIndex:(int)index factor:1 regionCounts:&m_calculatedRegionCounts];
+    }
+    return;
+  }
+
+  if (parameters->estimateDeadStones)
+  {
+    NSIndexSet* deadStoneGroups = [GoDeadStoneEstimator deadStoneGroupsInBoardSnapshot:boardSnapshot];
+    DDLogVerbose(@"%@: estimated number of dead stone groups = %lu", self, (unsigned long)deadStoneGroups.count);
+    for (NSUInteger index = deadStoneGroups.firstIndex;
+         index != NSNotFound;
+         index = [deadStoneGroups indexGreaterThanIndex:index])
+    {
+      m_stoneGroupStates[index] = GoStoneGroupStateDead;
     }
+    if ([self isCalculationObsolete])
+      return;
+  }
 
-    [self updateScoringProperties];
+  bool success = [self updateTerritoryColor];
+  DDLogVerbose(@"%@: updateTerritoryColor returned with result = %d", self, success);
+  if (! success)
+  {
+    m_calculationHadError = true;
+    return;
   }
-  @finally
+  if ([self isCalculationObsolete])
+    return;
+
+  for (int regionIndex = 0; regionIndex < numberOfRegions; ++regionIndex)
+    [self countRegionAtIndex:regionIndex factor:1 regionCounts:&m_calculatedRegionCounts];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Frees the memory that calculate() allocated for its results.
+///
+/// This is a private helper.
+// -----------------------------------------------------------------------------
+- (void) freeCalculationResults
+{
+  free(m_stoneGroupStates);
+  free(m_territoryColors);
+  free(m_territoryInconsistencies);
+  m_stoneGroupStates = NULL;
+  m_territoryColors = NULL;
+  m_territoryInconsistencies = NULL;
+  m_numberOfCalculatedRegions = 0;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns true if a generation newer than m_calculationGeneration has
+/// been requested, i.e. if the calculation in progress is obsolete.
+///
+/// This is a private helper.
+// -----------------------------------------------------------------------------
+- (bool) isCalculationObsolete
+{
+  @synchronized(self)
   {
-    self.scoringInProgress = false;
+    if (m_calculationGeneration == m_requestedGeneration)
+      return false;
   }
+  DDLogVerbose(@"%@: abandoning calculation of generation %d", self, m_calculationGeneration);
+  return true;
 }
 
 // -----------------------------------------------------------------------------
@@ -313,10 +770,13 @@
 // -----------------------------------------------------------------------------
 - (void) setScoringInProgress:(bool)newValue
 {
-  if (_scoringInProgress == newValue)
-    return;
-  _scoringInProgress = newValue;
-  [self postScoringInProgressNotification];
+  @synchronized(self)
+  {
+    if (_scoringInProgress == newValue)
+      return;
+    _scoringInProgress = newValue;
+  }
+  [self postScoringInProgressNotification:newValue];
 }
 
 // -----------------------------------------------------------------------------
@@ -355,60 +815,190 @@
 }
 
 // -----------------------------------------------------------------------------
-/// @brief Queries the GTP engine for an initial set of dead stones. Updates
-/// GoBoardRegion objects with the result of the query.
+/// @brief Queries the GTP engine for dead stones. Does not wait for the
+/// response, deadStonesGtpResponseReceived:() handles the response when it
+/// arrives.
+///
+/// If the GTP engine was already asked about the current board position, the
+/// answer is taken from the application's GtpAnalysisCache instead, and
+/// applied immediately by deadStonesCacheHit:().
+///
+/// Is invoked in the context of the main thread.
 // -----------------------------------------------------------------------------
 - (void) askGtpEngineForDeadStones
 {
-  if (! [ApplicationDelegate sharedDelegate].scoringModel.askGtpEngineForDeadStones)
+  if (! self.scoringEnabled)
     return;
-  if (self.didAskGtpEngineForDeadStones)
+  // If a previous query is still in progress, its response will be ignored,
+  // so the GTP engine should not waste time on it
+  [self cancelDeadStonesGtpCommand];
+  self.deadStonesQueryGeneration = m_deadStonesGeneration;
+  self.deadStonesCacheKey = [GtpAnalysisCache keyForBoardPositionOfGame:self.game];
+  NSData* cachedDeadStoneVertices = [[ApplicationDelegate sharedDelegate].gtpAnalysisCache deadStoneVerticesForKey:self.deadStonesCacheKey];
+  if (cachedDeadStoneVertices)
+  {
+    self.deadStonesGtpCommand = nil;
+    if (self.askGtpEngineForDeadStonesInProgress)
+    {
+      self.askGtpEngineForDeadStonesInProgress = false;
+      [self postNotificationOnMainThread:askGtpEngineForDeadStonesEnds];
+    }
+    [self deadStonesCacheHit:cachedDeadStoneVertices];
     return;
-  self.didAskGtpEngineForDeadStones = true;
+  }
 
-  @try
+  if (! self.askGtpEngineForDeadStonesInProgress)
   {
     self.askGtpEngineForDeadStonesInProgress = true;
-    [self performSelector:@selector(postNotificationOnMainThread:)
-                 onThread:[NSThread mainThread]
-               withObject:askGtpEngineForDeadStonesStarts
-            waitUntilDone:YES];
-    GtpCommand* command = [GtpCommand command:@"final_status_list dead"];
-    [command submit];
-    if (command.response.status)
-    {
-      NSArray* deadStoneVertexList = [self parseDeadStoneGtpResponse:command.response.parsedResponse];
-      for (NSString* vertex in deadStoneVertexList)
-      {
-        GoPoint* point = [self.game.board pointAtVertex:vertex];
-        if (! [point hasStone])
-        {
-          DDLogError(@"%@: GTP engine reports vertex %@ is dead stone, but point %@ has no stone", self, vertex, point);
-          assert(0);
-          continue;
-        }
-        // TODO The next statement is problematic in two respects: 1) If the
-        // region has more than one point, we repeatedly set it to be dead,
-        // once for each vertex reported by the GTP engine. 2) We don't perform
-        // any kind of check if the vertex list reported by the GTP engine
-        // matches our regions.
-        point.region.stoneGroupState = GoStoneGroupStateDead;
-      }
-    }
-    else
+    [self postNotificationOnMainThread:askGtpEngineForDeadStonesStarts];
+  }
+  self.deadStonesGtpCommand = [GtpCommand asynchronousCommand:@"final_status_list dead"
+                                               responseTarget:self
+                                                     selector:@selector(deadStonesGtpResponseReceived:)];
+  self.deadStonesGtpCommand.timeout = deadStonesGtpCommandTimeout;
+  // The query needs no search tree, so an analysis engine can answer it
+  // without interrupting the play engine
+  self.deadStonesGtpCommand.engineAffinity = GtpEngineAffinityAnalysis;
+  // The commands that set up an analysis engine for the query are abandoned
+  // together with the query
+  self.deadStonesCancellationToken = [GtpCancellationToken token];
+  self.deadStonesGtpCommand.cancellationToken = self.deadStonesCancellationToken;
+  self.deadStonesGtpCommand.cancellable = true;
+  [GtpUtilities submitCommandAtCurrentBoardPosition:self.deadStonesGtpCommand];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Is invoked in the context of the main thread when the GTP engine
+/// responds to a command submitted by askGtpEngineForDeadStones().
+///
+/// Replaces the estimated set of dead stones with the set reported by the GTP
+/// engine, then starts a new score calculation. Nothing is replaced if
+/// @a response is obsolete (see @e deadStonesQueryGeneration).
+///
+/// The response is applied immediately, even if a scoring operation is in
+/// progress: The operation works on a snapshot, and the new calculation that
+/// is requested supersedes it.
+// -----------------------------------------------------------------------------
+- (void) deadStonesGtpResponseReceived:(GtpResponse*)response
+{
+  // Responses to commands that were superseded by a newer query are ignored
+  if (response.command != self.deadStonesGtpCommand)
+    return;
+
+  self.deadStonesGtpCommand = nil;
+  self.deadStonesCancellationToken = nil;
+  self.askGtpEngineForDeadStonesInProgress = false;
+  [self postNotificationOnMainThread:askGtpEngineForDeadStonesEnds];
+
+  int numberOfDeadStoneVertices = 0;
+  const struct GoVertexNumeric* deadStoneVertices = NULL;
+  if (response.status)
+  {
+    // The answer remains valid for its board position even if it is obsolete
+    // for the current one
+    deadStoneVertices = [response verticesWithCount:&numberOfDeadStoneVertices];
+    [[ApplicationDelegate sharedDelegate].gtpAnalysisCache setDeadStoneVertices:deadStoneVertices
+                                                                          count:numberOfDeadStoneVertices
+                                                                         forKey:self.deadStonesCacheKey];
+  }
+
+  if (self.deadStonesQueryGeneration != m_deadStonesGeneration)
+  {
+    DDLogVerbose(@"%@: ignoring obsolete response to query for dead stones", self);
+    return;
+  }
+  if (! response.status)
+  {
+    DDLogError(@"%@: Querying GTP engine for initial set of dead stones failed, keeping estimate", self);
+    return;
+  }
+
+  [self applyDeadStoneVertices:deadStoneVertices count:numberOfDeadStoneVertices];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Is invoked in the context of the main thread if
+/// askGtpEngineForDeadStones() finds the dead stones for the current board
+/// position in the GtpAnalysisCache.
+///
+/// Replaces the estimated set of dead stones with the cached set of dead
+/// stones @a deadStoneVertices, an array of GoVertexNumeric structs, then
+/// starts a new score calculation. Nothing is replaced if the cached set is
+/// obsolete (see @e deadStonesQueryGeneration).
+// -----------------------------------------------------------------------------
+- (void) deadStonesCacheHit:(NSData*)deadStoneVertices
+{
+  if (self.deadStonesQueryGeneration != m_deadStonesGeneration)
+  {
+    DDLogVerbose(@"%@: ignoring obsolete cached dead stones", self);
+    return;
+  }
+  // Cast is safe because the number of vertices is limited by the board size
+  int numberOfDeadStoneVertices = (int)(deadStoneVertices.length / sizeof(struct GoVertexNumeric));
+  [self applyDeadStoneVertices:(const struct GoVertexNumeric*)deadStoneVertices.bytes
+                         count:numberOfDeadStoneVertices];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Makes sure that the answer to a query for dead stones that is still
+/// pending is not applied when it arrives. Also abandons the query.
+///
+/// This is a private helper.
+// -----------------------------------------------------------------------------
+- (void) discardDeadStonesQuery
+{
+  ++m_deadStonesGeneration;
+  [self cancelDeadStonesGtpCommand];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Abandons the query for dead stones that is still pending, if there
+/// is one. GtpClient interrupts the GTP engine if it is working on the query,
+/// and completes the query with a "cancelled" failure response, which
+/// deadStonesGtpResponseReceived:() receives as usual.
+///
+/// This is a private helper.
+// -----------------------------------------------------------------------------
+- (void) cancelDeadStonesGtpCommand
+{
+  if (! self.deadStonesCancellationToken)
+    return;
+  [self.deadStonesCancellationToken cancel];
+  self.deadStonesCancellationToken = nil;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Private helper for deadStonesGtpResponseReceived:() and
+/// deadStonesCacheHit:(). Marks all stone groups that contain one of the
+/// @a numberOfDeadStoneVertices vertices in @a deadStoneVertices as dead, and
+/// all other stone groups as alive. Then starts a new score calculation.
+// -----------------------------------------------------------------------------
+- (void) applyDeadStoneVertices:(const struct GoVertexNumeric*)deadStoneVertices count:(int)numberOfDeadStoneVertices
+{
+  GoBoard* board = self.game.board;
+  for (GoBoardRegion* region in board.regions)
+  {
+    if ([region isStoneGroup])
+      region.stoneGroupState = GoStoneGroupStateAlive;
+  }
+  for (int indexOfVertex = 0; indexOfVertex < numberOfDeadStoneVertices; ++indexOfVertex)
+  {
+    struct GoVertexNumeric vertex = deadStoneVertices[indexOfVertex];
+    GoPoint* point = [board pointAtNumericVertex:vertex];
+    if (! [point hasStone])
     {
-      DDLogError(@"%@: Querying GTP engine for initial set of dead stones failed", self);
+      DDLogError(@"%@: GTP engine reports vertex %d/%d is dead stone, but point %@ has no stone", self, vertex.x, vertex.y, point);
       assert(0);
+      continue;
     }
+    // The GTP engine reports each stone of a stone group
+    GoBoardRegion* stoneGroup = point.region;
+    if (GoStoneGroupStateDead != stoneGroup.stoneGroupState)
+      stoneGroup.stoneGroupState = GoStoneGroupStateDead;
   }
-  @finally
-  {
-    self.askGtpEngineForDeadStonesInProgress = false;
-    [self performSelector:@selector(postNotificationOnMainThread:)
-                 onThread:[NSThread mainThread]
-               withObject:askGtpEngineForDeadStonesEnds
-            waitUntilDone:YES];
-  }
+
+  [self discardIncrementalCalculationState];
+  [self calculateWaitUntilDone:false];
 }
 
 // -----------------------------------------------------------------------------
@@ -448,9 +1038,23 @@
 /// posting the notification.
 // -----------------------------------------------------------------------------
 - (void) postScoringInProgressNotification
+{
+  [self postScoringInProgressNotification:self.scoringInProgress];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Posts either #goScoreCalculationStarts or #goScoreCalculationEnds to
+/// the global notification center, depending on @a scoringInProgress.
+///
+/// This is a private helper. Callers that change the scoring in progress flag
+/// pass the value that they read while holding the lock, so that the
+/// notification matches the change even if another thread changes the flag
+/// again before the notification is posted.
+// -----------------------------------------------------------------------------
+- (void) postScoringInProgressNotification:(bool)scoringInProgress
 {
   NSString* notificationName;
-  if (self.scoringInProgress)
+  if (scoringInProgress)
     notificationName = goScoreCalculationStarts;
   else
     notificationName = goScoreCalculationEnds;
@@ -468,32 +1072,6 @@
   [[NSNotificationCenter defaultCenter] postNotificationName:notificationName object:nil];
 }
 
-// -----------------------------------------------------------------------------
-/// @brief Parses @a gtpResponse, which is expected to be the response to the
-/// command "final_status_list dead", for strings that denote vertexes. Returns
-/// a list with all vertexes found.
-// -----------------------------------------------------------------------------
-- (NSArray*) parseDeadStoneGtpResponse:(NSString*)gtpResponse
-{
-  NSMutableArray* deadStoneVertexList = [NSMutableArray arrayWithCapacity:0];
-  if (0 == gtpResponse.length)
-    return deadStoneVertexList;
-  NSArray* responseLines = [gtpResponse componentsSeparatedByString:@"\n"];
-  for (NSString* responseLine in responseLines)
-  {
-    if (0 == responseLine.length)
-      continue;
-    NSArray* vertexList = [responseLine componentsSeparatedByString:@" "];
-    for (NSString* vertex in vertexList)
-    {
-      if (0 == vertex.length)
-        continue;
-      [deadStoneVertexList addObject:vertex];
-    }
-  }
-  return deadStoneVertexList;
-}
-
 // -----------------------------------------------------------------------------
 /// @brief Toggles the status of the stone group @a stoneGroup from alive to
 /// dead, or vice versa. If @a stoneGroup is in seki, its status is changed to
@@ -510,15 +1088,18 @@
 /// client needs to separately invoke calculateWaitUntilDone:() to get the
 /// updated score.
 ///
+/// @note The toggle takes effect immediately, even if a scoring operation is
+/// in progress. The scoring operation works on a snapshot, so it is not
+/// affected by the toggle, and its results are discarded when the next
+/// calculation is requested.
+///
 /// @note This method does nothing if scoring is not enabled on this GoScore
-/// object, or if a scoring operation is already in progress.
+/// object.
 // -----------------------------------------------------------------------------
 - (void) toggleDeadStateOfStoneGroup:(GoBoardRegion*)stoneGroup
 {
   if (! self.scoringEnabled)
     return;
-  if (self.scoringInProgress)
-    return;
   if (! [stoneGroup isStoneGroup])
     return;
 
@@ -560,6 +1141,7 @@
         assert(0);
         continue;
     }
+    [self willChangeStateOfStoneGroup:stoneGroupToToggle];
     stoneGroupToToggle.stoneGroupState = newStoneGroupState;
     enum GoColor colorOfStoneGroupToToggle = [stoneGroupToToggle color];
 
@@ -627,15 +1209,16 @@
 /// @brief Toggles the status of the stone group @a stoneGroup from seki to
 /// alive, or vice versa. If @a stoneGroup is dead, its status is changed to
 /// in seki.
+///
+/// The notes for toggleDeadStateOfStoneGroup:() apply to this method, too.
 // -----------------------------------------------------------------------------
 - (void) toggleSekiStateOfStoneGroup:(GoBoardRegion*)stoneGroup
 {
   if (! self.scoringEnabled)
     return;
-  if (self.scoringInProgress)
-    return;
   if (! [stoneGroup isStoneGroup])
     return;
+
   enum GoStoneGroupState newStoneGroupState;
   switch (stoneGroup.stoneGroupState)
   {
@@ -653,268 +1236,522 @@
       assert(0);
       return;
   }
+  [self willChangeStateOfStoneGroup:stoneGroup];
   stoneGroup.stoneGroupState = newStoneGroupState;
 }
 
 // -----------------------------------------------------------------------------
-/// @brief (Re)Calculates the territory color of all GoBoardRegion objects.
-/// Returns true if calculation was successful, false if not.
-///
-/// This method looks at the @e stoneGroupState property of GoBoardRegion
-/// objects. For details see the class documentation, paragraph "Determining
-/// territory color".
+/// @brief Private helper for the methods that toggle the state of a stone
+/// group. Must be invoked before the state of @a stoneGroup is changed.
 ///
-/// Initial dead stones are set up by askGtpEngineForDeadStones(). User
-/// interaction during scoring invokes toggleDeadStateOfStoneGroup:() to add
-/// more dead stones, or turn them back to alive.
+/// Remembers @a stoneGroup and the empty regions adjacent to it for the next
+/// incremental calculation, and subtracts their current counts from the
+/// scoring values that will be adjusted by that calculation. Also makes sure
+/// that neither a pending response of the GTP engine to a query for dead
+/// stones, nor the estimate of a calculation that is still in progress, undo
+/// the user's change.
 // -----------------------------------------------------------------------------
-- (bool) updateTerritoryColor
+- (void) willChangeStateOfStoneGroup:(GoBoardRegion*)stoneGroup
 {
-  // Preliminary sanity check. The fact that only two scoring systems can occur
-  // makes some of the logic further down a lot simpler.
-  enum GoScoringSystem scoringSystem = self.game.rules.scoringSystem;
-  if (GoScoringSystemAreaScoring != scoringSystem &&
-      GoScoringSystemTerritoryScoring != scoringSystem)
+  // The user's decision takes precedence over a pending GTP engine response
+  // and over an estimate that has not been published yet
+  [self discardDeadStonesQuery];
+  self.didSetupInitialDeadStones = true;
+  if (! self.canCalculateIncrementally)
+    return;
+  [self addRegionToRescore:stoneGroup];
+  for (GoBoardRegion* adjacentRegion in [stoneGroup adjacentRegions])
   {
-    DDLogError(@"%@: Unknown scoring system = %d", self, scoringSystem);
-    return false;
+    if (! [adjacentRegion isStoneGroup])
+      [self addRegionToRescore:adjacentRegion];
   }
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Private helper for willChangeStateOfStoneGroup:().
+// -----------------------------------------------------------------------------
+- (void) addRegionToRescore:(GoBoardRegion*)region
+{
+  if ([self.regionsToRescore containsObject:region])
+    return;
+  [self.regionsToRescore addObject:region];
+  [self countRegion:region factor:-1 regionCounts:&m_pendingRegionCounts];
+}
 
-  // Regions that are truly empty, i.e. that do not have dead stones
-  NSMutableArray* emptyRegions = [NSMutableArray arrayWithCapacity:0];
+// -----------------------------------------------------------------------------
+/// @brief Forgets everything that was remembered for the next incremental
+/// calculation. The next calculation will be a full one.
+///
+/// This is a private helper.
+// -----------------------------------------------------------------------------
+- (void) discardIncrementalCalculationState
+{
+  self.canCalculateIncrementally = false;
+  [self.regionsToRescore removeAllObjects];
+  memset(&m_pendingRegionCounts, 0, sizeof(m_pendingRegionCounts));
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns true if the next calculation can be incremental, false if it
+/// must be a full calculation.
+///
+/// This is a private helper.
+// -----------------------------------------------------------------------------
+- (bool) shouldCalculateIncrementally
+{
+  if (! self.scoringEnabled || ! self.canCalculateIncrementally)
+    return false;
+  if (0 == self.regionsToRescore.count)
+    return false;
+  // Initial dead stones must be set up by a full calculation
+  if (! self.didSetupInitialDeadStones)
+    return false;
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief (Re)Calculates the territory color of all regions in
+/// @e boardSnapshot. Returns true if calculation was successful, false if not.
+///
+/// This method looks at the stone group states in m_stoneGroupStates. For
+/// details see the class documentation, paragraph "Determining territory
+/// color". The results are stored in m_territoryColors and
+/// m_territoryInconsistencies, publishCalculation() later copies them to the
+/// GoBoardRegion objects.
+///
+/// This is a private helper for calculate().
+// -----------------------------------------------------------------------------
+- (bool) updateTerritoryColor
+{
+  GoBoardSnapshot* boardSnapshot = self.boardSnapshot;
+  int numberOfRegions = boardSnapshot.numberOfRegions;
+  enum GoScoringSystem scoringSystem = m_calculationParameters.scoringSystem;
+
+  // Bitboards that collect the points of all empty regions, and the stones of
+  // all stone groups, separated by color and stone group state. In pass 2 we
+  // can then find out which kinds of stone groups surround an empty region
+  // with a few bitboard operations, instead of examining every adjacent
+  // region.
+  struct GoBitboard emptyPoints;
+  struct GoBitboard blackAliveStones;
+  struct GoBitboard whiteAliveStones;
+  struct GoBitboard blackDeadStones;
+  struct GoBitboard whiteDeadStones;
+  struct GoBitboard blackSekiStones;
+  struct GoBitboard whiteSekiStones;
+  GoBitboardClear(&emptyPoints);
+  GoBitboardClear(&blackAliveStones);
+  GoBitboardClear(&whiteAliveStones);
+  GoBitboardClear(&blackDeadStones);
+  GoBitboardClear(&whiteDeadStones);
+  GoBitboardClear(&blackSekiStones);
+  GoBitboardClear(&whiteSekiStones);
 
   // Pass 1: Set territory colors for stone groups. This is easy and can be
   // done both for groups that are alive and dead. While we are at it, we can
-  // also collect empty regions, which will be processed in pass 2.
-  NSArray* allRegions = self.game.board.regions;
-  for (GoBoardRegion* region in allRegions)
+  // also collect the points of empty regions, which will be processed in
+  // pass 2.
+  for (int regionIndex = 0; regionIndex < numberOfRegions; ++regionIndex)
   {
-    if (! [region isStoneGroup])
+    const struct GoBitboard* regionBitboard = [boardSnapshot pointsOfRegion:regionIndex];
+    enum GoColor regionColor = [boardSnapshot colorOfRegion:regionIndex];
+    if (GoColorNone == regionColor)
     {
-      // Setting territory color here is temporary, the final color will be
-      // determined in pass 2. We still need to do it, though, to erase traces
-      // from a previous scoring calculation.
-      region.territoryColor = GoColorNone;
-      [emptyRegions addObject:region];
+      GoBitboardOr(&emptyPoints, &emptyPoints, regionBitboard);
     }
     else
     {
-      switch (region.stoneGroupState)
+      if (! [self updateTerritoryColorOfStoneGroup:regionIndex scoringSystem:scoringSystem])
+        return false;
+      bool isBlack = (GoColorBlack == regionColor);
+      struct GoBitboard* stones;
+      switch (m_stoneGroupStates[regionIndex])
       {
         case GoStoneGroupStateAlive:
-        {
-          // If the group is alive, it belongs to the territory of the color who
-          // played the stones in the group. This is important only for area
-          // scoring.
-          region.territoryColor = [region color];
+          stones = isBlack ? &blackAliveStones : &whiteAliveStones;
           break;
-        }
         case GoStoneGroupStateDead:
-        {
-          // If the group is dead, it belongs to the territory of the opposing
-          // color
-          switch ([region color])
-          {
-            case GoColorBlack:
-              region.territoryColor = GoColorWhite;
-              break;
-            case GoColorWhite:
-              region.territoryColor = GoColorBlack;
-              break;
-            default:
-              DDLogError(@"%@: Stone groups must be either black or white, region %@ has color %d", self, region, [region color]);
-              return false;
-          }
+          stones = isBlack ? &blackDeadStones : &whiteDeadStones;
           break;
-        }
-        case GoStoneGroupStateSeki:
-        {
-          // If the group is in seki, the scoring system decides the territory
-          // that the group belongs to
-          if (GoScoringSystemAreaScoring == scoringSystem)
-            region.territoryColor = [region color];
-          else
-            region.territoryColor = GoColorNone;
-          break;
-        }
         default:
-        {
-          DDLogError(@"%@: Unknown stone group state = %d", self, region.stoneGroupState);
-          return false;
-        }
+          stones = isBlack ? &blackSekiStones : &whiteSekiStones;
+          break;
       }
+      GoBitboardOr(stones, stones, regionBitboard);
     }
   }
 
   // Pass 2: Process empty regions. Here we examine the stone groups adjacent
   // to each empty region to determine the empty region's final territory color.
-  for (GoBoardRegion* emptyRegion in emptyRegions)
+  // The stones adjacent to an empty region are the border of the region's
+  // bitboard.
+  for (int regionIndex = 0; regionIndex < numberOfRegions; ++regionIndex)
+  {
+    if (GoColorNone != [boardSnapshot colorOfRegion:regionIndex])
+      continue;
+    struct GoBitboard adjacentStones;
+    GoBitboardBorder(&adjacentStones, [boardSnapshot pointsOfRegion:regionIndex], boardSnapshot.rowStride, boardSnapshot.onBoardMask);
+    if (GoBitboardIntersects(&adjacentStones, &emptyPoints))
+    {
+      DDLogError(@"%@: Regions adjacent to an empty region can only be stone groups, empty region index = %d", self, regionIndex);
+      return false;
+    }
+
+    struct GoScoreAdjacentStoneGroups adjacentStoneGroups;
+    adjacentStoneGroups.blackAliveSeen = GoBitboardIntersects(&adjacentStones, &blackAliveStones);
+    adjacentStoneGroups.whiteAliveSeen = GoBitboardIntersects(&adjacentStones, &whiteAliveStones);
+    adjacentStoneGroups.blackDeadSeen = GoBitboardIntersects(&adjacentStones, &blackDeadStones);
+    adjacentStoneGroups.whiteDeadSeen = GoBitboardIntersects(&adjacentStones, &whiteDeadStones);
+    adjacentStoneGroups.blackSekiSeen = GoBitboardIntersects(&adjacentStones, &blackSekiStones);
+    adjacentStoneGroups.whiteSekiSeen = GoBitboardIntersects(&adjacentStones, &whiteSekiStones);
+    [self updateTerritoryColorOfEmptyRegion:regionIndex
+                        adjacentStoneGroups:&adjacentStoneGroups
+                              scoringSystem:scoringSystem];
+  }
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Sets the territory color of the stone group with region index
+/// @a regionIndex according to its state in m_stoneGroupStates. Returns true
+/// if successful, false if the stone group has an unexpected color or state.
+///
+/// This is a private helper for updateTerritoryColor() and
+/// updateTerritoryColorIncrementally().
+// -----------------------------------------------------------------------------
+- (bool) updateTerritoryColorOfStoneGroup:(int)regionIndex
+                            scoringSystem:(enum GoScoringSystem)scoringSystem
+{
+  // Preliminary sanity check. The fact that only two colors can occur makes
+  // the subsequent logic simpler.
+  enum GoColor regionColor = [self.boardSnapshot colorOfRegion:regionIndex];
+  if (GoColorBlack != regionColor && GoColorWhite != regionColor)
+  {
+    DDLogError(@"%@: Stone groups must be either black or white, region index %d has color %d", self, regionIndex, regionColor);
+    return false;
+  }
+
+  enum GoStoneGroupState stoneGroupState = m_stoneGroupStates[regionIndex];
+  switch (stoneGroupState)
+  {
+    case GoStoneGroupStateAlive:
+    {
+      // If the group is alive, it belongs to the territory of the color who
+      // played the stones in the group. This is important only for area
+      // scoring.
+      m_territoryColors[regionIndex] = regionColor;
+      break;
+    }
+    case GoStoneGroupStateDead:
+    {
+      // If the group is dead, it belongs to the territory of the opposing
+      // color
+      m_territoryColors[regionIndex] = (GoColorBlack == regionColor) ? GoColorWhite : GoColorBlack;
+      break;
+    }
+    case GoStoneGroupStateSeki:
+    {
+      // If the group is in seki, the scoring system decides the territory
+      // that the group belongs to
+      if (GoScoringSystemAreaScoring == scoringSystem)
+        m_territoryColors[regionIndex] = regionColor;
+      else
+        m_territoryColors[regionIndex] = GoColorNone;
+      break;
+    }
+    default:
+    {
+      DDLogError(@"%@: Unknown stone group state = %d", self, stoneGroupState);
+      return false;
+    }
+  }
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Sets the territory color of the empty region with region index
+/// @a regionIndex according to the kinds of stone groups that are adjacent to
+/// it, as described by @a adjacentStoneGroups.
+///
+/// This is a private helper for updateTerritoryColor() and
+/// updateTerritoryColorIncrementally().
+// -----------------------------------------------------------------------------
+- (void) updateTerritoryColorOfEmptyRegion:(int)regionIndex
+                       adjacentStoneGroups:(const struct GoScoreAdjacentStoneGroups*)adjacentStoneGroups
+                             scoringSystem:(enum GoScoringSystem)scoringSystem
+{
+  bool blackAliveSeen = adjacentStoneGroups->blackAliveSeen;
+  bool whiteAliveSeen = adjacentStoneGroups->whiteAliveSeen;
+  bool blackDeadSeen = adjacentStoneGroups->blackDeadSeen;
+  bool whiteDeadSeen = adjacentStoneGroups->whiteDeadSeen;
+  bool blackSekiSeen = adjacentStoneGroups->blackSekiSeen;
+  bool whiteSekiSeen = adjacentStoneGroups->whiteSekiSeen;
+  bool aliveSeen = (blackAliveSeen || whiteAliveSeen);
+  bool deadSeen = (blackDeadSeen || whiteDeadSeen);
+  bool sekiSeen = (blackSekiSeen || whiteSekiSeen);
+
+  bool territoryInconsistencyFound = false;
+  enum GoColor territoryColor = GoColorNone;
+  if (! deadSeen)
   {
-    bool aliveSeen = false;
-    bool blackAliveSeen = false;
-    bool whiteAliveSeen = false;
-    bool deadSeen = false;
-    bool blackDeadSeen = false;
-    bool whiteDeadSeen = false;
-    bool sekiSeen = false;
-    bool blackSekiSeen = false;
-    bool whiteSekiSeen = false;
-    for (GoBoardRegion* adjacentRegion in [emptyRegion adjacentRegions])
+    if (! aliveSeen && ! sekiSeen)
+    {
+      // Ok, empty board, neutral territory
+      territoryColor = GoColorNone;
+    }
+    else if ((blackSekiSeen && blackAliveSeen) || (whiteSekiSeen && whiteAliveSeen))
+    {
+      // Rules violation! Cannot see alive and seki stones of the same
+      // color. In such a position, the seki stones could, theoretically,
+      // be connected to the alive stones. The opposing player therefore
+      // MUST play so that no connection is possible and this position
+      // cannot occur.
+      territoryInconsistencyFound = true;
+    }
+    else if ((blackSekiSeen && whiteAliveSeen) || (whiteSekiSeen && blackAliveSeen))
     {
-      if (! [adjacentRegion isStoneGroup])
+      // Rules violation! Cannot see alive and seki stones of different
+      // colors. In all seki positions and examples that I could find,
+      // seki stones are always completely surrounded, the only liberties
+      // being their own eyes, or liberties shared with seki stones of
+      // the other color. The opposing player therefore MUST play and fill
+      // in all liberties around the seki stones.
+      territoryInconsistencyFound = true;
+    }
+    else if ((blackSekiSeen && whiteSekiSeen) || (blackAliveSeen && whiteAliveSeen))
+    {
+      // Ok, dame, neutral territory
+      territoryColor = GoColorNone;
+    }
+    else if (sekiSeen)
+    {
+      // Ok, only one color has been seen, and all groups were in seki
+      if (GoScoringSystemAreaScoring == scoringSystem)
       {
-        DDLogError(@"%@: Regions adjacent to an empty region can only be stone groups, adjacent region = %@", self, adjacentRegion);
-        return false;
+        // Area scoring counts this as territory
+        if (blackSekiSeen)
+          territoryColor = GoColorBlack;
+        else
+          territoryColor = GoColorWhite;
       }
+      else
+      {
+        // Territory scoring counts this as neutral territory
+        territoryColor = GoColorNone;
+      }
+    }
+    else
+    {
+      // Ok, only one color has been seen, and all groups were alive
+      if (blackAliveSeen)
+        territoryColor = GoColorBlack;
+      else
+        territoryColor = GoColorWhite;
+    }
+  }
+  else
+  {
+    if (sekiSeen)
+    {
+      // Rules violation! Cannot see dead and seki stones at the same time
+      territoryInconsistencyFound = true;
+    }
+    else if (blackDeadSeen && whiteDeadSeen)
+    {
+      // Rules violation! Cannot see dead stones of both colors
+      territoryInconsistencyFound = true;
+    }
+    else if ((blackDeadSeen && blackAliveSeen) || (whiteDeadSeen && whiteAliveSeen))
+    {
+      // Rules violation! Cannot see both dead and alive stones of the same
+      // color
+      territoryInconsistencyFound = true;
+    }
+    else
+    {
+      // Ok, only dead stones of one color seen (we don't care whether the
+      // opposing color has alive stones)
+      if (blackDeadSeen)
+        territoryColor = GoColorWhite;
+      else
+        territoryColor = GoColorBlack;
+    }
+  }
+
+  m_territoryColors[regionIndex] = territoryColor;
+  m_territoryInconsistencies[regionIndex] = territoryInconsistencyFound;
+}
+
+
+// -----------------------------------------------------------------------------
+/// @brief Recalculates the territory color of the regions in
+/// @e regionIndexesToRescore. Returns true if calculation was successful,
+/// false if not.
+///
+/// This is the incremental counterpart of updateTerritoryColor(). The
+/// territory color of a stone group depends only on its own state, and the
+/// territory color of an empty region depends only on the state of the stone
+/// groups adjacent to it. When the state of some stone groups changes, these
+/// stone groups and the empty regions adjacent to them are therefore the only
+/// regions whose territory color can change.
+// -----------------------------------------------------------------------------
+- (bool) updateTerritoryColorIncrementally
+{
+  GoBoardSnapshot* boardSnapshot = self.boardSnapshot;
+  enum GoScoringSystem scoringSystem = m_calculationParameters.scoringSystem;
+  NSIndexSet* regionIndexesToRescore = self.regionIndexesToRescore;
+  for (NSUInteger index = regionIndexesToRescore.firstIndex;
+       index != NSNotFound;
+       index = [regionIndexesToRescore indexGreaterThanIndex:index])
+  {
+    // Cast is safe because region indexes are created from int values
+    int regionIndex = (int)index;
+    if (GoColorNone != [boardSnapshot colorOfRegion:regionIndex])
+    {
+      if (! [self updateTerritoryColorOfStoneGroup:regionIndex scoringSystem:scoringSystem])
+        return false;
+      continue;
+    }
 
-      // Preliminary sanity check. The fact that only two colors can occur makes
-      // the subsequent logic simpler.
-      enum GoColor adjacentRegionColor = [adjacentRegion color];
-      if (GoColorBlack != adjacentRegionColor && GoColorWhite != adjacentRegionColor)
+    struct GoScoreAdjacentStoneGroups adjacentStoneGroups;
+    memset(&adjacentStoneGroups, 0, sizeof(adjacentStoneGroups));
+    int numberOfAdjacentRegions;
+    const int* adjacentRegions = [boardSnapshot adjacentRegionsOfRegion:regionIndex count:&numberOfAdjacentRegions];
+    for (int indexOfAdjacentRegion = 0; indexOfAdjacentRegion < numberOfAdjacentRegions; ++indexOfAdjacentRegion)
+    {
+      int adjacentRegion = adjacentRegions[indexOfAdjacentRegion];
+      enum GoColor adjacentRegionColor = [boardSnapshot colorOfRegion:adjacentRegion];
+      if (GoColorNone == adjacentRegionColor)
       {
-        DDLogError(@"%@: Stone groups must be either black or white, adjacent stone group region %@ has color %d", self, adjacentRegion, adjacentRegionColor);
+        DDLogError(@"%@: Regions adjacent to an empty region can only be stone groups, empty region index = %d", self, regionIndex);
         return false;
       }
-
-      switch (adjacentRegion.stoneGroupState)
+      bool isBlack = (GoColorBlack == adjacentRegionColor);
+      switch (m_stoneGroupStates[adjacentRegion])
       {
         case GoStoneGroupStateAlive:
-        {
-          aliveSeen = true;
-          if (GoColorBlack == adjacentRegionColor)
-            blackAliveSeen = true;
+          if (isBlack)
+            adjacentStoneGroups.blackAliveSeen = true;
           else
-            whiteAliveSeen = true;
+            adjacentStoneGroups.whiteAliveSeen = true;
           break;
-        }
         case GoStoneGroupStateDead:
-        {
-          deadSeen = true;
-          if (GoColorBlack == adjacentRegionColor)
-            blackDeadSeen = true;
+          if (isBlack)
+            adjacentStoneGroups.blackDeadSeen = true;
           else
-            whiteDeadSeen = true;
+            adjacentStoneGroups.whiteDeadSeen = true;
           break;
-        }
         case GoStoneGroupStateSeki:
-        {
-          sekiSeen = true;
-          if (GoColorBlack == adjacentRegionColor)
-            blackSekiSeen = true;
+          if (isBlack)
+            adjacentStoneGroups.blackSekiSeen = true;
           else
-            whiteSekiSeen = true;
+            adjacentStoneGroups.whiteSekiSeen = true;
           break;
-        }
         default:
-        {
-          DDLogError(@"%@: Unknown stone group state = %d", self, adjacentRegion.stoneGroupState);
+          DDLogError(@"%@: Unknown stone group state = %d", self, m_stoneGroupStates[adjacentRegion]);
           return false;
-        }
       }
     }
+    [self updateTerritoryColorOfEmptyRegion:regionIndex
+                        adjacentStoneGroups:&adjacentStoneGroups
+                              scoringSystem:scoringSystem];
+  }
+
+  return true;
+}
 
-    bool territoryInconsistencyFound = false;
-    enum GoColor territoryColor = GoColorNone;
-    if (! deadSeen)
+// -----------------------------------------------------------------------------
+/// @brief Copies the results of the calculation that has just finished to the
+/// GoBoardRegion objects and to the scoring properties of this GoScore object.
+/// Does nothing if a newer generation has been requested in the meantime.
+///
+/// This is the only place where the results of a calculation are applied to
+/// the Go model objects. It is invoked in the context of the main thread,
+/// i.e. in the same thread that changes GoBoardRegion objects, so the
+/// regions are guaranteed to describe the board position of @e boardSnapshot
+/// as long as the generation is not obsolete.
+///
+/// This is a private helper for doCalculate().
+// -----------------------------------------------------------------------------
+- (void) publishCalculation
+{
+  NSArray* boardRegions;
+  @synchronized(self)
+  {
+    if (m_calculationGeneration != m_requestedGeneration)
     {
-      if (! aliveSeen && ! sekiSeen)
-      {
-        // Ok, empty board, neutral territory
-        territoryColor = GoColorNone;
-      }
-      else if ((blackSekiSeen && blackAliveSeen) || (whiteSekiSeen && whiteAliveSeen))
-      {
-        // Rules violation! Cannot see alive and seki stones of the same
-        // color. In such a position, the seki stones could, theoretically,
-        // be connected to the alive stones. The opposing player therefore
-        // MUST play so that no connection is possible and this position
-        // cannot occur.
-        territoryInconsistencyFound = true;
-      }
-      else if ((blackSekiSeen && whiteAliveSeen) || (whiteSekiSeen && blackAliveSeen))
-      {
-        // Rules violation! Cannot see alive and seki stones of different
-        // colors. In all seki positions and examples that I could find,
-        // seki stones are always completely surrounded, the only liberties
-        // being their own eyes, or liberties shared with seki stones of
-        // the other color. The opposing player therefore MUST play and fill
-        // in all liberties around the seki stones.
-        territoryInconsistencyFound = true;
-      }
-      else if ((blackSekiSeen && whiteSekiSeen) || (blackAliveSeen && whiteAliveSeen))
-      {
-        // Ok, dame, neutral territory
-        territoryColor = GoColorNone;
-      }
-      else if (sekiSeen)
-      {
-        // Ok, only one color has been seen, and all groups were in seki
-        if (GoScoringSystemAreaScoring == scoringSystem)
-        {
-          // Area scoring counts this as territory
-          if (blackSekiSeen)
-            territoryColor = GoColorBlack;
-          else
-            territoryColor = GoColorWhite;
-        }
-        else
-        {
-          // Territory scoring counts this as neutral territory
-          territoryColor = GoColorNone;
-        }
-      }
-      else
-      {
-        // Ok, only one color has been seen, and all groups were alive
-        if (blackAliveSeen)
-          territoryColor = GoColorBlack;
-        else
-          territoryColor = GoColorWhite;
-      }
+      DDLogVerbose(@"%@: not publishing obsolete calculation of generation %d", self, m_calculationGeneration);
+      return;
     }
-    else
+    boardRegions = [[self.requestedBoardRegions retain] autorelease];
+  }
+  const struct GoScoreCalculationParameters* parameters = &m_calculationParameters;
+
+  if (parameters->calculateIncrementally)
+  {
+    if (m_calculationHadError)
     {
-      if (sekiSeen)
-      {
-        // Rules violation! Cannot see dead and seki stones at the same time
-        territoryInconsistencyFound = true;
-      }
-      else if (blackDeadSeen && whiteDeadSeen)
-      {
-        // Rules violation! Cannot see dead stones of both colors
-        territoryInconsistencyFound = true;
-      }
-      else if ((blackDeadSeen && blackAliveSeen) || (whiteDeadSeen && whiteAliveSeen))
-      {
-        // Rules violation! Cannot see both dead and alive stones of the same
-        // color
-        territoryInconsistencyFound = true;
-      }
-      else
-      {
-        // Ok, only dead stones of one color seen (we don't care whether the
-        // opposing color has alive stones)
-        if (blackDeadSeen)
-          territoryColor = GoColorWhite;
-        else
-          territoryColor = GoColorBlack;
-      }
+      [self discardIncrementalCalculationState];
+      self.lastCalculationHadError = true;
+      return;
+    }
+    NSIndexSet* regionIndexesToRescore = self.regionIndexesToRescore;
+    for (NSUInteger index = regionIndexesToRescore.firstIndex;
+         index != NSNotFound;
+         index = [regionIndexesToRescore indexGreaterThanIndex:index])
+    {
+      [self publishCalculationOfRegion:[boardRegions objectAtIndex:index] atIndex:(int)index];
     }
+    self.lastCalculationHadError = false;
+    [self updateScoringPropertiesIncrementally];
+    return;
+  }
 
-    emptyRegion.territoryColor = territoryColor;
-    emptyRegion.territoryInconsistencyFound = territoryInconsistencyFound;
+  [self discardIncrementalCalculationState];
+  [self resetValues];
+  if (parameters->setupInitialDeadStones)
+    self.didSetupInitialDeadStones = true;
+  self.lastCalculationHadError = m_calculationHadError;
+  if (m_calculationHadError)
+    return;
+
+  if (parameters->scoringEnabled)
+  {
+    for (int regionIndex = 0; regionIndex < m_numberOfCalculatedRegions; ++regionIndex)
+      [self publishCalculationOfRegion:[boardRegions objectAtIndex:regionIndex] atIndex:regionIndex];
   }
+  [self updateScoringProperties];
+  self.canCalculateIncrementally = parameters->scoringEnabled;
 
-  return true;
+  // The estimate is only the first step, the GTP engine usually knows better
+  if (parameters->estimateDeadStones)
+    [self askGtpEngineForDeadStones];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Copies the results of the calculation for the region with region
+/// index @a regionIndex to the GoBoardRegion object @a region.
+///
+/// This is a private helper for publishCalculation().
+// -----------------------------------------------------------------------------
+- (void) publishCalculationOfRegion:(GoBoardRegion*)region atIndex:(int)regionIndex
+{
+  // Only the estimate of dead stones changes the state of stone groups
+  if (m_calculationParameters.estimateDeadStones && [region isStoneGroup])
+    region.stoneGroupState = m_stoneGroupStates[regionIndex];
+  region.territoryColor = m_territoryColors[regionIndex];
+  region.territoryInconsistencyFound = m_territoryInconsistencies[regionIndex];
 }
 
 // -----------------------------------------------------------------------------
 /// @brief (Re)Calculates the scoring and move statistics properties of this
 /// GoScore object.
 ///
-/// If territory scoring is enabled, this method requires that the
-/// @e deadStoneGroup and @e territoryColor properties of GoBoardRegion objects
-/// are correct and up-to-date.
+/// The area, territory and dead stones scoring properties are taken from the
+/// counts in m_calculatedRegionCounts.
+///
+/// This is a private helper for publishCalculation().
 // -----------------------------------------------------------------------------
 - (void) updateScoringProperties
 {
@@ -922,129 +1759,189 @@
   self.komi = self.game.komi;
 
   // Captured stones (up to the current board position) and move statistics (for
-  // the entire game)
-  self.numberOfMoves = 0;
-  GoMove* currentBoardPositionMove = self.game.boardPosition.currentMove;
-  bool loopHasPassedCurrentBoardPosition = false;
-  GoMove* move = self.game.lastMove;
-  while (move != nil)
+  // the entire game). GoMoveModel maintains running totals for each board
+  // position, so we don't have to look at the individual moves.
+  GoMoveModel* moveModel = self.game.moveModel;
+  int numberOfMoves = moveModel.numberOfMoves;
+  struct GoMoveStatistics currentBoardPositionStatistics;
+  struct GoMoveStatistics gameStatistics;
+  [moveModel getStatistics:&currentBoardPositionStatistics forBoardPosition:self.game.boardPosition.currentBoardPosition];
+  [moveModel getStatistics:&gameStatistics forBoardPosition:numberOfMoves];
+  self.capturedByBlack = currentBoardPositionStatistics.capturedByBlack;
+  self.capturedByWhite = currentBoardPositionStatistics.capturedByWhite;
+  self.numberOfMoves = numberOfMoves;
+  self.stonesPlayedByBlack = gameStatistics.stonesPlayedByBlack;
+  self.stonesPlayedByWhite = gameStatistics.stonesPlayedByWhite;
+  self.passesPlayedByBlack = gameStatistics.passesPlayedByBlack;
+  self.passesPlayedByWhite = gameStatistics.passesPlayedByWhite;
+
+  // Area, territory & dead stones (for current board position)
+  [self addRegionCounts:&m_calculatedRegionCounts];
+
+  [self updateTotalScore];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Adjusts the scoring properties of this GoScore object after an
+/// incremental calculation.
+///
+/// This is the incremental counterpart of updateScoringProperties(). The
+/// counts of the GoBoardRegion objects in @e regionsToRescore were subtracted
+/// when the regions were added to @e regionsToRescore, the calculation has
+/// added their new counts to m_calculatedRegionCounts. Move statistics are not
+/// updated because they cannot have changed.
+///
+/// This is a private helper for publishCalculation().
+// -----------------------------------------------------------------------------
+- (void) updateScoringPropertiesIncrementally
+{
+  self.komi = self.game.komi;
+
+  [self addRegionCounts:&m_calculatedRegionCounts];
+  [self.regionsToRescore removeAllObjects];
+  memset(&m_pendingRegionCounts, 0, sizeof(m_pendingRegionCounts));
+
+  [self updateTotalScore];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Adds the number of intersections that @a region currently
+/// contributes to the area, territory and dead stones scoring properties,
+/// multiplied by @a factor, to @a regionCounts.
+///
+/// This is a private helper. It reads GoBoardRegion objects, so it must be
+/// invoked in the context of the main thread.
+// -----------------------------------------------------------------------------
+- (void) countRegion:(GoBoardRegion*)region
+              factor:(int)factor
+        regionCounts:(struct GoScoreRegionCounts*)regionCounts
+{
+  [self countRegionWithSize:[region size]
+                 stoneColor:[region color]
+            stoneGroupState:region.stoneGroupState
+             territoryColor:region.territoryColor
+                     factor:factor
+               regionCounts:regionCounts];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Adds the number of intersections that the region with region index
+/// @a regionIndex contributes to the area, territory and dead stones scoring
+/// properties according to the calculation in progress, multiplied by
+/// @a factor, to @a regionCounts.
+///
+/// This is a private helper for calculate().
+// -----------------------------------------------------------------------------
+- (void) countRegionAtIndex:(int)regionIndex
+                     factor:(int)factor
+               regionCounts:(struct GoScoreRegionCounts*)regionCounts
+{
+  GoBoardSnapshot* boardSnapshot = self.boardSnapshot;
+  [self countRegionWithSize:[boardSnapshot sizeOfRegion:regionIndex]
+                 stoneColor:[boardSnapshot colorOfRegion:regionIndex]
+            stoneGroupState:m_stoneGroupStates[regionIndex]
+             territoryColor:m_territoryColors[regionIndex]
+                     factor:factor
+               regionCounts:regionCounts];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Adds the number of intersections that a region with the specified
+/// properties contributes to the area, territory and dead stones scoring
+/// properties, multiplied by @a factor, to @a regionCounts. @a stoneColor is
+/// #GoColorNone if the region is empty.
+///
+/// This is a private helper for countRegion:factor:regionCounts:() and
+/// countRegionAtIndex:factor:regionCounts:().
+// -----------------------------------------------------------------------------
+- (void) countRegionWithSize:(int)size
+                  stoneColor:(enum GoColor)stoneColor
+             stoneGroupState:(enum GoStoneGroupState)stoneGroupState
+              territoryColor:(enum GoColor)regionTerritoryColor
+                      factor:(int)factor
+                regionCounts:(struct GoScoreRegionCounts*)regionCounts
+{
+  int regionSize = size * factor;
+  bool regionIsStoneGroup = (GoColorNone != stoneColor);
+  bool regionIsDeadStoneGroup = (regionIsStoneGroup && GoStoneGroupStateDead == stoneGroupState);
+
+  // Territory: We count dead stones and intersections in empty regions. An
+  // empty region could be an eye in seki, which only counts when area
+  // scoring is in effect. We don't have to check the scoring system,
+  // though, this was already done when the empty region's territory color
+  // was determined.
+  if (regionIsDeadStoneGroup || ! regionIsStoneGroup)
   {
-    if (! loopHasPassedCurrentBoardPosition)
+    switch (regionTerritoryColor)
     {
-      if (move == currentBoardPositionMove)
-        loopHasPassedCurrentBoardPosition = true;
+      case GoColorBlack:
+        regionCounts->territoryBlack += regionSize;
+        break;
+      case GoColorWhite:
+        regionCounts->territoryWhite += regionSize;
+        break;
+      default:
+        break;
     }
+  }
 
-    self.numberOfMoves++;
-    bool moveByBlack = move.player.black;
-    switch (move.type)
+  // Alive stones + stones in seki
+  if (regionIsStoneGroup && ! regionIsDeadStoneGroup)
+  {
+    switch (regionTerritoryColor)
     {
-      case GoMoveTypePlay:
-      {
-        if (moveByBlack)
-        {
-          if (loopHasPassedCurrentBoardPosition)
-          {
-            // Cast is required because NSUInteger and int differ in size in
-            // 64-bit. Cast is safe because the number of captured stones can
-            // never exceed pow(2, 32).
-            self.capturedByBlack += (int)move.capturedStones.count;
-          }
-          self.stonesPlayedByBlack++;
-        }
-        else
-        {
-          if (loopHasPassedCurrentBoardPosition)
-          {
-            // Cast is required because NSUInteger and int differ in size in
-            // 64-bit. Cast is safe because the number of captured stones can
-            // never exceed pow(2, 32).
-            self.capturedByWhite += (int)move.capturedStones.count;
-          }
-          self.stonesPlayedByWhite++;
-        }
+      case GoColorBlack:
+        regionCounts->aliveBlack += regionSize;
         break;
-      }
-      case GoMoveTypePass:
-      {
-        if (moveByBlack)
-          self.passesPlayedByBlack++;
-        else
-          self.passesPlayedByWhite++;
+      case GoColorWhite:
+        regionCounts->aliveWhite += regionSize;
         break;
-      }
       default:
         break;
     }
-    move = move.previous;
   }
 
-  // Area, territory & dead stones (for current board position)
-  if (self.scoringEnabled)
+  // Dead stones
+  if (regionIsDeadStoneGroup)
   {
-    NSArray* allRegions = self.game.board.regions;
-    for (GoBoardRegion* region in allRegions)
+    switch (stoneColor)
     {
-      int regionSize = [region size];
-      bool regionIsStoneGroup = [region isStoneGroup];
-      enum GoStoneGroupState stoneGroupState = region.stoneGroupState;
-      bool regionIsDeadStoneGroup = (GoStoneGroupStateDead == stoneGroupState);
-      enum GoColor regionTerritoryColor = region.territoryColor;
-
-      // Territory: We count dead stones and intersections in empty regions. An
-      // empty region could be an eye in seki, which only counts when area
-      // scoring is in effect. We don't have to check the scoring system,
-      // though, this was already done when the empty region's territory color
-      // was determined.
-      if (regionIsDeadStoneGroup || ! regionIsStoneGroup)
-      {
-        switch (regionTerritoryColor)
-        {
-          case GoColorBlack:
-            self.territoryBlack += regionSize;
-            break;
-          case GoColorWhite:
-            self.territoryWhite += regionSize;
-            break;
-          default:
-            break;
-        }
-      }
-
-      // Alive stones + stones in seki
-      if (regionIsStoneGroup && ! regionIsDeadStoneGroup)
-      {
-        switch (regionTerritoryColor)
-        {
-          case GoColorBlack:
-            self.aliveBlack += regionSize;
-            break;
-          case GoColorWhite:
-            self.aliveWhite += regionSize;
-            break;
-          default:
-            break;
-        }
-      }
-
-      // Dead stones
-      if (regionIsDeadStoneGroup)
-      {
-        switch ([region color])
-        {
-          case GoColorBlack:
-            self.deadBlack += regionSize;
-            break;
-          case GoColorWhite:
-            self.deadWhite += regionSize;
-            break;
-          default:
-            break;
-        }
-      }
+      case GoColorBlack:
+        regionCounts->deadBlack += regionSize;
+        break;
+      case GoColorWhite:
+        regionCounts->deadWhite += regionSize;
+        break;
+      default:
+        break;
     }
   }
+}
 
+// -----------------------------------------------------------------------------
+/// @brief Adds the counts in @a regionCounts to the area, territory and dead
+/// stones scoring properties of this GoScore object.
+///
+/// This is a private helper.
+// -----------------------------------------------------------------------------
+- (void) addRegionCounts:(const struct GoScoreRegionCounts*)regionCounts
+{
+  self.territoryBlack += regionCounts->territoryBlack;
+  self.territoryWhite += regionCounts->territoryWhite;
+  self.aliveBlack += regionCounts->aliveBlack;
+  self.aliveWhite += regionCounts->aliveWhite;
+  self.deadBlack += regionCounts->deadBlack;
+  self.deadWhite += regionCounts->deadWhite;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief (Re)Calculates the handicap compensation, the total score and the
+/// final result from the other scoring properties of this GoScore object.
+///
+/// This is a private helper.
+// -----------------------------------------------------------------------------
+- (void) updateTotalScore
+{
   // Handicap
   // Cast is required because NSUInteger and int differ in size in 64-bit.
   // Cast is safe because the number of handicap stones never exceeds
@@ -1113,7 +2010,7 @@
   [encoder encodeInt:self.passesPlayedByBlack forKey:goScorePassesPlayedByBlackKey];
   [encoder encodeInt:self.passesPlayedByWhite forKey:goScorePassesPlayedByWhiteKey];
   [encoder encodeObject:self.game forKey:goScoreGameKey];
-  [encoder encodeBool:self.didAskGtpEngineForDeadStones forKey:goScoreDidAskGtpEngineForDeadStonesKey];
+  [encoder encodeBool:self.didSetupInitialDeadStones forKey:goScoreDidSetupInitialDeadStonesKey];
   [encoder encodeBool:self.lastCalculationHadError forKey:goScoreLastCalculationHadErrorKey];
 }
 
@@ -26,5 +26,14 @@ struct GoVertexNumeric
   int y;   ///< @brief Vertical axis compound of the vertex.
 };
 
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
 // Helper functions
 extern bool GoVertexNumericEqualToVertex(struct GoVertexNumeric vertex1, struct GoVertexNumeric vertex2);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
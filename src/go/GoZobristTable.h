@@ -37,7 +37,18 @@
 /// I do not know the real reason. I am simply using the same number of bits
 /// as everybody else (e.g. Fuego, but also [2]). It appears that it is
 /// universally accepted that the chance for a hash collision is extremely (!)
-/// small when 64 bit values are used (e.g. [3]).
+/// small when 64 bit values are used (e.g. [3]). Clients that nevertheless
+/// want to rule out collisions can create a GoZobristTable that uses 128-bit
+/// hashes. The upper 64 bits of such a hash are calculated separately, by the
+/// methods whose name starts with "highHash".
+///
+/// The random values are generated only once per process, for all board sizes
+/// at the same time, and all GoZobristTable objects for the same board size
+/// share the same values. The random number generator always starts with the
+/// same seed, so the random values, and with them all Zobrist hashes, are the
+/// same every time the application runs. Zobrist hashes can therefore be
+/// archived, and they can be used as keys that identify a board position
+/// across application launches.
 ///
 /// [1] http://en.wikipedia.org/wiki/Zobrist_hashing
 /// [2] http://www.cwi.nl/~tromp/java/go/GoGame.java
@@ -48,6 +59,7 @@
 }
 
 - (id) initWithBoardSize:(enum GoBoardSize)boardSize;
+- (id) initWithBoardSize:(enum GoBoardSize)boardSize uses128BitHashes:(bool)uses128BitHashes;
 
 - (long long) hashForBoard:(GoBoard*)board;
 - (long long) hashForMove:(GoMove*)move;
@@ -55,5 +67,14 @@
                            atPoint:(GoPoint*)point
                    capturingStones:(NSArray*)capturedStones
                          afterMove:(GoMove*)move;
+- (long long) highHashForMove:(GoMove*)move;
+- (long long) highHashForStonePlayedBy:(GoPlayer*)player
+                               atPoint:(GoPoint*)point
+                       capturingStones:(NSArray*)capturedStones
+                             afterMove:(GoMove*)move;
+
+/// @brief True if this GoZobristTable calculates 128-bit hashes, false if it
+/// calculates only 64-bit hashes.
+@property(nonatomic, assign, readonly) bool uses128BitHashes;
 
 @end
@@ -23,62 +23,84 @@
 #import "GoPoint.h"
 #import "GoVertex.h"
 
-// C++ standard library
-#include <cstdlib>
-#include <ctime>
-
 
 // -----------------------------------------------------------------------------
-/// @brief Class extension with private properties for GoZobristTable.
+/// @brief The seed for the pseudo-random number generator that fills the
+/// shared Zobrist tables.
+///
+/// Zobrist hashes are archived together with the moves that they belong to.
+/// Changing this value, or the generator algorithm, therefore requires that
+/// the NSCoding version is bumped.
 // -----------------------------------------------------------------------------
-@interface GoZobristTable()
-@property(nonatomic, assign) enum GoBoardSize boardSize;
-@property(nonatomic, assign) long long* zobristTable;
-@end
+static const unsigned long long zobristTableSeed = 0x4C6974746C65476FULL;
 
+/// @brief The number of distinct board sizes, i.e. the number of shared
+/// Zobrist tables.
+static const int numberOfZobristTables = (GoBoardSizeMax - GoBoardSizeMin) / 2 + 1;
+
+/// @brief Zobrist tables shared by all GoZobristTable instances, one table
+/// per board size. Each table holds 4 * boardSize * boardSize values: First
+/// the 64-bit values for black and white stones, then the values for the
+/// upper 64 bits of 128-bit hashes, again for black and white stones.
+static long long* sharedZobristTables[numberOfZobristTables];
 
-@implementation GoZobristTable
 
 // -----------------------------------------------------------------------------
-/// @brief Initializes a GoZobristTable object for use with a board of size
-/// @a boardSize.
-///
-/// @note This is the designated initializer of GoZobristTable.
+/// @brief Returns the next number from the pseudo-random sequence whose state
+/// is stored in @a state. This is the SplitMix64 generator, which produces the
+/// same well-distributed sequence on every platform.
 // -----------------------------------------------------------------------------
-- (id) initWithBoardSize:(enum GoBoardSize)boardSize
+static unsigned long long GoZobristTableNextRandomNumber(unsigned long long* state)
 {
-  // Call designated initializer of superclass (NSObject)
-  self = [super init];
-  if (! self)
-    return nil;
-  self.boardSize = boardSize;
-  [self setupZobristTable];
-  return self;
+  unsigned long long z = (*state += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
 }
 
+
 // -----------------------------------------------------------------------------
-/// @brief Deallocates memory allocated by this GoZobristTable object.
+/// @brief Class extension with private properties for GoZobristTable.
 // -----------------------------------------------------------------------------
-- (void) dealloc
-{
-  delete[] _zobristTable;
-  [super dealloc];
-}
+@interface GoZobristTable()
+@property(nonatomic, assign) enum GoBoardSize boardSize;
+@property(nonatomic, assign, readwrite) bool uses128BitHashes;
+@property(nonatomic, assign) long long* zobristTable;
+@end
+
+
+@implementation GoZobristTable
 
 // -----------------------------------------------------------------------------
-/// Private helper invoked during initialization.
+/// @brief Fills the shared Zobrist tables for all board sizes. Is invoked by
+/// the runtime exactly once, before the first message is sent to the class.
+///
+/// The tables are filled with a pseudo-random sequence that always starts from
+/// the same seed, therefore the tables and all Zobrist hashes calculated with
+/// them are the same every time the application runs.
 // -----------------------------------------------------------------------------
-- (void) setupZobristTable
++ (void) initialize
 {
+  if (self != [GoZobristTable class])
+    return;
   [self throwIfLongLongIsLessThan8Bytes];
-  _zobristTable = new long long[_boardSize * _boardSize * 2];
-  [self fillZobristTableWithRandomNumbers];
+  for (int boardSize = GoBoardSizeMin; boardSize <= GoBoardSizeMax; boardSize += 2)
+  {
+    // Each board size gets its own sequence so that adding a board size does
+    // not change the tables of the existing board sizes
+    unsigned long long state = zobristTableSeed ^ boardSize;
+    int numberOfValues = 4 * boardSize * boardSize;
+    long long* zobristTable = new long long[numberOfValues];
+    for (int index = 0; index < numberOfValues; ++index)
+      zobristTable[index] = GoZobristTableNextRandomNumber(&state);
+    sharedZobristTables[(boardSize - GoBoardSizeMin) / 2] = zobristTable;
+  }
 }
 
 // -----------------------------------------------------------------------------
-/// Private helper for setupZobristTable()
+/// Private helper for initialize()
 // -----------------------------------------------------------------------------
-- (void) throwIfLongLongIsLessThan8Bytes
++ (void) throwIfLongLongIsLessThan8Bytes
 {
   size_t sizeOfLongLong = sizeof(long long);
   if (sizeOfLongLong < 8)
@@ -93,42 +115,48 @@
 }
 
 // -----------------------------------------------------------------------------
-/// Private helper for setupZobristTable()
+/// @brief Initializes a GoZobristTable object for use with a board of size
+/// @a boardSize. The object calculates 128-bit hashes if
+/// #gUse128BitZobristHashes is true.
 // -----------------------------------------------------------------------------
-- (void) fillZobristTableWithRandomNumbers
+- (id) initWithBoardSize:(enum GoBoardSize)boardSize
 {
-  // Cast is required because time_t (the result of time()) and unsigned (the
-  // parameter of srand()) differ in size in 64-bit. Cast is safe because we
-  // don't care about the exact time_t value, we just want a number that is
-  // not always the same to initialize the random number generator so that we
-  // won't get the same sequence of random numbers every time.
-  srand((unsigned)time(NULL));
-  for (int vertexX = 0; vertexX < _boardSize; ++vertexX)
-  {
-    for (int vertexY = 0; vertexY < _boardSize; ++vertexY)
-    {
-      for (int color = 0; color < 2; ++color)
-      {
-        int index = (color * _boardSize * _boardSize) + (vertexY * _boardSize) + vertexX;
-        _zobristTable[index] = [self random64BitNumber];
-      }
-    }
-  }
+  return [self initWithBoardSize:boardSize uses128BitHashes:gUse128BitZobristHashes];
 }
 
 // -----------------------------------------------------------------------------
-/// Private helper for fillZobristTableWithRandomNumbers:()
+/// @brief Initializes a GoZobristTable object for use with a board of size
+/// @a boardSize. The object calculates 128-bit hashes if @a uses128BitHashes
+/// is true.
+///
+/// The object does not allocate a table of its own, it uses the table for
+/// @a boardSize that is shared by all GoZobristTable objects.
+///
+/// Raises an @e NSInvalidArgumentException if @a boardSize is not a supported
+/// board size.
+///
+/// @note This is the designated initializer of GoZobristTable.
 // -----------------------------------------------------------------------------
-- (long long) random64BitNumber
+- (id) initWithBoardSize:(enum GoBoardSize)boardSize uses128BitHashes:(bool)uses128BitHashes
 {
-  // Implementation taken from
-  // http://stackoverflow.com/questions/8120062/generate-random-64-bit-integer
-  // TODO switch to an algorithm from <random> once we are allowed to use C++11
-  long long r30 = RAND_MAX*rand()+rand();
-  long long s30 = RAND_MAX*rand()+rand();
-  long long t4  = rand() & 0xf;
-  long long res = (r30 << 34) + (s30 << 4) + t4;
-  return res;
+  // Call designated initializer of superclass (NSObject)
+  self = [super init];
+  if (! self)
+    return nil;
+  if (boardSize < GoBoardSizeMin || boardSize > GoBoardSizeMax || 0 == boardSize % 2)
+  {
+    NSString* errorMessage = [NSString stringWithFormat:@"Board size %d is not supported", boardSize];
+    DDLogError(@"%@: %@", self, errorMessage);
+    [self release];
+    NSException* exception = [NSException exceptionWithName:NSInvalidArgumentException
+                                                     reason:errorMessage
+                                                   userInfo:nil];
+    @throw exception;
+  }
+  self.boardSize = boardSize;
+  self.uses128BitHashes = uses128BitHashes;
+  self.zobristTable = sharedZobristTables[(boardSize - GoBoardSizeMin) / 2];
+  return self;
 }
 
 // -----------------------------------------------------------------------------
@@ -210,17 +238,94 @@
     hash = move.zobristHash;
   else
     hash = 0;
+  return [self hashForStonePlayedBy:player
+                            atPoint:point
+                    capturingStones:capturedStones
+                       previousHash:hash
+                        tableOffset:0];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Generates the upper 64 bits of the 128-bit Zobrist hash for
+/// @a move. Returns 0 if this GoZobristTable does not use 128-bit hashes.
+///
+/// The hash is calculated in the same way as the hash returned by
+/// hashForMove:(), but it is based on the @e zobristHashHigh property of the
+/// previous move, and it uses an independent set of random values.
+// -----------------------------------------------------------------------------
+- (long long) highHashForMove:(GoMove*)move
+{
+  if (! _uses128BitHashes)
+    return 0;
+  long long hash;
+  if (GoMoveTypePlay == move.type)
+  {
+    hash = [self highHashForStonePlayedBy:move.player
+                                  atPoint:move.point
+                          capturingStones:move.capturedStones
+                                afterMove:move.previous];
+  }
+  else
+  {
+    GoMove* previousMove = move.previous;
+    if (previousMove)
+      hash = previousMove.zobristHashHigh;
+    else
+      hash = 0;
+  }
+  return hash;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Generates the upper 64 bits of the 128-bit Zobrist hash for a
+/// hypothetical move. Returns 0 if this GoZobristTable does not use 128-bit
+/// hashes.
+///
+/// See hashForStonePlayedBy:atPoint:capturingStones:afterMove:() for details
+/// about the parameters.
+// -----------------------------------------------------------------------------
+- (long long) highHashForStonePlayedBy:(GoPlayer*)player
+                               atPoint:(GoPoint*)point
+                       capturingStones:(NSArray*)capturedStones
+                             afterMove:(GoMove*)move
+{
+  if (! _uses128BitHashes)
+    return 0;
+  long long hash;
+  if (move)
+    hash = move.zobristHashHigh;
+  else
+    hash = 0;
+  return [self hashForStonePlayedBy:player
+                            atPoint:point
+                    capturingStones:capturedStones
+                       previousHash:hash
+                        tableOffset:2 * _boardSize * _boardSize];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Private helper for the public hash calculation methods. Calculates
+/// a hash incrementally from @a hash, using the random values that start at
+/// index position @a tableOffset in the Zobrist table.
+// -----------------------------------------------------------------------------
+- (long long) hashForStonePlayedBy:(GoPlayer*)player
+                           atPoint:(GoPoint*)point
+                   capturingStones:(NSArray*)capturedStones
+                      previousHash:(long long)hash
+                       tableOffset:(int)tableOffset
+{
   [self throwIfTableSizeDoesNotMatchSizeOfBoard:point.board];
+  const long long* zobristTable = _zobristTable + tableOffset;
   if (capturedStones)
   {
     for (GoPoint* capturedStone in capturedStones)
     {
       int indexCaptured = [self indexForStoneAt:capturedStone capturedBy:player];
-      hash ^= _zobristTable[indexCaptured];
+      hash ^= zobristTable[indexCaptured];
     }
   }
   int indexPlayed = [self indexForStoneAt:point playedBy:player];
-  hash ^= _zobristTable[indexPlayed];
+  hash ^= zobristTable[indexPlayed];
   return hash;
 }
 
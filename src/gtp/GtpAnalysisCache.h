@@ -0,0 +1,77 @@
+// -----------------------------------------------------------------------------
+// Copyright 2014 Patrick Näf (herzbube@herzbube.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// -----------------------------------------------------------------------------
+
+
+
+// Project includes
+#import "../go/GoVertexNumeric.h"
+
+// Forward declarations
+@class GoGame;
+
+
+// -----------------------------------------------------------------------------
+/// @brief The GtpAnalysisCache class stores the results of GTP commands that
+/// analyze a board position, so that the GTP engine does not have to be asked
+/// again when the user returns to a position that was already analyzed.
+///
+/// @ingroup gtp
+///
+/// Results are stored under a key that is obtained with
+/// keyForBoardPositionOfGame:(). The key identifies the position by its
+/// Zobrist hash, the handicap stones, the side to move, the board size and
+/// komi. It also contains the active GTP engine profile, so that a result
+/// that arrives after a different profile has become active is not mixed up
+/// with the results of that profile.
+///
+/// All results are discarded when a new game is created, which includes a
+/// change of board size, and when a GTP engine profile is applied, because
+/// the profile's settings may lead the GTP engine to different results (see
+/// GtpEngineProfile::applyProfile()).
+///
+/// The cache currently stores
+/// - The territory statistics reported by "uct_stat_territory", as a grid of
+///   float values in the order in which GtpResponse provides them (see
+///   GtpResponse::floatGridWithNumberOfRows:numberOfColumns:()).
+/// - The dead stones reported by "final_status_list dead", as an array of
+///   GoVertexNumeric structs.
+///
+/// The memory used by the cache is limited to @e memoryLimit bytes. If storing
+/// a result would exceed the limit, the least recently used results are
+/// discarded.
+///
+/// GtpAnalysisCache is thread-safe.
+// -----------------------------------------------------------------------------
+@interface GtpAnalysisCache : NSObject
+{
+}
+
+- (id) initWithMemoryLimit:(int)memoryLimit;
+
+- (NSData*) territoryScoresForKey:(NSString*)key numberOfRows:(int*)numberOfRows numberOfColumns:(int*)numberOfColumns;
+- (void) setTerritoryScores:(const float*)scores numberOfRows:(int)numberOfRows numberOfColumns:(int)numberOfColumns forKey:(NSString*)key;
+- (NSData*) deadStoneVerticesForKey:(NSString*)key;
+- (void) setDeadStoneVertices:(const struct GoVertexNumeric*)vertices count:(int)count forKey:(NSString*)key;
+- (void) removeAllResults;
+
++ (NSString*) keyForBoardPositionOfGame:(GoGame*)game;
+
+/// @brief The maximum number of bytes that the cache may use.
+@property(assign, readonly) int memoryLimit;
+/// @brief The approximate number of bytes that the cache currently uses.
+@property(assign, readonly) int memoryUsage;
+
+@end
@@ -0,0 +1,330 @@
+// -----------------------------------------------------------------------------
+// Copyright 2014 Patrick Näf (herzbube@herzbube.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// -----------------------------------------------------------------------------
+
+
+
+// Project includes
+#import "GtpAnalysisCache.h"
+#import "../go/GoBoard.h"
+#import "../go/GoBoardPosition.h"
+#import "../go/GoGame.h"
+#import "../go/GoMove.h"
+#import "../go/GoPlayer.h"
+#import "../go/GoPoint.h"
+#import "../go/GoVertex.h"
+#import "../main/ApplicationDelegate.h"
+#import "../player/GtpEngineProfile.h"
+#import "../player/GtpEngineProfileModel.h"
+
+
+// -----------------------------------------------------------------------------
+/// @brief The approximate number of bytes used by the cache for each result,
+/// in addition to the result data and the key.
+// -----------------------------------------------------------------------------
+static const int resultOverhead = 64;
+/// @brief The prefix of the internal keys that refer to territory statistics.
+static NSString* territoryScoresKeyPrefix = @"territory/";
+/// @brief The prefix of the internal keys that refer to dead stones.
+static NSString* deadStoneVerticesKeyPrefix = @"deadstones/";
+
+
+// -----------------------------------------------------------------------------
+/// @brief Helper class that stores a single result in the cache, together
+/// with the grid dimensions if the result is a grid.
+// -----------------------------------------------------------------------------
+@interface GtpAnalysisCacheResult : NSObject
+{
+}
++ (GtpAnalysisCacheResult*) resultWithData:(NSData*)data numberOfRows:(int)numberOfRows numberOfColumns:(int)numberOfColumns;
+- (void) dealloc;
+@property(nonatomic, retain) NSData* data;
+@property(nonatomic, assign) int numberOfRows;
+@property(nonatomic, assign) int numberOfColumns;
+@end
+
+
+// -----------------------------------------------------------------------------
+/// @brief Class extension with private properties for GtpAnalysisCache.
+// -----------------------------------------------------------------------------
+@interface GtpAnalysisCache()
+/// @name Re-declaration of properties to make them readwrite privately
+//@{
+@property(assign, readwrite) int memoryLimit;
+@property(assign, readwrite) int memoryUsage;
+//@}
+/// @name Private properties
+//@{
+/// @brief Keys are internal keys (the key of a board position with a prefix
+/// that denotes the kind of result), values are GtpAnalysisCacheResult
+/// objects.
+@property(retain) NSMutableDictionary* results;
+/// @brief The internal keys of all results, ordered by the time when the
+/// result was last used. The least recently used result is at the front.
+@property(retain) NSMutableArray* keysInUsageOrder;
+//@}
+@end
+
+
+@implementation GtpAnalysisCache
+
+// -----------------------------------------------------------------------------
+/// @brief Initializes a GtpAnalysisCache object that uses at most
+/// @a memoryLimit bytes.
+///
+/// @note This is the designated initializer of GtpAnalysisCache.
+// -----------------------------------------------------------------------------
+- (id) initWithMemoryLimit:(int)memoryLimit
+{
+  // Call designated initializer of superclass (NSObject)
+  self = [super init];
+  if (! self)
+    return nil;
+  self.memoryLimit = memoryLimit;
+  self.memoryUsage = 0;
+  self.results = [NSMutableDictionary dictionaryWithCapacity:0];
+  self.keysInUsageOrder = [NSMutableArray arrayWithCapacity:0];
+  [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(goGameDidCreate:) name:goGameDidCreate object:nil];
+  return self;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Deallocates memory allocated by this GtpAnalysisCache object.
+// -----------------------------------------------------------------------------
+- (void) dealloc
+{
+  [[NSNotificationCenter defaultCenter] removeObserver:self];
+  self.results = nil;
+  self.keysInUsageOrder = nil;
+  [super dealloc];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns the territory statistics stored for the board position
+/// identified by @a key, or nil if no territory statistics are stored. The
+/// dimensions of the grid are filled into the out parameters @a numberOfRows
+/// and @a numberOfColumns.
+// -----------------------------------------------------------------------------
+- (NSData*) territoryScoresForKey:(NSString*)key numberOfRows:(int*)numberOfRows numberOfColumns:(int*)numberOfColumns
+{
+  NSString* internalKey = [territoryScoresKeyPrefix stringByAppendingString:key];
+  @synchronized(self)
+  {
+    GtpAnalysisCacheResult* result = [self resultForInternalKey:internalKey];
+    if (! result)
+      return nil;
+    *numberOfRows = result.numberOfRows;
+    *numberOfColumns = result.numberOfColumns;
+    // The result may be discarded by another thread while the caller still
+    // uses the data
+    return [[result.data retain] autorelease];
+  }
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Stores the territory statistics @a scores, a grid with
+/// @a numberOfRows rows and @a numberOfColumns columns, for the board position
+/// identified by @a key.
+// -----------------------------------------------------------------------------
+- (void) setTerritoryScores:(const float*)scores numberOfRows:(int)numberOfRows numberOfColumns:(int)numberOfColumns forKey:(NSString*)key
+{
+  NSString* internalKey = [territoryScoresKeyPrefix stringByAppendingString:key];
+  NSData* data = [NSData dataWithBytes:scores length:numberOfRows * numberOfColumns * sizeof(float)];
+  GtpAnalysisCacheResult* result = [GtpAnalysisCacheResult resultWithData:data
+                                                             numberOfRows:numberOfRows
+                                                          numberOfColumns:numberOfColumns];
+  @synchronized(self)
+  {
+    [self setResult:result forInternalKey:internalKey];
+  }
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns the dead stones stored for the board position identified by
+/// @a key, or nil if no dead stones are stored. The NSData object contains an
+/// array of GoVertexNumeric structs. The array is empty if there are no dead
+/// stones.
+// -----------------------------------------------------------------------------
+- (NSData*) deadStoneVerticesForKey:(NSString*)key
+{
+  NSString* internalKey = [deadStoneVerticesKeyPrefix stringByAppendingString:key];
+  @synchronized(self)
+  {
+    return [[[self resultForInternalKey:internalKey].data retain] autorelease];
+  }
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Stores the @a count dead stones in @a vertices for the board
+/// position identified by @a key.
+// -----------------------------------------------------------------------------
+- (void) setDeadStoneVertices:(const struct GoVertexNumeric*)vertices count:(int)count forKey:(NSString*)key
+{
+  NSString* internalKey = [deadStoneVerticesKeyPrefix stringByAppendingString:key];
+  NSData* data = [NSData dataWithBytes:vertices length:count * sizeof(struct GoVertexNumeric)];
+  GtpAnalysisCacheResult* result = [GtpAnalysisCacheResult resultWithData:data numberOfRows:0 numberOfColumns:0];
+  @synchronized(self)
+  {
+    [self setResult:result forInternalKey:internalKey];
+  }
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Discards all results stored in the cache.
+// -----------------------------------------------------------------------------
+- (void) removeAllResults
+{
+  @synchronized(self)
+  {
+    [self.results removeAllObjects];
+    [self.keysInUsageOrder removeAllObjects];
+    self.memoryUsage = 0;
+  }
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Responds to the #goGameDidCreate notification. Results that were
+/// obtained for the positions of the old game are of no further use, and if
+/// the board size has changed they would be wrong.
+// -----------------------------------------------------------------------------
+- (void) goGameDidCreate:(NSNotification*)notification
+{
+  [self removeAllResults];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns the key that identifies the current board position of
+/// @a game, as seen by the active GTP engine profile.
+// -----------------------------------------------------------------------------
++ (NSString*) keyForBoardPositionOfGame:(GoGame*)game
+{
+  GoBoardPosition* boardPosition = game.boardPosition;
+  GoMove* currentMove = boardPosition.currentMove;
+  // Zobrist hashes do not include handicap stones, so these must be part of
+  // the key
+  NSMutableArray* handicapVertices = [NSMutableArray arrayWithCapacity:game.handicapPoints.count];
+  for (GoPoint* handicapPoint in game.handicapPoints)
+    [handicapVertices addObject:handicapPoint.vertex.string];
+  GtpEngineProfile* profile = [[ApplicationDelegate sharedDelegate].gtpEngineProfileModel activeProfile];
+  return [NSString stringWithFormat:@"%d/%@/%016llx%016llx/%@/%.1f/%@",
+          game.board.size,
+          [handicapVertices componentsJoinedByString:@","],
+          (unsigned long long)currentMove.zobristHashHigh,
+          (unsigned long long)currentMove.zobristHash,
+          boardPosition.currentPlayer.colorString,
+          game.komi,
+          (profile ? profile.uuid : @"")];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns the result stored under @a internalKey, or nil if there is
+/// no such result. Marks the result as the most recently used one.
+///
+/// This is a private helper. The caller must hold the lock on this object.
+// -----------------------------------------------------------------------------
+- (GtpAnalysisCacheResult*) resultForInternalKey:(NSString*)internalKey
+{
+  GtpAnalysisCacheResult* result = [self.results objectForKey:internalKey];
+  if (result)
+  {
+    [self.keysInUsageOrder removeObject:internalKey];
+    [self.keysInUsageOrder addObject:internalKey];
+  }
+  return result;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Stores @a result under @a internalKey, replacing any result that was
+/// previously stored under the same key. Discards the least recently used
+/// results until the memory used by the cache is within @e memoryLimit.
+///
+/// This is a private helper. The caller must hold the lock on this object.
+// -----------------------------------------------------------------------------
+- (void) setResult:(GtpAnalysisCacheResult*)result forInternalKey:(NSString*)internalKey
+{
+  [self removeResultForInternalKey:internalKey];
+  [self.results setObject:result forKey:internalKey];
+  [self.keysInUsageOrder addObject:internalKey];
+  self.memoryUsage += [self memoryUsageOfResult:result internalKey:internalKey];
+  while (self.memoryUsage > self.memoryLimit && self.keysInUsageOrder.count > 0)
+  {
+    NSString* leastRecentlyUsedKey = [self.keysInUsageOrder objectAtIndex:0];
+    [self removeResultForInternalKey:leastRecentlyUsedKey];
+  }
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Removes the result stored under @a internalKey. Does nothing if there
+/// is no such result.
+///
+/// This is a private helper. The caller must hold the lock on this object.
+// -----------------------------------------------------------------------------
+- (void) removeResultForInternalKey:(NSString*)internalKey
+{
+  GtpAnalysisCacheResult* result = [self.results objectForKey:internalKey];
+  if (! result)
+    return;
+  self.memoryUsage -= [self memoryUsageOfResult:result internalKey:internalKey];
+  [self.results removeObjectForKey:internalKey];
+  // @a internalKey may be the object stored in the array, so this must be done
+  // last
+  [self.keysInUsageOrder removeObject:internalKey];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns the approximate number of bytes used to store @a result
+/// under @a internalKey.
+///
+/// This is a private helper.
+// -----------------------------------------------------------------------------
+- (int) memoryUsageOfResult:(GtpAnalysisCacheResult*)result internalKey:(NSString*)internalKey
+{
+  // Cast is safe because results are at most a few kilobytes in size
+  return (int)(result.data.length + internalKey.length * sizeof(unichar)) + resultOverhead;
+}
+
+@end
+
+
+@implementation GtpAnalysisCacheResult
+
+// -----------------------------------------------------------------------------
+/// @brief Convenience constructor. Creates a GtpAnalysisCacheResult instance
+/// that stores @a data. @a numberOfRows and @a numberOfColumns are the grid
+/// dimensions, or 0 if the result is not a grid.
+// -----------------------------------------------------------------------------
++ (GtpAnalysisCacheResult*) resultWithData:(NSData*)data numberOfRows:(int)numberOfRows numberOfColumns:(int)numberOfColumns
+{
+  GtpAnalysisCacheResult* result = [[GtpAnalysisCacheResult alloc] init];
+  if (result)
+  {
+    result.data = data;
+    result.numberOfRows = numberOfRows;
+    result.numberOfColumns = numberOfColumns;
+    [result autorelease];
+  }
+  return result;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Deallocates memory allocated by this GtpAnalysisCacheResult object.
+// -----------------------------------------------------------------------------
+- (void) dealloc
+{
+  self.data = nil;
+  [super dealloc];
+}
+
+@end
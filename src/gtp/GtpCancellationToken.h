@@ -0,0 +1,54 @@
+// -----------------------------------------------------------------------------
+// Copyright 2014 Patrick Näf (herzbube@herzbube.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// -----------------------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------------------
+/// @brief The GtpCancellationToken class lets a user-level action cancel all
+/// GtpCommand objects that were submitted on its behalf.
+///
+/// @ingroup gtp
+///
+/// A GtpCancellationToken can be bound to a thread with setCurrentToken:().
+/// Every GtpCommand that is created while a token is bound to the current
+/// thread picks up that token. CommandProcessor binds a new token while it
+/// executes an asynchronous command, so that all GtpCommand objects submitted
+/// by the command (and by commands that it submits in turn) share the same
+/// token. CommandProcessor cancels the token when the user abandons the
+/// command (see CommandProcessor::cancelAsynchronousCommand()).
+///
+/// When cancel() is invoked, GtpClient completes all cancellable commands (see
+/// GtpCommand::cancellable) that carry the token and that have not been
+/// answered yet with a failure response (see GtpClient::abandonCommand:reason:()).
+/// Cancellable commands that are submitted after the token has been cancelled
+/// are completed immediately without being sent to the GTP engine. Commands
+/// that are not cancellable are not affected by the token.
+///
+/// GtpCancellationToken is thread-safe.
+// -----------------------------------------------------------------------------
+@interface GtpCancellationToken : NSObject
+{
+}
+
++ (GtpCancellationToken*) token;
++ (GtpCancellationToken*) currentToken;
++ (void) setCurrentToken:(GtpCancellationToken*)token;
+- (void) cancel;
+
+/// @brief Is true if cancel() has been invoked.
+@property(assign, readonly, getter=isCancelled) bool cancelled;
+
+@end
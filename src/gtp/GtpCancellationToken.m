@@ -0,0 +1,108 @@
+// -----------------------------------------------------------------------------
+// Copyright 2014 Patrick Näf (herzbube@herzbube.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// -----------------------------------------------------------------------------
+
+
+
+// Project includes
+#import "GtpCancellationToken.h"
+#import "GtpEnginePool.h"
+#import "../main/ApplicationDelegate.h"
+
+
+/// @brief Key under which the current token is stored in the thread
+/// dictionary.
+static NSString* currentTokenKey = @"GtpCancellationTokenCurrentToken";
+
+
+// -----------------------------------------------------------------------------
+/// @brief Class extension with private properties for GtpCancellationToken.
+// -----------------------------------------------------------------------------
+@interface GtpCancellationToken()
+// Re-declare property as readwrite
+@property(assign, readwrite, getter=isCancelled) bool cancelled;
+@end
+
+
+@implementation GtpCancellationToken
+
+// -----------------------------------------------------------------------------
+/// @brief Convenience constructor. Creates a GtpCancellationToken instance
+/// that is not cancelled.
+// -----------------------------------------------------------------------------
++ (GtpCancellationToken*) token
+{
+  GtpCancellationToken* token = [[GtpCancellationToken alloc] init];
+  if (token)
+    [token autorelease];
+  return token;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns the token that is bound to the current thread, or nil if no
+/// token is bound.
+// -----------------------------------------------------------------------------
++ (GtpCancellationToken*) currentToken
+{
+  return [[[NSThread currentThread] threadDictionary] objectForKey:currentTokenKey];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Binds @a token to the current thread. If @a token is nil, the token
+/// that is currently bound is unbound.
+// -----------------------------------------------------------------------------
++ (void) setCurrentToken:(GtpCancellationToken*)token
+{
+  NSMutableDictionary* threadDictionary = [[NSThread currentThread] threadDictionary];
+  if (token)
+    [threadDictionary setObject:token forKey:currentTokenKey];
+  else
+    [threadDictionary removeObjectForKey:currentTokenKey];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Initializes a GtpCancellationToken object.
+///
+/// @note This is the designated initializer of GtpCancellationToken.
+// -----------------------------------------------------------------------------
+- (id) init
+{
+  // Call designated initializer of superclass (NSObject)
+  self = [super init];
+  if (! self)
+    return nil;
+  self.cancelled = false;
+  return self;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Cancels this token and all GtpCommand objects that carry it and
+/// that have not been answered yet. Does nothing if this token is already
+/// cancelled.
+// -----------------------------------------------------------------------------
+- (void) cancel
+{
+  @synchronized(self)
+  {
+    if (self.cancelled)
+      return;
+    self.cancelled = true;
+  }
+  DDLogInfo(@"%@: Cancelled", self);
+  GtpEnginePool* gtpEnginePool = [ApplicationDelegate sharedDelegate].gtpEnginePool;
+  [gtpEnginePool abandonCommandsWithCancellationToken:self];
+}
+
+@end
@@ -0,0 +1,180 @@
+// -----------------------------------------------------------------------------
+// Copyright 2014 Patrick Näf (herzbube@herzbube.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// -----------------------------------------------------------------------------
+
+
+
+// This file contains C++ syntax. It must be #include'd only by Objective-C++
+// implementations.
+
+// System includes
+#include <istream>
+#include <ostream>
+#include <streambuf>
+#include <pthread.h>
+
+
+// -----------------------------------------------------------------------------
+/// @brief The GtpByteRing class is a bounded buffer of bytes that is shared by
+/// exactly one producer thread and exactly one consumer thread.
+///
+/// @ingroup gtp
+///
+/// The producer and the consumer exchange data without locking. Each side
+/// advances only its own index, and memory barriers make sure that the data is
+/// visible to the other side before the index is. A mutex and a condition
+/// variable are used only when one side must wait for the other, i.e. when the
+/// consumer finds the ring empty, or when the producer finds the ring full.
+///
+/// @note GtpByteRing is not safe for use by more than one producer or more than
+/// one consumer at the same time.
+// -----------------------------------------------------------------------------
+class GtpByteRing
+{
+public:
+  explicit GtpByteRing(size_t capacity);
+  ~GtpByteRing();
+
+  size_t write(const char* data, size_t length);
+  size_t read(char* buffer, size_t length);
+  void close();
+
+private:
+  GtpByteRing(const GtpByteRing&);
+  GtpByteRing& operator=(const GtpByteRing&);
+
+  bool isEmpty() const;
+  bool isFull() const;
+
+  char* m_buffer;
+  /// @brief Is always a power of two, so that indexes can be mapped to buffer
+  /// positions with m_mask.
+  size_t m_capacity;
+  size_t m_mask;
+  /// @brief Total number of bytes written so far. Is modified only by the
+  /// producer.
+  volatile size_t m_writeIndex;
+  /// @brief Total number of bytes read so far. Is modified only by the
+  /// consumer.
+  volatile size_t m_readIndex;
+  volatile bool m_isClosed;
+  volatile bool m_consumerIsWaiting;
+  volatile bool m_producerIsWaiting;
+  pthread_mutex_t m_mutex;
+  pthread_cond_t m_condition;
+};
+
+// -----------------------------------------------------------------------------
+/// @brief The GtpRingInputStreamBuffer class is a std::streambuf that reads
+/// from a GtpByteRing. It lets the consumer of a GtpByteRing use a
+/// std::istream.
+///
+/// @ingroup gtp
+// -----------------------------------------------------------------------------
+class GtpRingInputStreamBuffer : public std::streambuf
+{
+public:
+  explicit GtpRingInputStreamBuffer(GtpByteRing& ring);
+
+protected:
+  virtual int_type underflow();
+
+private:
+  GtpRingInputStreamBuffer(const GtpRingInputStreamBuffer&);
+  GtpRingInputStreamBuffer& operator=(const GtpRingInputStreamBuffer&);
+
+  GtpByteRing& m_ring;
+  char m_buffer[4096];
+};
+
+// -----------------------------------------------------------------------------
+/// @brief The GtpRingOutputStreamBuffer class is a std::streambuf that writes
+/// to a GtpByteRing. It lets the producer of a GtpByteRing use a
+/// std::ostream.
+///
+/// @ingroup gtp
+///
+/// Data becomes visible to the consumer when the stream is flushed (e.g. by
+/// std::endl), or when the internal buffer is full.
+// -----------------------------------------------------------------------------
+class GtpRingOutputStreamBuffer : public std::streambuf
+{
+public:
+  explicit GtpRingOutputStreamBuffer(GtpByteRing& ring);
+
+protected:
+  virtual int_type overflow(int_type character);
+  virtual int sync();
+
+private:
+  GtpRingOutputStreamBuffer(const GtpRingOutputStreamBuffer&);
+  GtpRingOutputStreamBuffer& operator=(const GtpRingOutputStreamBuffer&);
+
+  bool flushBuffer();
+
+  GtpByteRing& m_ring;
+  char m_buffer[4096];
+};
+
+// -----------------------------------------------------------------------------
+/// @brief The GtpChannel class is an in-memory, bidirectional transport
+/// between GtpClient and GtpEngine that runs in the same process.
+///
+/// @ingroup gtp
+///
+/// GtpChannel consists of two GtpByteRing objects, one that carries commands
+/// from the client to the engine, and one that carries responses from the
+/// engine to the client. Each side sees the rings as a pair of standard C++
+/// streams. Compared to named pipes, GtpChannel avoids the kernel round trip
+/// and the stdio buffering for each GTP command and response. GtpChannel can
+/// only be used with engines that accept the streams that they read commands
+/// from and write responses to, i.e. with GtpReplayEngine. Fuego, which reads
+/// from the process-wide std::cin unless it is given named pipes, keeps using
+/// named pipes.
+///
+/// Each GtpClient/GtpEngine pair uses its own GtpChannel. The channel is owned
+/// by the GtpEngine, and is deallocated together with the GtpEngine.
+///
+/// The client thread is the only writer of the command stream and the only
+/// reader of the response stream. The engine thread is the only reader of the
+/// command stream and the only writer of the response stream.
+// -----------------------------------------------------------------------------
+class GtpChannel
+{
+public:
+  GtpChannel();
+  ~GtpChannel();
+
+  std::ostream& clientCommandStream();
+  std::istream& clientResponseStream();
+  std::istream& engineCommandStream();
+  std::ostream& engineResponseStream();
+  void close();
+
+private:
+  GtpChannel(const GtpChannel&);
+  GtpChannel& operator=(const GtpChannel&);
+
+  GtpByteRing m_commandRing;
+  GtpByteRing m_responseRing;
+  GtpRingOutputStreamBuffer m_clientCommandBuffer;
+  GtpRingInputStreamBuffer m_clientResponseBuffer;
+  GtpRingInputStreamBuffer m_engineCommandBuffer;
+  GtpRingOutputStreamBuffer m_engineResponseBuffer;
+  std::ostream m_clientCommandStream;
+  std::istream m_clientResponseStream;
+  std::istream m_engineCommandStream;
+  std::ostream m_engineResponseStream;
+};
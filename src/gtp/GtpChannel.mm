@@ -0,0 +1,344 @@
+// -----------------------------------------------------------------------------
+// Copyright 2014 Patrick Näf (herzbube@herzbube.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// -----------------------------------------------------------------------------
+
+
+
+// Project includes
+#include "GtpChannel.h"
+
+// System includes
+#include <cstring>  // memcpy
+
+
+/// @brief The capacity of each of the two rings of GtpChannel. Is large enough
+/// to hold most GTP responses (e.g. territory statistics for a 19x19 board)
+/// without the engine having to wait for the client.
+static const size_t channelRingCapacity = 64 * 1024;
+
+
+// -----------------------------------------------------------------------------
+/// @brief Initializes a GtpByteRing object that can hold at least @a capacity
+/// bytes.
+// -----------------------------------------------------------------------------
+GtpByteRing::GtpByteRing(size_t capacity)
+  : m_buffer(0),
+    m_capacity(1),
+    m_mask(0),
+    m_writeIndex(0),
+    m_readIndex(0),
+    m_isClosed(false),
+    m_consumerIsWaiting(false),
+    m_producerIsWaiting(false)
+{
+  while (m_capacity < capacity)
+    m_capacity <<= 1;
+  m_mask = m_capacity - 1;
+  m_buffer = new char[m_capacity];
+  pthread_mutex_init(&m_mutex, 0);
+  pthread_cond_init(&m_condition, 0);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Deallocates memory allocated by this GtpByteRing object.
+// -----------------------------------------------------------------------------
+GtpByteRing::~GtpByteRing()
+{
+  pthread_cond_destroy(&m_condition);
+  pthread_mutex_destroy(&m_mutex);
+  delete[] m_buffer;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Writes @a length bytes from @a data to the ring. Blocks while the
+/// ring is full. Returns the number of bytes written, which is less than
+/// @a length only if the ring was closed.
+///
+/// Must be invoked only by the producer.
+// -----------------------------------------------------------------------------
+size_t GtpByteRing::write(const char* data, size_t length)
+{
+  size_t numberOfBytesWritten = 0;
+  while (numberOfBytesWritten < length)
+  {
+    if (m_isClosed)
+      break;
+    if (isFull())
+    {
+      pthread_mutex_lock(&m_mutex);
+      m_producerIsWaiting = true;
+      __sync_synchronize();
+      while (isFull() && ! m_isClosed)
+        pthread_cond_wait(&m_condition, &m_mutex);
+      m_producerIsWaiting = false;
+      pthread_mutex_unlock(&m_mutex);
+      continue;
+    }
+
+    size_t writeIndex = m_writeIndex;
+    size_t numberOfFreeBytes = m_capacity - (writeIndex - m_readIndex);
+    size_t numberOfBytesToWrite = length - numberOfBytesWritten;
+    if (numberOfBytesToWrite > numberOfFreeBytes)
+      numberOfBytesToWrite = numberOfFreeBytes;
+    // The free space may wrap around the end of the buffer
+    size_t position = writeIndex & m_mask;
+    size_t numberOfBytesUntilEnd = m_capacity - position;
+    if (numberOfBytesToWrite <= numberOfBytesUntilEnd)
+    {
+      memcpy(m_buffer + position, data + numberOfBytesWritten, numberOfBytesToWrite);
+    }
+    else
+    {
+      memcpy(m_buffer + position, data + numberOfBytesWritten, numberOfBytesUntilEnd);
+      memcpy(m_buffer, data + numberOfBytesWritten + numberOfBytesUntilEnd, numberOfBytesToWrite - numberOfBytesUntilEnd);
+    }
+    // The data must be visible before the new index is
+    __sync_synchronize();
+    m_writeIndex = writeIndex + numberOfBytesToWrite;
+    // The new index must be visible before we look at the consumer's flag. The
+    // consumer does the opposite, so one of us is guaranteed to see the other.
+    __sync_synchronize();
+    if (m_consumerIsWaiting)
+    {
+      pthread_mutex_lock(&m_mutex);
+      pthread_cond_broadcast(&m_condition);
+      pthread_mutex_unlock(&m_mutex);
+    }
+    numberOfBytesWritten += numberOfBytesToWrite;
+  }
+  return numberOfBytesWritten;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Reads at most @a length bytes from the ring into @a buffer. Blocks
+/// while the ring is empty. Returns the number of bytes read, which is 0 only
+/// if the ring was closed and all data has been read.
+///
+/// Must be invoked only by the consumer.
+// -----------------------------------------------------------------------------
+size_t GtpByteRing::read(char* buffer, size_t length)
+{
+  while (isEmpty())
+  {
+    if (m_isClosed)
+      return 0;
+    pthread_mutex_lock(&m_mutex);
+    m_consumerIsWaiting = true;
+    __sync_synchronize();
+    while (isEmpty() && ! m_isClosed)
+      pthread_cond_wait(&m_condition, &m_mutex);
+    m_consumerIsWaiting = false;
+    pthread_mutex_unlock(&m_mutex);
+  }
+  // The index must have been read before the data is
+  __sync_synchronize();
+
+  size_t readIndex = m_readIndex;
+  size_t numberOfBytesToRead = m_writeIndex - readIndex;
+  if (numberOfBytesToRead > length)
+    numberOfBytesToRead = length;
+  // The data may wrap around the end of the buffer
+  size_t position = readIndex & m_mask;
+  size_t numberOfBytesUntilEnd = m_capacity - position;
+  if (numberOfBytesToRead <= numberOfBytesUntilEnd)
+  {
+    memcpy(buffer, m_buffer + position, numberOfBytesToRead);
+  }
+  else
+  {
+    memcpy(buffer, m_buffer + position, numberOfBytesUntilEnd);
+    memcpy(buffer + numberOfBytesUntilEnd, m_buffer, numberOfBytesToRead - numberOfBytesUntilEnd);
+  }
+  // We must be done with the data before the producer may overwrite it
+  __sync_synchronize();
+  m_readIndex = readIndex + numberOfBytesToRead;
+  __sync_synchronize();
+  if (m_producerIsWaiting)
+  {
+    pthread_mutex_lock(&m_mutex);
+    pthread_cond_broadcast(&m_condition);
+    pthread_mutex_unlock(&m_mutex);
+  }
+  return numberOfBytesToRead;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Closes the ring. Wakes up the producer and the consumer if they are
+/// waiting. Data that has already been written can still be read.
+// -----------------------------------------------------------------------------
+void GtpByteRing::close()
+{
+  pthread_mutex_lock(&m_mutex);
+  m_isClosed = true;
+  pthread_cond_broadcast(&m_condition);
+  pthread_mutex_unlock(&m_mutex);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Private helper.
+// -----------------------------------------------------------------------------
+bool GtpByteRing::isEmpty() const
+{
+  return (m_writeIndex == m_readIndex);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Private helper.
+// -----------------------------------------------------------------------------
+bool GtpByteRing::isFull() const
+{
+  return (m_writeIndex - m_readIndex == m_capacity);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Initializes a GtpRingInputStreamBuffer object that reads from
+/// @a ring.
+// -----------------------------------------------------------------------------
+GtpRingInputStreamBuffer::GtpRingInputStreamBuffer(GtpByteRing& ring)
+  : m_ring(ring)
+{
+  setg(m_buffer, m_buffer, m_buffer);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief std::streambuf method. Refills the buffer from the ring.
+// -----------------------------------------------------------------------------
+GtpRingInputStreamBuffer::int_type GtpRingInputStreamBuffer::underflow()
+{
+  if (gptr() < egptr())
+    return traits_type::to_int_type(*gptr());
+  size_t numberOfBytesRead = m_ring.read(m_buffer, sizeof(m_buffer));
+  if (0 == numberOfBytesRead)
+    return traits_type::eof();
+  setg(m_buffer, m_buffer, m_buffer + numberOfBytesRead);
+  return traits_type::to_int_type(*gptr());
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Initializes a GtpRingOutputStreamBuffer object that writes to
+/// @a ring.
+// -----------------------------------------------------------------------------
+GtpRingOutputStreamBuffer::GtpRingOutputStreamBuffer(GtpByteRing& ring)
+  : m_ring(ring)
+{
+  setp(m_buffer, m_buffer + sizeof(m_buffer));
+}
+
+// -----------------------------------------------------------------------------
+/// @brief std::streambuf method. Writes the buffer to the ring to make room
+/// for @a character.
+// -----------------------------------------------------------------------------
+GtpRingOutputStreamBuffer::int_type GtpRingOutputStreamBuffer::overflow(int_type character)
+{
+  if (! flushBuffer())
+    return traits_type::eof();
+  if (! traits_type::eq_int_type(character, traits_type::eof()))
+  {
+    *pptr() = traits_type::to_char_type(character);
+    pbump(1);
+  }
+  return traits_type::not_eof(character);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief std::streambuf method. Writes the buffer to the ring.
+// -----------------------------------------------------------------------------
+int GtpRingOutputStreamBuffer::sync()
+{
+  return flushBuffer() ? 0 : -1;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Writes the buffer to the ring and empties the buffer. Returns false
+/// if the ring was closed before all data could be written.
+///
+/// This is a private helper.
+// -----------------------------------------------------------------------------
+bool GtpRingOutputStreamBuffer::flushBuffer()
+{
+  size_t numberOfBytesToWrite = pptr() - pbase();
+  size_t numberOfBytesWritten = 0;
+  if (numberOfBytesToWrite > 0)
+    numberOfBytesWritten = m_ring.write(pbase(), numberOfBytesToWrite);
+  setp(m_buffer, m_buffer + sizeof(m_buffer));
+  return (numberOfBytesWritten == numberOfBytesToWrite);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Initializes a GtpChannel object.
+// -----------------------------------------------------------------------------
+GtpChannel::GtpChannel()
+  : m_commandRing(channelRingCapacity),
+    m_responseRing(channelRingCapacity),
+    m_clientCommandBuffer(m_commandRing),
+    m_clientResponseBuffer(m_responseRing),
+    m_engineCommandBuffer(m_commandRing),
+    m_engineResponseBuffer(m_responseRing),
+    m_clientCommandStream(&m_clientCommandBuffer),
+    m_clientResponseStream(&m_clientResponseBuffer),
+    m_engineCommandStream(&m_engineCommandBuffer),
+    m_engineResponseStream(&m_engineResponseBuffer)
+{
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Deallocates memory allocated by this GtpChannel object.
+// -----------------------------------------------------------------------------
+GtpChannel::~GtpChannel()
+{
+  close();
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns the stream that GtpClient uses to write commands.
+// -----------------------------------------------------------------------------
+std::ostream& GtpChannel::clientCommandStream()
+{
+  return m_clientCommandStream;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns the stream that GtpClient uses to read responses.
+// -----------------------------------------------------------------------------
+std::istream& GtpChannel::clientResponseStream()
+{
+  return m_clientResponseStream;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns the stream that GtpEngine uses to read commands.
+// -----------------------------------------------------------------------------
+std::istream& GtpChannel::engineCommandStream()
+{
+  return m_engineCommandStream;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns the stream that GtpEngine uses to write responses.
+// -----------------------------------------------------------------------------
+std::ostream& GtpChannel::engineResponseStream()
+{
+  return m_engineResponseStream;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Closes both rings. Readers on either side receive end-of-file once
+/// they have consumed the data that was written before.
+// -----------------------------------------------------------------------------
+void GtpChannel::close()
+{
+  m_commandRing.close();
+  m_responseRing.close();
+}
@@ -19,7 +19,10 @@
 // must not contain any C++ syntax.
 
 // Forward declarations
+@class GtpCancellationToken;
 @class GtpCommand;
+@class GtpEngine;
+@class GtpEngineMoveHistory;
 
 
 // -----------------------------------------------------------------------------
@@ -27,16 +30,33 @@
 ///
 /// @ingroup gtp
 ///
-/// GtpClient communicates with its counterpart GtpEngine via named pipes.
-/// When GtpClient is instantiated using clientWithInputPipe:outputPipe:() it
-/// spawns a new secondary thread, then blocks and waits for GTP commands to be
-/// submitted via submit:(). submit:() is usually (but not necessarily) invoked
-/// in the main thread's context. If the command's @e waitUntilDone property is
-/// false, submit:() returns immediately, while the command is processed and
-/// passed on to the GtpEngine asynchronously in the secondary thread's context.
-/// If the command's @e waitUntilDone property is true, submit:() blocks and
-/// waits until after the command has been processed and its answer was
-/// received.
+/// GtpClient communicates with its counterpart GtpEngine either via named
+/// pipes, or, if the GtpEngine runs GtpReplayEngine, via the GtpEngine's
+/// in-memory GtpChannel (see clientWithInProcessChannelOfEngine:()). When
+/// GtpClient is instantiated it spawns a new secondary thread, then blocks and
+/// waits for GTP commands to be submitted via submit:(). submit:() is usually
+/// (but not necessarily) invoked in the main thread's context. If the command's
+/// @e waitUntilDone property is false, submit:() returns immediately, while the
+/// command is processed and passed on to the GtpEngine asynchronously in the
+/// secondary thread's context. If the command's @e waitUntilDone property is
+/// true, submit:() blocks and waits until after the command has been processed
+/// and its answer was received.
+///
+/// Commands are pipelined: The secondary thread writes several commands to the
+/// GtpEngine, each prefixed by a numeric GTP command ID, before it waits for
+/// the first response. Responses are matched to their GtpCommand objects in
+/// the order in which the commands were written, which is also the order in
+/// which the GtpEngine processes them. An interruptible command (see
+/// GtpCommand::interruptible) is not pipelined: It is written only when no
+/// other command is in flight, and later commands are held back until the
+/// GtpEngine has answered it. An interrupt therefore always stops the command
+/// that it is meant for.
+///
+/// A command can be abandoned before the GtpEngine has answered it, either
+/// because its deadline passes or, if the command is cancellable, because its
+/// cancellation token is cancelled (see GtpCommand). The command is then
+/// completed with a failure response right away. The GtpEngine is interrupted if it is working on the command,
+/// and the engine's response that arrives later is discarded.
 ///
 /// @note As a convenience, GtpCommand is capable of submitting itself so that
 /// clients do not have to concern themselves with where to obtain an instance
@@ -54,7 +74,10 @@
 /// Observers listening for both notifications are guaranteed to receive
 /// #gtpCommandWillBeSubmitted before they receive the matching
 /// #gtpResponseWasReceived. Both notifications are delivered in the context of
-/// the secondary thread that processes commands.
+/// the secondary thread that processes commands. Because commands are
+/// pipelined, #gtpCommandWillBeSubmitted for a command may be sent before
+/// #gtpResponseWasReceived for an earlier command. Both notifications are
+/// always sent in the order in which commands were submitted, though.
 ///
 ///
 /// @par Private notification of response target
@@ -78,11 +101,33 @@
 }
 
 + (GtpClient*) clientWithInputPipe:(NSString*)inputPipe outputPipe:(NSString*)outputPipe;
++ (GtpClient*) clientWithInProcessChannelOfEngine:(GtpEngine*)engine;
 - (void) submit:(GtpCommand*)command;
+- (void) abandonCommand:(GtpCommand*)command reason:(NSString*)reason;
+- (void) abandonCommandsWithCancellationToken:(GtpCancellationToken*)cancellationToken;
 - (void) interrupt;
 
 /// @brief Set this property to true to trigger termination of the secondary
 /// thread.
 @property(assign, getter=shouldExit, setter=exit:) bool shouldExit;
+/// @brief The number of commands that were submitted to this GtpClient but
+/// have not yet been completed. GtpEnginePool uses this as a measure of how
+/// busy the GtpEngine is.
+@property(assign, readonly) int numberOfOutstandingCommands;
+/// @brief Keeps track of the handicap and the moves that the GtpEngine
+/// currently has on its board. Is updated whenever a response is received.
+@property(retain, readonly) GtpEngineMoveHistory* engineMoveHistory;
+/// @brief Keeps track of the handicap and the moves that the GtpEngine will
+/// have on its board once it has processed all commands that were submitted so
+/// far, assuming that they succeed. Is updated whenever a command is
+/// submitted, and becomes unknown when a command fails or is abandoned.
+/// GtpEnginePool uses this to find out whether an analysis engine that is
+/// still busy must be set up again.
+///
+/// The default for this property is nil, which means that the record is not
+/// kept. GtpEnginePool sets up the record only for the clients of analysis
+/// engines, so that submitting a command to the play engine does not pay for
+/// it. The property must be set before the first command is submitted.
+@property(retain) GtpEngineMoveHistory* queuedEngineMoveHistory;
 
 @end
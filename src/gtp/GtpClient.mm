@@ -24,17 +24,23 @@
 
 // Project includes
 #import "GtpClient.h"
+#import "GtpCancellationToken.h"
+#import "GtpChannel.h"
 #import "GtpCommand.h"
+#import "GtpEngine.h"
+#import "GtpEngineMoveHistory.h"
 #import "GtpResponse.h"
 
 // System includes
+#include <cctype>    // isdigit
+#include <cstdlib>   // atoi
 #include <fstream>   // ifstream and ofstream
+#include <string>
 
-// It would be much nicer to make these variables members of the GtpClient
-// class, but they are C++ and GtpClient.h is also #import'ed by pure
-// Objective-C implementations.
-static std::ofstream commandStream;
-static std::ifstream responseStream;
+/// @brief The maximum number of commands that GtpClient writes to the GTP
+/// engine before it waits for the response to the oldest of them. The window
+/// is small so that a burst of commands never fills the pipe buffer.
+static const int maximumNumberOfCommandsInFlight = 8;
 
 
 // -----------------------------------------------------------------------------
@@ -42,6 +48,58 @@ static std::ifstream responseStream;
 // -----------------------------------------------------------------------------
 @interface GtpClient()
 @property(retain) NSThread* thread;
+/// @brief The GtpEngine whose in-memory GtpChannel this GtpClient uses. Is
+/// retained so that the channel lives at least as long as this GtpClient. Is
+/// nil if named pipes are used.
+@property(retain) GtpEngine* engine;
+/// @brief The stream to write commands to the GtpEngine. Points either to
+/// @e commandFileStream, or to the client command stream of a GtpChannel. Is
+/// set up by the secondary thread.
+@property(assign) std::ostream* commandStream;
+/// @brief The stream to read responses from the GtpEngine. Points either to
+/// @e responseFileStream, or to the client response stream of a GtpChannel.
+/// Is set up by the secondary thread.
+@property(assign) std::istream* responseStream;
+/// @brief The named pipe streams. Are owned by GtpClient. Are 0 if a
+/// GtpChannel is used.
+@property(assign) std::ofstream* commandFileStream;
+@property(assign) std::ifstream* responseFileStream;
+/// @brief GtpCommand objects that were submitted but have not yet been written
+/// to the GTP engine, in the order in which they were submitted. Is protected
+/// by @synchronized(self).
+@property(retain) NSMutableArray* pendingCommands;
+/// @brief GtpCommand objects that were written to the GTP engine and whose
+/// response has not yet been received, in the order in which they were
+/// written. Is accessed only by the secondary thread.
+@property(retain) NSMutableArray* commandsInFlight;
+/// @brief The ID of the command that was written most recently. IDs are
+/// assigned in ascending order, so the ID of the oldest command in
+/// @e commandsInFlight can be derived from this value. Is accessed only by the
+/// secondary thread.
+@property(assign) int lastCommandID;
+/// @brief Serializes writing to the command stream, which is done both by the
+/// secondary thread and by interrupt().
+@property(retain) NSLock* commandStreamLock;
+/// @brief GtpCommand objects that were submitted but have not yet been
+/// completed, i.e. that have neither been answered by the GTP engine nor been
+/// abandoned. Is protected by @e completionCondition.
+@property(retain) NSMutableArray* outstandingCommands;
+/// @brief The GtpCommand that the GtpEngine is known to be working on, or nil
+/// if this is not known. Commands are pipelined, so the engine may already
+/// have answered the command whose response the secondary thread is waiting
+/// for, and be working on a later command. The engine can be working only on
+/// the oldest command in flight if no later command has been written, so this
+/// is set only while the secondary thread waits for the response to the only
+/// command in flight. An interruptible command is always the only command in
+/// flight (see writePendingCommands()). Is protected by
+/// @e completionCondition.
+@property(retain) GtpCommand* commandBeingProcessedByEngine;
+/// @brief Protects @e outstandingCommands and @e commandBeingProcessedByEngine,
+/// and is
+/// signalled whenever a command is completed.
+@property(retain) NSCondition* completionCondition;
+// Re-declare property as readwrite
+@property(retain, readwrite) GtpEngineMoveHistory* engineMoveHistory;
 @end
 
 
@@ -56,15 +114,27 @@ static std::ifstream responseStream;
   // Create copies so that the objects can be safely used by the thread when
   // it starts
   NSArray* pipes = [NSArray arrayWithObjects:[[inputPipe copy] autorelease], [[outputPipe copy] autorelease], nil];
-  return [[[GtpClient alloc] initWithPipes:pipes] autorelease];
+  return [[[GtpClient alloc] initWithPipes:pipes engine:nil] autorelease];
 }
 
 // -----------------------------------------------------------------------------
-/// @brief Initializes a GtpClient object.
+/// @brief Convenience constructor. Creates a GtpClient instance which will use
+/// the in-memory GtpChannel of @a engine to communicate with @a engine.
+/// @a engine must have been created with
+/// GtpEngine::engineWithReplayTranscript:().
+// -----------------------------------------------------------------------------
++ (GtpClient*) clientWithInProcessChannelOfEngine:(GtpEngine*)engine
+{
+  return [[[GtpClient alloc] initWithPipes:nil engine:engine] autorelease];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Initializes a GtpClient object. If @a pipes is nil, the GtpClient
+/// uses the in-memory GtpChannel of @a engine instead of named pipes.
 ///
 /// @note This is the designated initializer of GtpClient.
 // -----------------------------------------------------------------------------
-- (id) initWithPipes:(NSArray*)pipes
+- (id) initWithPipes:(NSArray*)pipes engine:(GtpEngine*)engine
 {
   // Call designated initializer of superclass (NSObject)
   self = [super init];
@@ -72,6 +142,20 @@ static std::ifstream responseStream;
     return nil;
 
   self.shouldExit = false;
+  self.engine = engine;
+  self.commandStream = 0;
+  self.responseStream = 0;
+  self.commandFileStream = 0;
+  self.responseFileStream = 0;
+  self.pendingCommands = [NSMutableArray arrayWithCapacity:0];
+  self.commandsInFlight = [NSMutableArray arrayWithCapacity:0];
+  self.lastCommandID = 0;
+  self.commandStreamLock = [[[NSLock alloc] init] autorelease];
+  self.outstandingCommands = [NSMutableArray arrayWithCapacity:0];
+  self.commandBeingProcessedByEngine = nil;
+  self.completionCondition = [[[NSCondition alloc] init] autorelease];
+  self.engineMoveHistory = [[[GtpEngineMoveHistory alloc] init] autorelease];
+  self.queuedEngineMoveHistory = nil;
 
   // Create and start the thread
   self.thread = [[[NSThread alloc] initWithTarget:self selector:@selector(mainLoop:) object:pipes] autorelease];
@@ -91,6 +175,19 @@ static std::ifstream responseStream;
 {
   // TODO implement stuff
   self.thread = nil;
+  self.pendingCommands = nil;
+  self.commandsInFlight = nil;
+  self.commandStreamLock = nil;
+  self.outstandingCommands = nil;
+  self.commandBeingProcessedByEngine = nil;
+  self.completionCondition = nil;
+  self.engineMoveHistory = nil;
+  self.queuedEngineMoveHistory = nil;
+  self.engine = nil;
+  delete _commandFileStream;
+  _commandFileStream = 0;
+  delete _responseFileStream;
+  _responseFileStream = 0;
   [super dealloc];
 }
 
@@ -103,15 +200,26 @@ static std::ifstream responseStream;
   // Create an autorelease pool as the very first thing in this thread
   NSAutoreleasePool* mainPool = [[NSAutoreleasePool alloc] init];
 
-  // Stream to write commands for the GTP engine
-  NSString* inputPipePath = [pipes objectAtIndex:0];
-  const char* pchInputPipePath = [inputPipePath cStringUsingEncoding:[NSString defaultCStringEncoding]];
-  commandStream.open(pchInputPipePath);
-
-  // Stream to read responses from the GTP engine
-  NSString* outputPipePath = [pipes objectAtIndex:1];
-  const char* pchOutputPipePath = [outputPipePath cStringUsingEncoding:[NSString defaultCStringEncoding]];
-  responseStream.open(pchOutputPipePath);
+  if (pipes)
+  {
+    // Stream to write commands for the GTP engine
+    NSString* inputPipePath = [pipes objectAtIndex:0];
+    const char* pchInputPipePath = [inputPipePath cStringUsingEncoding:[NSString defaultCStringEncoding]];
+    self.commandFileStream = new std::ofstream(pchInputPipePath);
+    self.commandStream = self.commandFileStream;
+
+    // Stream to read responses from the GTP engine
+    NSString* outputPipePath = [pipes objectAtIndex:1];
+    const char* pchOutputPipePath = [outputPipePath cStringUsingEncoding:[NSString defaultCStringEncoding]];
+    self.responseFileStream = new std::ifstream(pchOutputPipePath);
+    self.responseStream = self.responseFileStream;
+  }
+  else
+  {
+    GtpChannel& channel = *[self.engine channel];
+    self.commandStream = &channel.clientCommandStream();
+    self.responseStream = &channel.clientResponseStream();
+  }
 
   // The timer is required because otherwise the run loop has no input source
   NSDate* distantFuture = [NSDate distantFuture];
@@ -141,39 +249,162 @@ static std::ifstream responseStream;
 }
 
 // -----------------------------------------------------------------------------
-/// @brief Processes the GTP command @a command. This method is executed in the
-/// secondary thread's context.
+/// @brief Processes all GTP commands that were submitted so far. This method is
+/// executed in the secondary thread's context.
 ///
-/// Performs the following operations:
-/// - Pass @a command to the GtpEngine
-/// - Wait for the response from the GtpEngine (blocks)
-/// - Creates a GtpResponse object using the response received from the
-///   GtpEngine
-/// - If requested, invokes notifyResponseTarget:() to notify an observer
-///   object that the response has been received; the notification occurs in
-///   the context of the thread that submitted the command
+/// Commands are pipelined: The secondary thread writes up to
+/// #maximumNumberOfCommandsInFlight commands to the GtpEngine, each of them
+/// prefixed by a numeric GTP command ID, before it waits for the response to
+/// the oldest of them. Whenever a response has been received, the secondary
+/// thread tops up the window with commands that were submitted in the
+/// meantime. This method returns when all commands have been answered.
+///
+/// The GtpEngine processes commands in the order in which they were written,
+/// therefore responses arrive in the same order. The command ID in each
+/// response is checked against the expected ID to detect if client and engine
+/// have become out of sync (see readResponse()).
 // -----------------------------------------------------------------------------
-- (void) processCommand:(GtpCommand*)command
+- (void) processCommands
 {
-  // Undo retain message sent to the command object by submit:()
-  [command autorelease];
+  while (true)
+  {
+    [self writePendingCommands];
+    if (0 == self.commandsInFlight.count)
+      break;
+    [self readResponse];
+  }
+}
 
-  // Notify observers in the secondary thread context
-  [[NSNotificationCenter defaultCenter] postNotificationName:gtpCommandWillBeSubmittedNotification
-                                                      object:command];
+// -----------------------------------------------------------------------------
+/// @brief Writes pending commands to the GtpEngine until either no more
+/// commands are pending, or the window of commands in flight is full.
+///
+/// An interruptible command (see isInterruptibleCommand:()) is written only
+/// when no other command is in flight, and no command is written while an
+/// interruptible command is in flight. When the GtpEngine is interrupted, it
+/// therefore cannot be working on a later command.
+///
+/// This is a private helper for processCommands().
+// -----------------------------------------------------------------------------
+- (void) writePendingCommands
+{
+  [self.commandStreamLock lock];
+  while (self.commandsInFlight.count < maximumNumberOfCommandsInFlight)
+  {
+    // If an interruptible command is in flight, it is the only one
+    if (self.commandsInFlight.count > 0 && [self isInterruptibleCommand:[self.commandsInFlight lastObject]])
+      break;
+    GtpCommand* command;
+    @synchronized(self)
+    {
+      if (0 == self.pendingCommands.count)
+        break;
+      command = [self.pendingCommands objectAtIndex:0];
+      if (self.commandsInFlight.count > 0 && [self isInterruptibleCommand:command])
+        break;
+      command = [[command retain] autorelease];
+      [self.pendingCommands removeObjectAtIndex:0];
+    }
+
+    // Notify observers in the secondary thread context
+    [[NSNotificationCenter defaultCenter] postNotificationName:gtpCommandWillBeSubmittedNotification
+                                                        object:command];
+
+    // Send the command to the engine
+    if (nil == command.command || 0 == [command.command length])
+    {
+      // There will be no response, so the command is complete right away
+      [self.completionCondition lock];
+      [self.outstandingCommands removeObjectIdenticalTo:command];
+      [self.completionCondition broadcast];
+      [self.completionCondition unlock];
+      continue;
+    }
+    const char* pchCommand = [command.command cStringUsingEncoding:[NSString defaultCStringEncoding]];
+    self.lastCommandID++;
+    *_commandStream << self.lastCommandID << ' ' << pchCommand << '\n';
+    [self.commandsInFlight addObject:command];
+  }
+  // Flush only once per burst. This wakes up the engine.
+  *_commandStream << std::flush;
+  [self.commandStreamLock unlock];
+}
 
-  // Send the command to the engine
-  if (nil == command.command || 0 == [command.command length])
+// -----------------------------------------------------------------------------
+/// @brief Reads the response to the oldest command in flight from the
+/// GtpEngine (blocking if necessary), and completes the command.
+///
+/// If the command has already been abandoned, and if the GtpEngine is known to
+/// be working on it, interrupts the GtpEngine so that the engine does not
+/// waste time on it. The engine is not interrupted if later commands are in
+/// flight, because the engine may already be working on one of them.
+///
+/// The command ID in the response must match the ID of the oldest command in
+/// flight. A mismatch is a protocol error, which is handled as follows:
+/// - A response with an ID that does not belong to any command in flight is
+///   discarded, and the next response is read.
+/// - A response with the ID of a later command in flight means that the
+///   responses to the commands in between were lost. These commands are failed
+///   with a "protocol error" response, and the response is delivered to the
+///   command whose ID it carries.
+///
+/// This is a private helper for processCommands().
+// -----------------------------------------------------------------------------
+- (void) readResponse
+{
+  GtpCommand* command = [self.commandsInFlight objectAtIndex:0];
+  bool isOnlyCommandInFlight = (1 == self.commandsInFlight.count);
+  [self.completionCondition lock];
+  if (isOnlyCommandInFlight)
+    self.commandBeingProcessedByEngine = command;
+  bool isAbandoned = (NSNotFound == [self.outstandingCommands indexOfObjectIdenticalTo:command]);
+  [self.completionCondition unlock];
+  if (isAbandoned && isOnlyCommandInFlight)
+    [self interruptCommand:command];
+
+  while (true)
+  {
+    int responseID;
+    std::string response = [self readResponseWithID:&responseID];
+    // Cast is required because NSUInteger and int differ in size in 64-bit.
+    // Cast is safe because the window is small.
+    int expectedResponseID = self.lastCommandID - (int)self.commandsInFlight.count + 1;
+    if (-1 == responseID || expectedResponseID == responseID)
+    {
+      [self completeOldestCommandInFlightWithResponse:response];
+      return;
+    }
+    if (responseID < expectedResponseID || responseID > self.lastCommandID)
+    {
+      DDLogError(@"%@: Protocol error, expected response to command ID %d, discarding response to unknown command ID %d",
+                 self, expectedResponseID, responseID);
+      continue;
+    }
+    DDLogError(@"%@: Protocol error, expected response to command ID %d, received response to command ID %d, failing the commands in between",
+               self, expectedResponseID, responseID);
+    for (; expectedResponseID < responseID; ++expectedResponseID)
+      [self completeOldestCommandInFlightWithResponse:std::string("? protocol error")];
+    [self completeOldestCommandInFlightWithResponse:response];
     return;
-  const char* pchCommand = [command.command cStringUsingEncoding:[NSString defaultCStringEncoding]];
-  commandStream << pchCommand << std::endl;  // this wakes up the engine
+  }
+}
 
-  // Read the engine's response (blocking if necessary)
+// -----------------------------------------------------------------------------
+/// @brief Reads a single response from the GtpEngine (blocking if necessary).
+/// Returns the response without the command ID, so that the response looks
+/// the same as if the command had been written without ID. Fills the out
+/// parameter @a responseID with the command ID, or with -1 if the response
+/// has no command ID.
+///
+/// This is a private helper for readResponse().
+// -----------------------------------------------------------------------------
+- (std::string) readResponseWithID:(int*)responseID
+{
   std::string fullResponse;
   std::string singleLineResponse;
   while (true)
   {
-    getline(responseStream, singleLineResponse);
+    getline(*_responseStream, singleLineResponse);
     if (singleLineResponse.empty())
       break;
     if (! fullResponse.empty())
@@ -181,13 +412,71 @@ static std::ifstream responseStream;
     fullResponse += singleLineResponse;
   }
 
-  // Create the response object
-  NSString* nsResponse = [NSString stringWithCString:fullResponse.c_str()
-                                            encoding:[NSString defaultCStringEncoding]];
-  GtpResponse* response = [GtpResponse response:nsResponse toCommand:command];
-  command.response = response;
+  // Remove the command ID, which immediately follows the status character
+  *responseID = -1;
+  if (! fullResponse.empty() && ('=' == fullResponse[0] || '?' == fullResponse[0]))
+  {
+    std::string::size_type indexAfterID = 1;
+    while (indexAfterID < fullResponse.size() && isdigit(fullResponse[indexAfterID]))
+      ++indexAfterID;
+    if (indexAfterID > 1)
+    {
+      *responseID = atoi(fullResponse.substr(1, indexAfterID - 1).c_str());
+      fullResponse.erase(1, indexAfterID - 1);
+    }
+  }
+
+  return fullResponse;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Removes the oldest command from the commands in flight, and
+/// completes it with @a responseBytes.
+///
+/// Performs the following operations:
+/// - Creates a GtpResponse object using @a responseBytes
+/// - Updates the GtpEngineMoveHistory with the effect of the command. Marks
+///   the queued GtpEngineMoveHistory as unknown if the command failed.
+/// - Completes the command, unless it has been abandoned in the meantime. The
+///   response to an abandoned command is stale and is not delivered to the
+///   command.
+/// - If requested, invokes notifyResponseTarget:() to notify an observer
+///   object that the response has been received; the notification occurs in
+///   the context of the thread that submitted the command
+///
+/// This is a private helper for readResponse().
+// -----------------------------------------------------------------------------
+- (void) completeOldestCommandInFlightWithResponse:(const std::string&)responseBytes
+{
+  GtpCommand* command = [[[self.commandsInFlight objectAtIndex:0] retain] autorelease];
+  [self.commandsInFlight removeObjectAtIndex:0];
+
+  GtpResponse* response = [GtpResponse responseWithBytes:responseBytes.data()
+                                                  length:responseBytes.size()
+                                               toCommand:command];
+  // Must happen before anyone is notified so that the record is up-to-date
+  // when a synchronous submitter resumes. The engine has executed an abandoned
+  // command all the same, so its response must not be skipped here.
+  [self.engineMoveHistory updateWithResponse:response];
+  // The queued record assumed that the command would succeed
+  if (! response.status)
+    [self.queuedEngineMoveHistory invalidate];
+
+  [self.completionCondition lock];
+  self.commandBeingProcessedByEngine = nil;
+  NSUInteger indexOfCommand = [self.outstandingCommands indexOfObjectIdenticalTo:command];
+  bool isStale = (NSNotFound == indexOfCommand);
+  if (! isStale)
+  {
+    command.response = response;
+    [self.outstandingCommands removeObjectAtIndex:indexOfCommand];
+    [self.completionCondition broadcast];
+  }
+  [self.completionCondition unlock];
+  if (isStale)
+    DDLogWarn(@"%@: Discarding stale response to abandoned command %@", self, command);
 
-  if (response.command.responseTarget)
+  if (! isStale && command.responseTarget)
   {
     // Retain to make sure that object is still alive when it "arrives" in
     // the submitting thread
@@ -221,18 +510,156 @@ static std::ifstream responseStream;
 /// context is the backup task just before the application is suspended.
 ///
 /// If @a command.waitUntilDone is false, this method returns immediately and
-/// does not wait for the GtpEngine's response.
+/// does not wait for the GtpEngine's response. Several commands submitted in
+/// quick succession this way are written to the GtpEngine in one burst. If
+/// @a command has a timeout, a block is scheduled on a global dispatch queue
+/// that abandons the command when the deadline passes. A dispatch queue is
+/// used instead of a timer because the submitting thread may not run its run
+/// loop, e.g. if it is a secondary thread that ends after submitting.
+///
+/// If @a command.waitUntilDone is true, this method returns only after the
+/// command has been completed, i.e. after it has been answered, or after it
+/// has been abandoned because its deadline passed or its cancellation token
+/// was cancelled.
 // -----------------------------------------------------------------------------
 - (void) submit:(GtpCommand*)command
 {
   command.submittingThread = [NSThread currentThread];
-  // Retain to make sure that object is still alive when it "arrives" in
-  // the secondary thread
-  [command retain];
-  [self performSelector:@selector(processCommand:)
+  [self.completionCondition lock];
+  [self.outstandingCommands addObject:command];
+  [self.completionCondition unlock];
+  if (command.cancellable && command.cancellationToken.isCancelled)
+  {
+    [self abandonCommand:command reason:@"cancelled"];
+    return;
+  }
+
+  @synchronized(self)
+  {
+    // Must happen in the same order in which the commands are written. Does
+    // nothing if the record is not kept.
+    [self.queuedEngineMoveHistory updateWithSubmittedCommand:command];
+    [self.pendingCommands addObject:command];
+  }
+  // If the secondary thread is already busy with processCommands(), it will
+  // pick up the command on its own, and when the selector is finally performed
+  // there is nothing left to do.
+  [self performSelector:@selector(processCommands)
                onThread:self.thread
-             withObject:command
-          waitUntilDone:command.waitUntilDone];
+             withObject:nil
+          waitUntilDone:NO];
+
+  if (command.waitUntilDone)
+    [self waitForCompletionOfCommand:command];
+  else if (command.timeout > 0)
+  {
+    // The block retains self and command until the deadline passes. If the
+    // command has been completed in the meantime, abandonCommand:reason:()
+    // does nothing.
+    dispatch_time_t deadline = dispatch_time(DISPATCH_TIME_NOW, (int64_t)(command.timeout * NSEC_PER_SEC));
+    dispatch_after(deadline, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+      [self abandonCommand:command reason:@"timeout"];
+    });
+  }
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Blocks until @a command has been completed. Abandons @a command if
+/// its deadline passes first.
+///
+/// This is a private helper for submit:().
+// -----------------------------------------------------------------------------
+- (void) waitForCompletionOfCommand:(GtpCommand*)command
+{
+  NSDate* deadline;
+  if (command.timeout > 0)
+    deadline = [NSDate dateWithTimeIntervalSinceNow:command.timeout];
+  else
+    deadline = [NSDate distantFuture];
+  [self.completionCondition lock];
+  while (NSNotFound != [self.outstandingCommands indexOfObjectIdenticalTo:command])
+  {
+    if (! [self.completionCondition waitUntilDate:deadline])
+    {
+      [self.completionCondition unlock];
+      [self abandonCommand:command reason:@"timeout"];
+      [self.completionCondition lock];
+    }
+  }
+  [self.completionCondition unlock];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Completes @a command with a failure response whose parsed response
+/// is @a reason, without waiting for the GtpEngine. Does nothing if
+/// @a command has already been completed.
+///
+/// If @a command has not yet been written to the GtpEngine, it is never
+/// written. If the GtpEngine is known to be working on @a command, the engine
+/// is interrupted. The response that the engine eventually sends for @a command
+/// is stale and is discarded.
+///
+/// The response target of an asynchronous command is notified as usual, in
+/// the context of the thread that submitted the command.
+///
+/// This method can be executed in arbitrary thread contexts.
+// -----------------------------------------------------------------------------
+- (void) abandonCommand:(GtpCommand*)command reason:(NSString*)reason
+{
+  [self.completionCondition lock];
+  NSUInteger indexOfCommand = [self.outstandingCommands indexOfObjectIdenticalTo:command];
+  if (NSNotFound == indexOfCommand)
+  {
+    [self.completionCondition unlock];
+    return;
+  }
+  // Keep the command alive after removing it from the array
+  [[command retain] autorelease];
+  [self.outstandingCommands removeObjectAtIndex:indexOfCommand];
+  command.response = [GtpResponse response:[@"? " stringByAppendingString:reason] toCommand:command];
+  [self.completionCondition broadcast];
+  [self.completionCondition unlock];
+
+  @synchronized(self)
+  {
+    [self.pendingCommands removeObjectIdenticalTo:command];
+  }
+  // The command may or may not be executed by the engine
+  [self.queuedEngineMoveHistory invalidate];
+  DDLogWarn(@"%@: Abandoned %@, reason: %@", self, command, reason);
+  [self interruptCommand:command];
+
+  if (! command.waitUntilDone && command.responseTarget)
+  {
+    // Retain to make sure that object is still alive when it "arrives" in
+    // the submitting thread
+    [command retain];
+    [self performSelector:@selector(notifyResponseTarget:)
+                 onThread:command.submittingThread
+               withObject:command
+            waitUntilDone:NO];
+  }
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Abandons all cancellable commands that carry @a cancellationToken
+/// and that have not been completed yet. See abandonCommand:reason:() for
+/// details.
+///
+/// This method can be executed in arbitrary thread contexts.
+// -----------------------------------------------------------------------------
+- (void) abandonCommandsWithCancellationToken:(GtpCancellationToken*)cancellationToken
+{
+  NSMutableArray* commandsToAbandon = [NSMutableArray arrayWithCapacity:0];
+  [self.completionCondition lock];
+  for (GtpCommand* command in self.outstandingCommands)
+  {
+    if (command.cancellable && command.cancellationToken == cancellationToken)
+      [commandsToAbandon addObject:command];
+  }
+  [self.completionCondition unlock];
+  for (GtpCommand* command in commandsToAbandon)
+    [self abandonCommand:command reason:@"cancelled"];
 }
 
 // -----------------------------------------------------------------------------
@@ -247,7 +674,8 @@ static std::ifstream responseStream;
 // -----------------------------------------------------------------------------
 - (void) notifyResponseTarget:(GtpCommand*)command
 {
-  // Undo retain message sent to the command object by processCommand:()
+  // Undo retain message sent to the command object by readResponse() or
+  // abandonCommand:reason:()
   [command autorelease];
   id responseTarget = command.responseTarget;
   if (responseTarget)
@@ -259,16 +687,17 @@ static std::ifstream responseStream;
 
 // -----------------------------------------------------------------------------
 /// @brief Interrupts the GTP command currently being processed by the
-/// GtpEngine.
+/// GtpEngine, if that command is interruptible (see GtpCommand::interruptible).
+/// Does nothing if the GtpEngine is not known to be working on an
+/// interruptible command.
 ///
-/// This method is always executed in the main thread's context, in response to
-/// user interaction in the GUI. This method does not return until the
-/// interruption has been sent to the GtpEngine.
+/// This method is executed in the main thread's context, in response to user
+/// interaction in the GUI. This method does not return until the interruption
+/// has been sent to the GtpEngine.
 ///
-/// @note The current thread architecture does not allow the interrupt to be
-/// sent in the context of the secondary thread, because the secondary thread
-/// currently blocks and waits for the response to the GTP command that is
-/// currently being processed.
+/// Because an interruptible command is never pipelined together with other
+/// commands (see writePendingCommands()), the interruption cannot stop a
+/// later command by accident.
 ///
 /// When the GtpEngine is interrupted, it immediately stops processing the
 /// current GTP command and returns a result on the GTP response stream.
@@ -282,9 +711,67 @@ static std::ifstream responseStream;
 /// global notification centre.
 // -----------------------------------------------------------------------------
 - (void) interrupt
+{
+  [self.completionCondition lock];
+  GtpCommand* command = [[self.commandBeingProcessedByEngine retain] autorelease];
+  [self.completionCondition unlock];
+  if (command && [self isInterruptibleCommand:command])
+    [self interruptCommand:command];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Interrupts the GtpEngine if it is known to be working on
+/// @a command. Does nothing otherwise.
+///
+/// This method is executed when a command is abandoned (see
+/// abandonCommand:reason:()), which may happen in arbitrary thread contexts,
+/// and by interrupt().
+///
+/// @note The secondary thread sends an interrupt only before it starts to wait
+/// for the response to a command that has already been abandoned, and only if
+/// no later command is in flight (see readResponse()). Once it blocks and
+/// waits for a response, another thread must send the interrupt. Writing the
+/// interrupt to the command stream is serialized with the secondary thread's
+/// writes, so that the command stream has only one writer at any time even if
+/// it is the single-producer GtpChannel. The check whether the engine is
+/// working on @a command is made while the command stream is locked, so no
+/// later command can be written between the check and the interrupt.
+// -----------------------------------------------------------------------------
+- (void) interruptCommand:(GtpCommand*)command
 {
   const char* pchCommand = "# interrupt";
-  commandStream << pchCommand << std::endl;
+  [self.commandStreamLock lock];
+  [self.completionCondition lock];
+  bool isCommandBeingProcessedByEngine = (command == self.commandBeingProcessedByEngine);
+  [self.completionCondition unlock];
+  if (isCommandBeingProcessedByEngine)
+    *_commandStream << pchCommand << std::endl;
+  [self.commandStreamLock unlock];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns true if the GtpEngine may be interrupted while it works on
+/// @a command, i.e. if @a command is interruptible, or if @a command may be
+/// abandoned because it has a deadline or because it is cancellable.
+///
+/// This is a private helper.
+// -----------------------------------------------------------------------------
+- (bool) isInterruptibleCommand:(GtpCommand*)command
+{
+  return (command.interruptible || command.cancellable || command.timeout > 0);
+}
+
+// -----------------------------------------------------------------------------
+// Property is documented in the header file.
+// -----------------------------------------------------------------------------
+- (int) numberOfOutstandingCommands
+{
+  [self.completionCondition lock];
+  // Cast is required because NSUInteger and int differ in size in 64-bit. Cast
+  // is safe because the number of outstanding commands is small.
+  int numberOfOutstandingCommands = (int)self.outstandingCommands.count;
+  [self.completionCondition unlock];
+  return numberOfOutstandingCommands;
 }
 
 @end
@@ -16,9 +16,24 @@
 
 
 // Forward declarations
+@class GtpCancellationToken;
+@class GtpClient;
 @class GtpResponse;
 
 
+// -----------------------------------------------------------------------------
+/// @brief Enumerates the kinds of GTP engines that a GtpCommand can be routed
+/// to by GtpEnginePool.
+///
+/// @ingroup gtp
+// -----------------------------------------------------------------------------
+enum GtpEngineAffinity
+{
+  GtpEngineAffinityPlay,      ///< @brief The engine that holds the game and plays moves.
+  GtpEngineAffinityAnalysis   ///< @brief Any engine that is not busy, usually one of the analysis engines.
+};
+
+
 // -----------------------------------------------------------------------------
 /// @brief The GtpCommand class represents a Go Text Protocol (GTP) command.
 ///
@@ -29,13 +44,25 @@
 ///
 /// GtpCommand conveniently knows how to submit itself to the application's
 /// GtpClient, thus clients do not have to concern themselves with where to
-/// obtain a GtpClient instance.
+/// obtain a GtpClient instance. If the application runs several GTP engines,
+/// GtpEnginePool selects the GtpClient according to the command's
+/// @e engineAffinity, unless the command specifies a GtpClient explicitly
+/// (see @e gtpClient).
 ///
 /// GtpCommand can be executed synchronously (the default) or asynchronously.
 /// In the latter case, a target object and selector may be specified that
 /// are invoked when the response to the command has been received. This
 /// callback always occurs in the context of the thread that the command was
 /// submitted in.
+///
+/// A GtpCommand may have a deadline (see @e timeout) and a cancellation token
+/// (see @e cancellationToken). If the deadline passes, or if the token of a
+/// cancellable command (see @e cancellable) is cancelled, before the GTP
+/// engine has answered the command, GtpClient completes the command with a
+/// failure response whose parsed response is either "timeout" or
+/// "cancelled". If the engine is working on the command
+/// at that time, GtpClient interrupts the engine. The engine's response that
+/// arrives later is discarded.
 // -----------------------------------------------------------------------------
 @interface GtpCommand : NSObject
 {
@@ -72,5 +99,49 @@
 /// for this command is received. The selector must take a single GtpResponse*
 /// argument.
 @property(nonatomic, assign) SEL responseTargetSelector;
+/// @brief The number of seconds, measured from the time when the command is
+/// submitted, after which GtpClient gives up waiting for the GTP response.
+///
+/// The default for this property is 0, which means that there is no deadline.
+@property(nonatomic, assign) NSTimeInterval timeout;
+/// @brief The token that cancels this command.
+///
+/// The default for this property is the token that is bound to the thread in
+/// which the command is created (see GtpCancellationToken::currentToken()), or
+/// nil if no token is bound.
+@property(nonatomic, retain) GtpCancellationToken* cancellationToken;
+/// @brief True if the command is abandoned when its cancellation token is
+/// cancelled.
+///
+/// The default for this property is false. Only commands that do not change
+/// the state of the GTP engine (e.g. "final_status_list") should be
+/// cancellable, or commands after whose abandonment the engine is set up
+/// from scratch anyway. A command that is not cancellable is written to the
+/// engine and waited for even if its cancellation token has been cancelled,
+/// so that the engine does not get out of sync with the application. The
+/// deadline applies to all commands.
+@property(nonatomic, assign) bool cancellable;
+/// @brief True if the GTP engine may be interrupted while it works on this
+/// command, e.g. "genmove" when the user interrupts the computer (see
+/// GtpClient::interrupt()).
+///
+/// The default for this property is false. GtpClient writes an interruptible
+/// command only when no other command is in flight, and holds back later
+/// commands until the engine has answered it, so that an interrupt cannot
+/// stop a later command by accident. A command that has a deadline, or that
+/// is cancellable, is interrupted when it is abandoned, so GtpClient treats
+/// it as interruptible regardless of the value of this property.
+@property(nonatomic, assign) bool interruptible;
+/// @brief The kind of GTP engine that this command should be routed to.
+///
+/// The default for this property is #GtpEngineAffinityPlay. The property is
+/// ignored if @e gtpClient is not nil.
+@property(nonatomic, assign) enum GtpEngineAffinity engineAffinity;
+/// @brief The GtpClient that this command is submitted to.
+///
+/// The default for this property is nil, which means that GtpEnginePool
+/// selects the GtpClient when the command is submitted. submit() stores the
+/// selected GtpClient in this property.
+@property(nonatomic, retain) GtpClient* gtpClient;
 
 @end
@@ -17,6 +17,7 @@
 
 // Project includes
 #import "GtpCommand.h"
+#import "GtpCancellationToken.h"
 #import "GtpClient.h"
 #import "../main/ApplicationDelegate.h"
 
@@ -75,6 +76,12 @@
   self.response = nil;
   self.responseTarget = nil;
   self.responseTargetSelector = nil;
+  self.timeout = 0;
+  self.cancellationToken = [GtpCancellationToken currentToken];
+  self.cancellable = false;
+  self.interruptible = false;
+  self.engineAffinity = GtpEngineAffinityPlay;
+  self.gtpClient = nil;
 
   return self;
 }
@@ -89,6 +96,8 @@
   self.response = nil;
   self.responseTarget = nil;
   self.responseTargetSelector = nil;
+  self.cancellationToken = nil;
+  self.gtpClient = nil;
   [super dealloc];
 }
 
@@ -114,8 +123,9 @@
 - (void) submit
 {
   DDLogInfo(@"Submitting %@", self);
-  GtpClient* client = [ApplicationDelegate sharedDelegate].gtpClient;
-  [client submit:self];
+  if (! self.gtpClient)
+    self.gtpClient = [[ApplicationDelegate sharedDelegate].gtpEnginePool clientForCommand:self];
+  [self.gtpClient submit:self];
 }
 
 @end
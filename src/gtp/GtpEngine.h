@@ -16,16 +16,52 @@
 
 
 
+// This file is #import'ed from pure Objective-C implementations. C++ syntax
+// must be guarded by __cplusplus.
+
+#ifdef __cplusplus
+// Forward declarations
+class GtpChannel;
+#endif
+
+
 // -----------------------------------------------------------------------------
 /// @brief The GtpEngine class represents a Go Text Protocol (GTP) engine.
 ///
 /// @ingroup gtp
 ///
-/// GtpClient communicates with its counterpart GtpClient via named pipes.
-/// When GtpClient is instantiated using engineWithInputPipe:outputPipe:() it
-/// spawns a new secondary thread, then invokes the engine's main method, and
-/// finally blocks and waits for the engine's main method to return. It is
-/// expected that this happens when the engine receives a "quit" command.
+/// GtpEngine communicates with its counterpart GtpClient via named pipes.
+///
+/// When GtpEngine is instantiated it spawns a new secondary thread, then
+/// invokes the engine's main method, and finally blocks and waits for the
+/// engine's main method to return. It is expected that this happens when the
+/// engine receives a "quit" command.
+///
+/// Fuego initializes and finalizes process-wide state in its main function,
+/// including its debug stream, so only one instance of Fuego may run at any
+/// given time.
+///
+/// Fuego is started with --quiet, i.e. its debug output is discarded. While
+/// the engine searches with live graphics enabled (see
+/// GtpUtilities::startLiveGraphics()), the search progress hook is active
+/// (see startSearchProgressHook()): GtpEngine then extracts the live graphics
+/// blocks from the engine's debug output, discarding all other debug output
+/// (see GtpSearchProgressStreamBuffer), and posts them as GtpSearchProgress
+/// objects with #gtpSearchProgressWasReceivedNotification in the context of
+/// the main thread. The notification is throttled so that the main thread is
+/// not flooded.
+///
+/// Instead of the real GTP engine, GtpEngine can also run GtpReplayEngine,
+/// which answers commands from a recorded transcript (see
+/// engineWithReplayTranscript:()). The replay engine does not depend on
+/// Fuego, it is available even if the project is built with
+/// LITTLEGO_UNITTESTS. Unlike Fuego, the replay engine accepts the streams
+/// that it reads commands from and writes responses to, so it communicates
+/// with its counterpart GtpClient via an in-memory GtpChannel that is owned by
+/// the GtpEngine. The counterpart GtpClient must be created with
+/// GtpClient::clientWithInProcessChannelOfEngine:(). Because the replay engine
+/// does not touch any process-wide streams, any number of replay engines may
+/// run at the same time, each with its own channel.
 // -----------------------------------------------------------------------------
 @interface GtpEngine : NSObject
 {
@@ -35,5 +71,11 @@
 }
 
 + (GtpEngine*) engineWithInputPipe:(NSString*)inputPipe outputPipe:(NSString*)outputPipe;
++ (GtpEngine*) engineWithReplayTranscript:(NSString*)transcript;
+- (void) startSearchProgressHook;
+- (void) stopSearchProgressHook;
+#ifdef __cplusplus
+- (GtpChannel*) channel;
+#endif
 
 @end
@@ -17,14 +17,83 @@
 
 // Project includes
 #include "GtpEngine.h"
+#include "GtpChannel.h"
+#include "GtpReplayEngine.h"
+#include "GtpSearchProgress.h"
+#include "GtpSearchProgressStreamBuffer.h"
 
 // Fuego
 #ifndef LITTLEGO_UNITTESTS
 #include <fuego-on-ios/FuegoMainUtil.h>
+#include <fuego-on-ios/SgDebug.h>
 #endif
 
 // System includes
 #include <exception>
+#include <ostream>
+#include <string>
+
+/// @brief The minimum interval (in seconds) between two
+/// #gtpSearchProgressWasReceivedNotification. Live graphics blocks that the
+/// engine writes in the meantime are dropped.
+static const CFAbsoluteTime searchProgressMinimumInterval = 0.5;
+/// @brief The time at which the most recent live graphics block was accepted.
+/// Is accessed only by searchProgressCallback(), which is serialized by
+/// GtpSearchProgressStreamBuffer.
+static CFAbsoluteTime lastSearchProgressTime = 0;
+
+// -----------------------------------------------------------------------------
+/// @brief Is invoked by GtpSearchProgressStreamBuffer, in the context of one of
+/// the engine's threads, when the engine has written a live graphics block.
+/// Throttles the blocks, then delivers a GtpSearchProgress to the main thread.
+// -----------------------------------------------------------------------------
+static void searchProgressCallback(const std::string& gfxBlock, void* context)
+{
+  CFAbsoluteTime now = CFAbsoluteTimeGetCurrent();
+  if (now - lastSearchProgressTime < searchProgressMinimumInterval)
+    return;
+  lastSearchProgressTime = now;
+
+  // The engine's threads have no autorelease pool
+  NSAutoreleasePool* pool = [[NSAutoreleasePool alloc] init];
+  NSString* nsGfxBlock = [NSString stringWithCString:gfxBlock.c_str()
+                                            encoding:[NSString defaultCStringEncoding]];
+  GtpSearchProgress* searchProgress = [GtpSearchProgress searchProgressWithGfxBlock:nsGfxBlock];
+  GtpEngine* engine = (GtpEngine*)context;
+  [engine performSelectorOnMainThread:@selector(postSearchProgress:)
+                           withObject:searchProgress
+                        waitUntilDone:NO];
+  [pool drain];
+}
+
+
+// -----------------------------------------------------------------------------
+/// @brief Class extension with private properties for GtpEngine.
+// -----------------------------------------------------------------------------
+@interface GtpEngine()
+/// @name Private properties
+//@{
+/// @brief The transcript that GtpReplayEngine answers commands from. Is nil
+/// if the real GTP engine is used.
+@property(nonatomic, retain) NSString* replayTranscript;
+/// @brief The in-memory channel that this GtpEngine uses to communicate with
+/// its counterpart GtpClient. Is owned by this GtpEngine. Is 0 if the real GTP
+/// engine is used, which communicates via named pipes.
+@property(nonatomic, assign) GtpChannel* inProcessChannel;
+/// @brief The stream that the real GTP engine uses as its debug stream while
+/// the search progress hook is active. Is owned by this GtpEngine. Is 0 if
+/// GtpReplayEngine is used.
+@property(nonatomic, assign) std::ostream* searchProgressStream;
+/// @brief The buffer of @e searchProgressStream. Is owned by this GtpEngine.
+@property(nonatomic, assign) GtpSearchProgressStreamBuffer* searchProgressStreamBuffer;
+/// @brief The engine's debug stream that @e searchProgressStream replaces
+/// while the search progress hook is active.
+@property(nonatomic, assign) std::ostream* originalDebugStream;
+/// @brief The number of startSearchProgressHook() invocations that have not
+/// yet been balanced by stopSearchProgressHook().
+@property(nonatomic, assign) int searchProgressHookCount;
+//@}
+@end
 
 
 @implementation GtpEngine
@@ -38,21 +107,53 @@
   // Create copies so that the objects can be safely used by the thread when
   // it starts
   NSArray* pipes = [NSArray arrayWithObjects:[[inputPipe copy] autorelease], [[outputPipe copy] autorelease], nil];
-  return [[[GtpEngine alloc] initWithPipes:pipes] autorelease];
+  return [[[GtpEngine alloc] initWithPipes:pipes replayTranscript:nil] autorelease];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Convenience constructor. Creates a GtpEngine instance which runs
+/// GtpReplayEngine instead of the real GTP engine. The replay engine answers
+/// commands from @a transcript (see GtpReplayEngine for the format), and uses
+/// its own in-memory GtpChannel to communicate with its counterpart GtpClient.
+// -----------------------------------------------------------------------------
++ (GtpEngine*) engineWithReplayTranscript:(NSString*)transcript
+{
+  return [[[GtpEngine alloc] initWithPipes:nil
+                          replayTranscript:[[transcript copy] autorelease]] autorelease];
 }
 
 // -----------------------------------------------------------------------------
-/// @brief Initializes a GtpEngine object.
+/// @brief Initializes a GtpEngine object. If @a replayTranscript is nil, the
+/// GtpEngine runs the real GTP engine, which uses the named pipes in @a pipes.
+/// Otherwise the GtpEngine runs GtpReplayEngine, which uses a new in-memory
+/// GtpChannel, and @a pipes is ignored.
 ///
 /// @note This is the designated initializer of GtpEngine.
 // -----------------------------------------------------------------------------
-- (id) initWithPipes:(NSArray*)pipes
+- (id) initWithPipes:(NSArray*)pipes replayTranscript:(NSString*)replayTranscript
 {
   // Call designated initializer of superclass (NSObject)
   self = [super init];
   if (! self)
     return nil;
 
+  // Must be set before the thread starts
+  self.replayTranscript = replayTranscript;
+  if (replayTranscript)
+  {
+    self.inProcessChannel = new GtpChannel();
+    self.searchProgressStreamBuffer = 0;
+    self.searchProgressStream = 0;
+  }
+  else
+  {
+    self.inProcessChannel = 0;
+    self.searchProgressStreamBuffer = new GtpSearchProgressStreamBuffer(searchProgressCallback, self);
+    self.searchProgressStream = new std::ostream(self.searchProgressStreamBuffer);
+  }
+  self.originalDebugStream = 0;
+  self.searchProgressHookCount = 0;
+
   // Create and start the thread
   m_thread = [[NSThread alloc] initWithTarget:self selector:@selector(mainLoop:) object:pipes];
   [m_thread start];
@@ -71,6 +172,17 @@
 {
   // TODO implement stuff
   [m_thread release];
+  self.replayTranscript = nil;
+  // The secondary thread retains self, and so does a GtpClient that uses the
+  // channel, so neither of them can still be using the channel
+  delete _inProcessChannel;
+  _inProcessChannel = 0;
+  // Likewise, the engine's main method has returned, so the engine no longer
+  // writes to the search progress stream
+  delete _searchProgressStream;
+  _searchProgressStream = 0;
+  delete _searchProgressStreamBuffer;
+  _searchProgressStreamBuffer = 0;
   [super dealloc];
 }
 
@@ -83,6 +195,24 @@
   // Create an autorelease pool as the very first thing in this thread
   NSAutoreleasePool* mainPool = [[NSAutoreleasePool alloc] init];
 
+  if (self.replayTranscript)
+    [self runReplayEngine];
+  else
+    [self runEngineWithPipes:pipes];
+
+  // Deallocate the autorelease pool as the very last thing in this thread
+  [mainPool release];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Invokes the GTP engine's main method so that the engine uses the
+/// named pipes in @a pipes. Returns only after the engine's main method
+/// returns.
+///
+/// This is a private helper for mainLoop:().
+// -----------------------------------------------------------------------------
+- (void) runEngineWithPipes:(NSArray*)pipes
+{
   // Pipe to read commands from the GTP client
   NSString* inputPipePath = [pipes objectAtIndex:0];
   const char* pchInputPipePath = [inputPipePath cStringUsingEncoding:[NSString defaultCStringEncoding]];
@@ -129,9 +259,116 @@
   catch(...)
   {
   }
+}
 
-  // Deallocate the autorelease pool as the very last thing in this thread
-  [mainPool release];
+// -----------------------------------------------------------------------------
+/// @brief Runs GtpReplayEngine so that it uses the in-memory GtpChannel of
+/// this GtpEngine. Returns only after the replay engine has
+/// received the "quit" command.
+///
+/// This is a private helper for mainLoop:().
+// -----------------------------------------------------------------------------
+- (void) runReplayEngine
+{
+  GtpChannel& channel = *self.inProcessChannel;
+  std::string transcript = [self.replayTranscript UTF8String];
+
+  try
+  {
+    GtpReplayEngine replayEngine(transcript);
+    replayEngine.run(channel.engineCommandStream(), channel.engineResponseStream());
+  }
+  catch(std::exception& e)
+  {
+  }
+  catch(...)
+  {
+  }
+
+  // The client must not wait forever for responses that will never come
+  channel.close();
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns the in-memory GtpChannel that this GtpEngine uses to
+/// communicate with its counterpart GtpClient. Returns 0 if this GtpEngine
+/// runs the real GTP engine, which uses named pipes.
+///
+/// The channel is owned by this GtpEngine. It remains valid for as long as the
+/// GtpEngine lives.
+// -----------------------------------------------------------------------------
+- (GtpChannel*) channel
+{
+  return self.inProcessChannel;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Makes the real GTP engine write its debug output to a stream that
+/// extracts the live graphics blocks (see GtpSearchProgressStreamBuffer), so
+/// that GtpEngine can report the progress of the engine's search. Does
+/// nothing if this GtpEngine runs GtpReplayEngine.
+///
+/// Invocations of this method must be balanced by invocations of
+/// stopSearchProgressHook(). Invocations may be nested, the hook remains
+/// active until the outermost invocation is balanced.
+///
+/// The hook should be active only while live graphics are enabled (see
+/// GtpUtilities::startLiveGraphics()). At all other times the engine writes
+/// its debug output to the debug stream that the engine has set up itself,
+/// which discards the output because the engine is started with --quiet.
+///
+/// This method may be invoked from any thread.
+// -----------------------------------------------------------------------------
+- (void) startSearchProgressHook
+{
+  if (! self.searchProgressStream)
+    return;
+  @synchronized(self)
+  {
+    self.searchProgressHookCount++;
+    if (1 != self.searchProgressHookCount)
+      return;
+#ifndef LITTLEGO_UNITTESTS
+    self.originalDebugStream = SgSwapDebugStr(self.searchProgressStream);
+#endif
+  }
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Balances an invocation of startSearchProgressHook(). Restores the
+/// engine's original debug stream when the outermost invocation of
+/// startSearchProgressHook() is balanced.
+///
+/// This method may be invoked from any thread.
+// -----------------------------------------------------------------------------
+- (void) stopSearchProgressHook
+{
+  if (! self.searchProgressStream)
+    return;
+  @synchronized(self)
+  {
+    if (self.searchProgressHookCount <= 0)
+      return;
+    self.searchProgressHookCount--;
+    if (0 != self.searchProgressHookCount)
+      return;
+#ifndef LITTLEGO_UNITTESTS
+    SgSwapDebugStr(self.originalDebugStream);
+#endif
+    self.originalDebugStream = 0;
+  }
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Posts #gtpSearchProgressWasReceivedNotification with
+/// @a searchProgress. Is invoked in the context of the main thread.
+///
+/// This is a private helper for searchProgressCallback().
+// -----------------------------------------------------------------------------
+- (void) postSearchProgress:(GtpSearchProgress*)searchProgress
+{
+  [[NSNotificationCenter defaultCenter] postNotificationName:gtpSearchProgressWasReceivedNotification
+                                                      object:searchProgress];
 }
 
 @end
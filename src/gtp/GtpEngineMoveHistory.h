@@ -0,0 +1,72 @@
+// -----------------------------------------------------------------------------
+// Copyright 2014 Patrick Näf (herzbube@herzbube.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// -----------------------------------------------------------------------------
+
+
+
+// Forward declarations
+@class GtpCommand;
+@class GtpResponse;
+
+
+// -----------------------------------------------------------------------------
+/// @brief The GtpEngineMoveHistory class keeps track of the board size, the
+/// komi, the handicap and the moves that the GTP engine currently has on its
+/// board.
+///
+/// @ingroup gtp
+///
+/// GtpClient feeds every GtpResponse that it receives into
+/// updateWithResponse:(). GtpEngineMoveHistory interprets successful commands
+/// that are known to change the engine's board (e.g. "play", "genmove",
+/// "undo", "clear_board") and updates its record accordingly. Any command
+/// whose effect on the board cannot be reproduced (e.g. "loadsgf", or a failed
+/// "gogui-play_sequence") causes the record to become unknown. The record
+/// becomes known again the next time the engine clears its board.
+///
+/// Alternatively, a GtpEngineMoveHistory can be fed every GtpCommand when it
+/// is submitted, using updateWithSubmittedCommand:(). It then describes the
+/// board that the engine will have once it has processed all submitted
+/// commands, assuming that they succeed. The owner must invoke invalidate()
+/// if one of the commands fails or is abandoned.
+///
+/// Moves are recorded as strings in the normalized form "<color> <vertex>",
+/// e.g. "B D4" or "W PASS", so that they can be compared directly to the moves
+/// of a GoGame. deltaToBoardSize:komi:handicap:moves:numberOfCommonMoves:numberOfMovesToUndo:()
+/// uses the record to find out which moves must be taken back and which moves
+/// must be played to bring the engine's board into a desired state.
+///
+/// GtpEngineMoveHistory is thread-safe. It is updated in the context of the
+/// GtpClient's secondary thread, while it is usually queried in the context of
+/// the main thread.
+// -----------------------------------------------------------------------------
+@interface GtpEngineMoveHistory : NSObject
+{
+}
+
+- (void) updateWithResponse:(GtpResponse*)response;
+- (void) updateWithSubmittedCommand:(GtpCommand*)command;
+- (void) invalidate;
+- (NSArray*) movesIfHandicapIs:(NSUInteger)handicap;
+- (bool) deltaToBoardSize:(int)boardSize
+                     komi:(double)komi
+                 handicap:(NSUInteger)handicap
+                    moves:(NSArray*)moveStrings
+      numberOfCommonMoves:(NSUInteger*)numberOfCommonMoves
+      numberOfMovesToUndo:(NSUInteger*)numberOfMovesToUndo;
+
++ (NSString*) moveStringWithColor:(NSString*)color vertex:(NSString*)vertex;
+
+@end
@@ -0,0 +1,346 @@
+// -----------------------------------------------------------------------------
+// Copyright 2014 Patrick Näf (herzbube@herzbube.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// -----------------------------------------------------------------------------
+
+
+
+// Project includes
+#import "GtpEngineMoveHistory.h"
+#import "GtpCommand.h"
+#import "GtpResponse.h"
+
+
+// -----------------------------------------------------------------------------
+/// @brief Class extension with private properties for GtpEngineMoveHistory.
+// -----------------------------------------------------------------------------
+@interface GtpEngineMoveHistory()
+/// @brief True if the content of the GTP engine's board is known.
+@property(nonatomic, assign) bool known;
+/// @brief The board size that the GTP engine was set up with using
+/// "boardsize", or 0 if the board size is unknown.
+@property(nonatomic, assign) int boardSize;
+/// @brief True if the komi that the GTP engine was set up with is known.
+@property(nonatomic, assign) bool komiKnown;
+/// @brief The komi that the GTP engine was set up with using "komi". Is
+/// meaningful only if @e komiKnown is true.
+@property(nonatomic, assign) double komi;
+/// @brief The number of handicap stones that the GTP engine placed with
+/// "fixed_handicap". Is meaningful only if @e known is true.
+@property(nonatomic, assign) NSUInteger handicap;
+/// @brief The moves that the GTP engine currently has on its board, in the
+/// order in which they were played. Is meaningful only if @e known is true.
+@property(nonatomic, retain) NSMutableArray* moves;
+@end
+
+
+@implementation GtpEngineMoveHistory
+
+// -----------------------------------------------------------------------------
+/// @brief Initializes a GtpEngineMoveHistory object. The content of the GTP
+/// engine's board is initially unknown.
+///
+/// @note This is the designated initializer of GtpEngineMoveHistory.
+// -----------------------------------------------------------------------------
+- (id) init
+{
+  // Call designated initializer of superclass (NSObject)
+  self = [super init];
+  if (! self)
+    return nil;
+  self.known = false;
+  self.boardSize = 0;
+  self.komiKnown = false;
+  self.komi = 0.0;
+  self.handicap = 0;
+  self.moves = [NSMutableArray arrayWithCapacity:0];
+  return self;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Deallocates memory allocated by this GtpEngineMoveHistory object.
+// -----------------------------------------------------------------------------
+- (void) dealloc
+{
+  self.moves = nil;
+  [super dealloc];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Updates the record of the GTP engine's board with the effect of the
+/// command that @a response belongs to.
+///
+/// This method is invoked by GtpClient in the context of its secondary thread.
+// -----------------------------------------------------------------------------
+- (void) updateWithResponse:(GtpResponse*)response
+{
+  [self updateWithCommand:response.command.command response:response];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Updates the record of the GTP engine's board with the effect that
+/// @a command will have when the engine processes it, assuming that the
+/// command succeeds. Commands whose effect depends on the engine's response
+/// (e.g. "genmove") cause the record to become unknown.
+///
+/// This method is invoked by GtpClient when @a command is submitted, in the
+/// context of the submitting thread.
+// -----------------------------------------------------------------------------
+- (void) updateWithSubmittedCommand:(GtpCommand*)command
+{
+  [self updateWithCommand:command.command response:nil];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Updates the record of the GTP engine's board with the effect of
+/// @a commandString. If @a response is nil, the command is assumed to
+/// succeed.
+///
+/// This is a private helper for updateWithResponse:() and
+/// updateWithSubmittedCommand:().
+// -----------------------------------------------------------------------------
+- (void) updateWithCommand:(NSString*)commandString response:(GtpResponse*)response
+{
+  NSArray* arguments = [self argumentsOfCommand:commandString];
+  if (0 == arguments.count)
+    return;
+  NSString* commandName = [arguments objectAtIndex:0];
+  bool status = (response ? response.status : true);
+  @synchronized(self)
+  {
+    if ([commandName isEqualToString:@"clear_board"])
+    {
+      if (status)
+        [self resetToEmptyBoard];
+      else
+        self.known = false;
+    }
+    else if ([commandName isEqualToString:@"boardsize"])
+    {
+      if (status && 2 == arguments.count)
+      {
+        [self resetToEmptyBoard];
+        self.boardSize = [[arguments objectAtIndex:1] intValue];
+      }
+      else
+      {
+        self.known = false;
+        self.boardSize = 0;
+      }
+    }
+    else if ([commandName isEqualToString:@"komi"])
+    {
+      // Komi does not affect the content of the board
+      self.komiKnown = (status && 2 == arguments.count);
+      if (self.komiKnown)
+        self.komi = [[arguments objectAtIndex:1] doubleValue];
+    }
+    else if ([commandName isEqualToString:@"fixed_handicap"])
+    {
+      // Fuego accepts handicap only on an empty board
+      if (status && self.known && 0 == self.moves.count && 0 == self.handicap && 2 == arguments.count)
+        self.handicap = [[arguments objectAtIndex:1] intValue];
+      else
+        self.known = false;
+    }
+    else if ([commandName isEqualToString:@"play"])
+    {
+      // A failed "play" leaves the board unchanged
+      if (status && 3 == arguments.count)
+      {
+        [self.moves addObject:[GtpEngineMoveHistory moveStringWithColor:[arguments objectAtIndex:1]
+                                                                 vertex:[arguments objectAtIndex:2]]];
+      }
+    }
+    else if ([commandName isEqualToString:@"genmove"] ||
+             [commandName isEqualToString:@"kgs-genmove_cleanup"])
+    {
+      if (! response)
+      {
+        // The move is not known until the engine has generated it
+        self.known = false;
+      }
+      else if (status && 2 == arguments.count)
+      {
+        NSString* vertex = [response parsedResponse];
+        if (NSOrderedSame != [vertex caseInsensitiveCompare:@"resign"])
+        {
+          [self.moves addObject:[GtpEngineMoveHistory moveStringWithColor:[arguments objectAtIndex:1]
+                                                                   vertex:vertex]];
+        }
+      }
+    }
+    else if ([commandName isEqualToString:@"undo"])
+    {
+      // A failed "undo" leaves the board unchanged
+      if (status && self.moves.count > 0)
+        [self.moves removeLastObject];
+    }
+    else if ([commandName isEqualToString:@"gogui-play_sequence"])
+    {
+      // A failed sequence may have been partially played
+      if (status && 1 == arguments.count % 2)
+      {
+        for (NSUInteger indexOfArgument = 1; indexOfArgument < arguments.count; indexOfArgument += 2)
+        {
+          [self.moves addObject:[GtpEngineMoveHistory moveStringWithColor:[arguments objectAtIndex:indexOfArgument]
+                                                                   vertex:[arguments objectAtIndex:indexOfArgument + 1]]];
+        }
+      }
+      else
+      {
+        self.known = false;
+      }
+    }
+    else if ([commandName isEqualToString:@"loadsgf"])
+    {
+      // The game record may specify any board size and komi
+      self.known = false;
+      self.boardSize = 0;
+      self.komiKnown = false;
+    }
+    else if ([commandName isEqualToString:@"set_free_handicap"] ||
+             [commandName isEqualToString:@"place_free_handicap"] ||
+             [commandName isEqualToString:@"gogui-setup"] ||
+             [commandName isEqualToString:@"gg-undo"])
+    {
+      self.known = false;
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Marks the content of the GTP engine's board as unknown.
+// -----------------------------------------------------------------------------
+- (void) invalidate
+{
+  @synchronized(self)
+  {
+    self.known = false;
+  }
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns the moves that the GTP engine currently has on its board,
+/// in the order in which they were played. Returns nil if the content of the
+/// GTP engine's board is unknown, or if the engine's handicap differs from
+/// @a handicap.
+// -----------------------------------------------------------------------------
+- (NSArray*) movesIfHandicapIs:(NSUInteger)handicap
+{
+  @synchronized(self)
+  {
+    if (! self.known || handicap != self.handicap)
+      return nil;
+    return [NSArray arrayWithArray:self.moves];
+  }
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Finds out how the GTP engine's board can be brought into the state
+/// that is described by @a boardSize, @a komi, @a handicap and
+/// @a moveStrings by taking back and playing moves. @a moveStrings is expected
+/// to contain moves in the normalized form (e.g. "B D4").
+///
+/// Returns true if this is possible. In that case fills the out parameter
+/// @a numberOfCommonMoves with the number of moves at the beginning of
+/// @a moveStrings that the engine already has on its board, and the out
+/// parameter @a numberOfMovesToUndo with the number of moves that must be
+/// taken back before the moves in @a moveStrings that follow the common moves
+/// can be played.
+///
+/// Returns false if the engine's board must be cleared and set up from
+/// scratch. This is the case if the content of the engine's board is unknown,
+/// if the engine's board size, komi or handicap differ from @a boardSize,
+/// @a komi or @a handicap, or if taking back and playing moves is more
+/// expensive than replaying all moves in @a moveStrings. The out parameters
+/// are not filled in this case.
+// -----------------------------------------------------------------------------
+- (bool) deltaToBoardSize:(int)boardSize
+                     komi:(double)komi
+                 handicap:(NSUInteger)handicap
+                    moves:(NSArray*)moveStrings
+      numberOfCommonMoves:(NSUInteger*)numberOfCommonMoves
+      numberOfMovesToUndo:(NSUInteger*)numberOfMovesToUndo
+{
+  @synchronized(self)
+  {
+    if (! self.known || boardSize != self.boardSize || ! self.komiKnown || komi != self.komi || handicap != self.handicap)
+      return false;
+
+    NSUInteger numberOfMovesInCommon = 0;
+    while (numberOfMovesInCommon < self.moves.count &&
+           numberOfMovesInCommon < moveStrings.count &&
+           [[self.moves objectAtIndex:numberOfMovesInCommon] isEqualToString:[moveStrings objectAtIndex:numberOfMovesInCommon]])
+    {
+      ++numberOfMovesInCommon;
+    }
+    NSUInteger numberOfMovesToTakeBack = self.moves.count - numberOfMovesInCommon;
+    NSUInteger numberOfMovesToPlay = moveStrings.count - numberOfMovesInCommon;
+    // A full synchronization replays all moves
+    if (numberOfMovesToTakeBack + numberOfMovesToPlay > moveStrings.count)
+      return false;
+
+    *numberOfCommonMoves = numberOfMovesInCommon;
+    *numberOfMovesToUndo = numberOfMovesToTakeBack;
+    return true;
+  }
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns a move string in the normalized form that
+/// GtpEngineMoveHistory uses to record moves. @a color and @a vertex are
+/// expected to be GTP color and vertex arguments in any of the forms that GTP
+/// allows (e.g. "b", "B" or "black", "d4" or "D4").
+// -----------------------------------------------------------------------------
++ (NSString*) moveStringWithColor:(NSString*)color vertex:(NSString*)vertex
+{
+  NSString* normalizedColor;
+  if ([color hasPrefix:@"b"] || [color hasPrefix:@"B"])
+    normalizedColor = @"B";
+  else
+    normalizedColor = @"W";
+  return [NSString stringWithFormat:@"%@ %@", normalizedColor, [vertex uppercaseString]];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Splits @a command into the command name and its arguments.
+///
+/// This is a private helper.
+// -----------------------------------------------------------------------------
+- (NSArray*) argumentsOfCommand:(NSString*)command
+{
+  NSArray* components = [command componentsSeparatedByCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+  NSMutableArray* arguments = [NSMutableArray arrayWithCapacity:components.count];
+  for (NSString* component in components)
+  {
+    if (component.length > 0)
+      [arguments addObject:component];
+  }
+  return arguments;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Records that the GTP engine's board is known to be empty.
+///
+/// This is a private helper.
+// -----------------------------------------------------------------------------
+- (void) resetToEmptyBoard
+{
+  self.known = true;
+  self.handicap = 0;
+  [self.moves removeAllObjects];
+}
+
+@end
@@ -0,0 +1,81 @@
+// -----------------------------------------------------------------------------
+// Copyright 2014 Patrick Näf (herzbube@herzbube.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// -----------------------------------------------------------------------------
+
+
+
+// Forward declarations
+@class GtpCancellationToken;
+@class GtpClient;
+@class GtpCommand;
+@class GtpEngine;
+
+
+// -----------------------------------------------------------------------------
+/// @brief The GtpEnginePool class manages the GtpClient/GtpEngine pairs of
+/// the application and routes GtpCommand objects to them.
+///
+/// @ingroup gtp
+///
+/// The pool always contains the play engine, i.e. the engine that holds the
+/// game and that generates the computer player's moves. In addition the pool
+/// may contain any number of analysis engines. Each engine has its own
+/// GtpClient, its own transport and its own thread, so commands sent to
+/// different engines are processed concurrently.
+///
+/// Only one instance of Fuego can run in the process (see GtpEngine), so in
+/// production the pool contains only the play engine, and every command goes
+/// to it. Analysis engines are GtpReplayEngine instances. They exist only if
+/// the application is launched with a replay transcript, or in unit tests.
+///
+/// GtpCommand::submit() asks the pool for a GtpClient with
+/// clientForCommand:(). Commands with #GtpEngineAffinityPlay always go to the
+/// play engine. Commands with #GtpEngineAffinityAnalysis go to the analysis
+/// engine that currently has the fewest outstanding commands. If the pool has
+/// no analysis engines, the pool is a pass-through: All commands go to the
+/// play engine without any client selection, locking or synchronization
+/// checks, so that the application behaves as if there were no pool.
+///
+/// Analysis engines do not follow the game. A client that wants to query an
+/// analysis engine about a position submits its command with
+/// submitCommand:atBoardSize:komi:handicap:moves:(), which synchronizes the
+/// engine to the position on demand and submits the command in the same
+/// step.
+///
+/// GtpEnginePool is thread-safe.
+// -----------------------------------------------------------------------------
+@interface GtpEnginePool : NSObject
+{
+}
+
+- (id) initWithPlayClient:(GtpClient*)playClient playEngine:(GtpEngine*)playEngine;
+- (void) addAnalysisClient:(GtpClient*)analysisClient analysisEngine:(GtpEngine*)analysisEngine;
+- (GtpClient*) clientForCommand:(GtpCommand*)command;
+- (void) submitCommand:(GtpCommand*)command
+           atBoardSize:(int)boardSize
+                  komi:(double)komi
+              handicap:(NSUInteger)handicap
+                 moves:(NSArray*)moveStrings;
+- (void) abandonCommandsWithCancellationToken:(GtpCancellationToken*)cancellationToken;
+
+/// @brief The GtpClient of the play engine.
+@property(retain, readonly) GtpClient* playClient;
+/// @brief The GtpClient objects of the analysis engines. The array is empty if
+/// the pool has no analysis engines.
+@property(retain, readonly) NSArray* analysisClients;
+/// @brief True if the pool has at least one analysis engine.
+@property(assign, readonly) bool hasAnalysisClients;
+
+@end
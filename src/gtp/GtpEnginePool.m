@@ -0,0 +1,307 @@
+// -----------------------------------------------------------------------------
+// Copyright 2014 Patrick Näf (herzbube@herzbube.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// -----------------------------------------------------------------------------
+
+
+
+// Project includes
+#import "GtpEnginePool.h"
+#import "GtpClient.h"
+#import "GtpCommand.h"
+#import "GtpEngineMoveHistory.h"
+
+
+// -----------------------------------------------------------------------------
+/// @brief Class extension with private properties for GtpEnginePool.
+// -----------------------------------------------------------------------------
+@interface GtpEnginePool()
+/// @name Re-declaration of properties to make them readwrite privately
+//@{
+@property(retain, readwrite) GtpClient* playClient;
+@property(retain, readwrite) NSArray* analysisClients;
+@property(assign, readwrite) bool hasAnalysisClients;
+//@}
+/// @name Private properties
+//@{
+/// @brief The GtpEngine objects of all engines in the pool. GtpEnginePool
+/// retains them so that they live as long as their clients.
+@property(retain) NSMutableArray* engines;
+/// @brief Keys are NSValue objects that wrap a GtpClient of an analysis
+/// engine, values are NSLock objects that serialize the submission of
+/// commands with submitCommand:atBoardSize:komi:handicap:moves:().
+@property(retain) NSMutableDictionary* analysisClientLocks;
+//@}
+@end
+
+
+@implementation GtpEnginePool
+
+// -----------------------------------------------------------------------------
+/// @brief Initializes a GtpEnginePool object that contains only the play
+/// engine @a playEngine, whose GtpClient is @a playClient.
+///
+/// @note This is the designated initializer of GtpEnginePool.
+// -----------------------------------------------------------------------------
+- (id) initWithPlayClient:(GtpClient*)playClient playEngine:(GtpEngine*)playEngine
+{
+  // Call designated initializer of superclass (NSObject)
+  self = [super init];
+  if (! self)
+    return nil;
+
+  self.playClient = playClient;
+  self.analysisClients = [NSArray array];
+  self.hasAnalysisClients = false;
+  self.engines = [NSMutableArray arrayWithObject:playEngine];
+  self.analysisClientLocks = [NSMutableDictionary dictionaryWithCapacity:0];
+
+  return self;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Deallocates memory allocated by this GtpEnginePool object.
+// -----------------------------------------------------------------------------
+- (void) dealloc
+{
+  self.playClient = nil;
+  self.analysisClients = nil;
+  self.engines = nil;
+  self.analysisClientLocks = nil;
+  [super dealloc];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Adds the analysis engine @a analysisEngine, whose GtpClient is
+/// @a analysisClient, to the pool.
+///
+/// Analysis engines must be added before the first command is submitted to
+/// them. The GtpClient of an analysis engine starts to keep track of the
+/// engine's queued move history (see GtpClient::queuedEngineMoveHistory).
+// -----------------------------------------------------------------------------
+- (void) addAnalysisClient:(GtpClient*)analysisClient analysisEngine:(GtpEngine*)analysisEngine
+{
+  analysisClient.queuedEngineMoveHistory = [[[GtpEngineMoveHistory alloc] init] autorelease];
+  @synchronized(self)
+  {
+    self.analysisClients = [self.analysisClients arrayByAddingObject:analysisClient];
+    [self.engines addObject:analysisEngine];
+    [self.analysisClientLocks setObject:[[[NSLock alloc] init] autorelease]
+                                 forKey:[NSValue valueWithNonretainedObject:analysisClient]];
+    self.hasAnalysisClients = true;
+  }
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns the GtpClient that @a command should be submitted to,
+/// according to the command's engine affinity. See the class documentation
+/// for details.
+// -----------------------------------------------------------------------------
+- (GtpClient*) clientForCommand:(GtpCommand*)command
+{
+  if (GtpEngineAffinityAnalysis == command.engineAffinity && self.hasAnalysisClients)
+    return [self leastBusyAnalysisClient];
+  return self.playClient;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Submits @a command to an analysis engine whose board is set up with
+/// the position that is described by @a boardSize, @a komi, @a handicap and
+/// @a moveStrings. @a moveStrings is expected to contain moves in the form
+/// used by GtpEngineMoveHistory (e.g. "B D4"). Stores the GtpClient of the
+/// engine in @a command's @e gtpClient property.
+///
+/// If the engine is not yet set up with the position, the GTP commands that
+/// set up the position are submitted first, without waiting for their
+/// response. The setup commands carry the same cancellation token as
+/// @a command, and they are cancellable. If one of them is abandoned, the
+/// engine's queued move history becomes unknown, so the next query sets up
+/// the engine from scratch, starting with "boardsize". The setup commands and @a command are submitted while the
+/// engine's GtpClient is reserved for the caller, so the commands of several
+/// callers that query different positions concurrently do not interleave.
+///
+/// If the pool has no analysis engines, @a command is submitted to the
+/// GtpClient of the play engine, which is always synchronized by the
+/// application, and no setup commands are submitted.
+// -----------------------------------------------------------------------------
+- (void) submitCommand:(GtpCommand*)command
+           atBoardSize:(int)boardSize
+                  komi:(double)komi
+              handicap:(NSUInteger)handicap
+                 moves:(NSArray*)moveStrings
+{
+  if (! self.hasAnalysisClients)
+  {
+    command.gtpClient = self.playClient;
+    [command submit];
+    return;
+  }
+  [self submitCommandToAnalysisClient:command
+                          atBoardSize:boardSize
+                                 komi:komi
+                             handicap:handicap
+                                moves:moveStrings];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Submits @a command to the least busy analysis engine, after setting
+/// up the engine with the position that is described by @a boardSize,
+/// @a komi, @a handicap and @a moveStrings if necessary.
+///
+/// This is a private helper for
+/// submitCommand:atBoardSize:komi:handicap:moves:(). It must only be invoked
+/// if the pool has analysis engines.
+// -----------------------------------------------------------------------------
+- (void) submitCommandToAnalysisClient:(GtpCommand*)command
+                           atBoardSize:(int)boardSize
+                                  komi:(double)komi
+                              handicap:(NSUInteger)handicap
+                                 moves:(NSArray*)moveStrings
+{
+  GtpClient* client;
+  NSLock* clientLock;
+  @synchronized(self)
+  {
+    client = [self leastBusyAnalysisClient];
+    clientLock = [self.analysisClientLocks objectForKey:[NSValue valueWithNonretainedObject:client]];
+  }
+  command.gtpClient = client;
+
+  // If the command is synchronous the client remains reserved until the
+  // command has been answered. This does not hold up other callers more than
+  // necessary because the engine processes commands one after the other
+  // anyway.
+  [clientLock lock];
+  @try
+  {
+    if (! [self isClient:client syncedToBoardSize:boardSize komi:komi handicap:handicap moves:moveStrings])
+    {
+      GtpCancellationToken* cancellationToken = command.cancellationToken;
+      // "boardsize" also clears the board, so the engine is in a known state
+      // no matter what it was doing before
+      [self submitAsynchronousCommand:[NSString stringWithFormat:@"boardsize %d", boardSize]
+                             toClient:client
+                    cancellationToken:cancellationToken];
+      [self submitAsynchronousCommand:[NSString stringWithFormat:@"komi %.1f", komi]
+                             toClient:client
+                    cancellationToken:cancellationToken];
+      if (handicap > 0)
+      {
+        [self submitAsynchronousCommand:[NSString stringWithFormat:@"fixed_handicap %lu", (unsigned long)handicap]
+                               toClient:client
+                      cancellationToken:cancellationToken];
+      }
+      if (moveStrings.count > 0)
+      {
+        NSString* commandString = [@"gogui-play_sequence " stringByAppendingString:[moveStrings componentsJoinedByString:@" "]];
+        [self submitAsynchronousCommand:commandString toClient:client cancellationToken:cancellationToken];
+      }
+    }
+    [command submit];
+  }
+  @finally
+  {
+    [clientLock unlock];
+  }
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Abandons the commands that carry @a cancellationToken on all engines
+/// in the pool. See GtpClient::abandonCommandsWithCancellationToken:().
+// -----------------------------------------------------------------------------
+- (void) abandonCommandsWithCancellationToken:(GtpCancellationToken*)cancellationToken
+{
+  [self.playClient abandonCommandsWithCancellationToken:cancellationToken];
+  if (! self.hasAnalysisClients)
+    return;
+  for (GtpClient* analysisClient in self.analysisClients)
+    [analysisClient abandonCommandsWithCancellationToken:cancellationToken];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns the GtpClient of the analysis engine with the fewest
+/// outstanding commands, or the GtpClient of the play engine if the pool has
+/// no analysis engines.
+///
+/// This is a private helper.
+// -----------------------------------------------------------------------------
+- (GtpClient*) leastBusyAnalysisClient
+{
+  GtpClient* leastBusyClient = self.playClient;
+  int leastNumberOfOutstandingCommands = 0;
+  for (GtpClient* analysisClient in self.analysisClients)
+  {
+    int numberOfOutstandingCommands = analysisClient.numberOfOutstandingCommands;
+    if (leastBusyClient == self.playClient || numberOfOutstandingCommands < leastNumberOfOutstandingCommands)
+    {
+      leastBusyClient = analysisClient;
+      leastNumberOfOutstandingCommands = numberOfOutstandingCommands;
+    }
+  }
+  return leastBusyClient;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns true if the board of the GTP engine of @a client is known to
+/// be set up with the position that is described by @a boardSize, @a komi,
+/// @a handicap and @a moveStrings, once the engine has processed all commands
+/// that were submitted so far.
+///
+/// The check uses the queued engine move history, which is updated when a
+/// command is submitted, not when it is answered. A query about the same
+/// position can therefore be queued behind the commands that an engine is
+/// still working on, without setting up the position again.
+///
+/// This is a private helper.
+// -----------------------------------------------------------------------------
+- (bool) isClient:(GtpClient*)client
+syncedToBoardSize:(int)boardSize
+             komi:(double)komi
+         handicap:(NSUInteger)handicap
+            moves:(NSArray*)moveStrings
+{
+  NSUInteger numberOfCommonMoves;
+  NSUInteger numberOfMovesToUndo;
+  if (! [client.queuedEngineMoveHistory deltaToBoardSize:boardSize
+                                              komi:komi
+                                          handicap:handicap
+                                             moves:moveStrings
+                               numberOfCommonMoves:&numberOfCommonMoves
+                               numberOfMovesToUndo:&numberOfMovesToUndo])
+  {
+    return false;
+  }
+  return (0 == numberOfMovesToUndo && moveStrings.count == numberOfCommonMoves);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Submits a cancellable GtpCommand with the command string
+/// @a commandString and the cancellation token @a cancellationToken to
+/// @a client, without waiting for the response.
+///
+/// This is a private helper.
+// -----------------------------------------------------------------------------
+- (void) submitAsynchronousCommand:(NSString*)commandString
+                          toClient:(GtpClient*)client
+                 cancellationToken:(GtpCancellationToken*)cancellationToken
+{
+  GtpCommand* command = [GtpCommand command:commandString];
+  command.waitUntilDone = false;
+  command.gtpClient = client;
+  command.cancellationToken = cancellationToken;
+  command.cancellable = true;
+  [command submit];
+}
+
+@end
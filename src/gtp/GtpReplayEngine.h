@@ -0,0 +1,133 @@
+// -----------------------------------------------------------------------------
+// Copyright 2014 Patrick Näf (herzbube@herzbube.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// -----------------------------------------------------------------------------
+
+
+
+
+// This file contains C++ syntax. It must be #include'd only by Objective-C++
+// implementations.
+
+// System includes
+#include <istream>
+#include <map>
+#include <ostream>
+#include <set>
+#include <string>
+#include <vector>
+
+
+// -----------------------------------------------------------------------------
+/// @brief The GtpReplayEngine class is a stand-in for the GTP engine that
+/// answers commands from a recorded transcript instead of computing answers.
+///
+/// @ingroup gtp
+///
+/// GtpReplayEngine reads GTP commands from a command stream and writes GTP
+/// responses to a response stream, in the same way that the real engine does.
+/// It can therefore be used with any transport that GtpClient supports. The
+/// responses are taken from a transcript such as the one that GtpLogModel
+/// records. Because GtpReplayEngine does not depend on Fuego, it can be used
+/// to benchmark and stress the client side of the GTP communication in a
+/// reproducible way.
+///
+/// The transcript consists of blocks that are separated by empty lines. The
+/// first line of a block is a command, the remaining lines are the raw
+/// response to that command, including the status prefix. Example:
+/// @verbatim
+/// boardsize 19
+/// =
+///
+/// genmove b
+/// = Q16
+///
+/// @endverbatim
+///
+/// When a command appears several times in the transcript, its responses are
+/// replayed in the order in which they were recorded. Once all recorded
+/// responses have been used up, the last one is repeated. A command that does
+/// not appear in the transcript is answered with an error response, except for
+/// "quit", which is always answered successfully.
+///
+/// Before it writes a response, GtpReplayEngine waits for a configurable
+/// latency plus or minus a random jitter, both in seconds. The transcript can
+/// configure these with directive lines, which may appear anywhere in the
+/// transcript. The first form sets the default for all commands, the second
+/// form overrides the default for commands with a given name:
+/// @verbatim
+/// # latency 0.05 0.01
+/// # latency genmove 2.0 0.5
+/// @endverbatim
+///
+/// To exercise the client's handling of protocol errors, directive lines can
+/// also make GtpReplayEngine lose the responses to commands with a given name,
+/// or send the responses to such commands twice:
+/// @verbatim
+/// # drop genmove
+/// # duplicate play
+/// @endverbatim
+///
+/// Other lines that start with "#" are comments and are ignored. The random
+/// numbers for the jitter are generated from a fixed seed, so the same
+/// sequence of commands always experiences the same sequence of delays.
+// -----------------------------------------------------------------------------
+class GtpReplayEngine
+{
+public:
+  explicit GtpReplayEngine(const std::string& transcript);
+
+  void setLatency(double latency, double jitter);
+  void setLatencyForCommand(const std::string& commandName, double latency, double jitter);
+  void run(std::istream& commandStream, std::ostream& responseStream);
+
+private:
+  GtpReplayEngine(const GtpReplayEngine&);
+  GtpReplayEngine& operator=(const GtpReplayEngine&);
+
+  /// @brief The recorded responses to one command.
+  struct RecordedResponses
+  {
+    RecordedResponses() : indexOfNextResponse(0) {}
+
+    std::vector<std::string> responses;
+    size_t indexOfNextResponse;
+  };
+
+  /// @brief The latency and jitter of a command, in seconds.
+  struct Latency
+  {
+    double latency;
+    double jitter;
+  };
+
+  void parseTranscript(const std::string& transcript);
+  void parseDirective(const std::string& line);
+  std::string responseToCommand(const std::string& command);
+  void waitForCommand(const std::string& command);
+  double nextRandomNumber();
+
+  /// @brief Keys are commands, without comments and with normalized
+  /// whitespace.
+  std::map<std::string, RecordedResponses> m_recordedResponses;
+  /// @brief Keys are command names, i.e. the first word of a command.
+  std::map<std::string, Latency> m_latencyOverrides;
+  /// @brief Names of the commands that are not answered.
+  std::set<std::string> m_droppedCommands;
+  /// @brief Names of the commands that are answered twice.
+  std::set<std::string> m_duplicatedCommands;
+  Latency m_defaultLatency;
+  /// @brief State of the random number generator used for jitter.
+  unsigned int m_randomState;
+};
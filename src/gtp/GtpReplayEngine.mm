@@ -0,0 +1,273 @@
+// -----------------------------------------------------------------------------
+// Copyright 2014 Patrick Näf (herzbube@herzbube.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// -----------------------------------------------------------------------------
+
+
+
+
+// Project includes
+#include "GtpReplayEngine.h"
+
+// System includes
+#include <cctype>   // isdigit, isspace
+#include <cstdlib>  // strtod
+#include <sstream>
+#include <time.h>   // nanosleep
+
+
+/// @brief The seed of the random number generator used for jitter. Is fixed so
+/// that delays are reproducible.
+static const unsigned int replayEngineRandomSeed = 42;
+
+
+// -----------------------------------------------------------------------------
+/// @brief Returns @a command without comment and without leading, trailing
+/// and repeated whitespace, so that commands from the transcript and commands
+/// received from the client can be compared.
+// -----------------------------------------------------------------------------
+static std::string normalizeCommand(const std::string& command)
+{
+  std::string normalizedCommand;
+  bool isAfterWhitespace = false;
+  for (std::string::const_iterator it = command.begin(); it != command.end(); ++it)
+  {
+    char character = *it;
+    if ('#' == character)
+      break;
+    if (isspace(static_cast<unsigned char>(character)))
+    {
+      isAfterWhitespace = true;
+      continue;
+    }
+    if (isAfterWhitespace && ! normalizedCommand.empty())
+      normalizedCommand += ' ';
+    isAfterWhitespace = false;
+    normalizedCommand += character;
+  }
+  return normalizedCommand;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Initializes a GtpReplayEngine object that answers commands from
+/// @a transcript. Responses are not delayed unless the transcript contains
+/// latency directives.
+// -----------------------------------------------------------------------------
+GtpReplayEngine::GtpReplayEngine(const std::string& transcript)
+  : m_randomState(replayEngineRandomSeed)
+{
+  m_defaultLatency.latency = 0.0;
+  m_defaultLatency.jitter = 0.0;
+  parseTranscript(transcript);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Configures the latency and jitter (in seconds) of all commands for
+/// which setLatencyForCommand() was not invoked. Each response is delayed by
+/// @a latency seconds, plus or minus a random jitter of up to @a jitter
+/// seconds.
+// -----------------------------------------------------------------------------
+void GtpReplayEngine::setLatency(double latency, double jitter)
+{
+  m_defaultLatency.latency = latency;
+  m_defaultLatency.jitter = jitter;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Configures the latency and jitter (in seconds) of commands whose
+/// name is @a commandName (e.g. "genmove"), overriding the values passed to
+/// setLatency().
+// -----------------------------------------------------------------------------
+void GtpReplayEngine::setLatencyForCommand(const std::string& commandName, double latency, double jitter)
+{
+  Latency commandLatency;
+  commandLatency.latency = latency;
+  commandLatency.jitter = jitter;
+  m_latencyOverrides[commandName] = commandLatency;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Reads commands from @a commandStream and writes the responses to
+/// @a responseStream until either the command stream ends, or the "quit"
+/// command is received.
+///
+/// Commands may be preceded by a numeric ID, which is then also sent with the
+/// response, as required by the GTP specification. Empty lines and comment
+/// lines (e.g. the "# interrupt" sent by GtpClient) are ignored. Commands for
+/// which a "drop" directive exists are not answered, commands for which a
+/// "duplicate" directive exists are answered twice.
+// -----------------------------------------------------------------------------
+void GtpReplayEngine::run(std::istream& commandStream, std::ostream& responseStream)
+{
+  std::string line;
+  while (getline(commandStream, line))
+  {
+    std::string command = normalizeCommand(line);
+    if (command.empty())
+      continue;
+
+    std::string::size_type indexAfterID = 0;
+    while (indexAfterID < command.size() && isdigit(static_cast<unsigned char>(command[indexAfterID])))
+      ++indexAfterID;
+    std::string commandID = command.substr(0, indexAfterID);
+    if (! commandID.empty())
+      command.erase(0, (indexAfterID < command.size()) ? indexAfterID + 1 : indexAfterID);
+
+    std::string response = responseToCommand(command);
+    waitForCommand(command);
+    std::string commandName = command.substr(0, command.find(' '));
+    if (m_droppedCommands.count(commandName) > 0)
+      continue;
+    // Insert the command ID after the status character
+    int numberOfResponses = (m_duplicatedCommands.count(commandName) > 0) ? 2 : 1;
+    for (int indexOfResponse = 0; indexOfResponse < numberOfResponses; ++indexOfResponse)
+      responseStream << response[0] << commandID << response.substr(1) << "\n\n";
+    responseStream << std::flush;
+
+    if ("quit" == command)
+      break;
+  }
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Splits @a transcript into commands and responses. See the class
+/// documentation for the format.
+///
+/// This is a private helper for the constructor.
+// -----------------------------------------------------------------------------
+void GtpReplayEngine::parseTranscript(const std::string& transcript)
+{
+  std::istringstream transcriptStream(transcript);
+  std::string line;
+  std::string command;
+  std::string response;
+  while (true)
+  {
+    bool hasLine = ! getline(transcriptStream, line).fail();
+    if (hasLine && ! line.empty() && '#' == line[0])
+    {
+      parseDirective(line);
+      continue;
+    }
+    if (hasLine && ! line.empty())
+    {
+      if (command.empty())
+      {
+        command = normalizeCommand(line);
+      }
+      else
+      {
+        if (! response.empty())
+          response += '\n';
+        response += line;
+      }
+      continue;
+    }
+
+    // An empty line (or the end of the transcript) completes the block
+    if (! command.empty() && ! response.empty() && ('=' == response[0] || '?' == response[0]))
+      m_recordedResponses[command].responses.push_back(response);
+    command.clear();
+    response.clear();
+    if (! hasLine)
+      break;
+  }
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Applies the directive in @a line. Does nothing if @a line is an
+/// ordinary comment.
+///
+/// This is a private helper for parseTranscript().
+// -----------------------------------------------------------------------------
+void GtpReplayEngine::parseDirective(const std::string& line)
+{
+  std::istringstream directiveStream(line.substr(1));
+  std::string directive;
+  directiveStream >> directive;
+  std::vector<std::string> arguments;
+  std::string argument;
+  while (directiveStream >> argument)
+    arguments.push_back(argument);
+  if ("drop" == directive && 1 == arguments.size())
+    m_droppedCommands.insert(arguments[0]);
+  else if ("duplicate" == directive && 1 == arguments.size())
+    m_duplicatedCommands.insert(arguments[0]);
+  if ("latency" != directive)
+    return;
+  if (2 == arguments.size())
+    setLatency(strtod(arguments[0].c_str(), 0), strtod(arguments[1].c_str(), 0));
+  else if (3 == arguments.size())
+    setLatencyForCommand(arguments[0], strtod(arguments[1].c_str(), 0), strtod(arguments[2].c_str(), 0));
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns the next recorded response to @a command, including the
+/// status prefix.
+///
+/// This is a private helper for run().
+// -----------------------------------------------------------------------------
+std::string GtpReplayEngine::responseToCommand(const std::string& command)
+{
+  std::map<std::string, RecordedResponses>::iterator it = m_recordedResponses.find(command);
+  if (it == m_recordedResponses.end())
+  {
+    // The transcript usually ends before the application quits, but the
+    // client must still be able to shut down the engine
+    if ("quit" == command)
+      return "=";
+    return "? command not in transcript: " + command;
+  }
+  RecordedResponses& recordedResponses = it->second;
+  const std::string& response = recordedResponses.responses[recordedResponses.indexOfNextResponse];
+  if (recordedResponses.indexOfNextResponse + 1 < recordedResponses.responses.size())
+    ++recordedResponses.indexOfNextResponse;
+  return response;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Blocks for the latency configured for @a command, plus or minus a
+/// random jitter.
+///
+/// This is a private helper for run().
+// -----------------------------------------------------------------------------
+void GtpReplayEngine::waitForCommand(const std::string& command)
+{
+  std::string commandName = command.substr(0, command.find(' '));
+  std::map<std::string, Latency>::const_iterator it = m_latencyOverrides.find(commandName);
+  const Latency& commandLatency = (it == m_latencyOverrides.end()) ? m_defaultLatency : it->second;
+
+  double delay = commandLatency.latency + commandLatency.jitter * (2.0 * nextRandomNumber() - 1.0);
+  if (delay <= 0.0)
+    return;
+  struct timespec delayTimespec;
+  delayTimespec.tv_sec = static_cast<time_t>(delay);
+  delayTimespec.tv_nsec = static_cast<long>((delay - delayTimespec.tv_sec) * 1000000000.0);
+  while (-1 == nanosleep(&delayTimespec, &delayTimespec))
+    ;  // interrupted by a signal, sleep for the remaining time
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns a pseudo-random number in the range [0, 1).
+///
+/// A simple linear congruential generator is used instead of rand() so that
+/// the sequence is independent of the platform and of other users of rand().
+///
+/// This is a private helper for waitForCommand().
+// -----------------------------------------------------------------------------
+double GtpReplayEngine::nextRandomNumber()
+{
+  m_randomState = m_randomState * 1664525u + 1013904223u;
+  return (m_randomState >> 8) / static_cast<double>(1u << 24);
+}
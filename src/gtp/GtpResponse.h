@@ -15,8 +15,38 @@
 // -----------------------------------------------------------------------------
 
 
+// Project includes
+#import "../go/GoVertexNumeric.h"
+
 // Forward declarations
 @class GtpCommand;
+struct GoBoardState;
+
+
+// -----------------------------------------------------------------------------
+/// @brief Enumerates the types of moves that can appear in a GTP response.
+///
+/// @ingroup gtp
+// -----------------------------------------------------------------------------
+enum GtpResponseMoveType
+{
+  GtpResponseMoveTypePlay,     ///< @brief The player placed a stone.
+  GtpResponseMoveTypePass,     ///< @brief The player passed.
+  GtpResponseMoveTypeResign    ///< @brief The player resigned.
+};
+
+// -----------------------------------------------------------------------------
+/// @brief Packed representation of a single move in a GTP response, e.g.
+/// "W C13".
+///
+/// @ingroup gtp
+// -----------------------------------------------------------------------------
+struct GtpResponseMove
+{
+  enum GoColor color;                ///< @brief GoColorNone if the color could not be parsed.
+  enum GtpResponseMoveType type;     ///< @brief The move type.
+  struct GoVertexNumeric vertex;     ///< @brief Only valid for #GtpResponseMoveTypePlay. Is 0/0 if the vertex could not be parsed.
+};
 
 
 // -----------------------------------------------------------------------------
@@ -24,18 +54,44 @@
 ///
 /// @ingroup gtp
 ///
-/// GtpResponse is mainly a wrapper around a string that forms the actual GTP
-/// response. The raw response includes the status prefix, while the parsed
-/// response does not.
+/// GtpResponse is mainly a wrapper around the bytes that form the actual GTP
+/// response, as they were received from the GTP engine. The raw response
+/// includes the status prefix, while the parsed response does not.
+/// GtpResponse keeps only the bytes. The raw response string and the parsed
+/// response string are created lazily, on first access, and are then cached.
+///
+/// In addition GtpResponse provides a number of typed views on the parsed
+/// response, for consumers that would otherwise have to split the response
+/// string into a large number of short-lived string objects:
+/// - verticesWithCount:() for vertex lists such as "D4 Q16"
+/// - pointIndexesWithBoardState:count:() for the same vertex lists, mapped to
+///   the point indexes of a GoBoardState
+/// - movesWithCount:() for move lists such as "B D4, W Q16, B PASS"
+/// - floatGridWithNumberOfRows:numberOfColumns:() for a grid of numbers with
+///   one row per line
+///
+/// The typed views are parsed lazily, on first access, directly from the
+/// bytes, so consumers that use only the typed views never cause a string
+/// object to be created. Tokenizing does not allocate memory per token. Every
+/// view is cached after it has been parsed, so repeated access is cheap. The
+/// memory of a view is owned by GtpResponse and remains valid for as long as
+/// the GtpResponse object lives. The views and the response strings may be
+/// accessed from any thread.
 // -----------------------------------------------------------------------------
 @interface GtpResponse : NSObject
 {
 }
 
 + (GtpResponse*) response:(NSString*)response toCommand:(GtpCommand*)command;
++ (GtpResponse*) responseWithBytes:(const char*)bytes length:(size_t)length toCommand:(GtpCommand*)command;
 - (NSString*) parsedResponse;
+- (const struct GoVertexNumeric*) verticesWithCount:(int*)numberOfVertices;
+- (const int*) pointIndexesWithBoardState:(const struct GoBoardState*)boardState count:(int*)numberOfPointIndexes;
+- (const struct GtpResponseMove*) movesWithCount:(int*)numberOfMoves;
+- (const float*) floatGridWithNumberOfRows:(int*)numberOfRows numberOfColumns:(int*)numberOfColumns;
 
-/// @brief The raw response string, which includes the status prefix.
+/// @brief The raw response string, which includes the status prefix. Is
+/// created lazily from the response bytes.
 @property(nonatomic, retain, readonly) NSString* rawResponse;
 /// @brief The GtpCommand object that this GtpResponse "belongs" to.
 ///
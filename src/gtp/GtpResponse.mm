@@ -0,0 +1,574 @@
+// -----------------------------------------------------------------------------
+// Copyright 2011-2013 Patrick Näf (herzbube@herzbube.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// -----------------------------------------------------------------------------
+
+
+// Project includes
+#import "GtpResponse.h"
+#import "../go/GoBoardState.h"
+
+// C++ Standard Library
+#include <cctype>
+#include <cstdlib>
+#include <vector>
+
+
+namespace
+{
+// -----------------------------------------------------------------------------
+/// @brief Splits a range of bytes into tokens in a single pass, without
+/// allocating memory.
+///
+/// Tokens are separated by whitespace and/or commas. A token is returned as a
+/// pair of pointers into the original range of bytes, together with the
+/// 0-based index of the line on which the token was found.
+// -----------------------------------------------------------------------------
+class GtpResponseTokenizer
+{
+public:
+  GtpResponseTokenizer(const char* begin, const char* end)
+    : m_next(begin), m_end(end), m_line(0)
+  {
+  }
+
+  /// @brief Finds the next token. Returns false if there are no more tokens.
+  bool nextToken(const char*& tokenBegin, const char*& tokenEnd, int& line)
+  {
+    while (m_next < m_end && isDelimiter(*m_next))
+    {
+      if ('\n' == *m_next)
+        ++m_line;
+      ++m_next;
+    }
+    if (m_next == m_end)
+      return false;
+    tokenBegin = m_next;
+    while (m_next < m_end && ! isDelimiter(*m_next))
+      ++m_next;
+    tokenEnd = m_next;
+    line = m_line;
+    return true;
+  }
+
+private:
+  static bool isDelimiter(char character)
+  {
+    switch (character)
+    {
+      case ' ':
+      case '\t':
+      case '\r':
+      case '\n':
+      case ',':
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  const char* m_next;
+  const char* m_end;
+  int m_line;
+};
+
+// -----------------------------------------------------------------------------
+/// @brief Returns true if the token that starts at @a tokenBegin and ends at
+/// @a tokenEnd is equal to @a word, ignoring case. @a word must be lowercase.
+// -----------------------------------------------------------------------------
+bool tokenEqualsWord(const char* tokenBegin, const char* tokenEnd, const char* word)
+{
+  for (; tokenBegin < tokenEnd; ++tokenBegin, ++word)
+  {
+    if (! *word || tolower(*tokenBegin) != *word)
+      return false;
+  }
+  return ! *word;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Parses the vertex token that starts at @a tokenBegin and ends at
+/// @a tokenEnd (e.g. "D4" or "q16"). Returns 0/0 if the token is not a valid
+/// vertex.
+///
+/// This is the allocation free counterpart to GoVertex::vertexFromString:().
+// -----------------------------------------------------------------------------
+struct GoVertexNumeric vertexFromToken(const char* tokenBegin, const char* tokenEnd)
+{
+  struct GoVertexNumeric invalidVertex = {0, 0};
+  if (tokenEnd - tokenBegin < 2 || tokenEnd - tokenBegin > 3)
+    return invalidVertex;
+  char letterAxisCompound = toupper(*tokenBegin);
+  if (letterAxisCompound < 'A' || letterAxisCompound > 'T' || 'I' == letterAxisCompound)
+    return invalidVertex;
+  struct GoVertexNumeric vertex;
+  vertex.x = letterAxisCompound - 'A' + 1;  // +1 because vertex is not zero-based
+  if (letterAxisCompound > 'H')
+    vertex.x--;                             // -1 because "I" is never used
+  vertex.y = 0;
+  for (const char* pchNumber = tokenBegin + 1; pchNumber < tokenEnd; ++pchNumber)
+  {
+    if (*pchNumber < '0' || *pchNumber > '9')
+      return invalidVertex;
+    vertex.y = vertex.y * 10 + (*pchNumber - '0');
+  }
+  if (vertex.y < 1 || vertex.y > 19)
+    return invalidVertex;
+  return vertex;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Bundles the response bytes and the typed views that have been
+/// parsed from them.
+// -----------------------------------------------------------------------------
+struct GtpResponseViews
+{
+  GtpResponseViews(const char* rawBytes, size_t numberOfRawBytes)
+    : hasVertices(false), pointIndexesBoardSize(0), hasMoves(false), hasFloatGrid(false),
+      isFloatGridValid(false), numberOfRows(0), numberOfColumns(0)
+  {
+    bytes.reserve(numberOfRawBytes + 1);
+    bytes.assign(rawBytes, rawBytes + numberOfRawBytes);
+    bytes.push_back('\0');
+    // Skip the status prefix, i.e. the status character and the space that
+    // follows it
+    parsedResponseOffset = (numberOfRawBytes < 2 ? numberOfRawBytes : 2);
+  }
+
+  /// @brief Returns the first byte of the raw response.
+  const char* rawBytesBegin() const { return &bytes[0]; }
+  /// @brief Returns the first byte of the parsed response.
+  const char* bytesBegin() const { return &bytes[0] + parsedResponseOffset; }
+  /// @brief Returns the terminating zero byte, which is not part of the
+  /// response.
+  const char* bytesEnd() const { return &bytes[0] + bytes.size() - 1; }
+
+  /// @brief The bytes of the raw response, plus a terminating zero byte.
+  std::vector<char> bytes;
+  /// @brief The number of bytes of the status prefix.
+  size_t parsedResponseOffset;
+  bool hasVertices;
+  std::vector<struct GoVertexNumeric> vertices;
+  /// @brief The board size for which @e pointIndexes has been mapped, 0 if it
+  /// has not been mapped yet.
+  int pointIndexesBoardSize;
+  std::vector<int> pointIndexes;
+  bool hasMoves;
+  std::vector<struct GtpResponseMove> moves;
+  bool hasFloatGrid;
+  bool isFloatGridValid;
+  std::vector<float> floatGrid;
+  int numberOfRows;
+  int numberOfColumns;
+};
+
+}  // namespace
+
+
+// -----------------------------------------------------------------------------
+/// @brief Class extension with private properties for GtpResponse.
+// -----------------------------------------------------------------------------
+@interface GtpResponse()
+/// @name Re-declaration of properties to make them readwrite privately
+//@{
+@property(nonatomic, retain, readwrite) NSString* rawResponse;
+@property(nonatomic, assign, readwrite) GtpCommand* command;
+//@}
+/// @name Private properties
+//@{
+/// @brief The bytes and typed views. The bytes are set up when GtpResponse is
+/// created, the typed views are parsed lazily.
+@property(nonatomic, assign) GtpResponseViews* views;
+/// @brief The parsed response string, created lazily by parsedResponse().
+@property(nonatomic, retain) NSString* parsedResponseString;
+//@}
+@end
+
+
+@implementation GtpResponse
+
+// -----------------------------------------------------------------------------
+/// @brief Convenience constructor. Creates a GtpResponse instance that wraps
+/// the response string @a response, and is a response to @a command.
+///
+/// This is used for responses that are made up by the application. Responses
+/// from the GTP engine are created with
+/// responseWithBytes:length:toCommand:().
+// -----------------------------------------------------------------------------
++ (GtpResponse*) response:(NSString*)response toCommand:(GtpCommand*)command
+{
+  NSData* bytes = [response dataUsingEncoding:[NSString defaultCStringEncoding] allowLossyConversion:YES];
+  GtpResponse* resp = [GtpResponse responseWithBytes:(const char*)bytes.bytes
+                                              length:bytes.length
+                                           toCommand:command];
+  // No need to create the same string again later
+  resp.rawResponse = response;
+  return resp;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Convenience constructor. Creates a GtpResponse instance that wraps
+/// the @a length response bytes at @a bytes, and is a response to
+/// @a command. The bytes are copied, @a bytes does not need to be
+/// zero-terminated.
+// -----------------------------------------------------------------------------
++ (GtpResponse*) responseWithBytes:(const char*)bytes length:(size_t)length toCommand:(GtpCommand*)command
+{
+  GtpResponse* resp = [[GtpResponse alloc] initWithBytes:bytes length:length];
+  if (resp)
+  {
+    resp.command = command;
+    [resp autorelease];
+    DDLogInfo(@"Received %@ (to %@)", resp, command);
+  }
+  return resp;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Initializes a GtpResponse object with a copy of the @a length
+/// response bytes at @a bytes.
+///
+/// @note This is the designated initializer of GtpResponse.
+// -----------------------------------------------------------------------------
+- (id) initWithBytes:(const char*)bytes length:(size_t)length
+{
+  // Call designated initializer of superclass (NSObject)
+  self = [super init];
+  if (! self)
+    return nil;
+
+  self.rawResponse = nil;
+  self.parsedResponseString = nil;
+  self.command = nil;
+  self.views = new GtpResponseViews(bytes, length);
+
+  return self;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Deallocates memory allocated by this GtpResponse object.
+// -----------------------------------------------------------------------------
+- (void) dealloc
+{
+  self.rawResponse = nil;
+  self.parsedResponseString = nil;
+  self.command = nil;
+  delete _views;
+  _views = 0;
+  [super dealloc];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns a description for this GtpResponse object.
+///
+/// This method is invoked when GtpResponse needs to be represented as a string,
+/// i.e. by NSLog, or when the debugger command "po" is used on the object.
+// -----------------------------------------------------------------------------
+- (NSString*) description
+{
+  // Don't use self to access properties to avoid unnecessary overhead during
+  // debugging. Use the bytes so that the response string is not created just
+  // for logging.
+  return [NSString stringWithFormat:@"GtpResponse(%p): %s", self, _views->rawBytesBegin()];
+}
+
+// -----------------------------------------------------------------------------
+// Property is documented in the header file. The getter is implemented
+// manually so that the string can be created lazily.
+// -----------------------------------------------------------------------------
+- (NSString*) rawResponse
+{
+  @synchronized(self)
+  {
+    if (! _rawResponse)
+    {
+      _rawResponse = [[GtpResponse stringWithBytes:_views->rawBytesBegin()
+                                               end:_views->bytesEnd()] retain];
+    }
+    return [[_rawResponse retain] autorelease];
+  }
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns the parsed response string, which is the raw response without
+/// the status prefix.
+// -----------------------------------------------------------------------------
+- (NSString*) parsedResponse
+{
+  @synchronized(self)
+  {
+    if (! self.parsedResponseString)
+    {
+      self.parsedResponseString = [GtpResponse stringWithBytes:_views->bytesBegin()
+                                                           end:_views->bytesEnd()];
+    }
+    return [[self.parsedResponseString retain] autorelease];
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Property is documented in the header file.
+// -----------------------------------------------------------------------------
+- (bool) status
+{
+  return ('=' == *_views->rawBytesBegin());
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns the list of vertices in the parsed response, e.g. the
+/// response to "list_handicap" or "final_status_list dead". The number of
+/// vertices is filled into the out parameter @a numberOfVertices.
+///
+/// A token that is not a valid vertex is represented by the vertex 0/0.
+// -----------------------------------------------------------------------------
+- (const struct GoVertexNumeric*) verticesWithCount:(int*)numberOfVertices
+{
+  @synchronized(self)
+  {
+    GtpResponseViews* views = [self viewsWithVertices];
+    // Cast is required because size_t and int differ in size in 64-bit
+    *numberOfVertices = (int)views->vertices.size();
+    return (views->vertices.empty() ? 0 : &views->vertices[0]);
+  }
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns the list of vertices in the parsed response (see
+/// verticesWithCount:()), mapped to the point indexes of @a boardState. The
+/// number of point indexes is filled into the out parameter
+/// @a numberOfPointIndexes.
+///
+/// A token that is not a valid vertex, or a vertex that is not on the board of
+/// @a boardState, is represented by the point index -1.
+///
+/// The point indexes remain cached for as long as this method is invoked with
+/// board states of the same board size.
+// -----------------------------------------------------------------------------
+- (const int*) pointIndexesWithBoardState:(const struct GoBoardState*)boardState count:(int*)numberOfPointIndexes
+{
+  @synchronized(self)
+  {
+    GtpResponseViews* views = [self viewsWithVertices];
+    int boardSize = boardState->boardSize;
+    if (views->pointIndexesBoardSize != boardSize)
+    {
+      views->pointIndexes.clear();
+      std::vector<struct GoVertexNumeric>::const_iterator it = views->vertices.begin();
+      for (; it != views->vertices.end(); ++it)
+      {
+        if (it->x < 1 || it->x > boardSize || it->y < 1 || it->y > boardSize)
+          views->pointIndexes.push_back(-1);
+        else
+          views->pointIndexes.push_back(GoBoardStatePointIndexOfVertex(boardState, it->x, it->y));
+      }
+      views->pointIndexesBoardSize = boardSize;
+    }
+    // Cast is required because size_t and int differ in size in 64-bit
+    *numberOfPointIndexes = (int)views->pointIndexes.size();
+    return (views->pointIndexes.empty() ? 0 : &views->pointIndexes[0]);
+  }
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns the list of moves in the parsed response, e.g. the response
+/// to "list_moves". The number of moves is filled into the out parameter
+/// @a numberOfMoves.
+///
+/// Expected format: "color vertex, color vertex, color vertex[...]", where
+/// vertex may also be "pass" or "resign".
+// -----------------------------------------------------------------------------
+- (const struct GtpResponseMove*) movesWithCount:(int*)numberOfMoves
+{
+  @synchronized(self)
+  {
+    GtpResponseViews* views = self.views;
+    if (! views->hasMoves)
+    {
+      GtpResponseTokenizer tokenizer(views->bytesBegin(), views->bytesEnd());
+      const char* tokenBegin;
+      const char* tokenEnd;
+      int line;
+      while (tokenizer.nextToken(tokenBegin, tokenEnd, line))
+      {
+        struct GtpResponseMove move;
+        if (tokenEqualsWord(tokenBegin, tokenEnd, "b") || tokenEqualsWord(tokenBegin, tokenEnd, "black"))
+          move.color = GoColorBlack;
+        else if (tokenEqualsWord(tokenBegin, tokenEnd, "w") || tokenEqualsWord(tokenBegin, tokenEnd, "white"))
+          move.color = GoColorWhite;
+        else
+          move.color = GoColorNone;
+        move.vertex.x = 0;
+        move.vertex.y = 0;
+        if (! tokenizer.nextToken(tokenBegin, tokenEnd, line))
+        {
+          DDLogError(@"%@: Move list ends with a color that is not followed by a vertex", self);
+          move.type = GtpResponseMoveTypePlay;
+        }
+        else if (tokenEqualsWord(tokenBegin, tokenEnd, "pass"))
+        {
+          move.type = GtpResponseMoveTypePass;
+        }
+        else if (tokenEqualsWord(tokenBegin, tokenEnd, "resign"))
+        {
+          move.type = GtpResponseMoveTypeResign;
+        }
+        else
+        {
+          move.type = GtpResponseMoveTypePlay;
+          move.vertex = vertexFromToken(tokenBegin, tokenEnd);
+        }
+        views->moves.push_back(move);
+      }
+      views->hasMoves = true;
+    }
+    // Cast is required because size_t and int differ in size in 64-bit
+    *numberOfMoves = (int)views->moves.size();
+    return (views->moves.empty() ? 0 : &views->moves[0]);
+  }
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns the grid of numbers in the parsed response, e.g. the
+/// response to "uct_stat_territory". The numbers are stored row by row, in the
+/// order in which they appear in the response. The grid dimensions are filled
+/// into the out parameters @a numberOfRows and @a numberOfColumns.
+///
+/// Every line that contains at least one number forms a row, other lines are
+/// skipped. Returns NULL if a token is not a number, or if the rows do not all
+/// have the same number of columns.
+// -----------------------------------------------------------------------------
+- (const float*) floatGridWithNumberOfRows:(int*)numberOfRows numberOfColumns:(int*)numberOfColumns
+{
+  @synchronized(self)
+  {
+    GtpResponseViews* views = self.views;
+    if (! views->hasFloatGrid)
+    {
+      views->hasFloatGrid = true;
+      views->isFloatGridValid = [self parseFloatGrid:views];
+      if (! views->isFloatGridValid)
+      {
+        views->floatGrid.clear();
+        views->numberOfRows = 0;
+        views->numberOfColumns = 0;
+      }
+    }
+    *numberOfRows = views->numberOfRows;
+    *numberOfColumns = views->numberOfColumns;
+    if (! views->isFloatGridValid || views->floatGrid.empty())
+      return 0;
+    return &views->floatGrid[0];
+  }
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Parses the float grid view into @a views. Returns true on success,
+/// false on failure.
+///
+/// This is a private helper for floatGridWithNumberOfRows:numberOfColumns:().
+// -----------------------------------------------------------------------------
+- (bool) parseFloatGrid:(GtpResponseViews*)views
+{
+  GtpResponseTokenizer tokenizer(views->bytesBegin(), views->bytesEnd());
+  const char* tokenBegin;
+  const char* tokenEnd;
+  int line;
+  int lineOfCurrentRow = -1;
+  int numberOfColumnsInCurrentRow = 0;
+  while (tokenizer.nextToken(tokenBegin, tokenEnd, line))
+  {
+    char* pchEndOfNumber;
+    // The byte buffer is zero-terminated, and delimiters are never part of a
+    // number, so strtof does not read beyond the end of the token
+    float number = strtof(tokenBegin, &pchEndOfNumber);
+    if (pchEndOfNumber != tokenEnd)
+    {
+      DDLogError(@"%@: Float grid contains a token that is not a number", self);
+      return false;
+    }
+    if (line != lineOfCurrentRow)
+    {
+      if (! [self finishFloatGridRow:views numberOfColumns:numberOfColumnsInCurrentRow])
+        return false;
+      lineOfCurrentRow = line;
+      numberOfColumnsInCurrentRow = 0;
+    }
+    views->floatGrid.push_back(number);
+    ++numberOfColumnsInCurrentRow;
+  }
+  return [self finishFloatGridRow:views numberOfColumns:numberOfColumnsInCurrentRow];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Accounts for a row with @a numberOfColumns columns that has been
+/// added to the float grid view in @a views. A row with 0 columns is ignored.
+/// Returns false if the row is inconsistent with previous rows.
+///
+/// This is a private helper for parseFloatGrid:().
+// -----------------------------------------------------------------------------
+- (bool) finishFloatGridRow:(GtpResponseViews*)views numberOfColumns:(int)numberOfColumns
+{
+  if (0 == numberOfColumns)
+    return true;
+  if (0 == views->numberOfRows)
+  {
+    views->numberOfColumns = numberOfColumns;
+  }
+  else if (numberOfColumns != views->numberOfColumns)
+  {
+    DDLogError(@"%@: Float grid row %d has %d columns, expected %d", self, views->numberOfRows + 1, numberOfColumns, views->numberOfColumns);
+    return false;
+  }
+  views->numberOfRows++;
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns a string object created from the response bytes that start
+/// at @a begin and end at @a end. The bytes are interpreted in the default C
+/// string encoding, which GtpClient also uses for the commands that it writes
+/// to the GTP engine.
+///
+/// This is a private helper.
+// -----------------------------------------------------------------------------
++ (NSString*) stringWithBytes:(const char*)begin end:(const char*)end
+{
+  return [[[NSString alloc] initWithBytes:begin
+                                   length:end - begin
+                                 encoding:[NSString defaultCStringEncoding]] autorelease];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns the object that holds the typed views, with the vertex list
+/// view parsed.
+///
+/// This is a private helper. The caller must synchronize on self.
+// -----------------------------------------------------------------------------
+- (GtpResponseViews*) viewsWithVertices
+{
+  GtpResponseViews* views = self.views;
+  if (! views->hasVertices)
+  {
+    GtpResponseTokenizer tokenizer(views->bytesBegin(), views->bytesEnd());
+    const char* tokenBegin;
+    const char* tokenEnd;
+    int line;
+    while (tokenizer.nextToken(tokenBegin, tokenEnd, line))
+      views->vertices.push_back(vertexFromToken(tokenBegin, tokenEnd));
+    views->hasVertices = true;
+  }
+  return views;
+}
+
+@end
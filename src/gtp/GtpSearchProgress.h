@@ -0,0 +1,61 @@
+// -----------------------------------------------------------------------------
+// Copyright 2014 Patrick Näf (herzbube@herzbube.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// -----------------------------------------------------------------------------
+
+
+
+// -----------------------------------------------------------------------------
+/// @brief The GtpSearchProgress class represents a snapshot of the state of
+/// the GTP engine's search while the engine is thinking, e.g. during
+/// "genmove".
+///
+/// @ingroup gtp
+///
+/// GtpSearchProgress objects are created from the GoGui live graphics blocks
+/// that Fuego periodically writes to its debug stream while it searches (see
+/// GtpSearchProgressStreamBuffer). A block starts with the line "gogui-gfx:"
+/// and ends with an empty line. GtpSearchProgress evaluates the following
+/// lines of a block and ignores all others:
+/// - "VAR b D4 w Q16 ...": The principal variation, i.e. the sequence of moves
+///   that the engine currently considers best.
+/// - "TEXT N=1234 V=0.55 ...": The number of simulations that the search has
+///   performed so far (N), and the value of the best move (V), which is the
+///   estimated probability that the player to move wins.
+///
+/// GtpSearchProgress is immutable.
+// -----------------------------------------------------------------------------
+@interface GtpSearchProgress : NSObject
+{
+}
+
++ (GtpSearchProgress*) searchProgressWithGfxBlock:(NSString*)gfxBlock;
+
+/// @brief The moves of the principal variation, in the normalized form
+/// "<color> <vertex>" (e.g. "B D4"). Is an empty array if the block contained
+/// no principal variation.
+@property(nonatomic, retain, readonly) NSArray* principalVariation;
+/// @brief The vertex of the move that the engine currently considers best
+/// (e.g. "D4" or "PASS"). Is nil if the block contained no principal
+/// variation.
+@property(nonatomic, retain, readonly) NSString* bestMove;
+/// @brief The number of simulations that the search has performed so far. Is
+/// 0 if the block did not contain this information.
+@property(nonatomic, assign, readonly) unsigned long long numberOfSimulations;
+/// @brief The estimated probability (0.0 - 1.0) that the player to move wins
+/// if the best move is played. Is -1.0 if the block did not contain this
+/// information.
+@property(nonatomic, assign, readonly) float winningProbability;
+
+@end
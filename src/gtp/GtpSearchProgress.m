@@ -0,0 +1,136 @@
+// -----------------------------------------------------------------------------
+// Copyright 2014 Patrick Näf (herzbube@herzbube.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// -----------------------------------------------------------------------------
+
+
+
+// Project includes
+#import "GtpSearchProgress.h"
+#import "GtpEngineMoveHistory.h"
+
+
+// -----------------------------------------------------------------------------
+/// @brief Class extension with private properties for GtpSearchProgress.
+// -----------------------------------------------------------------------------
+@interface GtpSearchProgress()
+// Re-declare properties as readwrite
+@property(nonatomic, retain, readwrite) NSArray* principalVariation;
+@property(nonatomic, retain, readwrite) NSString* bestMove;
+@property(nonatomic, assign, readwrite) unsigned long long numberOfSimulations;
+@property(nonatomic, assign, readwrite) float winningProbability;
+@end
+
+
+@implementation GtpSearchProgress
+
+// -----------------------------------------------------------------------------
+/// @brief Convenience constructor. Creates a GtpSearchProgress instance from
+/// the GoGui live graphics block @a gfxBlock. See the class documentation for
+/// details about the expected format.
+// -----------------------------------------------------------------------------
++ (GtpSearchProgress*) searchProgressWithGfxBlock:(NSString*)gfxBlock
+{
+  GtpSearchProgress* searchProgress = [[GtpSearchProgress alloc] init];
+  if (searchProgress)
+  {
+    [searchProgress parseGfxBlock:gfxBlock];
+    [searchProgress autorelease];
+  }
+  return searchProgress;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Initializes a GtpSearchProgress object with no information.
+///
+/// @note This is the designated initializer of GtpSearchProgress.
+// -----------------------------------------------------------------------------
+- (id) init
+{
+  // Call designated initializer of superclass (NSObject)
+  self = [super init];
+  if (! self)
+    return nil;
+  self.principalVariation = [NSArray array];
+  self.bestMove = nil;
+  self.numberOfSimulations = 0;
+  self.winningProbability = -1.0f;
+  return self;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Deallocates memory allocated by this GtpSearchProgress object.
+// -----------------------------------------------------------------------------
+- (void) dealloc
+{
+  self.principalVariation = nil;
+  self.bestMove = nil;
+  [super dealloc];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns a description for this GtpSearchProgress object.
+///
+/// This method is invoked when GtpSearchProgress needs to be represented as a
+/// string, i.e. by NSLog, or when the debugger command "po" is used on the
+/// object.
+// -----------------------------------------------------------------------------
+- (NSString*) description
+{
+  return [NSString stringWithFormat:@"GtpSearchProgress(%p): best move = %@, simulations = %llu, winning probability = %f",
+          self, _bestMove, _numberOfSimulations, _winningProbability];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Sets up the properties of this GtpSearchProgress object with the
+/// information found in @a gfxBlock.
+///
+/// This is a private helper.
+// -----------------------------------------------------------------------------
+- (void) parseGfxBlock:(NSString*)gfxBlock
+{
+  NSCharacterSet* whitespaceCharacterSet = [NSCharacterSet whitespaceCharacterSet];
+  for (NSString* line in [gfxBlock componentsSeparatedByString:@"\n"])
+  {
+    NSMutableArray* tokens = [NSMutableArray arrayWithArray:[line componentsSeparatedByCharactersInSet:whitespaceCharacterSet]];
+    [tokens removeObject:@""];
+    if (0 == tokens.count)
+      continue;
+    NSString* keyword = [tokens objectAtIndex:0];
+    if ([keyword isEqualToString:@"VAR"])
+    {
+      NSMutableArray* principalVariation = [NSMutableArray arrayWithCapacity:tokens.count / 2];
+      for (NSUInteger indexOfToken = 1; indexOfToken + 1 < tokens.count; indexOfToken += 2)
+      {
+        [principalVariation addObject:[GtpEngineMoveHistory moveStringWithColor:[tokens objectAtIndex:indexOfToken]
+                                                                         vertex:[tokens objectAtIndex:indexOfToken + 1]]];
+      }
+      self.principalVariation = principalVariation;
+      if (principalVariation.count > 0)
+        self.bestMove = [[tokens objectAtIndex:2] uppercaseString];
+    }
+    else if ([keyword isEqualToString:@"TEXT"])
+    {
+      for (NSString* token in tokens)
+      {
+        if ([token hasPrefix:@"N="])
+          self.numberOfSimulations = [[token substringFromIndex:2] longLongValue];
+        else if ([token hasPrefix:@"V="])
+          self.winningProbability = [[token substringFromIndex:2] floatValue];
+      }
+    }
+  }
+}
+
+@end
@@ -0,0 +1,84 @@
+// -----------------------------------------------------------------------------
+// Copyright 2014 Patrick Näf (herzbube@herzbube.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// -----------------------------------------------------------------------------
+
+
+
+// This file contains C++ syntax. It must be #include'd only by Objective-C++
+// implementations.
+
+// System includes
+#include <streambuf>
+#include <string>
+#include <pthread.h>
+
+
+// -----------------------------------------------------------------------------
+/// @brief The GtpSearchProgressStreamBuffer class is a std::streambuf that
+/// extracts GoGui live graphics blocks from the GTP engine's debug output and
+/// discards everything else.
+///
+/// @ingroup gtp
+///
+/// While it searches with live graphics enabled, Fuego periodically writes
+/// live graphics blocks to its debug stream. A block starts with the line
+/// "gogui-gfx:" and ends with an empty line. GtpEngine temporarily replaces
+/// Fuego's debug stream with a stream that uses GtpSearchProgressStreamBuffer
+/// (see GtpEngine::startSearchProgressHook()). GtpSearchProgressStreamBuffer
+/// invokes a callback function with the content of each block (without the
+/// start and end lines) when the block is complete.
+///
+/// Output that does not belong to a live graphics block is discarded, so
+/// that the project's debugging console is not overloaded. A line outside of
+/// a block is skipped as soon as it can no longer be the start line of a
+/// block, without looking at the rest of the line.
+///
+/// GtpSearchProgressStreamBuffer is unbuffered and serializes all writes with
+/// a mutex, because the engine may write debug output from several threads.
+/// The callback is invoked while the mutex is held.
+// -----------------------------------------------------------------------------
+class GtpSearchProgressStreamBuffer : public std::streambuf
+{
+public:
+  /// @brief Type of the function that GtpSearchProgressStreamBuffer invokes
+  /// when a live graphics block is complete.
+  typedef void (*Callback)(const std::string& gfxBlock, void* context);
+
+  GtpSearchProgressStreamBuffer(Callback callback, void* context);
+  ~GtpSearchProgressStreamBuffer();
+
+protected:
+  virtual int_type overflow(int_type character);
+  virtual std::streamsize xsputn(const char* characters, std::streamsize numberOfCharacters);
+
+private:
+  GtpSearchProgressStreamBuffer(const GtpSearchProgressStreamBuffer&);
+  GtpSearchProgressStreamBuffer& operator=(const GtpSearchProgressStreamBuffer&);
+
+  void processCharacter(char character);
+  void processLine();
+
+  Callback m_callback;
+  void* m_context;
+  /// @brief The characters of the current line received so far.
+  std::string m_line;
+  /// @brief The lines of the current live graphics block received so far.
+  std::string m_gfxBlock;
+  bool m_isInsideGfxBlock;
+  /// @brief True if the current line is outside of a live graphics block and
+  /// is not the start line of a block.
+  bool m_isDiscardingLine;
+  pthread_mutex_t m_mutex;
+};
@@ -0,0 +1,146 @@
+// -----------------------------------------------------------------------------
+// Copyright 2014 Patrick Näf (herzbube@herzbube.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// -----------------------------------------------------------------------------
+
+
+
+// Project includes
+#include "GtpSearchProgressStreamBuffer.h"
+
+// System includes
+#include <cstring>
+
+/// @brief The line that starts a live graphics block.
+static const char gfxBlockStartLine[] = "gogui-gfx:";
+
+
+// -----------------------------------------------------------------------------
+/// @brief Initializes a GtpSearchProgressStreamBuffer object that invokes
+/// @a callback with @a context whenever a live graphics block is complete.
+// -----------------------------------------------------------------------------
+GtpSearchProgressStreamBuffer::GtpSearchProgressStreamBuffer(Callback callback, void* context)
+  : m_callback(callback),
+    m_context(context),
+    m_isInsideGfxBlock(false),
+    m_isDiscardingLine(false)
+{
+  pthread_mutex_init(&m_mutex, 0);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Deallocates memory allocated by this GtpSearchProgressStreamBuffer
+/// object.
+// -----------------------------------------------------------------------------
+GtpSearchProgressStreamBuffer::~GtpSearchProgressStreamBuffer()
+{
+  pthread_mutex_destroy(&m_mutex);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief std::streambuf method. Is invoked for every single character
+/// because GtpSearchProgressStreamBuffer has no put area.
+// -----------------------------------------------------------------------------
+GtpSearchProgressStreamBuffer::int_type GtpSearchProgressStreamBuffer::overflow(int_type character)
+{
+  if (traits_type::eq_int_type(character, traits_type::eof()))
+    return traits_type::not_eof(character);
+  pthread_mutex_lock(&m_mutex);
+  processCharacter(traits_type::to_char_type(character));
+  pthread_mutex_unlock(&m_mutex);
+  return character;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief std::streambuf method. Processes @a numberOfCharacters characters
+/// under a single lock. The remainder of a line that is being discarded is
+/// skipped in one go.
+// -----------------------------------------------------------------------------
+std::streamsize GtpSearchProgressStreamBuffer::xsputn(const char* characters, std::streamsize numberOfCharacters)
+{
+  const char* character = characters;
+  const char* end = characters + numberOfCharacters;
+  pthread_mutex_lock(&m_mutex);
+  while (character < end)
+  {
+    if (m_isDiscardingLine)
+    {
+      const char* lineEnd = static_cast<const char*>(memchr(character, '\n', end - character));
+      if (! lineEnd)
+        break;
+      character = lineEnd;
+    }
+    processCharacter(*character);
+    ++character;
+  }
+  pthread_mutex_unlock(&m_mutex);
+  return numberOfCharacters;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Appends @a character to the current line, or processes the line if
+/// @a character terminates it.
+///
+/// This is a private helper. The caller must hold the mutex.
+// -----------------------------------------------------------------------------
+void GtpSearchProgressStreamBuffer::processCharacter(char character)
+{
+  if ('\n' == character)
+  {
+    if (! m_isDiscardingLine)
+      processLine();
+    m_line.clear();
+    m_isDiscardingLine = false;
+  }
+  else if ('\r' != character && ! m_isDiscardingLine)
+  {
+    m_line += character;
+    // Lines outside of a block are needed only to detect the start of a
+    // block. As soon as a line can no longer be the start line, the rest of
+    // the line is discarded.
+    if (! m_isInsideGfxBlock &&
+        (m_line.size() >= sizeof(gfxBlockStartLine) ||
+         0 != strncmp(m_line.c_str(), gfxBlockStartLine, m_line.size())))
+    {
+      m_isDiscardingLine = true;
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Processes the line that has just been completed.
+///
+/// This is a private helper. The caller must hold the mutex.
+// -----------------------------------------------------------------------------
+void GtpSearchProgressStreamBuffer::processLine()
+{
+  if (! m_isInsideGfxBlock)
+  {
+    if (gfxBlockStartLine == m_line)
+    {
+      m_isInsideGfxBlock = true;
+      m_gfxBlock.clear();
+    }
+  }
+  else if (m_line.empty())
+  {
+    m_isInsideGfxBlock = false;
+    m_callback(m_gfxBlock, m_context);
+  }
+  else
+  {
+    m_gfxBlock += m_line;
+    m_gfxBlock += '\n';
+  }
+}
@@ -16,6 +16,8 @@
 
 
 // Forward classes
+@class GoMove;
+@class GtpCommand;
 @class Player;
 
 
@@ -37,5 +39,9 @@
 + (void) startPondering;
 + (void) stopPondering;
 + (void) restorePondering;
++ (void) startLiveGraphics;
++ (void) stopLiveGraphics;
++ (NSArray*) moveStringsUpToMove:(GoMove*)move;
++ (void) submitCommandAtCurrentBoardPosition:(GtpCommand*)command;
 
 @end
@@ -18,8 +18,17 @@
 // Project includes
 #import "GtpUtilities.h"
 #import "GtpCommand.h"
+#import "GtpEngineMoveHistory.h"
+#import "GtpEngine.h"
+#import "GtpEnginePool.h"
+#import "../go/GoBoard.h"
+#import "../go/GoBoardPosition.h"
 #import "../go/GoGame.h"
+#import "../go/GoMove.h"
+#import "../go/GoMoveModel.h"
 #import "../go/GoPlayer.h"
+#import "../go/GoPoint.h"
+#import "../go/GoVertex.h"
 #import "../main/ApplicationDelegate.h"
 #import "../player/GtpEngineProfileModel.h"
 #import "../player/GtpEngineProfile.h"
@@ -119,5 +128,123 @@
     [GtpUtilities stopPondering];
 }
 
+// -----------------------------------------------------------------------------
+/// @brief Tells the GTP engine to write live graphics blocks to its debug
+/// stream while it searches, and activates the search progress hook of
+/// GtpEngine, so that GtpEngine can report the progress of the search (see
+/// GtpEngine::startSearchProgressHook()).
+///
+/// Live graphics should be enabled only for searches whose progress is
+/// actually shown to the user, i.e. for "genmove" when the computer plays.
+/// Other searches (e.g. pondering, or "reg_genmove" for territory statistics)
+/// should not pay for generating and filtering the blocks.
+///
+/// Every invocation of this method must be balanced by an invocation of
+/// stopLiveGraphics().
+// -----------------------------------------------------------------------------
++ (void) startLiveGraphics
+{
+  [[ApplicationDelegate sharedDelegate].gtpEngine startSearchProgressHook];
+  GtpCommand* command = [GtpCommand command:@"uct_param_search live_gfx sequence"];
+  command.waitUntilDone = false;
+  [command submit];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Tells the GTP engine to stop writing live graphics blocks to its
+/// debug stream. The search progress hook of GtpEngine is deactivated when the
+/// engine has processed the command, i.e. after the search that was submitted
+/// in the meantime has finished.
+// -----------------------------------------------------------------------------
++ (void) stopLiveGraphics
+{
+  GtpCommand* command = [GtpCommand asynchronousCommand:@"uct_param_search live_gfx none"
+                                         responseTarget:self
+                                               selector:@selector(stopLiveGraphicsResponseReceived:)];
+  [command submit];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Is triggered when the GTP engine responds to the command submitted
+/// in stopLiveGraphics().
+///
+/// This is a private helper for stopLiveGraphics().
+// -----------------------------------------------------------------------------
++ (void) stopLiveGraphicsResponseReceived:(GtpResponse*)response
+{
+  // Deactivate the hook even if the command failed, otherwise the hook would
+  // remain active forever
+  [[ApplicationDelegate sharedDelegate].gtpEngine stopSearchProgressHook];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns the moves of the current game, from the first move up to and
+/// including @a move, as an array of strings in the form used by
+/// GtpEngineMoveHistory (e.g. "B D4"). Returns an empty array if @a move is
+/// nil. Returns nil if a move of an unexpected type is found.
+// -----------------------------------------------------------------------------
++ (NSArray*) moveStringsUpToMove:(GoMove*)move
+{
+  GoGame* game = [GoGame sharedGame];
+  NSMutableArray* moveStrings = [NSMutableArray arrayWithCapacity:game.moveModel.numberOfMoves];
+  if (! move)
+    return moveStrings;
+  GoMove* moveToAdd = game.moveModel.firstMove;
+  while (true)
+  {
+    NSString* color = (moveToAdd.player.black ? @"B" : @"W");
+    switch (moveToAdd.type)
+    {
+      case GoMoveTypePlay:
+        [moveStrings addObject:[GtpEngineMoveHistory moveStringWithColor:color vertex:moveToAdd.point.vertex.string]];
+        break;
+      case GoMoveTypePass:
+        [moveStrings addObject:[GtpEngineMoveHistory moveStringWithColor:color vertex:@"PASS"]];
+        break;
+      default:
+        DDLogError(@"GtpUtilities::moveStringsUpToMove(): Unexpected move type %d", moveToAdd.type);
+        assert(0);
+        return nil;
+    }
+    if (moveToAdd == move)
+      break;
+    moveToAdd = moveToAdd.next;
+  }
+  return moveStrings;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Submits @a command, which queries the current board position, to a
+/// GTP engine that is set up with the current board position. If the
+/// application has analysis engines, the query does not compete with the play
+/// engine.
+///
+/// @see GtpEnginePool::submitCommand:atBoardSize:komi:handicap:moves:()
+// -----------------------------------------------------------------------------
++ (void) submitCommandAtCurrentBoardPosition:(GtpCommand*)command
+{
+  GtpEnginePool* gtpEnginePool = [ApplicationDelegate sharedDelegate].gtpEnginePool;
+  // The play engine is always synchronized, so there is no need to collect
+  // the moves of the current board position
+  if (! gtpEnginePool.hasAnalysisClients)
+  {
+    command.gtpClient = gtpEnginePool.playClient;
+    [command submit];
+    return;
+  }
+  GoGame* game = [GoGame sharedGame];
+  NSArray* moveStrings = [GtpUtilities moveStringsUpToMove:game.boardPosition.currentMove];
+  if (! moveStrings)
+  {
+    command.gtpClient = gtpEnginePool.playClient;
+    [command submit];
+    return;
+  }
+  [gtpEnginePool submitCommand:command
+                   atBoardSize:game.board.size
+                          komi:game.komi
+                      handicap:game.handicapPoints.count
+                         moves:moveStrings];
+}
 
 @end
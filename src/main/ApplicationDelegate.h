@@ -22,6 +22,8 @@
 // Forward declarations
 @class GtpClient;
 @class GtpEngine;
+@class GtpEnginePool;
+@class GtpAnalysisCache;
 @class NewGameModel;
 @class PlayerModel;
 @class GtpEngineProfileModel;
@@ -72,6 +74,7 @@
 - (void) setupSound;
 - (void) setupGUI;
 - (void) setupFuego;
+- (void) setupGtpEnginePool;
 - (void) writeUserDefaults;
 - (NSString*) contentOfTextResource:(NSString*)resourceName;
 - (NSString*) logFolder;
@@ -105,6 +108,12 @@
 @property(nonatomic, retain) GtpClient* gtpClient;
 /// @brief The GTP engine instance.
 @property(nonatomic, retain) GtpEngine* gtpEngine;
+/// @brief The pool that routes GTP commands to @e gtpClient and to the
+/// clients of the analysis engines, if there are any.
+@property(nonatomic, retain) GtpEnginePool* gtpEnginePool;
+/// @brief The cache with the results of GTP commands that analyze a board
+/// position.
+@property(nonatomic, retain) GtpAnalysisCache* gtpAnalysisCache;
 /// @brief Model object that stores attributes of a new game.
 @property(nonatomic, retain) NewGameModel* theNewGameModel;
 /// @brief Model object that stores player data.
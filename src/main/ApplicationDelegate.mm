@@ -31,8 +31,10 @@
 #import "ApplicationDelegate.h"
 #import "MainMenuPresenter.h"
 #import "WindowRootViewController.h"
+#import "../gtp/GtpAnalysisCache.h"
 #import "../gtp/GtpClient.h"
 #import "../gtp/GtpEngine.h"
+#import "../gtp/GtpEnginePool.h"
 #import "../gtp/GtpUtilities.h"
 #import "../newgame/NewGameModel.h"
 #import "../player/GtpEngineProfileModel.h"
@@ -133,6 +135,8 @@ static ApplicationDelegate* sharedDelegate = nil;
 {
   self.window = nil;
   self.documentInteractionURL = nil;
+  self.gtpEnginePool = nil;
+  self.gtpAnalysisCache = nil;
   self.gtpClient = nil;
   self.gtpEngine = nil;
   // Observes BoardViewModel, so must be deallocated first
@@ -199,6 +203,7 @@ static ApplicationDelegate* sharedDelegate = nil;
   [self setupUserDefaults];
   [self setupSound];
   [self setupFuego];
+  [self setupGtpEnginePool];  // depends on setupFuego
   [self setupGUI];  // depends on setupUserDefaults (e.g. MainTabBarController wants to restore tab order)
 
   // Further setup steps are executed in a secondary thread so that we can
@@ -562,14 +567,50 @@ static ApplicationDelegate* sharedDelegate = nil;
 }
 
 // -----------------------------------------------------------------------------
-/// @brief Sets up the GTP engine and client (always Fuego).
+/// @brief Sets up the GTP engine and client (always Fuego, unless a replay
+/// transcript is specified).
 ///
 /// In a regular desktop environment, engine and client would be launched in
 /// separate processes, which would then communicate via stdin/stdout. Since
 /// there is no way to launch separate processes under iOS, engine and client
 /// run in separate threads, and they communicate via named pipes.
+///
+/// If the launch argument #gtpReplayTranscriptPathKey specifies a transcript
+/// file, GtpReplayEngine answers the client's commands from that transcript
+/// instead of Fuego. This is intended for deterministic load testing.
 // -----------------------------------------------------------------------------
 - (void) setupFuego
+{
+  NSString* replayTranscriptPath = [[NSUserDefaults standardUserDefaults] stringForKey:gtpReplayTranscriptPathKey];
+  if (replayTranscriptPath)
+  {
+    NSError* error;
+    NSString* replayTranscript = [NSString stringWithContentsOfFile:replayTranscriptPath
+                                                           encoding:NSUTF8StringEncoding
+                                                              error:&error];
+    if (replayTranscript)
+    {
+      DDLogVerbose(@"%@: Using replay engine with transcript %@", self, replayTranscriptPath);
+      self.gtpEngine = [GtpEngine engineWithReplayTranscript:replayTranscript];
+      self.gtpClient = [GtpClient clientWithInProcessChannelOfEngine:self.gtpEngine];
+      return;
+    }
+    DDLogError(@"%@: Failed to read replay transcript %@, using Fuego instead. Error: %@", self, replayTranscriptPath, [error localizedDescription]);
+  }
+
+  NSArray* pipes = [self createPipes];
+  self.gtpClient = [GtpClient clientWithInputPipe:[pipes objectAtIndex:0] outputPipe:[pipes objectAtIndex:1]];
+  self.gtpEngine = [GtpEngine engineWithInputPipe:[pipes objectAtIndex:0] outputPipe:[pipes objectAtIndex:1]];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Creates the named pipes that GtpClient and GtpEngine use to
+/// communicate. Returns an array with the paths of the input pipe and of the
+/// output pipe, in that order.
+///
+/// This is a private helper for setupFuego().
+// -----------------------------------------------------------------------------
+- (NSArray*) createPipes
 {
   mode_t pipeMode = S_IWUSR | S_IRUSR | S_IRGRP | S_IROTH;
   NSString* tempDir = NSTemporaryDirectory();
@@ -617,8 +658,52 @@ static ApplicationDelegate* sharedDelegate = nil;
       DDLogVerbose(@"%@: Failure! Reason = %@", self, error);
     }
   }
-  self.gtpClient = [GtpClient clientWithInputPipe:inputPipePath outputPipe:outputPipePath];
-  self.gtpEngine = [GtpEngine engineWithInputPipe:inputPipePath outputPipe:outputPipePath];
+  return [NSArray arrayWithObjects:inputPipePath, outputPipePath, nil];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Sets up the GtpEnginePool that routes GTP commands to the engines,
+/// and the GtpAnalysisCache that stores the results of the engines' analysis.
+///
+/// The pool always contains the GtpClient/GtpEngine pair created by
+/// setupFuego(). If the launch arguments #gtpReplayTranscriptPathKey and
+/// #gtpAnalysisEngineCountKey are both specified, the pool also contains that
+/// many analysis engines. Every analysis engine is a replay engine that
+/// communicates with its GtpClient via its own in-memory GtpChannel.
+///
+/// Fuego gets no analysis engines, because only one instance of Fuego can run
+/// in the process (see GtpEngine). All commands go to the play engine.
+// -----------------------------------------------------------------------------
+- (void) setupGtpEnginePool
+{
+  self.gtpEnginePool = [[[GtpEnginePool alloc] initWithPlayClient:self.gtpClient
+                                                       playEngine:self.gtpEngine] autorelease];
+  self.gtpAnalysisCache = [[[GtpAnalysisCache alloc] initWithMemoryLimit:gGtpAnalysisCacheMemoryLimit] autorelease];
+
+  NSInteger numberOfAnalysisEngines = [[NSUserDefaults standardUserDefaults] integerForKey:gtpAnalysisEngineCountKey];
+  if (numberOfAnalysisEngines <= 0)
+    return;
+  NSString* replayTranscriptPath = [[NSUserDefaults standardUserDefaults] stringForKey:gtpReplayTranscriptPathKey];
+  NSString* replayTranscript = nil;
+  if (replayTranscriptPath)
+  {
+    replayTranscript = [NSString stringWithContentsOfFile:replayTranscriptPath
+                                                 encoding:NSUTF8StringEncoding
+                                                    error:nil];
+  }
+  if (! replayTranscript)
+  {
+    DDLogWarn(@"%@: Only one instance of Fuego can run, ignoring request for %ld analysis engines", self, (long)numberOfAnalysisEngines);
+    return;
+  }
+
+  for (int engineIndex = 1; engineIndex <= numberOfAnalysisEngines; ++engineIndex)
+  {
+    DDLogVerbose(@"%@: Creating replay analysis engine %d", self, engineIndex);
+    GtpEngine* analysisEngine = [GtpEngine engineWithReplayTranscript:replayTranscript];
+    GtpClient* analysisClient = [GtpClient clientWithInProcessChannelOfEngine:analysisEngine];
+    [self.gtpEnginePool addAnalysisClient:analysisClient analysisEngine:analysisEngine];
+  }
 }
 
 
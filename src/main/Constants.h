@@ -381,6 +381,18 @@ extern const int gDefaultHandicap;
 extern const enum GoScoringSystem gDefaultScoringSystem;
 extern const double gDefaultKomiAreaScoring;
 extern const double gDefaultKomiTerritoryScoring;
+/// @brief The default number of board positions between two keyframes stored
+/// by GoBoardPosition.
+extern const int gDefaultKeyframeInterval;
+/// @brief The default maximum number of bytes that GoBoardPosition may use to
+/// store keyframes.
+extern const int gDefaultKeyframeMemoryLimit;
+/// @brief True if GoZobristTable objects that are created with
+/// GoZobristTable::initWithBoardSize:() calculate 128-bit Zobrist hashes
+/// instead of 64-bit Zobrist hashes. Turn this on if even the tiny probability
+/// of a 64-bit hash collision, which could cause a legal move to be rejected
+/// as superko, is not acceptable.
+extern const bool gUse128BitZobristHashes;
 //@}
 
 // -----------------------------------------------------------------------------
@@ -415,6 +427,12 @@ extern NSString* sgfBackupFileName;
 /// @brief Name of the folder used by the document interaction system to pass
 /// files into the app. The folder is located in the Documents folder.
 extern NSString* inboxFolderName;
+/// @brief Number of seconds after which the "loadsgf" and "savesgf" GTP
+/// commands are abandoned if the GTP engine has not answered them.
+extern const NSTimeInterval gSgfGtpCommandTimeout;
+/// @brief The maximum number of bytes that GtpAnalysisCache may use to store
+/// the results of GTP commands.
+extern const int gGtpAnalysisCacheMemoryLimit;
 //@}
 
 // -----------------------------------------------------------------------------
@@ -431,6 +449,11 @@ extern NSString* gtpCommandWillBeSubmittedNotification;
 ///
 /// @attention This notification is delivered in a secondary thread.
 extern NSString* gtpResponseWasReceivedNotification;
+/// @brief Is sent periodically while the GTP engine searches (e.g. during
+/// "genmove" or while pondering), at most twice per second. The
+/// GtpSearchProgress instance that describes the state of the search is
+/// associated with the notification.
+extern NSString* gtpSearchProgressWasReceivedNotification;
 /// @brief Is sent to indicate that the GTP engine is no longer idle.
 extern NSString* gtpEngineRunningNotification;
 /// @brief Is sent to indicate that the GTP engine is idle.
@@ -940,6 +963,12 @@ extern NSString* sortAscendingKey;
 extern NSString* gtpLogViewKey;
 extern NSString* gtpLogSizeKey;
 extern NSString* gtpLogViewFrontSideIsVisibleKey;
+// GTP transcript settings. These are not part of the registration domain
+// defaults, they are meant to be supplied as launch arguments (e.g.
+// "-GtpTranscriptRecordingPath /tmp/transcript.txt").
+extern NSString* gtpTranscriptRecordingPathKey;
+extern NSString* gtpReplayTranscriptPathKey;
+extern NSString* gtpAnalysisEngineCountKey;
 // GTP canned commands settings
 extern NSString* gtpCannedCommandsKey;
 // Scoring settings
@@ -1000,6 +1029,8 @@ extern NSString* goMovePreviousKey;
 extern NSString* goMoveNextKey;
 extern NSString* goMoveCapturedStonesKey;
 extern NSString* goMoveMoveNumberKey;
+extern NSString* goMoveZobristHashKey;
+extern NSString* goMoveZobristHashHighKey;
 // GoMoveModel keys
 extern NSString* goMoveModelGameKey;
 extern NSString* goMoveModelMoveListKey;
@@ -1053,7 +1084,7 @@ extern NSString* goScoreStonesPlayedByWhiteKey;
 extern NSString* goScorePassesPlayedByBlackKey;
 extern NSString* goScorePassesPlayedByWhiteKey;
 extern NSString* goScoreGameKey;
-extern NSString* goScoreDidAskGtpEngineForDeadStonesKey;
+extern NSString* goScoreDidSetupInitialDeadStonesKey;
 extern NSString* goScoreLastCalculationHadErrorKey;
 // GtpLogItem keys
 extern NSString* gtpLogItemCommandStringKey;
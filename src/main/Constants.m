@@ -36,16 +36,22 @@ const int gDefaultHandicap = 0;
 const enum GoScoringSystem gDefaultScoringSystem = GoScoringSystemAreaScoring;
 const double gDefaultKomiAreaScoring = 7.5;
 const double gDefaultKomiTerritoryScoring = 6.5;
+const int gDefaultKeyframeInterval = 10;
+const int gDefaultKeyframeMemoryLimit = 64 * 1024;
+const bool gUse128BitZobristHashes = false;
 
 // Filesystem related constants
 NSString* sgfTemporaryFileName = @"---tmp+++.sgf";
 NSString* archiveBackupFileName = @"backup.plist";
 NSString* sgfBackupFileName = @"backup.sgf";
 NSString* inboxFolderName = @"Inbox";
+const NSTimeInterval gSgfGtpCommandTimeout = 30.0;
+const int gGtpAnalysisCacheMemoryLimit = 1024 * 1024;
 
 // GTP notifications
 NSString* gtpCommandWillBeSubmittedNotification = @"GtpCommandWillBeSubmitted";
 NSString* gtpResponseWasReceivedNotification = @"GtpResponseWasReceived";
+NSString* gtpSearchProgressWasReceivedNotification = @"GtpSearchProgressWasReceived";
 NSString* gtpEngineRunningNotification = @"GtpEngineRunning";
 NSString* gtpEngineIdleNotification = @"GtpEngineIdle";
 // GoGame notifications
@@ -282,6 +288,10 @@ NSString* sortAscendingKey = @"SortAscending";
 NSString* gtpLogViewKey = @"GtpLogView";
 NSString* gtpLogSizeKey = @"GtpLogSize";
 NSString* gtpLogViewFrontSideIsVisibleKey = @"GtpLogViewFrontSideIsVisible";
+// GTP transcript settings
+NSString* gtpTranscriptRecordingPathKey = @"GtpTranscriptRecordingPath";
+NSString* gtpReplayTranscriptPathKey = @"GtpReplayTranscriptPath";
+NSString* gtpAnalysisEngineCountKey = @"GtpAnalysisEngineCount";
 // GTP canned commands settings
 NSString* gtpCannedCommandsKey = @"GtpCannedCommands";
 // Scoring settings
@@ -308,7 +318,7 @@ NSString* tabOrderKey = @"TabOrder";
 
 // Constants for NSCoding
 // General constants
-const int nscodingVersion = 5;
+const int nscodingVersion = 6;
 NSString* nscodingVersionKey = @"NSCodingVersion";
 // Top-level object keys
 NSString* nsCodingGoGameKey = @"GoGame";
@@ -338,6 +348,8 @@ NSString* goMovePreviousKey = @"Previous";
 NSString* goMoveNextKey = @"Next";
 NSString* goMoveCapturedStonesKey = @"CapturedStones";
 NSString* goMoveMoveNumberKey = @"MoveNumber";
+NSString* goMoveZobristHashKey = @"ZobristHash";
+NSString* goMoveZobristHashHighKey = @"ZobristHashHigh";
 // GoMoveModel keys
 NSString* goMoveModelGameKey = @"Game";
 NSString* goMoveModelMoveListKey = @"MoveList";
@@ -390,7 +402,7 @@ NSString* goScoreStonesPlayedByWhiteKey = @"StonesPlayedByWhite";
 NSString* goScorePassesPlayedByBlackKey = @"PassesPlayedByBlack";
 NSString* goScorePassesPlayedByWhiteKey = @"PassesPlayedByWhite";
 NSString* goScoreGameKey = @"Game";
-NSString* goScoreDidAskGtpEngineForDeadStonesKey = @"DidAskGtpEngineForDeadStones";
+NSString* goScoreDidSetupInitialDeadStonesKey = @"DidAskGtpEngineForDeadStones";
 NSString* goScoreLastCalculationHadErrorKey = @"LastCalculationHadError";
 // GtpLogItem keys
 NSString* gtpLogItemCommandStringKey = @"CommandString";
@@ -21,6 +21,9 @@
 #import "../../model/BoardViewMetrics.h"
 #import "../../model/BoardViewModel.h"
 #import "../../../go/GoBoard.h"
+#import "../../../go/GoBoardPosition.h"
+#import "../../../go/GoBoardSnapshot.h"
+#import "../../../go/GoBoardState.h"
 #import "../../../go/GoGame.h"
 #import "../../../go/GoPoint.h"
 #import "../../../go/GoVertex.h"
@@ -131,8 +134,8 @@
   CGRect tileRect = [BoardViewDrawingHelper canvasRectForTile:self.tile
                                                       metrics:self.boardViewMetrics];
   GoBoard* board = [GoGame sharedGame].board;
-  [self.drawingPoints enumerateKeysAndObjectsUsingBlock:^(NSString* vertexString, NSNumber* influenceScoreAsNumber, BOOL* stop){
-    GoPoint* point = [board pointAtVertex:vertexString];
+  [self.drawingPoints enumerateKeysAndObjectsUsingBlock:^(NSNumber* pointIndexAsNumber, NSNumber* influenceScoreAsNumber, BOOL* stop){
+    GoPoint* point = [board pointAtIndex:[pointIndexAsNumber intValue]];
     float influenceScore = [influenceScoreAsNumber floatValue];
     enum GoColor influenceColor = [self influenceColor:influenceScore];
     [self drawInfluenceRectWithContext:context
@@ -228,9 +231,9 @@
 ///   influence is tied), or if it has a stone on it that has the same color as
 ///   the influence rectangle to be drawn.
 ///
-/// Dictionary keys are NSString objects that contain the intersection vertex.
-/// The vertex string can be used to get the GoPoint object that corresponds to
-/// the intersection.
+/// Dictionary keys are NSNumber objects that store the point index of the
+/// intersection (see GoPoint::pointIndex()). The point index can be used to
+/// get the GoPoint object that corresponds to the intersection.
 ///
 /// Dictionary values are NSNumber objects that store a float value, which
 /// represents the influence score of the intersection identified by the
@@ -253,6 +256,11 @@
   // list of points. On a 19x19 board this could save us quite a bit of time:
   // 381 points are iterated on 16 tiles (iPhone), i.e. over 6000 iterations.
   // on iPad where there are more tiles it is even worse.
+  const float* territoryStatisticsScores = game.board.boardState->territoryStatisticsScores;
+  // The snapshot is cached by GoBoardPosition, and reading stone colors from
+  // its bitboards is cheaper than querying each GoPoint
+  GoBoardPosition* boardPosition = game.boardPosition;
+  GoBoardSnapshot* boardSnapshot = [boardPosition snapshotForBoardPosition:boardPosition.currentBoardPosition];
   NSEnumerator* enumerator = [game.board pointEnumerator];
   GoPoint* point;
   while (point = [enumerator nextObject])
@@ -261,11 +269,11 @@
                                                                  metrics:self.boardViewMetrics];
     if (! CGRectIntersectsRect(tileRect, stoneRect))
       continue;
-    float influenceScore = fabsf(point.territoryStatisticsScore);
+    float influenceScore = fabsf(territoryStatisticsScores[point.pointIndex]);
     enum GoColor influenceColor = [self influenceColor:influenceScore];
     if (GoColorNone == influenceColor)
       continue;
-    enum GoColor intersectionOwner = [self intersectionOwner:point];
+    enum GoColor intersectionOwner = [boardSnapshot colorAtPointIndex:point.pointIndex];
     if (intersectionOwner == influenceColor)
     {
       // Don't draw if the player who has more influence on the intersection
@@ -274,7 +282,7 @@
       continue;
     }
     NSNumber* influenceScoreAsNumber = [[[NSNumber alloc] initWithFloat:influenceScore] autorelease];
-    [drawingPoints setObject:influenceScoreAsNumber forKey:point.vertex.string];
+    [drawingPoints setObject:influenceScoreAsNumber forKey:[NSNumber numberWithInt:point.pointIndex]];
   }
 
   return drawingPoints;
@@ -293,17 +301,4 @@
     return GoColorNone;  // there is no score, or black and white are tied
 }
 
-// -----------------------------------------------------------------------------
-/// @brief Private helper for calculateDrawingPoints().
-// -----------------------------------------------------------------------------
-- (enum GoColor) intersectionOwner:(GoPoint*)point
-{
-  if (! point.hasStone)
-    return GoColorNone;
-  else if (point.blackStone)
-    return GoColorBlack;
-  else
-    return GoColorWhite;
-}
-
 @end
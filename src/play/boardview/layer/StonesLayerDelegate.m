@@ -308,11 +308,11 @@
   CGRect tileRect = [BoardViewDrawingHelper canvasRectForTile:self.tile
                                                       metrics:self.boardViewMetrics];
 
-  [self.drawingPoints enumerateKeysAndObjectsUsingBlock:^(NSString* vertexString, NSNumber* stoneStateAsNumber, BOOL* stop)
+  [self.drawingPoints enumerateKeysAndObjectsUsingBlock:^(NSNumber* pointIndexAsNumber, NSNumber* stoneStateAsNumber, BOOL* stop)
    {
      // Ignore stoneStateAsNumber, get the current values directly from the
      // GoPoint object
-     GoPoint* point = [board pointAtVertex:vertexString];
+     GoPoint* point = [board pointAtIndex:[pointIndexAsNumber intValue]];
 
      // If self.dirtyPointsForCrossHairPoint is set it acts as a filter: We
      // don't want to draw more points than those that are within the clipping
@@ -361,9 +361,9 @@
 /// @brief Returns a dictionary that identifies the points whose intersections
 /// are located on this tile, and their current states.
 ///
-/// Dictionary keys are NSString objects that contain the intersection vertex.
-/// The vertex string can be used to get the GoPoint object that corresponds to
-/// the intersection.
+/// Dictionary keys are NSNumber objects that store the point index of the
+/// intersection (see GoPoint::pointIndex()). The point index can be used to
+/// get the GoPoint object that corresponds to the intersection.
 ///
 /// Dictionary values are NSNumber objects that store a GoColor enum value. The
 /// value identifies what needs to be drawn at the intersection (i.e. a black
@@ -392,7 +392,7 @@
     if (! CGRectIntersectsRect(tileRect, stoneRect))
       continue;
     NSNumber* stoneStateAsNumber = [[[NSNumber alloc] initWithInt:point.stoneState] autorelease];
-    [drawingPoints setObject:stoneStateAsNumber forKey:point.vertex.string];
+    [drawingPoints setObject:stoneStateAsNumber forKey:[NSNumber numberWithInt:point.pointIndex]];
   }
 
   return drawingPoints;
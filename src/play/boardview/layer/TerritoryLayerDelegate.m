@@ -250,7 +250,7 @@
   CGLayerRef inconsistentFillColorTerritoryLayer = [cache layerOfType:InconsistentFillColorTerritoryLayerType];
   CGLayerRef inconsistentDotSymbolTerritoryLayer = [cache layerOfType:InconsistentDotSymbolTerritoryLayerType];
 
-  [self.drawingPointsTerritory enumerateKeysAndObjectsUsingBlock:^(NSString* vertexString, NSNumber* territoryMarkupStyleAsNumber, BOOL* stop){
+  [self.drawingPointsTerritory enumerateKeysAndObjectsUsingBlock:^(NSNumber* pointIndexAsNumber, NSNumber* territoryMarkupStyleAsNumber, BOOL* stop){
     enum TerritoryMarkupStyle territoryMarkupStyle = [territoryMarkupStyleAsNumber intValue];
     CGLayerRef layerToDraw = 0;
     switch (territoryMarkupStyle)
@@ -270,7 +270,7 @@
       default:
         return;
     }
-    GoPoint* point = [board pointAtVertex:vertexString];
+    GoPoint* point = [board pointAtIndex:[pointIndexAsNumber intValue]];
     [BoardViewDrawingHelper drawLayer:layerToDraw
                           withContext:context
                       centeredAtPoint:point
@@ -289,8 +289,8 @@
   CGLayerRef blackSekiStoneSymbolLayer = [cache layerOfType:BlackSekiStoneSymbolLayerType];
   CGLayerRef whiteSekiStoneSymbolLayer = [cache layerOfType:WhiteSekiStoneSymbolLayerType];
 
-  [self.drawingPointsStoneGroupState enumerateKeysAndObjectsUsingBlock:^(NSString* vertexString, NSNumber* stoneGroupStateAsNumber, BOOL* stop){
-    GoPoint* point = [board pointAtVertex:vertexString];
+  [self.drawingPointsStoneGroupState enumerateKeysAndObjectsUsingBlock:^(NSNumber* pointIndexAsNumber, NSNumber* stoneGroupStateAsNumber, BOOL* stop){
+    GoPoint* point = [board pointAtIndex:[pointIndexAsNumber intValue]];
     enum GoStoneGroupState stoneGroupState = [stoneGroupStateAsNumber intValue];
     CGLayerRef layerToDraw = 0;
     switch (stoneGroupState)
@@ -340,9 +340,9 @@
 /// are located on this tile, and the markup style that should be used to draw
 /// the territory for these points.
 ///
-/// Dictionary keys are NSString objects that contain the intersection vertex.
-/// The vertex string can be used to get the GoPoint object that corresponds to
-/// the intersection.
+/// Dictionary keys are NSNumber objects that store the point index of the
+/// intersection (see GoPoint::pointIndex()). The point index can be used to
+/// get the GoPoint object that corresponds to the intersection.
 ///
 /// Dictionary values are NSNumber objects that store a TerritoryMarkupStyle
 /// enum value. The value identifies the layer that needs to be drawn at the
@@ -415,7 +415,7 @@
     }
 
     NSNumber* territoryMarkupStyleAsNumber = [[[NSNumber alloc] initWithInt:territoryMarkupStyle] autorelease];
-    [drawingPoints setObject:territoryMarkupStyleAsNumber forKey:point.vertex.string];
+    [drawingPoints setObject:territoryMarkupStyleAsNumber forKey:[NSNumber numberWithInt:point.pointIndex]];
   }
 
   return drawingPoints;
@@ -426,9 +426,9 @@
 /// are located on this tile, and the stone group state of the region that each
 /// point belongs to.
 ///
-/// Dictionary keys are NSString objects that contain the intersection vertex.
-/// The vertex string can be used to get the GoPoint object that corresponds to
-/// the intersection.
+/// Dictionary keys are NSNumber objects that store the point index of the
+/// intersection (see GoPoint::pointIndex()). The point index can be used to
+/// get the GoPoint object that corresponds to the intersection.
 ///
 /// Dictionary values are NSNumber objects that store a GoStoneGroupState enum
 /// value.
@@ -461,7 +461,7 @@
       continue;
     enum GoStoneGroupState stoneGroupState = point.region.stoneGroupState;
     NSNumber* stoneGroupStateAsNumber = [[[NSNumber alloc] initWithInt:stoneGroupState] autorelease];
-    [drawingPoints setObject:stoneGroupStateAsNumber forKey:point.vertex.string];
+    [drawingPoints setObject:stoneGroupStateAsNumber forKey:[NSNumber numberWithInt:point.pointIndex]];
   }
 
   return drawingPoints;
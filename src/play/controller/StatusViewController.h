@@ -23,6 +23,9 @@
 /// Most of the time the status view displays textual information, but whenever
 /// the GTP engine is taking a long time to calculate something (e.g. computer
 /// player makes its move), the status view also displays an activity indicator.
+/// While the computer player searches for its move, the status view also shows
+/// the move that the GTP engine currently considers best, and the estimated
+/// winning probability of that move (see GtpSearchProgress).
 ///
 /// StatusViewController is a child view controller.
 // -----------------------------------------------------------------------------
@@ -25,6 +25,7 @@
 #import "../../go/GoPoint.h"
 #import "../../go/GoScore.h"
 #import "../../go/GoVertex.h"
+#import "../../gtp/GtpSearchProgress.h"
 #import "../../main/ApplicationDelegate.h"
 #import "../../player/Player.h"
 #import "../../shared/LayoutManager.h"
@@ -46,6 +47,10 @@
 @property(nonatomic, assign) bool activityIndicatorNeedsUpdate;
 @property(nonatomic, assign) bool statusLabelNeedsUpdate;
 @property(nonatomic, retain) NSArray* crossHairInformation;
+/// @brief The most recent progress report of the computer player's search. Is
+/// nil if the computer player is not thinking, or if no report has been
+/// received yet.
+@property(nonatomic, retain) GtpSearchProgress* searchProgress;
 @property(nonatomic, assign) bool shouldDisplayActivityIndicator;
 @property(nonatomic, retain) NSLayoutConstraint* activityIndicatorWidthConstraint;
 @property(nonatomic, retain) NSLayoutConstraint* activityIndicatorSpacingConstraint;
@@ -95,6 +100,7 @@
   self.statusLabel = nil;
   self.activityIndicator = nil;
   self.crossHairInformation = nil;
+  self.searchProgress = nil;
   self.activityIndicatorWidthConstraint = nil;
   self.activityIndicatorSpacingConstraint = nil;
 }
@@ -275,6 +281,7 @@
   [center addObserver:self selector:@selector(goGameStateChanged:) name:goGameStateChanged object:nil];
   [center addObserver:self selector:@selector(computerPlayerThinkingChanged:) name:computerPlayerThinkingStarts object:nil];
   [center addObserver:self selector:@selector(computerPlayerThinkingChanged:) name:computerPlayerThinkingStops object:nil];
+  [center addObserver:self selector:@selector(gtpSearchProgressWasReceived:) name:gtpSearchProgressWasReceivedNotification object:nil];
   [center addObserver:self selector:@selector(goScoreScoringDisabled:) name:goScoreScoringDisabled object:nil];
   [center addObserver:self selector:@selector(goScoreCalculationEnds:) name:goScoreCalculationEnds object:nil];
   [center addObserver:self selector:@selector(askGtpEngineForDeadStonesStarts:) name:askGtpEngineForDeadStonesStarts object:nil];
@@ -413,6 +420,12 @@
             statusText = [playerName stringByAppendingString:@" is thinking..."];
           else
             statusText = [NSString stringWithFormat:@"Computer is playing for %@...", playerName];
+          if (self.searchProgress.bestMove)
+          {
+            statusText = [statusText stringByAppendingFormat:@" %@", self.searchProgress.bestMove];
+            if (self.searchProgress.winningProbability >= 0.0f)
+              statusText = [statusText stringByAppendingFormat:@" (%d%%)", (int)(self.searchProgress.winningProbability * 100.0f + 0.5f)];
+          }
           break;
         }
         case GoGameComputerIsThinkingReasonPlayerInfluence:
@@ -580,11 +593,29 @@
 // -----------------------------------------------------------------------------
 - (void) computerPlayerThinkingChanged:(NSNotification*)notification
 {
+  // Progress reports are valid only for the search that has just started or
+  // stopped
+  self.searchProgress = nil;
   self.activityIndicatorNeedsUpdate = true;
   self.statusLabelNeedsUpdate = true;
   [self delayedUpdate];
 }
 
+// -----------------------------------------------------------------------------
+/// @brief Responds to the #gtpSearchProgressWasReceivedNotification
+/// notification.
+// -----------------------------------------------------------------------------
+- (void) gtpSearchProgressWasReceived:(NSNotification*)notification
+{
+  // Ignore reports of the search that the engine performs while it ponders
+  GoGame* game = [GoGame sharedGame];
+  if (! game.isComputerThinking || GoGameComputerIsThinkingReasonComputerPlay != game.reasonForComputerIsThinking)
+    return;
+  self.searchProgress = [notification object];
+  self.statusLabelNeedsUpdate = true;
+  [self delayedUpdate];
+}
+
 // -----------------------------------------------------------------------------
 /// @brief Responds to the #goScoreScoringDisabled notification.
 // -----------------------------------------------------------------------------
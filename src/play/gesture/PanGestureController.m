@@ -21,8 +21,10 @@
 #import "../gameaction/GameActionManager.h"
 #import "../model/BoardViewMetrics.h"
 #import "../model/BoardViewModel.h"
+#import "../../go/GoBitboard.h"
 #import "../../go/GoBoardPosition.h"
 #import "../../go/GoGame.h"
+#import "../../go/GoPoint.h"
 #import "../../go/GoScore.h"
 #import "../../main/ApplicationDelegate.h"
 #import "../../main/MainUtility.h"
@@ -162,7 +164,16 @@
     // be offset due to the user preference "stoneDistanceFromFingertip"
     bool isCrossHairInVisibleRect = CGRectContainsPoint(visibleRect, crossHairIntersection.coordinates);
     if (isCrossHairInVisibleRect)
-      isLegalMove = [[GoGame sharedGame] isLegalMove:crossHairIntersection.point isIllegalReason:&illegalReason];
+    {
+      // The legal move mask is calculated only once per board position, so
+      // moving the cross-hair around is cheap. The reason why a move is
+      // illegal is also looked up from the cache that backs the mask.
+      GoGame* game = [GoGame sharedGame];
+      GoPoint* crossHairPoint = crossHairIntersection.point;
+      isLegalMove = GoBitboardTestBit([game legalMoveMask], crossHairPoint.pointIndex);
+      if (! isLegalMove)
+        [game isLegalMove:crossHairPoint isIllegalReason:&illegalReason];
+    }
     else
       crossHairIntersection = BoardViewIntersectionNull;
   }
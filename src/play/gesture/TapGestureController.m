@@ -86,8 +86,6 @@
   [center addObserver:self selector:@selector(goGameDidCreate:) name:goGameDidCreate object:nil];
   [center addObserver:self selector:@selector(goScoreScoringEnabled:) name:goScoreScoringEnabled object:nil];
   [center addObserver:self selector:@selector(goScoreScoringDisabled:) name:goScoreScoringDisabled object:nil];
-  [center addObserver:self selector:@selector(goScoreCalculationStarts:) name:goScoreCalculationStarts object:nil];
-  [center addObserver:self selector:@selector(goScoreCalculationEnds:) name:goScoreCalculationEnds object:nil];
 }
 
 // -----------------------------------------------------------------------------
@@ -174,32 +172,16 @@
   [self updateTappingEnabled];
 }
 
-// -----------------------------------------------------------------------------
-/// @brief Responds to the #goScoreCalculationStarts notification.
-// -----------------------------------------------------------------------------
-- (void) goScoreCalculationStarts:(NSNotification*)notification
-{
-  [self updateTappingEnabled];
-}
-
-// -----------------------------------------------------------------------------
-/// @brief Responds to the #goScoreCalculationEnds notification.
-// -----------------------------------------------------------------------------
-- (void) goScoreCalculationEnds:(NSNotification*)notification
-{
-  [self updateTappingEnabled];
-}
-
 // -----------------------------------------------------------------------------
 /// @brief Updates whether tapping is enabled.
+///
+/// Tapping remains enabled while a score calculation is in progress. GoScore
+/// defers stone group toggles until the calculation can pick them up.
 // -----------------------------------------------------------------------------
 - (void) updateTappingEnabled
 {
   GoScore* score = [GoGame sharedGame].score;
-  if (score.scoringEnabled)
-    self.tappingEnabled = ! score.scoringInProgress;
-  else
-    self.tappingEnabled = false;
+  self.tappingEnabled = score.scoringEnabled;
 }
 
 @end
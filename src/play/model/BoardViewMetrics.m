@@ -19,6 +19,7 @@
 #import "BoardViewMetrics.h"
 #import "../model/BoardViewModel.h"
 #import "../../go/GoBoard.h"
+#import "../../go/GoBoardState.h"
 #import "../../go/GoGame.h"
 #import "../../go/GoPoint.h"
 #import "../../go/GoVertex.h"
@@ -615,16 +616,17 @@
   struct GoVertexNumeric numericVertex;
   numericVertex.x = 1 + (coordinates.x - self.topLeftPointX) / self.pointDistance;
   numericVertex.y = self.boardSize - (coordinates.y - self.topLeftPointY) / self.pointDistance;
-  GoVertex* vertex;
-  @try
-  {
-    vertex = [GoVertex vertexFromNumeric:numericVertex];
-  }
-  @catch (NSException* exception)
+  // This method is invoked very often during panning, so instead of creating
+  // a GoVertex and letting it validate the numeric vertex, we perform the range
+  // check ourselves and then look up the GoPoint via its point index
+  GoBoard* board = [GoGame sharedGame].board;
+  if (numericVertex.x < 1 || numericVertex.x > board.size ||
+      numericVertex.y < 1 || numericVertex.y > board.size)
   {
     return nil;
   }
-  return [[GoGame sharedGame].board pointAtVertex:vertex.string];
+  int pointIndex = GoBoardStatePointIndexOfVertex(board.boardState, numericVertex.x, numericVertex.y);
+  return [board pointAtIndex:pointIndex];
 }
 
 // -----------------------------------------------------------------------------
@@ -20,6 +20,7 @@
 #import "GtpEngineProfileModel.h"
 #import "../go/GoBoard.h"
 #import "../go/GoGame.h"
+#import "../gtp/GtpAnalysisCache.h"
 #import "../gtp/GtpCommand.h"
 #import "../gtp/GtpUtilities.h"
 #import "../main/ApplicationDelegate.h"
@@ -216,6 +217,17 @@
   command = [GtpCommand command:commandString];
   command.waitUntilDone = false;
   [command submit];
+  // The interval at which the engine reports the progress of its search, while
+  // ComputerPlayMoveCommand has live graphics enabled (see
+  // GtpUtilities::startLiveGraphics()). The interval is measured in
+  // simulations; GtpEngine throttles the reports further so that there is at
+  // most one update every half second.
+  command = [GtpCommand command:@"uct_param_search live_gfx_interval 1000"];
+  command.waitUntilDone = false;
+  [command submit];
+  // Results obtained with the old settings do not reflect what the engine
+  // would now report
+  [[ApplicationDelegate sharedDelegate].gtpAnalysisCache removeAllResults];
 
   self.hasUnappliedChanges = false;
   if (! self.isActiveProfile)
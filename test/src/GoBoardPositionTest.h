@@ -35,6 +35,8 @@
 - (void) testOutOfBoundsPositionTooHigh;
 - (void) testStateAfterDiscard;
 - (void) testBoardStateAfterPositionChange;
+- (void) testBoardStateAfterPositionChangeWithKeyframes;
+- (void) testKeyframesAfterMovesAreReplaced;
 - (void) testKVONotifications;
 
 @end
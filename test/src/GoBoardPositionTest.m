@@ -19,9 +19,13 @@
 #import "GoBoardPositionTest.h"
 
 // Application includes
+#import <go/GoBitboard.h>
 #import <go/GoBoard.h>
 #import <go/GoBoardPosition.h>
+#import <go/GoBoardRegion.h>
+#import <go/GoBoardState.h>
 #import <go/GoGame.h>
+#import <go/GoMove.h>
 #import <go/GoMoveModel.h>
 #import <go/GoPoint.h>
 #import <go/GoUtilities.h>
@@ -230,6 +234,101 @@
   XCTAssertEqual(expectedNumberOfRegions, m_game.board.regions.count);
 }
 
+// -----------------------------------------------------------------------------
+/// @brief Checks that the state of GoPoint and other Go objects is correct if
+/// keyframes are used to change the current board position.
+// -----------------------------------------------------------------------------
+- (void) testBoardStateAfterPositionChangeWithKeyframes
+{
+  GoBoardPosition* boardPosition = m_game.boardPosition;
+  XCTAssertEqual(gDefaultKeyframeInterval, boardPosition.keyframeInterval);
+  XCTAssertEqual(gDefaultKeyframeMemoryLimit, boardPosition.keyframeMemoryLimit);
+  XCTAssertThrowsSpecificNamed(boardPosition.keyframeInterval = 0,
+                               NSException, NSInvalidArgumentException, @"keyframe interval 0");
+  XCTAssertThrowsSpecificNamed(boardPosition.keyframeMemoryLimit = -1,
+                               NSException, NSInvalidArgumentException, @"keyframe memory limit -1");
+  boardPosition.keyframeInterval = 2;
+
+  // Play a few moves, including a capture, and remember how the board looks
+  // like in every board position
+  NSArray* vertexes = @[@"A2", @"A1", @"B1", @"C3", @"D4", @"E5", @"F6"];
+  const int numberOfBoardPositions = 8;
+  struct GoBitboard blackStones[numberOfBoardPositions];
+  struct GoBitboard whiteStones[numberOfBoardPositions];
+  NSUInteger numberOfRegions[numberOfBoardPositions];
+  struct GoBoardState* boardState = m_game.board.boardState;
+  for (int boardPositionIndex = 0; boardPositionIndex < numberOfBoardPositions; ++boardPositionIndex)
+  {
+    if (boardPositionIndex > 0)
+      [m_game play:[m_game.board pointAtVertex:[vertexes objectAtIndex:boardPositionIndex - 1]]];
+    blackStones[boardPositionIndex] = boardState->blackStones;
+    whiteStones[boardPositionIndex] = boardState->whiteStones;
+    numberOfRegions[boardPositionIndex] = m_game.board.regions.count;
+  }
+  XCTAssertEqual(GoColorNone, [m_game.board pointAtVertex:@"A1"].stoneState);
+
+  // Jump around so that keyframes are stored and restored in both directions
+  int targetBoardPositions[] = {0, 7, 3, 1, 6, 2, 5, 0, 4};
+  for (int indexOfTarget = 0; indexOfTarget < sizeof(targetBoardPositions) / sizeof(int); ++indexOfTarget)
+  {
+    int targetBoardPosition = targetBoardPositions[indexOfTarget];
+    boardPosition.currentBoardPosition = targetBoardPosition;
+    XCTAssertEqual(targetBoardPosition, boardPosition.currentBoardPosition);
+    XCTAssertTrue(GoBitboardIsEqual(&blackStones[targetBoardPosition], &boardState->blackStones));
+    XCTAssertTrue(GoBitboardIsEqual(&whiteStones[targetBoardPosition], &boardState->whiteStones));
+    XCTAssertEqual(numberOfRegions[targetBoardPosition], m_game.board.regions.count);
+  }
+
+  // Going back after a keyframe was restored must still undo captures
+  // correctly
+  boardPosition.currentBoardPosition = 4;
+  boardPosition.currentBoardPosition = 2;
+  XCTAssertEqual(GoColorWhite, [m_game.board pointAtVertex:@"A1"].stoneState);
+  XCTAssertEqual(GoColorNone, [m_game.board pointAtVertex:@"B1"].stoneState);
+  XCTAssertEqual(1, [m_game.board pointAtVertex:@"A1"].region.size);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Checks that keyframes for board positions after the first changed
+/// move are not used after moves were discarded and replaced by other moves
+/// between GoMoveModel::beginUpdates() and GoMoveModel::endUpdates(), i.e.
+/// when the number of moves does not change.
+// -----------------------------------------------------------------------------
+- (void) testKeyframesAfterMovesAreReplaced
+{
+  GoBoardPosition* boardPosition = m_game.boardPosition;
+  GoMoveModel* moveModel = m_game.moveModel;
+  boardPosition.keyframeInterval = 1;
+  [m_game play:[m_game.board pointAtVertex:@"C3"]];
+  [m_game play:[m_game.board pointAtVertex:@"D4"]];
+  [m_game play:[m_game.board pointAtVertex:@"E5"]];
+  // Store keyframes for all board positions
+  boardPosition.currentBoardPosition = 0;
+  boardPosition.currentBoardPosition = 3;
+
+  // Replace the last two moves. The current board position does not change.
+  [moveModel beginUpdates];
+  [[moveModel moveAtIndex:2] undo];
+  [[moveModel moveAtIndex:1] undo];
+  [moveModel discardMovesFromIndex:1];
+  [m_game play:[m_game.board pointAtVertex:@"F6"]];
+  [m_game play:[m_game.board pointAtVertex:@"G7"]];
+  [moveModel endUpdates];
+  XCTAssertEqual(3, moveModel.numberOfMoves);
+  XCTAssertEqual(3, boardPosition.currentBoardPosition);
+  struct GoBoardState* boardState = m_game.board.boardState;
+  struct GoBitboard blackStones = boardState->blackStones;
+  struct GoBitboard whiteStones = boardState->whiteStones;
+
+  boardPosition.currentBoardPosition = 0;
+  boardPosition.currentBoardPosition = 3;
+  XCTAssertTrue(GoBitboardIsEqual(&blackStones, &boardState->blackStones));
+  XCTAssertTrue(GoBitboardIsEqual(&whiteStones, &boardState->whiteStones));
+  XCTAssertEqual(GoColorWhite, [m_game.board pointAtVertex:@"F6"].stoneState);
+  XCTAssertEqual(GoColorNone, [m_game.board pointAtVertex:@"D4"].stoneState);
+  XCTAssertEqual(GoColorNone, [m_game.board pointAtVertex:@"E5"].stoneState);
+}
+
 // -----------------------------------------------------------------------------
 /// @brief Checks that KVO notifications are sent, and that they are sent in
 /// the order that they are documented.
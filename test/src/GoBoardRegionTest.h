@@ -36,7 +36,9 @@
 - (void) testIsStoneGroup;
 - (void) testColor;
 - (void) testLiberties;
+- (void) testLibertiesAfterCaptureAndUndo;
 - (void) testAdjacentRegions;
+- (void) testPointsBitboard;
 - (void) testScoringMode;
 - (void) testDeallocation;
 
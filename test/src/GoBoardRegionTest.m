@@ -21,6 +21,7 @@
 // Application includes
 #import <go/GoGame.h>
 #import <go/GoBoard.h>
+#import <go/GoBitboard.h>
 #import <go/GoBoardRegion.h>
 #import <go/GoPoint.h>
 
@@ -379,6 +380,43 @@
                               NSException, NSInternalInconsistencyException, @"region is no stone group");
 }
 
+// -----------------------------------------------------------------------------
+/// @brief Exercises the liberties() method when stone groups are captured and
+/// the capturing move is undone.
+// -----------------------------------------------------------------------------
+- (void) testLibertiesAfterCaptureAndUndo
+{
+  GoBoard* board = m_game.board;
+  GoPoint* pointA1 = [board pointAtVertex:@"A1"];
+  GoPoint* pointB1 = [board pointAtVertex:@"B1"];
+  GoPoint* pointC1 = [board pointAtVertex:@"C1"];
+  GoPoint* pointA2 = [board pointAtVertex:@"A2"];
+  GoPoint* pointB2 = [board pointAtVertex:@"B2"];
+
+  [m_game play:pointA2];
+  [m_game play:pointA1];
+  [m_game play:pointB2];
+  [m_game play:pointB1];
+  XCTAssertEqual(1, [pointA1.region liberties]);
+  XCTAssertEqual(pointA1.region, pointB1.region);
+  XCTAssertEqual(3, [pointA2.region liberties]);
+
+  // Black captures the two white stones
+  [m_game play:pointC1];
+  XCTAssertFalse(pointA1.hasStone);
+  XCTAssertFalse(pointB1.hasStone);
+  XCTAssertEqual(5, [pointA2.region liberties]);
+  XCTAssertEqual(3, [pointC1.region liberties]);
+
+  // Undo restores the captured stones and their single liberty
+  [m_game.lastMove undo];
+  XCTAssertEqual(GoColorWhite, pointA1.stoneState);
+  XCTAssertEqual(GoColorWhite, pointB1.stoneState);
+  XCTAssertEqual(pointA1.region, pointB1.region);
+  XCTAssertEqual(1, [pointA1.region liberties]);
+  XCTAssertEqual(3, [pointA2.region liberties]);
+}
+
 // -----------------------------------------------------------------------------
 /// @brief Exercises the adjacentRegions() method.
 // -----------------------------------------------------------------------------
@@ -451,6 +489,56 @@
   XCTAssertEqual(expectedNumberOfAdjacentRegions, adjacentRegions.count);
 }
 
+// -----------------------------------------------------------------------------
+/// @brief Exercises the pointsBitboard() method.
+// -----------------------------------------------------------------------------
+- (void) testPointsBitboard
+{
+  GoBoard* board = m_game.board;
+  GoPoint* pointA1 = [board pointAtVertex:@"A1"];
+  GoPoint* pointA2 = [board pointAtVertex:@"A2"];
+  GoPoint* pointB1 = [board pointAtVertex:@"B1"];
+  GoPoint* pointC1 = [board pointAtVertex:@"C1"];
+  GoBoardRegion* mainRegion = pointA1.region;
+
+  const struct GoBitboard* bitboard = [mainRegion pointsBitboard];
+  XCTAssertTrue(bitboard != NULL);
+  XCTAssertEqual([mainRegion size], GoBitboardPopCount(bitboard));
+  XCTAssertTrue(GoBitboardTestBit(bitboard, pointA1.pointIndex));
+
+  // Placing stones on A2 and B1 splits off the corner A1
+  pointA2.stoneState = GoColorBlack;
+  GoBoardRegion* regionA2 = [GoBoardRegion regionWithPoint:pointA2];
+  pointB1.stoneState = GoColorBlack;
+  [GoBoardRegion regionWithPoint:pointB1];
+  GoBoardRegion* regionA1 = pointA1.region;
+  mainRegion = pointC1.region;
+  XCTAssertTrue(regionA1 != mainRegion);
+
+  bitboard = [regionA1 pointsBitboard];
+  XCTAssertEqual(1, GoBitboardPopCount(bitboard));
+  XCTAssertTrue(GoBitboardTestBit(bitboard, pointA1.pointIndex));
+  bitboard = [regionA2 pointsBitboard];
+  XCTAssertEqual(1, GoBitboardPopCount(bitboard));
+  XCTAssertTrue(GoBitboardTestBit(bitboard, pointA2.pointIndex));
+  bitboard = [mainRegion pointsBitboard];
+  XCTAssertEqual([mainRegion size], GoBitboardPopCount(bitboard));
+  XCTAssertFalse(GoBitboardTestBit(bitboard, pointA1.pointIndex));
+  XCTAssertFalse(GoBitboardTestBit(bitboard, pointA2.pointIndex));
+  XCTAssertFalse(GoBitboardTestBit(bitboard, pointB1.pointIndex));
+  XCTAssertTrue(GoBitboardTestBit(bitboard, pointC1.pointIndex));
+
+  // Removing the stone on B1 joins the corner with the main region again
+  pointB1.stoneState = GoColorNone;
+  [mainRegion addPoint:pointB1];
+  [mainRegion joinRegion:regionA1];
+  bitboard = [mainRegion pointsBitboard];
+  XCTAssertEqual([mainRegion size], GoBitboardPopCount(bitboard));
+  XCTAssertTrue(GoBitboardTestBit(bitboard, pointA1.pointIndex));
+  XCTAssertTrue(GoBitboardTestBit(bitboard, pointB1.pointIndex));
+  XCTAssertFalse(GoBitboardTestBit(bitboard, pointA2.pointIndex));
+}
+
 // -----------------------------------------------------------------------------
 /// @brief Exercises the @e scoringMode property.
 // -----------------------------------------------------------------------------
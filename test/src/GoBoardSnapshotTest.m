@@ -0,0 +1,243 @@
+// -----------------------------------------------------------------------------
+// Copyright 2014 Patrick Näf (herzbube@herzbube.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// -----------------------------------------------------------------------------
+
+
+
+// Test includes
+#import "GoBoardSnapshotTest.h"
+
+// Application includes
+#import <go/GoBitboard.h>
+#import <go/GoBoard.h>
+#import <go/GoBoardPosition.h>
+#import <go/GoBoardRegion.h>
+#import <go/GoBoardSnapshot.h>
+#import <go/GoBoardState.h>
+#import <go/GoGame.h>
+#import <go/GoMoveModel.h>
+#import <go/GoPoint.h>
+#import <go/GoVertex.h>
+
+
+@implementation GoBoardSnapshotTest
+
+// -----------------------------------------------------------------------------
+/// @brief Checks that the snapshot for every board position matches the state
+/// of the Go board in that board position, regardless of the order in which
+/// snapshots are requested.
+// -----------------------------------------------------------------------------
+- (void) testSnapshotForBoardPosition
+{
+  GoBoard* board = m_game.board;
+  GoBoardPosition* boardPosition = m_game.boardPosition;
+  struct GoBoardState* boardState = board.boardState;
+
+  [m_game play:[board pointAtVertex:@"A2"]];
+  [m_game play:[board pointAtVertex:@"A1"]];
+  [m_game play:[board pointAtVertex:@"B1"]];
+  [m_game pass];
+  [m_game play:[board pointAtVertex:@"Q16"]];
+  XCTAssertEqual(5, boardPosition.currentBoardPosition);
+
+  // Request snapshots out of order so that they are derived in both directions
+  int boardPositions[] = {2, 0, 5, 3, 1, 4};
+  for (int index = 0; index < sizeof(boardPositions) / sizeof(int); ++index)
+  {
+    GoBoardSnapshot* snapshot = [boardPosition snapshotForBoardPosition:boardPositions[index]];
+    XCTAssertEqual(boardPositions[index], snapshot.boardPosition);
+    XCTAssertEqual(19, snapshot.boardSize);
+    XCTAssertEqual(snapshot, [boardPosition snapshotForBoardPosition:boardPositions[index]]);
+  }
+  // Requesting snapshots must not change the board
+  XCTAssertEqual(5, boardPosition.currentBoardPosition);
+  XCTAssertEqual(GoColorNone, [board pointAtVertex:@"A1"].stoneState);
+
+  for (int index = 0; index < sizeof(boardPositions) / sizeof(int); ++index)
+  {
+    boardPosition.currentBoardPosition = boardPositions[index];
+    GoBoardSnapshot* snapshot = [boardPosition snapshotForBoardPosition:boardPositions[index]];
+    XCTAssertTrue(GoBitboardIsEqual(&boardState->blackStones, snapshot.blackStones));
+    XCTAssertTrue(GoBitboardIsEqual(&boardState->whiteStones, snapshot.whiteStones));
+    XCTAssertTrue(GoBitboardIsEqual(&boardState->onBoardMask, snapshot.onBoardMask));
+  }
+
+  GoBoardSnapshot* snapshot = [boardPosition snapshotForBoardPosition:2];
+  struct GoVertexNumeric vertexA1 = [board pointAtVertex:@"A1"].vertex.numeric;
+  struct GoVertexNumeric vertexA2 = [board pointAtVertex:@"A2"].vertex.numeric;
+  struct GoVertexNumeric vertexB1 = [board pointAtVertex:@"B1"].vertex.numeric;
+  XCTAssertEqual(GoColorWhite, [snapshot colorAtVertex:vertexA1]);
+  XCTAssertEqual(GoColorBlack, [snapshot colorAtVertex:vertexA2]);
+  XCTAssertEqual(GoColorNone, [snapshot colorAtVertex:vertexB1]);
+  XCTAssertEqual([board pointAtVertex:@"A1"].pointIndex, [snapshot pointIndexOfVertex:vertexA1]);
+  snapshot = [boardPosition snapshotForBoardPosition:3];
+  XCTAssertEqual(GoColorNone, [snapshot colorAtVertex:vertexA1]);
+  XCTAssertEqual(GoColorBlack, [snapshot colorAtVertex:vertexB1]);
+  XCTAssertEqual(GoColorNone, [snapshot colorAtPointIndex:0]);
+  XCTAssertEqual(GoColorNone, [snapshot colorAtPointIndex:-1]);
+  struct GoVertexNumeric vertexOutsideBoard = { 0, 1 };
+  XCTAssertThrowsSpecificNamed([snapshot colorAtVertex:vertexOutsideBoard],
+                               NSException, NSRangeException, @"vertex outside board");
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Checks that a snapshot that has been handed out does not change
+/// when the board changes.
+// -----------------------------------------------------------------------------
+- (void) testSnapshotIsImmutable
+{
+  GoBoard* board = m_game.board;
+  GoBoardPosition* boardPosition = m_game.boardPosition;
+
+  [m_game play:[board pointAtVertex:@"A2"]];
+  [m_game play:[board pointAtVertex:@"A1"]];
+  GoBoardSnapshot* snapshot = [boardPosition snapshotForBoardPosition:2];
+  struct GoBitboard blackStones = *snapshot.blackStones;
+  struct GoBitboard whiteStones = *snapshot.whiteStones;
+
+  [m_game play:[board pointAtVertex:@"B1"]];
+  boardPosition.currentBoardPosition = 0;
+  XCTAssertEqual(2, snapshot.boardPosition);
+  XCTAssertTrue(GoBitboardIsEqual(&blackStones, snapshot.blackStones));
+  XCTAssertTrue(GoBitboardIsEqual(&whiteStones, snapshot.whiteStones));
+  XCTAssertEqual(1, GoBitboardPopCount(snapshot.blackStones));
+  XCTAssertEqual(1, GoBitboardPopCount(snapshot.whiteStones));
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Checks that snapshots of discarded board positions are no longer
+/// handed out.
+// -----------------------------------------------------------------------------
+- (void) testSnapshotsAfterDiscard
+{
+  GoBoard* board = m_game.board;
+  GoBoardPosition* boardPosition = m_game.boardPosition;
+
+  [m_game play:[board pointAtVertex:@"A2"]];
+  [m_game play:[board pointAtVertex:@"A1"]];
+  [m_game play:[board pointAtVertex:@"B1"]];
+  GoBoardSnapshot* snapshot1 = [boardPosition snapshotForBoardPosition:1];
+  GoBoardSnapshot* snapshot3 = [boardPosition snapshotForBoardPosition:3];
+
+  boardPosition.currentBoardPosition = 1;
+  [m_game.moveModel discardMovesFromIndex:1];
+  [m_game play:[board pointAtVertex:@"B2"]];
+  XCTAssertEqual(2, boardPosition.currentBoardPosition);
+
+  XCTAssertEqual(snapshot1, [boardPosition snapshotForBoardPosition:1]);
+  XCTAssertThrowsSpecificNamed([boardPosition snapshotForBoardPosition:3],
+                               NSException, NSRangeException, @"discarded board position");
+  GoBoardSnapshot* snapshot2 = [boardPosition snapshotForBoardPosition:2];
+  XCTAssertEqual(GoColorWhite, [snapshot2 colorAtPointIndex:[board pointAtVertex:@"B2"].pointIndex]);
+  XCTAssertEqual(GoColorNone, [snapshot2 colorAtPointIndex:[board pointAtVertex:@"A1"].pointIndex]);
+  XCTAssertEqual(3, snapshot3.boardPosition);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Exercises the getStones:connectedToPointIndex:() method.
+// -----------------------------------------------------------------------------
+- (void) testGetStonesConnectedToPointIndex
+{
+  GoBoard* board = m_game.board;
+  [m_game play:[board pointAtVertex:@"A2"]];
+  [m_game play:[board pointAtVertex:@"A1"]];
+  [m_game play:[board pointAtVertex:@"B1"]];
+  [m_game play:[board pointAtVertex:@"Q16"]];
+  [m_game play:[board pointAtVertex:@"B2"]];
+  GoBoardSnapshot* snapshot = [m_game.boardPosition snapshotForBoardPosition:5];
+
+  struct GoBitboard stones;
+  [snapshot getStones:&stones connectedToPointIndex:[board pointAtVertex:@"A2"].pointIndex];
+  XCTAssertEqual(3, GoBitboardPopCount(&stones));
+  XCTAssertTrue(GoBitboardTestBit(&stones, [board pointAtVertex:@"B1"].pointIndex));
+  XCTAssertTrue(GoBitboardTestBit(&stones, [board pointAtVertex:@"B2"].pointIndex));
+  [snapshot getStones:&stones connectedToPointIndex:[board pointAtVertex:@"Q16"].pointIndex];
+  XCTAssertEqual(1, GoBitboardPopCount(&stones));
+  // A1 is an empty area of its own because the captured stone left a hole
+  [snapshot getStones:&stones connectedToPointIndex:[board pointAtVertex:@"A1"].pointIndex];
+  XCTAssertEqual(1, GoBitboardPopCount(&stones));
+  [snapshot getStones:&stones connectedToPointIndex:[board pointAtVertex:@"T19"].pointIndex];
+  XCTAssertEqual(361 - 4 - 1, GoBitboardPopCount(&stones));
+  [snapshot getStones:&stones connectedToPointIndex:0];
+  XCTAssertTrue(GoBitboardIsEmpty(&stones));
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Exercises the snapshotForBoardPosition:() method with board
+/// positions that do not exist.
+// -----------------------------------------------------------------------------
+- (void) testOutOfBoundsBoardPosition
+{
+  GoBoardPosition* boardPosition = m_game.boardPosition;
+  XCTAssertNotNil([boardPosition snapshotForBoardPosition:0]);
+  XCTAssertThrowsSpecificNamed([boardPosition snapshotForBoardPosition:-1],
+                               NSException, NSRangeException, @"negative board position");
+  XCTAssertThrowsSpecificNamed([boardPosition snapshotForBoardPosition:1],
+                               NSException, NSRangeException, @"board position too high");
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Exercises the snapshotWithRegions:() method and the region
+/// accessors.
+// -----------------------------------------------------------------------------
+- (void) testSnapshotWithRegions
+{
+  GoBoard* board = m_game.board;
+  [m_game play:[board pointAtVertex:@"A2"]];
+  [m_game play:[board pointAtVertex:@"Q16"]];
+  [m_game play:[board pointAtVertex:@"B1"]];
+  GoBoardSnapshot* snapshot = [m_game.boardPosition snapshotForBoardPosition:3];
+  XCTAssertEqual(0, snapshot.numberOfRegions);
+  XCTAssertEqual(-1, [snapshot regionIndexAtPointIndex:[board pointAtVertex:@"A2"].pointIndex]);
+
+  NSArray* regions = board.regions;
+  GoBoardSnapshot* snapshotWithRegions = [snapshot snapshotWithRegions:regions];
+  XCTAssertEqual(0, snapshot.numberOfRegions);
+  XCTAssertEqual((int)regions.count, snapshotWithRegions.numberOfRegions);
+  XCTAssertEqual(snapshot.boardPosition, snapshotWithRegions.boardPosition);
+  XCTAssertEqual(-1, [snapshotWithRegions regionIndexAtPointIndex:0]);
+
+  // A1 is an empty region of its own, enclosed by two black stone groups
+  int regionA1 = [snapshotWithRegions regionIndexAtPointIndex:[board pointAtVertex:@"A1"].pointIndex];
+  int regionA2 = [snapshotWithRegions regionIndexAtPointIndex:[board pointAtVertex:@"A2"].pointIndex];
+  int regionB1 = [snapshotWithRegions regionIndexAtPointIndex:[board pointAtVertex:@"B1"].pointIndex];
+  int regionQ16 = [snapshotWithRegions regionIndexAtPointIndex:[board pointAtVertex:@"Q16"].pointIndex];
+  XCTAssertEqual([board pointAtVertex:@"A1"].region, [regions objectAtIndex:regionA1]);
+  XCTAssertEqual([board pointAtVertex:@"A2"].region, [regions objectAtIndex:regionA2]);
+  XCTAssertEqual(1, [snapshotWithRegions sizeOfRegion:regionA1]);
+  XCTAssertEqual(GoColorNone, [snapshotWithRegions colorOfRegion:regionA1]);
+  XCTAssertEqual(GoColorBlack, [snapshotWithRegions colorOfRegion:regionB1]);
+  XCTAssertEqual(GoColorWhite, [snapshotWithRegions colorOfRegion:regionQ16]);
+  XCTAssertTrue(GoBitboardTestBit([snapshotWithRegions pointsOfRegion:regionQ16], [board pointAtVertex:@"Q16"].pointIndex));
+  XCTAssertEqual([board pointAtVertex:@"Q16"].region.stoneGroupState, [snapshotWithRegions stoneGroupStateOfRegion:regionQ16]);
+
+  int numberOfAdjacentRegions;
+  const int* adjacentRegions = [snapshotWithRegions adjacentRegionsOfRegion:regionA1 count:&numberOfAdjacentRegions];
+  XCTAssertEqual(2, numberOfAdjacentRegions);
+  XCTAssertTrue((adjacentRegions[0] == regionA2 && adjacentRegions[1] == regionB1) ||
+                (adjacentRegions[0] == regionB1 && adjacentRegions[1] == regionA2));
+  // The white stone touches the large empty region on all four sides, the
+  // region must still be listed only once
+  adjacentRegions = [snapshotWithRegions adjacentRegionsOfRegion:regionQ16 count:&numberOfAdjacentRegions];
+  XCTAssertEqual(1, numberOfAdjacentRegions);
+  XCTAssertEqual(GoColorNone, [snapshotWithRegions colorOfRegion:adjacentRegions[0]]);
+
+  XCTAssertThrowsSpecificNamed([snapshotWithRegions sizeOfRegion:-1],
+                               NSException, NSRangeException, @"negative region index");
+  XCTAssertThrowsSpecificNamed([snapshotWithRegions sizeOfRegion:snapshotWithRegions.numberOfRegions],
+                               NSException, NSRangeException, @"region index too high");
+}
+
+@end
@@ -33,6 +33,9 @@
 - (void) testStringForSize;
 - (void) testPointEnumerator;
 - (void) testPointAtVertex;
+- (void) testPointAtIndex;
+- (void) testPointAtNumericVertex;
+- (void) testBoardState;
 - (void) testNeighbourOfInDirection;
 - (void) testPointAtCorner;
 - (void) testStarPoints;
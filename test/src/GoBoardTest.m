@@ -21,6 +21,8 @@
 // Application includes
 #import <go/GoGame.h>
 #import <go/GoBoard.h>
+#import <go/GoBoardRegion.h>
+#import <go/GoBoardState.h>
 #import <go/GoPoint.h>
 #import <go/GoVertex.h>
 #import <main/ApplicationDelegate.h>
@@ -144,6 +146,93 @@
                               NSException, NSInvalidArgumentException, @"malformed string used for vertex");
 }
 
+// -----------------------------------------------------------------------------
+/// @brief Exercises the pointAtIndex:() method.
+// -----------------------------------------------------------------------------
+- (void) testPointAtIndex
+{
+  GoBoard* board = m_game.board;
+  struct GoBoardState* boardState = board.boardState;
+
+  // Every GoPoint must be found under its own point index
+  GoPoint* point = [board pointAtVertex:@"A1"];
+  for (; point != nil; point = point.next)
+    XCTAssertEqual(point, [board pointAtIndex:point.pointIndex], @"%@", point.vertex.string);
+
+  int pointIndex = GoBoardStatePointIndexOfVertex(boardState, 3, 17);
+  point = [board pointAtIndex:pointIndex];
+  XCTAssertNotNil(point);
+  XCTAssertTrue([point.vertex.string isEqualToString:@"C17"]);
+  XCTAssertEqual(3, GoBoardStateXOfPointIndex(boardState, pointIndex));
+  XCTAssertEqual(17, GoBoardStateYOfPointIndex(boardState, pointIndex));
+
+  // Border entries
+  XCTAssertNil([board pointAtIndex:0]);
+  XCTAssertNil([board pointAtIndex:GoBoardStatePointIndexOfVertex(boardState, 0, 5)]);
+  XCTAssertNil([board pointAtIndex:GoBoardStatePointIndexOfVertex(boardState, 20, 5)]);
+  XCTAssertNil([board pointAtIndex:boardState->numberOfPointIndexes - 1]);
+
+  XCTAssertThrowsSpecificNamed([board pointAtIndex:-1],
+                              NSException, NSRangeException, @"negative point index");
+  XCTAssertThrowsSpecificNamed([board pointAtIndex:boardState->numberOfPointIndexes],
+                              NSException, NSRangeException, @"point index too large");
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Exercises the pointAtNumericVertex:() method.
+// -----------------------------------------------------------------------------
+- (void) testPointAtNumericVertex
+{
+  GoBoard* board = m_game.board;
+
+  struct GoVertexNumeric vertex = {3, 17};
+  XCTAssertEqual([board pointAtVertex:@"C17"], [board pointAtNumericVertex:vertex]);
+  vertex.x = 19;
+  vertex.y = 19;
+  XCTAssertEqual([board pointAtVertex:@"T19"], [board pointAtNumericVertex:vertex]);
+
+  // Vertexes that are not on the board
+  vertex.x = 0;
+  vertex.y = 0;
+  XCTAssertNil([board pointAtNumericVertex:vertex]);
+  vertex.x = 20;
+  vertex.y = 5;
+  XCTAssertNil([board pointAtNumericVertex:vertex]);
+  vertex.x = 5;
+  vertex.y = -1;
+  XCTAssertNil([board pointAtNumericVertex:vertex]);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Checks that the flat board state follows the GoPoint objects.
+// -----------------------------------------------------------------------------
+- (void) testBoardState
+{
+  GoBoard* board = m_game.board;
+  struct GoBoardState* boardState = board.boardState;
+  XCTAssertTrue(boardState != NULL);
+  XCTAssertEqual(19, boardState->boardSize);
+  XCTAssertEqual(21, boardState->rowStride);
+  XCTAssertEqual(21 * 21, boardState->numberOfPointIndexes);
+
+  GoPoint* point1 = [board pointAtVertex:@"B2"];
+  GoPoint* point2 = [board pointAtVertex:@"B3"];
+  XCTAssertEqual(GoColorNone, boardState->colors[point1.pointIndex]);
+  XCTAssertEqual(4, GoBoardStateNumberOfEmptyNeighbours(boardState, point1.pointIndex));
+  XCTAssertEqual(point1.region.regionID, boardState->regionIDs[point1.pointIndex]);
+  XCTAssertEqual(GoBoardStateBorder, boardState->colors[[board pointAtVertex:@"A1"].pointIndex - 1]);
+
+  [m_game play:point1];
+  XCTAssertEqual(GoColorBlack, boardState->colors[point1.pointIndex]);
+  XCTAssertEqual(3, GoBoardStateNumberOfEmptyNeighbours(boardState, point2.pointIndex));
+  XCTAssertEqual(point1.region.regionID, boardState->regionIDs[point1.pointIndex]);
+  XCTAssertTrue(boardState->regionIDs[point1.pointIndex] != boardState->regionIDs[point2.pointIndex]);
+
+  [m_game play:point2];
+  XCTAssertEqual(GoColorWhite, boardState->colors[point2.pointIndex]);
+  XCTAssertEqual(point2.region.regionID, boardState->regionIDs[point2.pointIndex]);
+}
+
 // -----------------------------------------------------------------------------
 /// @brief Exercises the neighbourOf:inDirection() method.
 // -----------------------------------------------------------------------------
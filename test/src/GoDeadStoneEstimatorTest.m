@@ -0,0 +1,105 @@
+// -----------------------------------------------------------------------------
+// Copyright 2014 Patrick Näf (herzbube@herzbube.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// -----------------------------------------------------------------------------
+
+// Test includes
+#import "GoDeadStoneEstimatorTest.h"
+
+// Application includes
+#import <go/GoBoard.h>
+#import <go/GoBoardPosition.h>
+#import <go/GoBoardSnapshot.h>
+#import <go/GoDeadStoneEstimator.h>
+#import <go/GoGame.h>
+#import <go/GoPoint.h>
+
+
+@implementation GoDeadStoneEstimatorTest
+
+// -----------------------------------------------------------------------------
+/// @brief Exercises the unconditionallyAliveStoneGroupsOfColor:inBoardSnapshot:()
+/// method.
+// -----------------------------------------------------------------------------
+- (void) testUnconditionallyAliveStoneGroups
+{
+  GoBoard* board = m_game.board;
+  NSUInteger expectedNumberOfStoneGroups = 0;
+  XCTAssertEqual(expectedNumberOfStoneGroups, [GoDeadStoneEstimator unconditionallyAliveStoneGroupsOfColor:GoColorBlack inBoardSnapshot:[self currentBoardSnapshot]].count);
+
+  // Black builds a group with two eyes at A1 and C1, White passes
+  NSArray* vertexes = @[@"B1", @"A2", @"B2", @"C2", @"D2"];
+  for (NSString* vertex in vertexes)
+  {
+    [m_game play:[board pointAtVertex:vertex]];
+    [m_game pass];
+  }
+  // A group with only one eye is not alive
+  XCTAssertEqual(expectedNumberOfStoneGroups, [GoDeadStoneEstimator unconditionallyAliveStoneGroupsOfColor:GoColorBlack inBoardSnapshot:[self currentBoardSnapshot]].count);
+
+  [m_game play:[board pointAtVertex:@"D1"]];
+  GoBoardSnapshot* boardSnapshot = [self currentBoardSnapshot];
+  NSIndexSet* aliveStoneGroups = [GoDeadStoneEstimator unconditionallyAliveStoneGroupsOfColor:GoColorBlack inBoardSnapshot:boardSnapshot];
+  expectedNumberOfStoneGroups = 1;
+  XCTAssertEqual(expectedNumberOfStoneGroups, aliveStoneGroups.count);
+  XCTAssertEqual((NSUInteger)[boardSnapshot regionIndexAtPointIndex:[board pointAtVertex:@"B1"].pointIndex], aliveStoneGroups.firstIndex);
+  expectedNumberOfStoneGroups = 0;
+  XCTAssertEqual(expectedNumberOfStoneGroups, [GoDeadStoneEstimator unconditionallyAliveStoneGroupsOfColor:GoColorWhite inBoardSnapshot:boardSnapshot].count);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Exercises the deadStoneGroupsInBoardSnapshot:() method.
+// -----------------------------------------------------------------------------
+- (void) testDeadStoneGroupsInBoardSnapshot
+{
+  GoBoard* board = m_game.board;
+  NSUInteger expectedNumberOfStoneGroups = 0;
+  XCTAssertEqual(expectedNumberOfStoneGroups, [GoDeadStoneEstimator deadStoneGroupsInBoardSnapshot:[self currentBoardSnapshot]].count);
+
+  // Black builds a group with two eyes at A1 and C1, White has a single stone
+  // in the center of the board
+  [m_game play:[board pointAtVertex:@"B1"]];
+  [m_game play:[board pointAtVertex:@"K10"]];
+  NSArray* vertexes = @[@"A2", @"B2", @"C2", @"D2"];
+  for (NSString* vertex in vertexes)
+  {
+    [m_game play:[board pointAtVertex:vertex]];
+    [m_game pass];
+  }
+  // Neither stone group is alive, so neither can be considered dead
+  XCTAssertEqual(expectedNumberOfStoneGroups, [GoDeadStoneEstimator deadStoneGroupsInBoardSnapshot:[self currentBoardSnapshot]].count);
+
+  // The white stone is surrounded by empty space that only the alive black
+  // group borders
+  [m_game play:[board pointAtVertex:@"D1"]];
+  GoBoardSnapshot* boardSnapshot = [self currentBoardSnapshot];
+  NSIndexSet* deadStoneGroups = [GoDeadStoneEstimator deadStoneGroupsInBoardSnapshot:boardSnapshot];
+  expectedNumberOfStoneGroups = 1;
+  XCTAssertEqual(expectedNumberOfStoneGroups, deadStoneGroups.count);
+  XCTAssertEqual((NSUInteger)[boardSnapshot regionIndexAtPointIndex:[board pointAtVertex:@"K10"].pointIndex], deadStoneGroups.firstIndex);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Private helper method of testUnconditionallyAliveStoneGroups() and
+/// testDeadStoneGroupsInBoardSnapshot(). Returns a snapshot of the current
+/// board position that includes the regions of the board.
+// -----------------------------------------------------------------------------
+- (GoBoardSnapshot*) currentBoardSnapshot
+{
+  GoBoardPosition* boardPosition = m_game.boardPosition;
+  GoBoardSnapshot* boardSnapshot = [boardPosition snapshotForBoardPosition:boardPosition.currentBoardPosition];
+  return [boardSnapshot snapshotWithRegions:m_game.board.regions];
+}
+
+@end
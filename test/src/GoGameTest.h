@@ -39,12 +39,14 @@
 - (void) testReasonForGameHasEnded;
 - (void) testPlay;
 - (void) testPass;
+- (void) testReplayMoves;
 - (void) testResign;
 - (void) testPause;
 - (void) testContinue;
 - (void) testIsLegalMove;
 - (void) testIsLegalMovePositionalSuperko;
 - (void) testIsLegalMoveSituationalSuperko;
+- (void) testLegalMoveMask;
 - (void) testIsComputerPlayersTurn;
 - (void) testRevertStateFromEndedToInProgress;
 - (void) testDiscardCausesRegionToFragment;
@@ -19,7 +19,9 @@
 #import "GoGameTest.h"
 
 // Application includes
+#import <go/GoBitboard.h>
 #import <go/GoBoard.h>
+#import <go/GoBoardPosition.h>
 #import <go/GoBoardRegion.h>
 #import <go/GoGame.h>
 #import <go/GoGameDocument.h>
@@ -318,6 +320,112 @@
                               NSException, NSInternalInconsistencyException, @"pass after game end");
 }
 
+// -----------------------------------------------------------------------------
+/// @brief Exercises the replayMoves:numberOfMoves:isIllegalReason:() method.
+// -----------------------------------------------------------------------------
+- (void) testReplayMoves
+{
+  GoBoard* board = m_game.board;
+  GoPoint* pointA1 = [board pointAtVertex:@"A1"];
+  GoPoint* pointB1 = [board pointAtVertex:@"B1"];
+  enum GoMoveIsIllegalReason illegalReason;
+
+  // Illegal move: the game must remain unchanged
+  struct GoGameReplayMove illegalMoves[3] =
+  {
+    { GoMoveTypePlay, pointA1.pointIndex },
+    { GoMoveTypePlay, pointB1.pointIndex },
+    { GoMoveTypePlay, pointA1.pointIndex },
+  };
+  XCTAssertEqual(2, [m_game replayMoves:illegalMoves numberOfMoves:3 isIllegalReason:&illegalReason]);
+  XCTAssertEqual(GoMoveIsIllegalReasonIntersectionOccupied, illegalReason);
+  XCTAssertEqual(0, m_game.moveModel.numberOfMoves);
+  XCTAssertEqual(0, m_game.boardPosition.currentBoardPosition);
+  XCTAssertNil(m_game.lastMove);
+  XCTAssertEqual(GoColorNone, pointA1.stoneState);
+  XCTAssertEqual(GoColorNone, pointB1.stoneState);
+  XCTAssertEqual(m_game.currentPlayer, m_game.playerBlack);
+  XCTAssertFalse(m_game.document.isDirty);
+
+  // Invalid point index: the game must remain unchanged
+  struct GoGameReplayMove invalidMoves[2] =
+  {
+    { GoMoveTypePlay, pointA1.pointIndex },
+    { GoMoveTypePlay, -1 },
+  };
+  XCTAssertThrowsSpecificNamed([m_game replayMoves:invalidMoves numberOfMoves:2 isIllegalReason:&illegalReason],
+                              NSException, NSRangeException, @"invalid point index");
+  XCTAssertEqual(0, m_game.moveModel.numberOfMoves);
+  XCTAssertEqual(GoColorNone, pointA1.stoneState);
+
+  // Legal moves
+  struct GoGameReplayMove legalMoves[3] =
+  {
+    { GoMoveTypePlay, pointA1.pointIndex },
+    { GoMoveTypePlay, pointB1.pointIndex },
+    { GoMoveTypePass, -1 },
+  };
+  XCTAssertEqual(-1, [m_game replayMoves:legalMoves numberOfMoves:3 isIllegalReason:&illegalReason]);
+  XCTAssertEqual(3, m_game.moveModel.numberOfMoves);
+  XCTAssertEqual(3, m_game.boardPosition.currentBoardPosition);
+  XCTAssertEqual(GoMoveTypePass, m_game.lastMove.type);
+  XCTAssertEqual(GoColorBlack, pointA1.stoneState);
+  XCTAssertEqual(GoColorWhite, pointB1.stoneState);
+  XCTAssertEqual(m_game.currentPlayer, m_game.playerWhite);
+  XCTAssertEqual(GoGameStateGameHasStarted, m_game.state);
+  XCTAssertTrue(m_game.document.isDirty);
+
+  // Capture by the player who moves second in a replay. The legality check
+  // must be made for the player whose turn it is in the replayed sequence,
+  // not for the player whose turn it was when the replay started.
+  GoPoint* pointS19 = [board pointAtVertex:@"S19"];
+  GoPoint* pointT19 = [board pointAtVertex:@"T19"];
+  struct GoGameReplayMove captureMoves[8] =
+  {
+    { GoMoveTypePlay, pointS19.pointIndex },
+    { GoMoveTypePlay, [board pointAtVertex:@"R19"].pointIndex },
+    { GoMoveTypePlay, [board pointAtVertex:@"A18"].pointIndex },
+    { GoMoveTypePlay, [board pointAtVertex:@"S18"].pointIndex },
+    { GoMoveTypePlay, [board pointAtVertex:@"B19"].pointIndex },
+    { GoMoveTypePlay, [board pointAtVertex:@"T18"].pointIndex },
+    { GoMoveTypePlay, [board pointAtVertex:@"K10"].pointIndex },
+    { GoMoveTypePlay, pointT19.pointIndex },
+  };
+  XCTAssertEqual(-1, [m_game replayMoves:captureMoves numberOfMoves:8 isIllegalReason:&illegalReason]);
+  XCTAssertEqual(11, m_game.moveModel.numberOfMoves);
+  XCTAssertEqual(11, m_game.boardPosition.currentBoardPosition);
+  XCTAssertEqual(GoColorBlack, pointT19.stoneState);
+  XCTAssertEqual(GoColorNone, pointS19.stoneState);
+  XCTAssertEqual(m_game.currentPlayer, m_game.playerWhite);
+
+  // Suicide by the player who moves second in a replay: the game must remain
+  // unchanged
+  GoPoint* pointA19 = [board pointAtVertex:@"A19"];
+  struct GoGameReplayMove suicideMoves[2] =
+  {
+    { GoMoveTypePlay, [board pointAtVertex:@"K11"].pointIndex },
+    { GoMoveTypePlay, pointA19.pointIndex },
+  };
+  XCTAssertEqual(1, [m_game replayMoves:suicideMoves numberOfMoves:2 isIllegalReason:&illegalReason]);
+  XCTAssertEqual(GoMoveIsIllegalReasonSuicide, illegalReason);
+  XCTAssertEqual(11, m_game.moveModel.numberOfMoves);
+  XCTAssertEqual(GoColorNone, [board pointAtVertex:@"K11"].stoneState);
+  XCTAssertEqual(GoColorNone, pointA19.stoneState);
+  XCTAssertEqual(m_game.currentPlayer, m_game.playerWhite);
+
+  // First pass does not end the game
+  struct GoGameReplayMove passMove = { GoMoveTypePass, -1 };
+  XCTAssertEqual(-1, [m_game replayMoves:&passMove numberOfMoves:1 isIllegalReason:&illegalReason]);
+  XCTAssertEqual(GoGameStateGameHasStarted, m_game.state);
+
+  // Second pass in a row ends the game
+  XCTAssertEqual(-1, [m_game replayMoves:&passMove numberOfMoves:1 isIllegalReason:&illegalReason]);
+  XCTAssertEqual(GoGameStateGameHasEnded, m_game.state);
+  XCTAssertEqual(GoGameHasEndedReasonTwoPasses, m_game.reasonForGameHasEnded);
+  XCTAssertThrowsSpecificNamed([m_game replayMoves:&passMove numberOfMoves:1 isIllegalReason:&illegalReason],
+                              NSException, NSInternalInconsistencyException, @"replay after game has ended");
+}
+
 // -----------------------------------------------------------------------------
 /// @brief Exercises the resign() method.
 // -----------------------------------------------------------------------------
@@ -547,6 +655,53 @@
   XCTAssertEqual(illegalReason, GoMoveIsIllegalReasonSuperko);
 }
 
+// -----------------------------------------------------------------------------
+/// @brief Exercises the legalMoveMask() method.
+// -----------------------------------------------------------------------------
+- (void) testLegalMoveMask
+{
+  enum GoMoveIsIllegalReason illegalReason;
+  int numberOfIntersections = pow(m_game.board.size, 2);
+
+  // All intersections are legal on an empty board
+  const struct GoBitboard* legalMoveMask = [m_game legalMoveMask];
+  XCTAssertTrue(legalMoveMask != NULL);
+  XCTAssertEqual(numberOfIntersections, GoBitboardPopCount(legalMoveMask));
+
+  // Black plays T1, white captures it with S1 and T2
+  GoPoint* point1 = [m_game.board pointAtVertex:@"T1"];
+  GoPoint* point2 = [m_game.board pointAtVertex:@"S1"];
+  GoPoint* point3 = [m_game.board pointAtVertex:@"T2"];
+  [m_game play:point1];
+  [m_game play:point2];
+  [m_game pass];
+  [m_game play:point3];
+
+  // For black, the occupied intersections and the suicide are illegal
+  legalMoveMask = [m_game legalMoveMask];
+  XCTAssertEqual(numberOfIntersections - 3, GoBitboardPopCount(legalMoveMask));
+  XCTAssertFalse(GoBitboardTestBit(legalMoveMask, point1.pointIndex));
+  XCTAssertFalse(GoBitboardTestBit(legalMoveMask, point2.pointIndex));
+  XCTAssertFalse(GoBitboardTestBit(legalMoveMask, point3.pointIndex));
+  XCTAssertFalse([m_game isLegalMove:point1 isIllegalReason:&illegalReason]);
+  XCTAssertEqual(illegalReason, GoMoveIsIllegalReasonSuicide);
+  XCTAssertFalse([m_game isLegalMove:point2 isIllegalReason:&illegalReason]);
+  XCTAssertEqual(illegalReason, GoMoveIsIllegalReasonIntersectionOccupied);
+
+  // For white, filling in T1 is legal. The mask must be recalculated after the
+  // pass move although no stones have changed.
+  [m_game pass];
+  legalMoveMask = [m_game legalMoveMask];
+  XCTAssertEqual(numberOfIntersections - 2, GoBitboardPopCount(legalMoveMask));
+  XCTAssertTrue(GoBitboardTestBit(legalMoveMask, point1.pointIndex));
+  XCTAssertTrue([m_game isLegalMove:point1 isIllegalReason:&illegalReason]);
+
+  // Discarding the pass move makes T1 illegal again
+  [m_game.moveModel discardLastMove];
+  legalMoveMask = [m_game legalMoveMask];
+  XCTAssertFalse(GoBitboardTestBit(legalMoveMask, point1.pointIndex));
+}
+
 // -----------------------------------------------------------------------------
 /// @brief Private helper method of testIsLegalMovePositionalSuperko() and
 /// testIsLegalMoveSituationalSuperko().
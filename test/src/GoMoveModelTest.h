@@ -34,7 +34,11 @@
 - (void) testDiscardAllMoves;
 - (void) testMoveAtIndex;
 - (void) testNumberOfMoves;
+- (void) testIndexOfFirstChangedMove;
 - (void) testFirstMove;
 - (void) testLastMove;
+- (void) testIndexOfMoveWithZobristHash;
+- (void) testMoveRecords;
+- (void) testGetStatistics;
 
 @end
@@ -24,6 +24,7 @@
 #import <go/GoGameDocument.h>
 #import <go/GoMove.h>
 #import <go/GoMoveModel.h>
+#import <go/GoPlayer.h>
 #import <go/GoPoint.h>
 
 
@@ -187,6 +188,40 @@
   XCTAssertEqual(moveModel.numberOfMoves, 0);
 }
 
+// -----------------------------------------------------------------------------
+/// @brief Exercises the @e indexOfFirstChangedMove property, both for single
+/// changes and for a series of changes between beginUpdates() and
+/// endUpdates() that does not change the number of moves.
+// -----------------------------------------------------------------------------
+- (void) testIndexOfFirstChangedMove
+{
+  GoMoveModel* moveModel = m_game.moveModel;
+  XCTAssertEqual(moveModel.indexOfFirstChangedMove, 0);
+  GoMove* move1 = [GoMove move:GoMoveTypePass by:m_game.playerBlack after:nil];
+  GoMove* move2 = [GoMove move:GoMoveTypePass by:m_game.playerWhite after:move1];
+  GoMove* move3 = [GoMove move:GoMoveTypePass by:m_game.playerBlack after:move2];
+  [moveModel appendMove:move1];
+  XCTAssertEqual(moveModel.indexOfFirstChangedMove, 0);
+  [moveModel appendMove:move2];
+  XCTAssertEqual(moveModel.indexOfFirstChangedMove, 1);
+  [moveModel appendMove:move3];
+  XCTAssertEqual(moveModel.indexOfFirstChangedMove, 2);
+  [moveModel discardLastMove];
+  XCTAssertEqual(moveModel.indexOfFirstChangedMove, 2);
+
+  // Discard moves and replace them with other moves
+  [moveModel beginUpdates];
+  [moveModel discardMovesFromIndex:1];
+  GoMove* move4 = [GoMove move:GoMoveTypePass by:m_game.playerWhite after:move1];
+  GoMove* move5 = [GoMove move:GoMoveTypePass by:m_game.playerBlack after:move4];
+  [moveModel appendMove:move4];
+  [moveModel appendMove:move5];
+  XCTAssertEqual(moveModel.indexOfFirstChangedMove, 2);
+  [moveModel endUpdates];
+  XCTAssertEqual(moveModel.numberOfMoves, 3);
+  XCTAssertEqual(moveModel.indexOfFirstChangedMove, 1);
+}
+
 // -----------------------------------------------------------------------------
 /// @brief Exercises the @e firstMove property.
 // -----------------------------------------------------------------------------
@@ -223,4 +258,140 @@
   XCTAssertNil(moveModel.firstMove);
 }
 
+// -----------------------------------------------------------------------------
+/// @brief Exercises the
+/// indexOfMoveWithZobristHash:zobristHashHigh:beforeIndex:player:() method.
+// -----------------------------------------------------------------------------
+- (void) testIndexOfMoveWithZobristHash
+{
+  GoMoveModel* moveModel = m_game.moveModel;
+  GoMove* move1 = [GoMove move:GoMoveTypePass by:m_game.playerBlack after:nil];
+  GoMove* move2 = [GoMove move:GoMoveTypePass by:m_game.playerWhite after:move1];
+  GoMove* move3 = [GoMove move:GoMoveTypePass by:m_game.playerBlack after:move2];
+  GoMove* move4 = [GoMove move:GoMoveTypePass by:m_game.playerWhite after:move3];
+  move1.zobristHash = 42;
+  move2.zobristHash = 17;
+  move3.zobristHash = 42;
+  move4.zobristHash = 42;
+  [moveModel appendMove:move1];
+  [moveModel appendMove:move2];
+  [moveModel appendMove:move3];
+  [moveModel appendMove:move4];
+
+  XCTAssertEqual([moveModel indexOfMoveWithZobristHash:42 zobristHashHigh:0 beforeIndex:4 player:nil], 3);
+  XCTAssertEqual([moveModel indexOfMoveWithZobristHash:42 zobristHashHigh:0 beforeIndex:3 player:nil], 2);
+  XCTAssertEqual([moveModel indexOfMoveWithZobristHash:42 zobristHashHigh:0 beforeIndex:2 player:nil], 0);
+  XCTAssertEqual([moveModel indexOfMoveWithZobristHash:42 zobristHashHigh:0 beforeIndex:0 player:nil], -1);
+  XCTAssertEqual([moveModel indexOfMoveWithZobristHash:17 zobristHashHigh:0 beforeIndex:4 player:nil], 1);
+  XCTAssertEqual([moveModel indexOfMoveWithZobristHash:99 zobristHashHigh:0 beforeIndex:4 player:nil], -1);
+  XCTAssertEqual([moveModel indexOfMoveWithZobristHash:42 zobristHashHigh:0 beforeIndex:4 player:m_game.playerBlack], 2);
+  XCTAssertEqual([moveModel indexOfMoveWithZobristHash:17 zobristHashHigh:0 beforeIndex:4 player:m_game.playerBlack], -1);
+
+  // The index must follow discarded moves
+  [moveModel discardMovesFromIndex:2];
+  XCTAssertEqual([moveModel indexOfMoveWithZobristHash:42 zobristHashHigh:0 beforeIndex:4 player:nil], 0);
+  XCTAssertEqual([moveModel indexOfMoveWithZobristHash:42 zobristHashHigh:0 beforeIndex:4 player:m_game.playerWhite], -1);
+
+  // The index must pick up changed hashes after it was invalidated
+  move2.zobristHash = 99;
+  [moveModel invalidateZobristHashIndex];
+  XCTAssertEqual([moveModel indexOfMoveWithZobristHash:17 zobristHashHigh:0 beforeIndex:4 player:nil], -1);
+  XCTAssertEqual([moveModel indexOfMoveWithZobristHash:99 zobristHashHigh:0 beforeIndex:4 player:nil], 1);
+  [moveModel appendMove:move3];
+  XCTAssertEqual([moveModel indexOfMoveWithZobristHash:42 zobristHashHigh:0 beforeIndex:4 player:nil], 2);
+
+  // The upper 64 bits of 128-bit hashes must match, too
+  move3.zobristHashHigh = 5;
+  [moveModel invalidateZobristHashIndex];
+  XCTAssertEqual([moveModel indexOfMoveWithZobristHash:42 zobristHashHigh:5 beforeIndex:4 player:nil], 2);
+  XCTAssertEqual([moveModel indexOfMoveWithZobristHash:42 zobristHashHigh:0 beforeIndex:4 player:nil], 0);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Exercises the moveRecords() and capturedStonePointIndexes() methods.
+// -----------------------------------------------------------------------------
+- (void) testMoveRecords
+{
+  GoMoveModel* moveModel = m_game.moveModel;
+  XCTAssertTrue([moveModel moveRecords] == NULL);
+  XCTAssertTrue([moveModel capturedStonePointIndexes] == NULL);
+
+  GoPoint* pointA1 = [m_game.board pointAtVertex:@"A1"];
+  GoPoint* pointB1 = [m_game.board pointAtVertex:@"B1"];
+  [m_game play:[m_game.board pointAtVertex:@"A2"]];
+  [m_game play:pointA1];
+  [m_game play:pointB1];  // captures A1
+  [m_game pass];
+
+  const struct GoMoveRecord* moveRecords = [moveModel moveRecords];
+  const int* capturedStonePointIndexes = [moveModel capturedStonePointIndexes];
+  XCTAssertTrue(moveRecords != NULL);
+  XCTAssertTrue(capturedStonePointIndexes != NULL);
+  for (int indexOfMove = 0; indexOfMove < moveModel.numberOfMoves; ++indexOfMove)
+  {
+    GoMove* move = [moveModel moveAtIndex:indexOfMove];
+    const struct GoMoveRecord* moveRecord = &moveRecords[indexOfMove];
+    XCTAssertEqual(move.type, (enum GoMoveType)moveRecord->type);
+    XCTAssertEqual(move.moveNumber, moveRecord->moveNumber);
+    XCTAssertEqual(move.zobristHash, moveRecord->zobristHash);
+    XCTAssertEqual(move.zobristHashHigh, moveRecord->zobristHashHigh);
+    XCTAssertEqual((move.player.isBlack ? GoColorBlack : GoColorWhite), (enum GoColor)moveRecord->color);
+    XCTAssertEqual((int)move.capturedStones.count, moveRecord->numberOfCapturedStones);
+  }
+  XCTAssertEqual(pointB1.pointIndex, moveRecords[2].pointIndex);
+  XCTAssertEqual(1, moveRecords[2].numberOfCapturedStones);
+  XCTAssertEqual(pointA1.pointIndex, capturedStonePointIndexes[moveRecords[2].capturedStonesOffset]);
+  XCTAssertEqual(-1, moveRecords[3].pointIndex);
+  XCTAssertEqual(0, moveRecords[3].numberOfCapturedStones);
+
+  // The records must follow discarded moves
+  [moveModel discardMovesFromIndex:2];
+  XCTAssertEqual(0, [moveModel moveRecords][1].numberOfCapturedStones);
+  XCTAssertTrue([moveModel capturedStonePointIndexes] == NULL);
+
+  // The records must be rebuilt after they were invalidated
+  [moveModel invalidateZobristHashIndex];
+  XCTAssertEqual(pointA1.pointIndex, [moveModel moveRecords][1].pointIndex);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Exercises the getStatistics:forBoardPosition:() method.
+// -----------------------------------------------------------------------------
+- (void) testGetStatistics
+{
+  GoMoveModel* moveModel = m_game.moveModel;
+  struct GoMoveStatistics statistics;
+  [moveModel getStatistics:&statistics forBoardPosition:0];
+  XCTAssertEqual(0, statistics.stonesPlayedByBlack);
+  XCTAssertThrowsSpecificNamed([moveModel getStatistics:&statistics forBoardPosition:1],
+                              NSException, NSRangeException, @"board position beyond last move");
+
+  [m_game play:[m_game.board pointAtVertex:@"A2"]];
+  [m_game play:[m_game.board pointAtVertex:@"A1"]];
+  [m_game play:[m_game.board pointAtVertex:@"B1"]];  // captures A1
+  [m_game pass];
+
+  [moveModel getStatistics:&statistics forBoardPosition:2];
+  XCTAssertEqual(0, statistics.capturedByBlack);
+  XCTAssertEqual(1, statistics.stonesPlayedByBlack);
+  XCTAssertEqual(1, statistics.stonesPlayedByWhite);
+  [moveModel getStatistics:&statistics forBoardPosition:4];
+  XCTAssertEqual(1, statistics.capturedByBlack);
+  XCTAssertEqual(0, statistics.capturedByWhite);
+  XCTAssertEqual(2, statistics.stonesPlayedByBlack);
+  XCTAssertEqual(1, statistics.stonesPlayedByWhite);
+  XCTAssertEqual(0, statistics.passesPlayedByBlack);
+  XCTAssertEqual(1, statistics.passesPlayedByWhite);
+  XCTAssertThrowsSpecificNamed([moveModel getStatistics:&statistics forBoardPosition:-1],
+                              NSException, NSRangeException, @"negative board position");
+
+  // The statistics must follow discarded moves
+  [moveModel discardMovesFromIndex:2];
+  [moveModel getStatistics:&statistics forBoardPosition:2];
+  XCTAssertEqual(0, statistics.capturedByBlack);
+  XCTAssertEqual(1, statistics.stonesPlayedByBlack);
+  XCTAssertThrowsSpecificNamed([moveModel getStatistics:&statistics forBoardPosition:3],
+                              NSException, NSRangeException, @"board position of discarded move");
+}
+
 @end
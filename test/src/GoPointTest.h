@@ -32,6 +32,7 @@
 - (void) testNeighbours;
 - (void) testStarPoint;
 - (void) testStoneState;
+- (void) testTerritoryStatisticsScore;
 - (void) testLiberties;
 - (void) testIsEqualToPoint;
 - (void) testNeighbourRegionsWithColor;
@@ -20,6 +20,7 @@
 
 // Application includes
 #import <go/GoBoard.h>
+#import <go/GoBoardState.h>
 #import <go/GoGame.h>
 #import <go/GoPoint.h>
 #import <go/GoVertex.h>
@@ -210,6 +211,24 @@
   XCTAssertFalse([point blackStone]);
 }
 
+// -----------------------------------------------------------------------------
+/// @brief Exercises the @e territoryStatisticsScore property.
+// -----------------------------------------------------------------------------
+- (void) testTerritoryStatisticsScore
+{
+  GoPoint* point = [m_game.board pointAtVertex:@"F15"];
+  struct GoBoardState* boardState = m_game.board.boardState;
+  XCTAssertEqual(0.0f, point.territoryStatisticsScore);
+
+  point.territoryStatisticsScore = 0.75f;
+  XCTAssertEqual(0.75f, point.territoryStatisticsScore);
+  // The score is stored in the flat board state
+  XCTAssertEqual(0.75f, boardState->territoryStatisticsScores[point.pointIndex]);
+
+  boardState->territoryStatisticsScores[point.pointIndex] = -0.5f;
+  XCTAssertEqual(-0.5f, point.territoryStatisticsScore);
+}
+
 // -----------------------------------------------------------------------------
 /// @brief Exercises the liberties() method.
 // -----------------------------------------------------------------------------
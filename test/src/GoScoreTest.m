@@ -0,0 +1,250 @@
+// -----------------------------------------------------------------------------
+// Copyright 2014 Patrick Näf (herzbube@herzbube.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// -----------------------------------------------------------------------------
+
+
+
+// Test includes
+#import "GoScoreTest.h"
+#import "GtpReplayEngineFixture.h"
+
+// Application includes
+#import <go/GoBoard.h>
+#import <go/GoBoardRegion.h>
+#import <go/GoGame.h>
+#import <go/GoPoint.h>
+#import <go/GoScore.h>
+#import <go/GoVertex.h>
+#import <gtp/GtpAnalysisCache.h>
+#import <gtp/GtpClient.h>
+#import <main/ApplicationDelegate.h>
+#import <play/model/ScoringModel.h>
+
+
+@implementation GoScoreTest
+
+// -----------------------------------------------------------------------------
+/// @brief Exercises the toggleDeadStateOfStoneGroup:() method, together with
+/// the score calculation that follows it.
+// -----------------------------------------------------------------------------
+- (void) testToggleDeadStateOfStoneGroup
+{
+  ScoringModel* scoringModel = m_delegate.scoringModel;
+  scoringModel.askGtpEngineForDeadStones = false;
+  scoringModel.markDeadStonesIntelligently = false;
+
+  // Black encloses A1, White has a single stone in the opposite corner
+  [m_game play:[m_game.board pointAtVertex:@"A2"]];
+  [m_game play:[m_game.board pointAtVertex:@"T19"]];
+  [m_game play:[m_game.board pointAtVertex:@"B1"]];
+  GoBoardRegion* whiteStoneGroup = [m_game.board pointAtVertex:@"T19"].region;
+
+  GoScore* score = m_game.score;
+  score.scoringEnabled = true;
+  [score calculateWaitUntilDone:true];
+  XCTAssertEqual(1, score.territoryBlack);
+  XCTAssertEqual(0, score.territoryWhite);
+  XCTAssertEqual(2, score.aliveBlack);
+  XCTAssertEqual(1, score.aliveWhite);
+  XCTAssertEqual(0, score.deadWhite);
+
+  // The dead white stone turns the large empty region into black territory
+  [score toggleDeadStateOfStoneGroup:whiteStoneGroup];
+  XCTAssertEqual(GoStoneGroupStateDead, whiteStoneGroup.stoneGroupState);
+  [score calculateWaitUntilDone:true];
+  XCTAssertEqual(359, score.territoryBlack);
+  XCTAssertEqual(0, score.territoryWhite);
+  XCTAssertEqual(2, score.aliveBlack);
+  XCTAssertEqual(0, score.aliveWhite);
+  XCTAssertEqual(1, score.deadWhite);
+  XCTAssertEqual(GoColorBlack, [m_game.board pointAtVertex:@"K10"].region.territoryColor);
+  XCTAssertEqual(GoGameResultBlackHasWon, score.result);
+
+  // Toggling back must restore the original score
+  [score toggleDeadStateOfStoneGroup:whiteStoneGroup];
+  [score calculateWaitUntilDone:true];
+  XCTAssertEqual(1, score.territoryBlack);
+  XCTAssertEqual(0, score.territoryWhite);
+  XCTAssertEqual(2, score.aliveBlack);
+  XCTAssertEqual(1, score.aliveWhite);
+  XCTAssertEqual(0, score.deadWhite);
+  XCTAssertEqual(GoColorNone, [m_game.board pointAtVertex:@"K10"].region.territoryColor);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Exercises the toggleSekiStateOfStoneGroup:() method, together with
+/// the score calculation that follows it.
+// -----------------------------------------------------------------------------
+- (void) testToggleSekiStateOfStoneGroup
+{
+  ScoringModel* scoringModel = m_delegate.scoringModel;
+  scoringModel.askGtpEngineForDeadStones = false;
+
+  [m_game play:[m_game.board pointAtVertex:@"A2"]];
+  [m_game play:[m_game.board pointAtVertex:@"T19"]];
+  [m_game play:[m_game.board pointAtVertex:@"B1"]];
+  GoBoardRegion* blackStoneGroup = [m_game.board pointAtVertex:@"A2"].region;
+  GoBoardRegion* eye = [m_game.board pointAtVertex:@"A1"].region;
+
+  GoScore* score = m_game.score;
+  score.scoringEnabled = true;
+  [score calculateWaitUntilDone:true];
+  XCTAssertEqual(GoColorBlack, eye.territoryColor);
+  XCTAssertFalse(eye.territoryInconsistencyFound);
+
+  // A1 is now adjacent to both alive and seki stones of the same color
+  [score toggleSekiStateOfStoneGroup:blackStoneGroup];
+  XCTAssertEqual(GoStoneGroupStateSeki, blackStoneGroup.stoneGroupState);
+  [score calculateWaitUntilDone:true];
+  XCTAssertEqual(GoColorNone, eye.territoryColor);
+  XCTAssertTrue(eye.territoryInconsistencyFound);
+  XCTAssertEqual(0, score.territoryBlack);
+
+  [score toggleSekiStateOfStoneGroup:blackStoneGroup];
+  XCTAssertEqual(GoStoneGroupStateAlive, blackStoneGroup.stoneGroupState);
+  [score calculateWaitUntilDone:true];
+  XCTAssertEqual(GoColorBlack, eye.territoryColor);
+  XCTAssertFalse(eye.territoryInconsistencyFound);
+  XCTAssertEqual(1, score.territoryBlack);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Exercises toggleDeadStateOfStoneGroup:() while a scoring operation
+/// is in progress.
+// -----------------------------------------------------------------------------
+- (void) testToggleWhileScoringIsInProgress
+{
+  ScoringModel* scoringModel = m_delegate.scoringModel;
+  scoringModel.askGtpEngineForDeadStones = false;
+  scoringModel.markDeadStonesIntelligently = false;
+
+  [m_game play:[m_game.board pointAtVertex:@"A2"]];
+  [m_game play:[m_game.board pointAtVertex:@"T19"]];
+  [m_game play:[m_game.board pointAtVertex:@"B1"]];
+  GoBoardRegion* whiteStoneGroup = [m_game.board pointAtVertex:@"T19"].region;
+
+  GoScore* score = m_game.score;
+  score.scoringEnabled = true;
+  [score calculateWaitUntilDone:true];
+  XCTAssertEqual(1, score.territoryBlack);
+
+  // Pretend that a scoring operation is in progress. The operation works on a
+  // snapshot, so the toggle takes effect immediately, but the request to
+  // calculate must not start another operation.
+  score.scoringInProgress = true;
+  [score toggleDeadStateOfStoneGroup:whiteStoneGroup];
+  XCTAssertEqual(GoStoneGroupStateDead, whiteStoneGroup.stoneGroupState);
+  [score calculateWaitUntilDone:true];
+  XCTAssertEqual(1, score.territoryBlack);
+  XCTAssertTrue(score.scoringInProgress);
+
+  // The next scoring operation picks up the toggle
+  score.scoringInProgress = false;
+  [score calculateWaitUntilDone:true];
+  XCTAssertFalse(score.scoringInProgress);
+  XCTAssertEqual(GoStoneGroupStateDead, whiteStoneGroup.stoneGroupState);
+  XCTAssertEqual(359, score.territoryBlack);
+  XCTAssertEqual(1, score.deadWhite);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Exercises the refinement of the estimated dead stones while a
+/// scoring operation is in progress.
+// -----------------------------------------------------------------------------
+- (void) testRefineDeadStonesWhileScoringIsInProgress
+{
+  ScoringModel* scoringModel = m_delegate.scoringModel;
+  scoringModel.askGtpEngineForDeadStones = true;
+  scoringModel.markDeadStonesIntelligently = false;
+
+  [m_game play:[m_game.board pointAtVertex:@"A2"]];
+  [m_game play:[m_game.board pointAtVertex:@"T19"]];
+  [m_game play:[m_game.board pointAtVertex:@"B1"]];
+  GoBoardRegion* whiteStoneGroup = [m_game.board pointAtVertex:@"T19"].region;
+
+  // The GTP engine was already asked about this board position, so the answer
+  // is found in the cache
+  m_delegate.gtpAnalysisCache = [[[GtpAnalysisCache alloc] initWithMemoryLimit:gGtpAnalysisCacheMemoryLimit] autorelease];
+  struct GoVertexNumeric deadStoneVertex = [m_game.board pointAtVertex:@"T19"].vertex.numeric;
+  [m_delegate.gtpAnalysisCache setDeadStoneVertices:&deadStoneVertex
+                                              count:1
+                                             forKey:[GtpAnalysisCache keyForBoardPositionOfGame:m_game]];
+
+  // The estimate does not find the white stone dead. The cached answer is
+  // applied by the same scoring operation that made the estimate, without
+  // waiting for the operation to end first.
+  GoScore* score = m_game.score;
+  score.scoringEnabled = true;
+  [score calculateWaitUntilDone:true];
+  XCTAssertFalse(score.scoringInProgress);
+  XCTAssertEqual(GoStoneGroupStateDead, whiteStoneGroup.stoneGroupState);
+  XCTAssertEqual(359, score.territoryBlack);
+  XCTAssertEqual(1, score.deadWhite);
+
+  // The refinement is applied only once, the user can still override it
+  [score toggleDeadStateOfStoneGroup:whiteStoneGroup];
+  [score calculateWaitUntilDone:true];
+  XCTAssertEqual(GoStoneGroupStateAlive, whiteStoneGroup.stoneGroupState);
+  XCTAssertEqual(1, score.territoryBlack);
+  XCTAssertEqual(0, score.deadWhite);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Checks that leaving scoring mode while the GTP engine is still
+/// being queried for dead stones abandons the query, instead of letting it
+/// run until the GTP engine answers.
+// -----------------------------------------------------------------------------
+- (void) testLeavingScoringModeCancelsDeadStonesQuery
+{
+  // The replay engine needs much longer to answer the query than the test
+  // is willing to wait
+  NSString* replayTranscript =
+    @"# latency final_status_list 2.0 0.0\n"
+    @"final_status_list dead\n"
+    @"= T19\n"
+    @"\n";
+  GtpReplayEngineFixture* fixture = [[[GtpReplayEngineFixture alloc] initWithReplayTranscript:replayTranscript] autorelease];
+  [fixture installInDelegate:m_delegate];
+  GtpClient* client = fixture.playClient;
+  ScoringModel* scoringModel = m_delegate.scoringModel;
+  scoringModel.askGtpEngineForDeadStones = true;
+
+  [m_game play:[m_game.board pointAtVertex:@"A2"]];
+  [m_game play:[m_game.board pointAtVertex:@"T19"]];
+  GoScore* score = m_game.score;
+  score.scoringEnabled = true;
+  [score calculateWaitUntilDone:true];
+  XCTAssertTrue(score.askGtpEngineForDeadStonesInProgress);
+  XCTAssertEqual(1, client.numberOfOutstandingCommands);
+
+  NSDate* cancelDate = [NSDate date];
+  score.scoringEnabled = false;
+  XCTAssertEqual(0, client.numberOfOutstandingCommands);
+  // The "cancelled" response is delivered asynchronously on this thread
+  NSDate* giveUpDate = [NSDate dateWithTimeIntervalSinceNow:1.0];
+  while (score.askGtpEngineForDeadStonesInProgress && [giveUpDate timeIntervalSinceNow] > 0)
+  {
+    [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode
+                             beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.05]];
+  }
+  XCTAssertFalse(score.askGtpEngineForDeadStonesInProgress);
+  XCTAssertTrue([[NSDate date] timeIntervalSinceDate:cancelDate] < 1.0);
+
+  // The replay engine answers "quit" only after it has answered the abandoned
+  // query, whose response must not confuse the client
+  XCTAssertTrue([fixture quit]);
+}
+
+@end
@@ -34,5 +34,7 @@
 - (void) testHashForLastMoveEqualsHashForBoard;
 - (void) testHashAfterPass;
 - (void) testHashAfterUndoAndRedo;
+- (void) testDeterministicHashes;
+- (void) testHighHash;
 
 @end
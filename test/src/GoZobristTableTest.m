@@ -22,6 +22,7 @@
 #import <go/GoBoard.h>
 #import <go/GoGame.h>
 #import <go/GoMove.h>
+#import <go/GoPlayer.h>
 #import <go/GoPoint.h>
 #import <go/GoZobristTable.h>
 
@@ -178,4 +179,72 @@
   XCTAssertEqual(hashForSecondMove, hash);
 }
 
+// -----------------------------------------------------------------------------
+/// @brief Checks that all GoZobristTable objects for the same board size
+/// calculate the same hashes, and that different board sizes use different
+/// random values.
+// -----------------------------------------------------------------------------
+- (void) testDeterministicHashes
+{
+  GoBoard* board = m_game.board;
+  [m_game play:[board pointAtVertex:@"B2"]];
+  [m_game play:[board pointAtVertex:@"Q14"]];
+  GoMove* lastMove = m_game.lastMove;
+
+  GoZobristTable* zobristTable = [[[GoZobristTable alloc] initWithBoardSize:board.size] autorelease];
+  XCTAssertEqual([board.zobristTable hashForBoard:board], [zobristTable hashForBoard:board]);
+  XCTAssertEqual(lastMove.zobristHash, [zobristTable hashForMove:lastMove]);
+  XCTAssertEqual(lastMove.zobristHash, [zobristTable hashForBoard:board]);
+
+  GoBoard* otherBoard = [GoBoard boardWithSize:GoBoardSize9];
+  GoZobristTable* otherZobristTable = [[[GoZobristTable alloc] initWithBoardSize:GoBoardSize9] autorelease];
+  GoPlayer* player = lastMove.player;
+  XCTAssertEqual([otherBoard.zobristTable hashForStonePlayedBy:player atPoint:[otherBoard pointAtVertex:@"B2"] capturingStones:nil afterMove:nil],
+                 [otherZobristTable hashForStonePlayedBy:player atPoint:[otherBoard pointAtVertex:@"B2"] capturingStones:nil afterMove:nil]);
+  XCTAssertTrue([otherZobristTable hashForStonePlayedBy:player atPoint:[otherBoard pointAtVertex:@"B2"] capturingStones:nil afterMove:nil] !=
+                [zobristTable hashForStonePlayedBy:player atPoint:[board pointAtVertex:@"B2"] capturingStones:nil afterMove:nil]);
+
+  XCTAssertThrowsSpecificNamed([[[GoZobristTable alloc] initWithBoardSize:GoBoardSizeUndefined] autorelease],
+                               NSException, NSInvalidArgumentException, @"unsupported board size");
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Exercises the calculation of the upper 64 bits of 128-bit hashes.
+// -----------------------------------------------------------------------------
+- (void) testHighHash
+{
+  GoBoard* board = m_game.board;
+  GoZobristTable* zobristTable64 = [[[GoZobristTable alloc] initWithBoardSize:board.size uses128BitHashes:false] autorelease];
+  GoZobristTable* zobristTable128 = [[[GoZobristTable alloc] initWithBoardSize:board.size uses128BitHashes:true] autorelease];
+  XCTAssertFalse(zobristTable64.uses128BitHashes);
+  XCTAssertTrue(zobristTable128.uses128BitHashes);
+
+  [m_game play:[board pointAtVertex:@"B2"]];
+  GoMove* firstMove = m_game.lastMove;
+  [m_game pass];
+  GoMove* passMove = m_game.lastMove;
+
+  // The lower 64 bits do not depend on the hash length
+  XCTAssertEqual([zobristTable64 hashForMove:firstMove], [zobristTable128 hashForMove:firstMove]);
+  XCTAssertEqual(0LL, [zobristTable64 highHashForMove:firstMove]);
+  long long highHashForFirstMove = [zobristTable128 highHashForMove:firstMove];
+  XCTAssertTrue(highHashForFirstMove != 0);
+  XCTAssertTrue(highHashForFirstMove != [zobristTable128 hashForMove:firstMove]);
+
+  // A pass move does not change the hash
+  firstMove.zobristHashHigh = highHashForFirstMove;
+  XCTAssertEqual(highHashForFirstMove, [zobristTable128 highHashForMove:passMove]);
+
+  // Playing the same stone after a different move must give a different hash
+  long long highHashForStone = [zobristTable128 highHashForStonePlayedBy:firstMove.player
+                                                                 atPoint:[board pointAtVertex:@"C3"]
+                                                         capturingStones:nil
+                                                               afterMove:firstMove];
+  long long highHashForStoneAfterNothing = [zobristTable128 highHashForStonePlayedBy:firstMove.player
+                                                                             atPoint:[board pointAtVertex:@"C3"]
+                                                                     capturingStones:nil
+                                                                           afterMove:nil];
+  XCTAssertEqual(highHashForStone, highHashForStoneAfterNothing ^ highHashForFirstMove);
+}
+
 @end
@@ -0,0 +1,255 @@
+// -----------------------------------------------------------------------------
+// Copyright 2014 Patrick Näf (herzbube@herzbube.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// -----------------------------------------------------------------------------
+
+
+
+// Test includes
+#import "GtpAnalysisCacheTest.h"
+
+// Application includes
+#import <command/game/NewGameCommand.h>
+#import <go/GoBoard.h>
+#import <go/GoGame.h>
+#import <gtp/GtpAnalysisCache.h>
+#import <main/ApplicationDelegate.h>
+#import <newgame/NewGameModel.h>
+#import <player/GtpEngineProfile.h>
+#import <player/GtpEngineProfileModel.h>
+
+
+/// @brief A 2x3 grid of territory scores.
+static const float scores2x3[] = { 0.5f, -0.5f, 1.0f, -1.0f, 0.0f, 0.25f };
+/// @brief A 3x2 grid of territory scores.
+static const float scores3x2[] = { 0.1f, 0.2f, 0.3f, 0.4f, 0.5f, 0.6f };
+
+
+@implementation GtpAnalysisCacheTest
+
+// -----------------------------------------------------------------------------
+/// @brief Exercises storing and looking up territory statistics.
+// -----------------------------------------------------------------------------
+- (void) testTerritoryScores
+{
+  GtpAnalysisCache* cache = [[[GtpAnalysisCache alloc] initWithMemoryLimit:100000] autorelease];
+  int numberOfRows = -1;
+  int numberOfColumns = -1;
+  XCTAssertNil([cache territoryScoresForKey:@"key1" numberOfRows:&numberOfRows numberOfColumns:&numberOfColumns]);
+  XCTAssertEqual(0, cache.memoryUsage);
+
+  [cache setTerritoryScores:scores2x3 numberOfRows:2 numberOfColumns:3 forKey:@"key1"];
+  XCTAssertTrue(cache.memoryUsage > 0);
+  [self checkTerritoryScores:scores2x3 numberOfRows:2 numberOfColumns:3 forKey:@"key1" inCache:cache];
+  XCTAssertNil([cache territoryScoresForKey:@"key2" numberOfRows:&numberOfRows numberOfColumns:&numberOfColumns]);
+  // Territory statistics and dead stones do not share results
+  XCTAssertNil([cache deadStoneVerticesForKey:@"key1"]);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Exercises storing and looking up dead stones, including an empty
+/// set of dead stones.
+// -----------------------------------------------------------------------------
+- (void) testDeadStoneVertices
+{
+  GtpAnalysisCache* cache = [[[GtpAnalysisCache alloc] initWithMemoryLimit:100000] autorelease];
+  XCTAssertNil([cache deadStoneVerticesForKey:@"key1"]);
+
+  struct GoVertexNumeric vertices[] = { {4, 4}, {16, 17} };
+  [cache setDeadStoneVertices:vertices count:2 forKey:@"key1"];
+  [cache setDeadStoneVertices:NULL count:0 forKey:@"key2"];
+
+  NSData* deadStoneVertices = [cache deadStoneVerticesForKey:@"key1"];
+  XCTAssertEqual(sizeof(vertices), deadStoneVertices.length);
+  XCTAssertEqual(0, memcmp(vertices, deadStoneVertices.bytes, sizeof(vertices)));
+  deadStoneVertices = [cache deadStoneVerticesForKey:@"key2"];
+  XCTAssertNotNil(deadStoneVertices);
+  XCTAssertEqual((NSUInteger)0, deadStoneVertices.length);
+  int numberOfRows;
+  int numberOfColumns;
+  XCTAssertNil([cache territoryScoresForKey:@"key1" numberOfRows:&numberOfRows numberOfColumns:&numberOfColumns]);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Checks that storing a result under a key that already has a result
+/// replaces the result, including the grid dimensions, and does not count the
+/// memory of the old result.
+// -----------------------------------------------------------------------------
+- (void) testReplaceResult
+{
+  GtpAnalysisCache* cache = [[[GtpAnalysisCache alloc] initWithMemoryLimit:100000] autorelease];
+  [cache setTerritoryScores:scores2x3 numberOfRows:2 numberOfColumns:3 forKey:@"key1"];
+  int memoryUsage = cache.memoryUsage;
+
+  [cache setTerritoryScores:scores3x2 numberOfRows:3 numberOfColumns:2 forKey:@"key1"];
+  XCTAssertEqual(memoryUsage, cache.memoryUsage);
+  [self checkTerritoryScores:scores3x2 numberOfRows:3 numberOfColumns:2 forKey:@"key1" inCache:cache];
+
+  // Storing the same result again must not lose the grid dimensions either
+  [cache setTerritoryScores:scores3x2 numberOfRows:3 numberOfColumns:2 forKey:@"key1"];
+  XCTAssertEqual(memoryUsage, cache.memoryUsage);
+  [self checkTerritoryScores:scores3x2 numberOfRows:3 numberOfColumns:2 forKey:@"key1" inCache:cache];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Checks that the least recently used result is discarded when the
+/// memory limit is reached, and that looking up a result counts as using it.
+// -----------------------------------------------------------------------------
+- (void) testLeastRecentlyUsedEviction
+{
+  int memoryUsagePerResult = [self memoryUsagePerResult];
+  GtpAnalysisCache* cache = [[[GtpAnalysisCache alloc] initWithMemoryLimit:2 * memoryUsagePerResult] autorelease];
+  [cache setTerritoryScores:scores2x3 numberOfRows:2 numberOfColumns:3 forKey:@"key1"];
+  [cache setTerritoryScores:scores3x2 numberOfRows:3 numberOfColumns:2 forKey:@"key2"];
+  XCTAssertEqual(2 * memoryUsagePerResult, cache.memoryUsage);
+
+  // key1 becomes the most recently used result, so key2 is discarded
+  [self checkTerritoryScores:scores2x3 numberOfRows:2 numberOfColumns:3 forKey:@"key1" inCache:cache];
+  [cache setTerritoryScores:scores3x2 numberOfRows:3 numberOfColumns:2 forKey:@"key3"];
+  XCTAssertEqual(2 * memoryUsagePerResult, cache.memoryUsage);
+  int numberOfRows;
+  int numberOfColumns;
+  XCTAssertNil([cache territoryScoresForKey:@"key2" numberOfRows:&numberOfRows numberOfColumns:&numberOfColumns]);
+  [self checkTerritoryScores:scores3x2 numberOfRows:3 numberOfColumns:2 forKey:@"key3" inCache:cache];
+  [self checkTerritoryScores:scores2x3 numberOfRows:2 numberOfColumns:3 forKey:@"key1" inCache:cache];
+
+  // Now key3 is the least recently used result
+  [cache setTerritoryScores:scores2x3 numberOfRows:2 numberOfColumns:3 forKey:@"key4"];
+  XCTAssertNil([cache territoryScoresForKey:@"key3" numberOfRows:&numberOfRows numberOfColumns:&numberOfColumns]);
+  [self checkTerritoryScores:scores2x3 numberOfRows:2 numberOfColumns:3 forKey:@"key1" inCache:cache];
+  [self checkTerritoryScores:scores2x3 numberOfRows:2 numberOfColumns:3 forKey:@"key4" inCache:cache];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Checks that a result that alone exceeds the memory limit is not
+/// kept.
+// -----------------------------------------------------------------------------
+- (void) testResultLargerThanMemoryLimit
+{
+  int memoryUsagePerResult = [self memoryUsagePerResult];
+  GtpAnalysisCache* cache = [[[GtpAnalysisCache alloc] initWithMemoryLimit:memoryUsagePerResult - 1] autorelease];
+  [cache setTerritoryScores:scores2x3 numberOfRows:2 numberOfColumns:3 forKey:@"key1"];
+  XCTAssertEqual(0, cache.memoryUsage);
+  int numberOfRows;
+  int numberOfColumns;
+  XCTAssertNil([cache territoryScoresForKey:@"key1" numberOfRows:&numberOfRows numberOfColumns:&numberOfColumns]);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Exercises the removeAllResults() method.
+// -----------------------------------------------------------------------------
+- (void) testRemoveAllResults
+{
+  GtpAnalysisCache* cache = [[[GtpAnalysisCache alloc] initWithMemoryLimit:100000] autorelease];
+  [cache setTerritoryScores:scores2x3 numberOfRows:2 numberOfColumns:3 forKey:@"key1"];
+  struct GoVertexNumeric vertices[] = { {4, 4} };
+  [cache setDeadStoneVertices:vertices count:1 forKey:@"key1"];
+  [cache removeAllResults];
+  XCTAssertEqual(0, cache.memoryUsage);
+  int numberOfRows;
+  int numberOfColumns;
+  XCTAssertNil([cache territoryScoresForKey:@"key1" numberOfRows:&numberOfRows numberOfColumns:&numberOfColumns]);
+  XCTAssertNil([cache deadStoneVerticesForKey:@"key1"]);
+
+  [cache setTerritoryScores:scores2x3 numberOfRows:2 numberOfColumns:3 forKey:@"key1"];
+  [self checkTerritoryScores:scores2x3 numberOfRows:2 numberOfColumns:3 forKey:@"key1" inCache:cache];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Checks that all results are discarded when a new game is created,
+/// with the same and with a different board size.
+// -----------------------------------------------------------------------------
+- (void) testNewGameRemovesAllResults
+{
+  GtpAnalysisCache* cache = [[[GtpAnalysisCache alloc] initWithMemoryLimit:100000] autorelease];
+  [cache setTerritoryScores:scores2x3 numberOfRows:2 numberOfColumns:3 forKey:@"key1"];
+  [[[[NewGameCommand alloc] init] autorelease] submit];
+  XCTAssertEqual(0, cache.memoryUsage);
+  int numberOfRows;
+  int numberOfColumns;
+  XCTAssertNil([cache territoryScoresForKey:@"key1" numberOfRows:&numberOfRows numberOfColumns:&numberOfColumns]);
+
+  [cache setTerritoryScores:scores2x3 numberOfRows:2 numberOfColumns:3 forKey:@"key1"];
+  m_delegate.theNewGameModel.boardSize = GoBoardSize9;
+  [[[[NewGameCommand alloc] init] autorelease] submit];
+  XCTAssertEqual(GoBoardSize9, m_delegate.game.board.size);
+  XCTAssertEqual(0, cache.memoryUsage);
+  XCTAssertNil([cache territoryScoresForKey:@"key1" numberOfRows:&numberOfRows numberOfColumns:&numberOfColumns]);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Checks that all results are discarded when a GTP engine profile is
+/// applied, regardless of whether the profile was already active.
+// -----------------------------------------------------------------------------
+- (void) testApplyProfileRemovesAllResults
+{
+  GtpAnalysisCache* cache = [[[GtpAnalysisCache alloc] initWithMemoryLimit:100000] autorelease];
+  m_delegate.gtpAnalysisCache = cache;
+  GtpEngineProfile* profile = [m_delegate.gtpEngineProfileModel defaultProfile];
+  int numberOfRows;
+  int numberOfColumns;
+
+  [cache setTerritoryScores:scores2x3 numberOfRows:2 numberOfColumns:3 forKey:@"key1"];
+  [profile applyProfile];
+  XCTAssertTrue(profile.isActiveProfile);
+  XCTAssertEqual(0, cache.memoryUsage);
+  XCTAssertNil([cache territoryScoresForKey:@"key1" numberOfRows:&numberOfRows numberOfColumns:&numberOfColumns]);
+
+  // Changed settings of the active profile
+  [cache setTerritoryScores:scores2x3 numberOfRows:2 numberOfColumns:3 forKey:@"key1"];
+  profile.fuegoMaxGames = profile.fuegoMaxGames / 2;
+  [profile applyProfile];
+  XCTAssertEqual(0, cache.memoryUsage);
+  XCTAssertNil([cache territoryScoresForKey:@"key1" numberOfRows:&numberOfRows numberOfColumns:&numberOfColumns]);
+
+  m_delegate.gtpAnalysisCache = nil;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Private helper method of several tests. Checks that @a cache
+/// contains the territory statistics @a expectedScores, with the grid
+/// dimensions @a expectedNumberOfRows and @a expectedNumberOfColumns, for
+/// @a key.
+// -----------------------------------------------------------------------------
+- (void) checkTerritoryScores:(const float*)expectedScores
+                 numberOfRows:(int)expectedNumberOfRows
+              numberOfColumns:(int)expectedNumberOfColumns
+                       forKey:(NSString*)key
+                      inCache:(GtpAnalysisCache*)cache
+{
+  int numberOfRows = -1;
+  int numberOfColumns = -1;
+  NSData* scores = [cache territoryScoresForKey:key numberOfRows:&numberOfRows numberOfColumns:&numberOfColumns];
+  XCTAssertNotNil(scores, @"%@", key);
+  XCTAssertEqual(expectedNumberOfRows, numberOfRows, @"%@", key);
+  XCTAssertEqual(expectedNumberOfColumns, numberOfColumns, @"%@", key);
+  NSUInteger expectedLength = expectedNumberOfRows * expectedNumberOfColumns * sizeof(float);
+  XCTAssertEqual(expectedLength, scores.length, @"%@", key);
+  if (expectedLength == scores.length)
+    XCTAssertEqual(0, memcmp(expectedScores, scores.bytes, expectedLength), @"%@", key);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Private helper method of the tests that exercise the memory limit.
+/// Returns the memory used by a 2x3 grid of territory scores stored under a
+/// key of the same length as "key1".
+// -----------------------------------------------------------------------------
+- (int) memoryUsagePerResult
+{
+  GtpAnalysisCache* cache = [[[GtpAnalysisCache alloc] initWithMemoryLimit:100000] autorelease];
+  [cache setTerritoryScores:scores2x3 numberOfRows:2 numberOfColumns:3 forKey:@"key1"];
+  return cache.memoryUsage;
+}
+
+@end
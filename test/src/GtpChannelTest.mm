@@ -0,0 +1,179 @@
+// -----------------------------------------------------------------------------
+// Copyright 2014 Patrick Näf (herzbube@herzbube.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// -----------------------------------------------------------------------------
+
+
+
+// Test includes
+#import "GtpChannelTest.h"
+
+// Application includes
+#import <gtp/GtpChannel.h>
+
+// System includes
+#include <cstring>  // memcmp
+#include <string>
+#include <unistd.h>  // usleep
+
+
+/// @brief The number of microseconds that a background block waits before it
+/// unblocks the test's thread. Is long enough for the test's thread to be
+/// blocked in GtpByteRing by then.
+static const useconds_t unblockDelay = 100 * 1000;
+
+
+@implementation GtpChannelTest
+
+// -----------------------------------------------------------------------------
+/// @brief Exercises writing and reading data that wraps around the end of the
+/// ring's buffer.
+// -----------------------------------------------------------------------------
+- (void) testWrapAround
+{
+  // The capacity is rounded up to a power of two
+  GtpByteRing ring(5);
+  char buffer[8];
+
+  XCTAssertEqual((size_t)6, ring.write("abcdef", 6));
+  XCTAssertEqual((size_t)6, ring.read(buffer, sizeof(buffer)));
+  XCTAssertEqual(0, memcmp(buffer, "abcdef", 6));
+
+  // The second write starts at buffer position 6 and wraps around
+  XCTAssertEqual((size_t)6, ring.write("ghijkl", 6));
+  XCTAssertEqual((size_t)6, ring.read(buffer, sizeof(buffer)));
+  XCTAssertEqual(0, memcmp(buffer, "ghijkl", 6));
+
+  // A read that is shorter than the available data leaves the rest in the
+  // ring, also if the rest wraps around
+  XCTAssertEqual((size_t)7, ring.write("mnopqrs", 7));
+  XCTAssertEqual((size_t)3, ring.read(buffer, 3));
+  XCTAssertEqual(0, memcmp(buffer, "mno", 3));
+  XCTAssertEqual((size_t)4, ring.read(buffer, sizeof(buffer)));
+  XCTAssertEqual(0, memcmp(buffer, "pqrs", 4));
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Checks that reading from an empty ring blocks until the producer
+/// writes data.
+// -----------------------------------------------------------------------------
+- (void) testEmptyRing
+{
+  GtpByteRing ring(8);
+  GtpByteRing* ringPointer = &ring;
+  char buffer[8];
+
+  dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+    usleep(unblockDelay);
+    ringPointer->write("abc", 3);
+  });
+  XCTAssertEqual((size_t)3, ring.read(buffer, sizeof(buffer)));
+  XCTAssertEqual(0, memcmp(buffer, "abc", 3));
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Checks that a full ring accepts exactly its capacity, and that
+/// writing to a full ring blocks until the consumer makes room.
+// -----------------------------------------------------------------------------
+- (void) testFullRing
+{
+  GtpByteRing ring(8);
+  GtpByteRing* ringPointer = &ring;
+  char consumerBuffer[8];
+  char* consumerBufferPointer = consumerBuffer;
+  __block size_t numberOfBytesReadByConsumer = 0;
+  char buffer[8];
+
+  // Filling the ring to its exact capacity does not block
+  XCTAssertEqual((size_t)8, ring.write("abcdefgh", 8));
+
+  dispatch_group_t group = dispatch_group_create();
+  dispatch_group_async(group, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+    usleep(unblockDelay);
+    numberOfBytesReadByConsumer = ringPointer->read(consumerBufferPointer, 8);
+  });
+  XCTAssertEqual((size_t)4, ring.write("ijkl", 4));
+  dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+  dispatch_release(group);
+
+  XCTAssertEqual((size_t)8, numberOfBytesReadByConsumer);
+  XCTAssertEqual(0, memcmp(consumerBuffer, "abcdefgh", 8));
+  XCTAssertEqual((size_t)4, ring.read(buffer, sizeof(buffer)));
+  XCTAssertEqual(0, memcmp(buffer, "ijkl", 4));
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Exercises the close() method.
+// -----------------------------------------------------------------------------
+- (void) testClose
+{
+  char buffer[8];
+
+  // Data written before the ring is closed can still be read, then the
+  // consumer receives end-of-file. The producer cannot write anymore.
+  GtpByteRing ring(8);
+  XCTAssertEqual((size_t)3, ring.write("abc", 3));
+  ring.close();
+  XCTAssertEqual((size_t)0, ring.write("def", 3));
+  XCTAssertEqual((size_t)3, ring.read(buffer, sizeof(buffer)));
+  XCTAssertEqual(0, memcmp(buffer, "abc", 3));
+  XCTAssertEqual((size_t)0, ring.read(buffer, sizeof(buffer)));
+
+  // Closing wakes up a consumer that waits on an empty ring
+  GtpByteRing emptyRing(8);
+  GtpByteRing* emptyRingPointer = &emptyRing;
+  dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+    usleep(unblockDelay);
+    emptyRingPointer->close();
+  });
+  XCTAssertEqual((size_t)0, emptyRing.read(buffer, sizeof(buffer)));
+
+  // Closing wakes up a producer that waits on a full ring. The producer
+  // reports how much it was able to write.
+  GtpByteRing fullRing(8);
+  GtpByteRing* fullRingPointer = &fullRing;
+  XCTAssertEqual((size_t)8, fullRing.write("abcdefgh", 8));
+  dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+    usleep(unblockDelay);
+    fullRingPointer->close();
+  });
+  XCTAssertEqual((size_t)0, fullRing.write("ijkl", 4));
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Checks that commands and responses travel through the streams of a
+/// GtpChannel, and that closing the channel results in end-of-file for both
+/// sides.
+// -----------------------------------------------------------------------------
+- (void) testChannelStreams
+{
+  GtpChannel channel;
+  std::string line;
+
+  channel.clientCommandStream() << "1 name" << std::endl;
+  XCTAssertTrue(std::getline(channel.engineCommandStream(), line));
+  XCTAssertTrue(line == "1 name");
+
+  channel.engineResponseStream() << "=1 Fuego" << std::endl << std::endl;
+  XCTAssertTrue(std::getline(channel.clientResponseStream(), line));
+  XCTAssertTrue(line == "=1 Fuego");
+  XCTAssertTrue(std::getline(channel.clientResponseStream(), line));
+  XCTAssertTrue(line.empty());
+
+  channel.close();
+  XCTAssertFalse(std::getline(channel.engineCommandStream(), line));
+  XCTAssertFalse(std::getline(channel.clientResponseStream(), line));
+}
+
+@end
@@ -0,0 +1,53 @@
+// -----------------------------------------------------------------------------
+// Copyright 2014 Patrick Näf (herzbube@herzbube.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// -----------------------------------------------------------------------------
+
+
+
+// Project includes
+#import "BaseTestCase.h"
+
+// Forward declarations
+@class GtpReplayEngineFixture;
+@class GtpResponse;
+
+
+// -----------------------------------------------------------------------------
+/// @brief The GtpClientTest class contains unit tests that exercise the
+/// GtpClient class, in particular the pipelining of commands, the handling of
+/// protocol errors, and the deadlines and cancellation tokens of GtpCommand.
+///
+/// The tests use GtpReplayEngine as the counterpart of GtpClient, so that the
+/// GTP engine's behaviour (e.g. how long it takes to answer a command) is
+/// deterministic.
+// -----------------------------------------------------------------------------
+@interface GtpClientTest : BaseTestCase
+{
+@private
+  GtpReplayEngineFixture* m_fixture;
+  GtpResponse* m_asynchronousResponse;
+}
+
+- (void) testDeadlineOfSynchronousCommand;
+- (void) testDeadlineOfAsynchronousCommand;
+- (void) testCancellationToken;
+- (void) testCancelledTokenBeforeSubmit;
+- (void) testCancellationTokenSparesCommandThatIsNotCancellable;
+- (void) testPipelining;
+- (void) testInterruptibleCommandIsNotPipelined;
+- (void) testResyncAfterLostResponse;
+- (void) testStaleResponseIsDiscarded;
+
+@end
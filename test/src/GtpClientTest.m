@@ -0,0 +1,412 @@
+// -----------------------------------------------------------------------------
+// Copyright 2014 Patrick Näf (herzbube@herzbube.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// -----------------------------------------------------------------------------
+
+
+
+// Test includes
+#import "GtpClientTest.h"
+#import "GtpReplayEngineFixture.h"
+
+// Application includes
+#import <gtp/GtpCancellationToken.h>
+#import <gtp/GtpClient.h>
+#import <gtp/GtpCommand.h>
+#import <gtp/GtpResponse.h>
+
+
+/// @brief The transcript that the replay engine answers commands from. The
+/// engine needs 2 seconds to answer "slow", which is much longer than the
+/// deadlines used by the tests, and half a second to answer "wait". The
+/// engine never answers "lost", and answers "twice" twice. The responses to
+/// "count" are the numbers 1 to 10, in the order in which the commands are
+/// received.
+static NSString* replayTranscript =
+  @"# latency slow 2.0 0.0\n"
+  @"# latency wait 0.5 0.0\n"
+  @"# drop lost\n"
+  @"# duplicate twice\n"
+  @"slow\n"
+  @"= slow\n"
+  @"\n"
+  @"fast\n"
+  @"= fast\n"
+  @"\n"
+  @"wait\n"
+  @"= wait\n"
+  @"\n"
+  @"lost\n"
+  @"= lost\n"
+  @"\n"
+  @"twice\n"
+  @"= twice\n"
+  @"\n"
+  @"count\n= 1\n\ncount\n= 2\n\ncount\n= 3\n\ncount\n= 4\n\n"
+  @"count\n= 5\n\ncount\n= 6\n\ncount\n= 7\n\ncount\n= 8\n\n"
+  @"count\n= 9\n\ncount\n= 10\n\n";
+/// @brief The number of commands that GtpClient writes to the engine before it
+/// waits for the first response. Must match the value in GtpClient.mm.
+static const int maximumNumberOfCommandsInFlight = 8;
+/// @brief The deadline (in seconds) of commands that are expected to time out.
+static const NSTimeInterval shortTimeout = 0.1;
+/// @brief The maximum time (in seconds) that a test waits for something that
+/// is expected to happen long before the replay engine answers "slow".
+static const NSTimeInterval maximumWaitTime = 1.0;
+
+
+@implementation GtpClientTest
+
+// -----------------------------------------------------------------------------
+/// @brief Checks that a synchronous command whose deadline passes returns with
+/// a "timeout" failure response, and that the engine's stale response to that
+/// command is not delivered to the next command.
+// -----------------------------------------------------------------------------
+- (void) testDeadlineOfSynchronousCommand
+{
+  GtpClient* client = [self clientWithNewReplayEngine];
+
+  GtpCommand* slowCommand = [GtpCommand command:@"slow"];
+  slowCommand.timeout = shortTimeout;
+  NSDate* submitDate = [NSDate date];
+  [client submit:slowCommand];
+  XCTAssertTrue([[NSDate date] timeIntervalSinceDate:submitDate] < maximumWaitTime);
+  XCTAssertFalse(slowCommand.response.status);
+  XCTAssertEqualObjects(@"timeout", [slowCommand.response parsedResponse]);
+
+  GtpCommand* fastCommand = [GtpCommand command:@"fast"];
+  [client submit:fastCommand];
+  XCTAssertTrue(fastCommand.response.status);
+  XCTAssertEqualObjects(@"fast", [fastCommand.response parsedResponse]);
+  XCTAssertEqualObjects(@"timeout", [slowCommand.response parsedResponse]);
+
+  [self quitReplayEngine];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Checks that the response target of an asynchronous command whose
+/// deadline passes is notified with a "timeout" failure response, even though
+/// the submitting thread does not run its run loop while the deadline passes.
+// -----------------------------------------------------------------------------
+- (void) testDeadlineOfAsynchronousCommand
+{
+  GtpClient* client = [self clientWithNewReplayEngine];
+
+  GtpCommand* slowCommand = [GtpCommand asynchronousCommand:@"slow"
+                                             responseTarget:self
+                                                   selector:@selector(asynchronousResponseReceived:)];
+  slowCommand.timeout = shortTimeout;
+  NSDate* submitDate = [NSDate date];
+  [client submit:slowCommand];
+  // Block the submitting thread until long after the deadline has passed
+  [NSThread sleepForTimeInterval:shortTimeout * 3];
+  XCTAssertEqual(0, client.numberOfOutstandingCommands);
+
+  [self waitForAsynchronousResponse];
+  XCTAssertTrue([[NSDate date] timeIntervalSinceDate:submitDate] < maximumWaitTime);
+  XCTAssertFalse(m_asynchronousResponse.status);
+  XCTAssertEqualObjects(@"timeout", [m_asynchronousResponse parsedResponse]);
+
+  [self quitReplayEngine];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Checks that abandoning the commands that carry a cancellation token
+/// completes the cancellable ones with a "cancelled" failure response, and
+/// that commands without the token are not affected.
+// -----------------------------------------------------------------------------
+- (void) testCancellationToken
+{
+  GtpClient* client = [self clientWithNewReplayEngine];
+
+  GtpCancellationToken* cancellationToken = [GtpCancellationToken token];
+  [GtpCancellationToken setCurrentToken:cancellationToken];
+  GtpCommand* slowCommand = [GtpCommand asynchronousCommand:@"slow"
+                                             responseTarget:self
+                                                   selector:@selector(asynchronousResponseReceived:)];
+  [GtpCancellationToken setCurrentToken:nil];
+  slowCommand.cancellable = true;
+  XCTAssertEqual(cancellationToken, slowCommand.cancellationToken);
+  GtpCommand* fastCommand = [GtpCommand command:@"fast"];
+  XCTAssertNil(fastCommand.cancellationToken);
+
+  NSDate* submitDate = [NSDate date];
+  [client submit:slowCommand];
+  [client abandonCommandsWithCancellationToken:cancellationToken];
+  [self waitForAsynchronousResponse];
+  XCTAssertTrue([[NSDate date] timeIntervalSinceDate:submitDate] < maximumWaitTime);
+  XCTAssertFalse(m_asynchronousResponse.status);
+  XCTAssertEqualObjects(@"cancelled", [m_asynchronousResponse parsedResponse]);
+
+  [client submit:fastCommand];
+  XCTAssertTrue(fastCommand.response.status);
+  XCTAssertEqualObjects(@"fast", [fastCommand.response parsedResponse]);
+
+  [self quitReplayEngine];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Checks that a cancellable command whose cancellation token has
+/// already been cancelled is completed without being sent to the GTP engine.
+// -----------------------------------------------------------------------------
+- (void) testCancelledTokenBeforeSubmit
+{
+  GtpClient* client = [self clientWithNewReplayEngine];
+
+  GtpCancellationToken* cancellationToken = [GtpCancellationToken token];
+  [cancellationToken cancel];
+  XCTAssertTrue(cancellationToken.isCancelled);
+  GtpCommand* slowCommand = [GtpCommand command:@"slow"];
+  slowCommand.cancellationToken = cancellationToken;
+  slowCommand.cancellable = true;
+  NSDate* submitDate = [NSDate date];
+  [client submit:slowCommand];
+  XCTAssertTrue([[NSDate date] timeIntervalSinceDate:submitDate] < maximumWaitTime);
+  XCTAssertFalse(slowCommand.response.status);
+  XCTAssertEqualObjects(@"cancelled", [slowCommand.response parsedResponse]);
+  XCTAssertEqual(0, client.numberOfOutstandingCommands);
+
+  [self quitReplayEngine];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Checks that a command that is not cancellable is sent to the GTP
+/// engine and answered even though its cancellation token is cancelled, both
+/// before and after the command is submitted.
+// -----------------------------------------------------------------------------
+- (void) testCancellationTokenSparesCommandThatIsNotCancellable
+{
+  GtpClient* client = [self clientWithNewReplayEngine];
+
+  GtpCancellationToken* cancellationToken = [GtpCancellationToken token];
+  GtpCommand* waitCommand = [GtpCommand command:@"wait"];
+  waitCommand.waitUntilDone = false;
+  waitCommand.cancellationToken = cancellationToken;
+  XCTAssertFalse(waitCommand.cancellable);
+  [client submit:waitCommand];
+  [client abandonCommandsWithCancellationToken:cancellationToken];
+  [cancellationToken cancel];
+  XCTAssertEqual(1, client.numberOfOutstandingCommands);
+
+  GtpCommand* fastCommand = [GtpCommand command:@"fast"];
+  fastCommand.cancellationToken = cancellationToken;
+  [client submit:fastCommand];
+  XCTAssertTrue(fastCommand.response.status);
+  XCTAssertEqualObjects(@"fast", [fastCommand.response parsedResponse]);
+  XCTAssertTrue(waitCommand.response.status);
+  XCTAssertEqualObjects(@"wait", [waitCommand.response parsedResponse]);
+
+  [self quitReplayEngine];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Checks that GtpClient writes no more than
+/// #maximumNumberOfCommandsInFlight commands to the engine before it waits for
+/// a response, that it writes the remaining commands as responses arrive, and
+/// that each response is delivered to the command that it answers.
+// -----------------------------------------------------------------------------
+- (void) testPipelining
+{
+  GtpClient* client = [self clientWithNewReplayEngine];
+
+  // The first "wait" is written on its own. The second "wait" and the first
+  // "count" commands are written in one burst when the first "wait" has been
+  // answered, and the engine then works on the second "wait" for a while.
+  GtpCommand* firstWaitCommand = [GtpCommand command:@"wait"];
+  firstWaitCommand.waitUntilDone = false;
+  [client submit:firstWaitCommand];
+  [NSThread sleepForTimeInterval:shortTimeout];
+
+  NSMutableArray* commands = [NSMutableArray array];
+  [commands addObject:[GtpCommand command:@"wait"]];
+  for (int indexOfCommand = 1; indexOfCommand <= 10; ++indexOfCommand)
+    [commands addObject:[GtpCommand command:@"count"]];
+  GtpCommand* lastCommand = [commands lastObject];
+  for (GtpCommand* command in commands)
+  {
+    if (command == lastCommand)
+      break;
+    command.waitUntilDone = false;
+    [client submit:command];
+  }
+
+  // The engine is still working on the second "wait", so the window must be
+  // full but must not have been topped up. The second "wait" is answered
+  // about one second after the first "wait" was submitted.
+  [NSThread sleepForTimeInterval:0.65];
+  XCTAssertEqualObjects(@"wait", [firstWaitCommand.response parsedResponse]);
+  XCTAssertEqual((NSUInteger)(1 + maximumNumberOfCommandsInFlight), [m_fixture submittedCommands].count);
+  XCTAssertEqual((int)commands.count - 1, client.numberOfOutstandingCommands);
+  for (GtpCommand* command in commands)
+    XCTAssertNil(command.response);
+
+  // Commands are answered in order, so when the last command is complete all
+  // others are complete, too
+  [client submit:lastCommand];
+
+  XCTAssertEqual(0, client.numberOfOutstandingCommands);
+  [commands insertObject:firstWaitCommand atIndex:0];
+  XCTAssertEqualObjects(commands, [m_fixture submittedCommands]);
+  XCTAssertEqualObjects(@"wait", [[[commands objectAtIndex:1] response] parsedResponse]);
+  for (NSUInteger indexOfCommand = 2; indexOfCommand < commands.count; ++indexOfCommand)
+  {
+    GtpResponse* response = [[commands objectAtIndex:indexOfCommand] response];
+    XCTAssertTrue(response.status);
+    XCTAssertEqualObjects(([NSString stringWithFormat:@"%lu", (unsigned long)indexOfCommand - 1]), [response parsedResponse]);
+  }
+
+  [self quitReplayEngine];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Checks that GtpClient writes an interruptible command on its own,
+/// and writes no further commands until the engine has answered it, so that
+/// an interrupt cannot stop a later command.
+// -----------------------------------------------------------------------------
+- (void) testInterruptibleCommandIsNotPipelined
+{
+  GtpClient* client = [self clientWithNewReplayEngine];
+
+  GtpCommand* waitCommand = [GtpCommand command:@"wait"];
+  waitCommand.waitUntilDone = false;
+  waitCommand.interruptible = true;
+  GtpCommand* fastCommand = [GtpCommand command:@"fast"];
+  fastCommand.waitUntilDone = false;
+  [client submit:waitCommand];
+  [client submit:fastCommand];
+
+  // The engine is still working on "wait"
+  [NSThread sleepForTimeInterval:shortTimeout * 2];
+  XCTAssertEqualObjects([NSArray arrayWithObject:waitCommand], [m_fixture submittedCommands]);
+  XCTAssertEqual(2, client.numberOfOutstandingCommands);
+
+  GtpCommand* countCommand = [GtpCommand command:@"count"];
+  [client submit:countCommand];
+  XCTAssertEqualObjects(@"wait", [waitCommand.response parsedResponse]);
+  XCTAssertEqualObjects(@"fast", [fastCommand.response parsedResponse]);
+  XCTAssertEqualObjects(@"1", [countCommand.response parsedResponse]);
+  NSArray* expectedCommands = [NSArray arrayWithObjects:waitCommand, fastCommand, countCommand, nil];
+  XCTAssertEqualObjects(expectedCommands, [m_fixture submittedCommands]);
+
+  [self quitReplayEngine];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Checks that when the engine's response to a command is lost, and the
+/// engine answers the next command, GtpClient fails the command whose response
+/// was lost with a "protocol error" failure response, and delivers the
+/// engine's response to the next command.
+// -----------------------------------------------------------------------------
+- (void) testResyncAfterLostResponse
+{
+  GtpClient* client = [self clientWithNewReplayEngine];
+
+  // While the engine is working on "wait", "lost" and "fast" are queued so
+  // that they are written in the same burst. Otherwise GtpClient would wait
+  // forever for the response to "lost".
+  GtpCommand* waitCommand = [GtpCommand command:@"wait"];
+  waitCommand.waitUntilDone = false;
+  GtpCommand* lostCommand = [GtpCommand command:@"lost"];
+  lostCommand.waitUntilDone = false;
+  GtpCommand* fastCommand = [GtpCommand command:@"fast"];
+  [client submit:waitCommand];
+  [client submit:lostCommand];
+  [client submit:fastCommand];
+
+  XCTAssertEqualObjects(@"wait", [waitCommand.response parsedResponse]);
+  XCTAssertFalse(lostCommand.response.status);
+  XCTAssertEqualObjects(@"protocol error", [lostCommand.response parsedResponse]);
+  XCTAssertTrue(fastCommand.response.status);
+  XCTAssertEqualObjects(@"fast", [fastCommand.response parsedResponse]);
+  XCTAssertEqual(0, client.numberOfOutstandingCommands);
+
+  [self quitReplayEngine];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Checks that a response whose command ID does not belong to any
+/// command in flight is discarded instead of being delivered to the next
+/// command.
+// -----------------------------------------------------------------------------
+- (void) testStaleResponseIsDiscarded
+{
+  GtpClient* client = [self clientWithNewReplayEngine];
+
+  GtpCommand* twiceCommand = [GtpCommand command:@"twice"];
+  [client submit:twiceCommand];
+  XCTAssertEqualObjects(@"twice", [twiceCommand.response parsedResponse]);
+
+  // The second response to "twice" is read before the response to "fast"
+  GtpCommand* fastCommand = [GtpCommand command:@"fast"];
+  [client submit:fastCommand];
+  XCTAssertTrue(fastCommand.response.status);
+  XCTAssertEqualObjects(@"fast", [fastCommand.response parsedResponse]);
+
+  GtpCommand* countCommand = [GtpCommand command:@"count"];
+  [client submit:countCommand];
+  XCTAssertEqualObjects(@"1", [countCommand.response parsedResponse]);
+
+  [self quitReplayEngine];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Private helper method of all tests in this class. Sets up a new
+/// replay engine and returns the GtpClient that communicates with it.
+// -----------------------------------------------------------------------------
+- (GtpClient*) clientWithNewReplayEngine
+{
+  m_asynchronousResponse = nil;
+  m_fixture = [[GtpReplayEngineFixture alloc] initWithReplayTranscript:replayTranscript];
+  return m_fixture.playClient;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Private helper method of all tests in this class. Submits "quit" so
+/// that both the client's and the replay engine's threads end.
+// -----------------------------------------------------------------------------
+- (void) quitReplayEngine
+{
+  XCTAssertTrue([m_fixture quit]);
+  [m_fixture release];
+  m_fixture = nil;
+  [m_asynchronousResponse release];
+  m_asynchronousResponse = nil;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Private helper method of the tests that submit asynchronous
+/// commands. Runs the current thread's run loop until the response target is
+/// notified, or until #maximumWaitTime has passed.
+// -----------------------------------------------------------------------------
+- (void) waitForAsynchronousResponse
+{
+  NSDate* giveUpDate = [NSDate dateWithTimeIntervalSinceNow:maximumWaitTime];
+  while (! m_asynchronousResponse && [giveUpDate timeIntervalSinceNow] > 0)
+  {
+    [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode
+                             beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.05]];
+  }
+  XCTAssertNotNil(m_asynchronousResponse);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Is invoked as the response target of asynchronous commands.
+// -----------------------------------------------------------------------------
+- (void) asynchronousResponseReceived:(GtpResponse*)response
+{
+  [m_asynchronousResponse release];
+  m_asynchronousResponse = [response retain];
+}
+
+@end
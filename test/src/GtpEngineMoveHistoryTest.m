@@ -0,0 +1,250 @@
+// -----------------------------------------------------------------------------
+// Copyright 2014 Patrick Näf (herzbube@herzbube.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// -----------------------------------------------------------------------------
+
+
+
+// Test includes
+#import "GtpEngineMoveHistoryTest.h"
+
+// Application includes
+#import <gtp/GtpCommand.h>
+#import <gtp/GtpEngineMoveHistory.h>
+#import <gtp/GtpResponse.h>
+
+
+@implementation GtpEngineMoveHistoryTest
+
+// -----------------------------------------------------------------------------
+/// @brief Checks that a full synchronization is required as long as the
+/// content of the GTP engine's board is unknown.
+// -----------------------------------------------------------------------------
+- (void) testUnknownBoard
+{
+  GtpEngineMoveHistory* history = [[[GtpEngineMoveHistory alloc] init] autorelease];
+  NSUInteger numberOfCommonMoves;
+  NSUInteger numberOfMovesToUndo;
+  XCTAssertFalse([history deltaToBoardSize:19 komi:6.5 handicap:0 moves:[NSArray array]
+                       numberOfCommonMoves:&numberOfCommonMoves numberOfMovesToUndo:&numberOfMovesToUndo]);
+  XCTAssertNil([history movesIfHandicapIs:0]);
+
+  [self setupHistory:history boardSize:19 komi:@"6.5" handicap:0];
+  XCTAssertTrue([history deltaToBoardSize:19 komi:6.5 handicap:0 moves:[NSArray array]
+                      numberOfCommonMoves:&numberOfCommonMoves numberOfMovesToUndo:&numberOfMovesToUndo]);
+  XCTAssertEqual((NSUInteger)0, numberOfCommonMoves);
+  XCTAssertEqual((NSUInteger)0, numberOfMovesToUndo);
+
+  [self updateHistory:history withCommand:@"loadsgf /tmp/game.sgf" status:true];
+  XCTAssertFalse([history deltaToBoardSize:19 komi:6.5 handicap:0 moves:[NSArray array]
+                       numberOfCommonMoves:&numberOfCommonMoves numberOfMovesToUndo:&numberOfMovesToUndo]);
+  // Clearing the board makes the content of the board known, but not the
+  // board size and komi that the game record specified
+  [self updateHistory:history withCommand:@"clear_board" status:true];
+  XCTAssertNotNil([history movesIfHandicapIs:0]);
+  XCTAssertFalse([history deltaToBoardSize:19 komi:6.5 handicap:0 moves:[NSArray array]
+                       numberOfCommonMoves:&numberOfCommonMoves numberOfMovesToUndo:&numberOfMovesToUndo]);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Checks the delta when moves were only appended to the moves that
+/// the GTP engine has on its board.
+// -----------------------------------------------------------------------------
+- (void) testAppendMoves
+{
+  GtpEngineMoveHistory* history = [[[GtpEngineMoveHistory alloc] init] autorelease];
+  [self setupHistory:history boardSize:19 komi:@"6.5" handicap:0];
+  [self updateHistory:history withCommand:@"play b d4" status:true];
+  [self updateHistory:history withCommand:@"play white q16" status:true];
+  // A failed move leaves the board unchanged
+  [self updateHistory:history withCommand:@"play b q16" status:false];
+  NSArray* expectedEngineMoves = [NSArray arrayWithObjects:@"B D4", @"W Q16", nil];
+  XCTAssertEqualObjects(expectedEngineMoves, [history movesIfHandicapIs:0]);
+
+  NSArray* moves = [NSArray arrayWithObjects:@"B D4", @"W Q16", @"B Q4", @"W PASS", nil];
+  NSUInteger numberOfCommonMoves;
+  NSUInteger numberOfMovesToUndo;
+  XCTAssertTrue([history deltaToBoardSize:19 komi:6.5 handicap:0 moves:moves
+                      numberOfCommonMoves:&numberOfCommonMoves numberOfMovesToUndo:&numberOfMovesToUndo]);
+  XCTAssertEqual((NSUInteger)2, numberOfCommonMoves);
+  XCTAssertEqual((NSUInteger)0, numberOfMovesToUndo);
+
+  [self updateHistory:history withCommand:@"gogui-play_sequence B Q4 W PASS" status:true];
+  XCTAssertTrue([history deltaToBoardSize:19 komi:6.5 handicap:0 moves:moves
+                      numberOfCommonMoves:&numberOfCommonMoves numberOfMovesToUndo:&numberOfMovesToUndo]);
+  XCTAssertEqual((NSUInteger)4, numberOfCommonMoves);
+  XCTAssertEqual((NSUInteger)0, numberOfMovesToUndo);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Checks the delta when moves were taken back from the end of the
+/// moves that the GTP engine has on its board, and other moves were played
+/// instead.
+// -----------------------------------------------------------------------------
+- (void) testUndoThenPlay
+{
+  GtpEngineMoveHistory* history = [[[GtpEngineMoveHistory alloc] init] autorelease];
+  [self setupHistory:history boardSize:19 komi:@"6.5" handicap:0];
+  [self updateHistory:history withCommand:@"gogui-play_sequence B D4 W Q16 B Q4" status:true];
+  [self updateHistory:history withCommand:@"genmove w" response:@"= D16"];
+
+  NSUInteger numberOfCommonMoves;
+  NSUInteger numberOfMovesToUndo;
+  // Back to an earlier board position
+  NSArray* moves = [NSArray arrayWithObjects:@"B D4", @"W Q16", nil];
+  XCTAssertTrue([history deltaToBoardSize:19 komi:6.5 handicap:0 moves:moves
+                      numberOfCommonMoves:&numberOfCommonMoves numberOfMovesToUndo:&numberOfMovesToUndo]);
+  XCTAssertEqual((NSUInteger)2, numberOfCommonMoves);
+  XCTAssertEqual((NSUInteger)2, numberOfMovesToUndo);
+
+  // The last move was replaced by a different move
+  moves = [NSArray arrayWithObjects:@"B D4", @"W Q16", @"B Q4", @"W C3", nil];
+  XCTAssertTrue([history deltaToBoardSize:19 komi:6.5 handicap:0 moves:moves
+                      numberOfCommonMoves:&numberOfCommonMoves numberOfMovesToUndo:&numberOfMovesToUndo]);
+  XCTAssertEqual((NSUInteger)3, numberOfCommonMoves);
+  XCTAssertEqual((NSUInteger)1, numberOfMovesToUndo);
+
+  [self updateHistory:history withCommand:@"undo" status:true];
+  [self updateHistory:history withCommand:@"play W C3" status:true];
+  XCTAssertEqualObjects(moves, [history movesIfHandicapIs:0]);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Checks the delta when the moves diverge from the moves that the GTP
+/// engine has on its board early in the game, so that replaying all moves is
+/// cheaper than taking back and playing moves.
+// -----------------------------------------------------------------------------
+- (void) testDivergentBranch
+{
+  GtpEngineMoveHistory* history = [[[GtpEngineMoveHistory alloc] init] autorelease];
+  [self setupHistory:history boardSize:19 komi:@"6.5" handicap:0];
+  [self updateHistory:history withCommand:@"gogui-play_sequence B D4 W Q16 B Q4 W D16" status:true];
+
+  NSUInteger numberOfCommonMoves;
+  NSUInteger numberOfMovesToUndo;
+  // 3 moves to undo and 3 moves to play are more expensive than replaying 4
+  // moves
+  NSArray* moves = [NSArray arrayWithObjects:@"B D4", @"W C3", @"B R3", @"W Q16", nil];
+  XCTAssertFalse([history deltaToBoardSize:19 komi:6.5 handicap:0 moves:moves
+                       numberOfCommonMoves:&numberOfCommonMoves numberOfMovesToUndo:&numberOfMovesToUndo]);
+  // 2 moves to undo and 3 moves to play are as expensive as replaying 5 moves
+  moves = [NSArray arrayWithObjects:@"B D4", @"W Q16", @"B R3", @"W C3", @"B Q4", nil];
+  XCTAssertTrue([history deltaToBoardSize:19 komi:6.5 handicap:0 moves:moves
+                      numberOfCommonMoves:&numberOfCommonMoves numberOfMovesToUndo:&numberOfMovesToUndo]);
+  XCTAssertEqual((NSUInteger)2, numberOfCommonMoves);
+  XCTAssertEqual((NSUInteger)2, numberOfMovesToUndo);
+  // No moves in common
+  moves = [NSArray arrayWithObjects:@"B Q4", nil];
+  XCTAssertFalse([history deltaToBoardSize:19 komi:6.5 handicap:0 moves:moves
+                       numberOfCommonMoves:&numberOfCommonMoves numberOfMovesToUndo:&numberOfMovesToUndo]);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Checks that a full synchronization is required if the board size,
+/// the komi or the handicap differ from those of the GTP engine, even if the
+/// moves are the same.
+// -----------------------------------------------------------------------------
+- (void) testSetupChangeRequiresFullSync
+{
+  GtpEngineMoveHistory* history = [[[GtpEngineMoveHistory alloc] init] autorelease];
+  [self setupHistory:history boardSize:9 komi:@"0.5" handicap:2];
+  [self updateHistory:history withCommand:@"play w e5" status:true];
+  NSArray* moves = [NSArray arrayWithObjects:@"W E5", nil];
+
+  NSUInteger numberOfCommonMoves;
+  NSUInteger numberOfMovesToUndo;
+  XCTAssertTrue([history deltaToBoardSize:9 komi:0.5 handicap:2 moves:moves
+                      numberOfCommonMoves:&numberOfCommonMoves numberOfMovesToUndo:&numberOfMovesToUndo]);
+  XCTAssertEqual((NSUInteger)1, numberOfCommonMoves);
+  XCTAssertEqual((NSUInteger)0, numberOfMovesToUndo);
+  XCTAssertFalse([history deltaToBoardSize:13 komi:0.5 handicap:2 moves:moves
+                       numberOfCommonMoves:&numberOfCommonMoves numberOfMovesToUndo:&numberOfMovesToUndo]);
+  XCTAssertFalse([history deltaToBoardSize:9 komi:6.5 handicap:2 moves:moves
+                       numberOfCommonMoves:&numberOfCommonMoves numberOfMovesToUndo:&numberOfMovesToUndo]);
+  XCTAssertFalse([history deltaToBoardSize:9 komi:0.5 handicap:0 moves:moves
+                       numberOfCommonMoves:&numberOfCommonMoves numberOfMovesToUndo:&numberOfMovesToUndo]);
+
+  // A new komi takes effect without clearing the board
+  [self updateHistory:history withCommand:@"komi 6.5" status:true];
+  XCTAssertTrue([history deltaToBoardSize:9 komi:6.5 handicap:2 moves:moves
+                      numberOfCommonMoves:&numberOfCommonMoves numberOfMovesToUndo:&numberOfMovesToUndo]);
+  // A failed komi makes the komi unknown
+  [self updateHistory:history withCommand:@"komi foo" status:false];
+  XCTAssertFalse([history deltaToBoardSize:9 komi:6.5 handicap:2 moves:moves
+                       numberOfCommonMoves:&numberOfCommonMoves numberOfMovesToUndo:&numberOfMovesToUndo]);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Checks that submitted commands are assumed to succeed, and that the
+/// board becomes unknown for commands whose effect depends on the response.
+// -----------------------------------------------------------------------------
+- (void) testSubmittedCommands
+{
+  GtpEngineMoveHistory* history = [[[GtpEngineMoveHistory alloc] init] autorelease];
+  [history updateWithSubmittedCommand:[GtpCommand command:@"boardsize 19"]];
+  [history updateWithSubmittedCommand:[GtpCommand command:@"komi 6.5"]];
+  [history updateWithSubmittedCommand:[GtpCommand command:@"gogui-play_sequence B D4 W Q16"]];
+  NSArray* moves = [NSArray arrayWithObjects:@"B D4", @"W Q16", nil];
+  XCTAssertEqualObjects(moves, [history movesIfHandicapIs:0]);
+
+  NSUInteger numberOfCommonMoves;
+  NSUInteger numberOfMovesToUndo;
+  XCTAssertTrue([history deltaToBoardSize:19 komi:6.5 handicap:0 moves:moves
+                      numberOfCommonMoves:&numberOfCommonMoves numberOfMovesToUndo:&numberOfMovesToUndo]);
+  XCTAssertEqual((NSUInteger)2, numberOfCommonMoves);
+  XCTAssertEqual((NSUInteger)0, numberOfMovesToUndo);
+
+  // The move is not known before the engine has answered
+  [history updateWithSubmittedCommand:[GtpCommand command:@"genmove b"]];
+  XCTAssertNil([history movesIfHandicapIs:0]);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Private helper method of all tests in this class. Feeds the
+/// successful responses to the GTP commands that set up the GTP engine's board
+/// with @a boardSize, @a komi and @a handicap into @a history.
+// -----------------------------------------------------------------------------
+- (void) setupHistory:(GtpEngineMoveHistory*)history boardSize:(int)boardSize komi:(NSString*)komi handicap:(NSUInteger)handicap
+{
+  [self updateHistory:history withCommand:[NSString stringWithFormat:@"boardsize %d", boardSize] status:true];
+  [self updateHistory:history withCommand:@"clear_board" status:true];
+  [self updateHistory:history withCommand:[@"komi " stringByAppendingString:komi] status:true];
+  if (handicap > 0)
+  {
+    [self updateHistory:history
+            withCommand:[NSString stringWithFormat:@"fixed_handicap %lu", (unsigned long)handicap]
+                 status:true];
+  }
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Private helper method of all tests in this class. Feeds a response
+/// with status @a status and without a value to the GTP command @a command
+/// into @a history.
+// -----------------------------------------------------------------------------
+- (void) updateHistory:(GtpEngineMoveHistory*)history withCommand:(NSString*)command status:(bool)status
+{
+  [self updateHistory:history withCommand:command response:(status ? @"=" : @"? error")];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Private helper method of all tests in this class. Feeds the raw
+/// response @a response to the GTP command @a command into @a history.
+// -----------------------------------------------------------------------------
+- (void) updateHistory:(GtpEngineMoveHistory*)history withCommand:(NSString*)command response:(NSString*)response
+{
+  [history updateWithResponse:[GtpResponse response:response toCommand:[GtpCommand command:command]]];
+}
+
+@end
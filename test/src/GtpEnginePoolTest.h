@@ -0,0 +1,45 @@
+// -----------------------------------------------------------------------------
+// Copyright 2014 Patrick Näf (herzbube@herzbube.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// -----------------------------------------------------------------------------
+
+
+
+// Project includes
+#import "BaseTestCase.h"
+
+// Forward declarations
+@class GtpReplayEngineFixture;
+
+
+// -----------------------------------------------------------------------------
+/// @brief The GtpEnginePoolTest class contains unit tests that exercise the
+/// GtpEnginePool class.
+///
+/// The tests use GtpReplayEngine for the play engine and for the analysis
+/// engines, and check which GTP commands are sent to which engine.
+// -----------------------------------------------------------------------------
+@interface GtpEnginePoolTest : BaseTestCase
+{
+@private
+  GtpReplayEngineFixture* m_fixture;
+}
+
+- (void) testRoutingWithoutAnalysisEngines;
+- (void) testRoutingToLeastBusyAnalysisEngine;
+- (void) testSubmitCommandAtBoardPosition;
+- (void) testSubmitCommandWhileEngineIsBusy;
+- (void) testConcurrentSubmissionsDoNotInterleave;
+
+@end
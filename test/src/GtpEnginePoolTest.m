@@ -0,0 +1,273 @@
+// -----------------------------------------------------------------------------
+// Copyright 2014 Patrick Näf (herzbube@herzbube.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// -----------------------------------------------------------------------------
+
+
+
+// Test includes
+#import "GtpEnginePoolTest.h"
+#import "GtpReplayEngineFixture.h"
+
+// Application includes
+#import <gtp/GtpClient.h>
+#import <gtp/GtpCommand.h>
+#import <gtp/GtpEnginePool.h>
+#import <gtp/GtpResponse.h>
+
+
+/// @brief The transcript that all replay engines answer commands from. The
+/// engines need 2 seconds to answer "slow". "queryA" and "queryB" stand for
+/// queries about the positions #movesA and #movesB.
+static NSString* replayTranscript =
+  @"# latency slow 2.0 0.0\n"
+  @"slow\n= slow\n\n"
+  @"fast\n= fast\n\n"
+  @"boardsize 19\n=\n\n"
+  @"komi 6.5\n=\n\n"
+  @"fixed_handicap 2\n=\n\n"
+  @"gogui-play_sequence B D4\n=\n\n"
+  @"gogui-play_sequence W Q16 B Q4\n=\n\n"
+  @"queryA\n= A\n\n"
+  @"queryB\n= B\n\n";
+/// @brief The command string that sets up the moves of the position that
+/// "queryA" stands for.
+static NSString* playSequenceA = @"gogui-play_sequence B D4";
+/// @brief The command string that sets up the moves of the position that
+/// "queryB" stands for.
+static NSString* playSequenceB = @"gogui-play_sequence W Q16 B Q4";
+/// @brief The maximum time (in seconds) that a test waits for something that
+/// is expected to happen long before a replay engine answers "slow".
+static const NSTimeInterval maximumWaitTime = 1.0;
+
+
+@implementation GtpEnginePoolTest
+
+// -----------------------------------------------------------------------------
+/// @brief Checks that all commands go to the play engine if the pool has no
+/// analysis engines, that no setup commands are sent, and that the play
+/// engine's client does not keep a queued move history.
+// -----------------------------------------------------------------------------
+- (void) testRoutingWithoutAnalysisEngines
+{
+  [self setupPoolWithNumberOfAnalysisEngines:0];
+  XCTAssertFalse(m_fixture.pool.hasAnalysisClients);
+  XCTAssertNil(m_fixture.pool.playClient.queuedEngineMoveHistory);
+
+  GtpCommand* analysisCommand = [GtpCommand command:@"fast"];
+  analysisCommand.engineAffinity = GtpEngineAffinityAnalysis;
+  XCTAssertEqual(m_fixture.pool.playClient, [m_fixture.pool clientForCommand:analysisCommand]);
+
+  GtpCommand* queryCommand = [GtpCommand command:@"queryA"];
+  [m_fixture.pool submitCommand:queryCommand atBoardSize:19 komi:6.5 handicap:0 moves:[self movesA]];
+  XCTAssertEqual(m_fixture.pool.playClient, queryCommand.gtpClient);
+  XCTAssertEqualObjects(@"A", [queryCommand.response parsedResponse]);
+  NSArray* expectedCommands = [NSArray arrayWithObjects:@"queryA", nil];
+  XCTAssertEqualObjects(expectedCommands, [m_fixture takeSubmittedCommandStringsOfClient:m_fixture.pool.playClient]);
+
+  [self quitPool];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Checks that commands with play affinity go to the play engine, and
+/// that commands with analysis affinity go to the analysis engine with the
+/// fewest outstanding commands.
+// -----------------------------------------------------------------------------
+- (void) testRoutingToLeastBusyAnalysisEngine
+{
+  [self setupPoolWithNumberOfAnalysisEngines:2];
+  GtpClient* firstAnalysisClient = [m_fixture.pool.analysisClients objectAtIndex:0];
+  GtpClient* secondAnalysisClient = [m_fixture.pool.analysisClients objectAtIndex:1];
+
+  GtpCommand* playCommand = [GtpCommand command:@"fast"];
+  XCTAssertEqual(GtpEngineAffinityPlay, playCommand.engineAffinity);
+  XCTAssertEqual(m_fixture.pool.playClient, [m_fixture.pool clientForCommand:playCommand]);
+
+  // The first analysis engine becomes busy
+  GtpCommand* slowCommand = [GtpCommand command:@"slow"];
+  slowCommand.engineAffinity = GtpEngineAffinityAnalysis;
+  slowCommand.waitUntilDone = false;
+  [slowCommand submit];
+  XCTAssertEqual(firstAnalysisClient, slowCommand.gtpClient);
+
+  GtpCommand* fastCommand = [GtpCommand command:@"fast"];
+  fastCommand.engineAffinity = GtpEngineAffinityAnalysis;
+  NSDate* submitDate = [NSDate date];
+  [fastCommand submit];
+  XCTAssertEqual(secondAnalysisClient, fastCommand.gtpClient);
+  XCTAssertEqualObjects(@"fast", [fastCommand.response parsedResponse]);
+  XCTAssertTrue([[NSDate date] timeIntervalSinceDate:submitDate] < maximumWaitTime);
+  XCTAssertEqual(0, m_fixture.pool.playClient.numberOfOutstandingCommands);
+
+  [self quitPool];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Checks that submitCommand:atBoardSize:komi:handicap:moves:() sets up
+/// the analysis engine only if the engine does not already have the requested
+/// position.
+// -----------------------------------------------------------------------------
+- (void) testSubmitCommandAtBoardPosition
+{
+  [self setupPoolWithNumberOfAnalysisEngines:1];
+  GtpClient* analysisClient = [m_fixture.pool.analysisClients objectAtIndex:0];
+
+  GtpCommand* queryCommand = [GtpCommand command:@"queryA"];
+  [m_fixture.pool submitCommand:queryCommand atBoardSize:19 komi:6.5 handicap:0 moves:[self movesA]];
+  XCTAssertEqual(analysisClient, queryCommand.gtpClient);
+  XCTAssertEqualObjects(@"A", [queryCommand.response parsedResponse]);
+  NSArray* expectedCommands = [NSArray arrayWithObjects:@"boardsize 19", @"komi 6.5", playSequenceA, @"queryA", nil];
+  XCTAssertEqualObjects(expectedCommands, [m_fixture takeSubmittedCommandStringsOfClient:analysisClient]);
+
+  // The engine already has the position
+  queryCommand = [GtpCommand command:@"queryA"];
+  [m_fixture.pool submitCommand:queryCommand atBoardSize:19 komi:6.5 handicap:0 moves:[self movesA]];
+  XCTAssertEqualObjects(@"A", [queryCommand.response parsedResponse]);
+  expectedCommands = [NSArray arrayWithObjects:@"queryA", nil];
+  XCTAssertEqualObjects(expectedCommands, [m_fixture takeSubmittedCommandStringsOfClient:analysisClient]);
+
+  // A different position, also with handicap
+  queryCommand = [GtpCommand command:@"queryB"];
+  [m_fixture.pool submitCommand:queryCommand atBoardSize:19 komi:6.5 handicap:2 moves:[self movesB]];
+  XCTAssertEqualObjects(@"B", [queryCommand.response parsedResponse]);
+  expectedCommands = [NSArray arrayWithObjects:@"boardsize 19", @"komi 6.5", @"fixed_handicap 2", playSequenceB, @"queryB", nil];
+  XCTAssertEqualObjects(expectedCommands, [m_fixture takeSubmittedCommandStringsOfClient:analysisClient]);
+
+  // The play engine is not involved
+  XCTAssertEqualObjects([NSArray array], [m_fixture takeSubmittedCommandStringsOfClient:m_fixture.pool.playClient]);
+
+  [self quitPool];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Checks that a query about the position that an analysis engine is
+/// being set up with is not preceded by setup commands, even if the engine
+/// has not yet answered the setup commands.
+// -----------------------------------------------------------------------------
+- (void) testSubmitCommandWhileEngineIsBusy
+{
+  [self setupPoolWithNumberOfAnalysisEngines:1];
+  GtpClient* analysisClient = [m_fixture.pool.analysisClients objectAtIndex:0];
+
+  GtpCommand* slowCommand = [GtpCommand command:@"slow"];
+  slowCommand.gtpClient = analysisClient;
+  slowCommand.waitUntilDone = false;
+  [slowCommand submit];
+
+  GtpCommand* firstQueryCommand = [GtpCommand command:@"queryA"];
+  firstQueryCommand.waitUntilDone = false;
+  [m_fixture.pool submitCommand:firstQueryCommand atBoardSize:19 komi:6.5 handicap:0 moves:[self movesA]];
+  GtpCommand* secondQueryCommand = [GtpCommand command:@"queryA"];
+  [m_fixture.pool submitCommand:secondQueryCommand atBoardSize:19 komi:6.5 handicap:0 moves:[self movesA]];
+  XCTAssertEqualObjects(@"A", [secondQueryCommand.response parsedResponse]);
+
+  NSArray* expectedCommands = [NSArray arrayWithObjects:@"slow", @"boardsize 19", @"komi 6.5", playSequenceA, @"queryA", @"queryA", nil];
+  XCTAssertEqualObjects(expectedCommands, [m_fixture takeSubmittedCommandStringsOfClient:analysisClient]);
+
+  [self quitPool];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Checks that when several threads submit queries about different
+/// positions at the same time, each query reaches the analysis engine
+/// immediately after the commands that set up its position, or after another
+/// query about the same position.
+// -----------------------------------------------------------------------------
+- (void) testConcurrentSubmissionsDoNotInterleave
+{
+  [self setupPoolWithNumberOfAnalysisEngines:1];
+  GtpClient* analysisClient = [m_fixture.pool.analysisClients objectAtIndex:0];
+
+  const size_t numberOfQueries = 40;
+  dispatch_apply(numberOfQueries, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t indexOfQuery) {
+    bool isQueryA = (0 == indexOfQuery % 2);
+    GtpCommand* queryCommand = [GtpCommand command:(isQueryA ? @"queryA" : @"queryB")];
+    queryCommand.waitUntilDone = false;
+    [m_fixture.pool submitCommand:queryCommand
+              atBoardSize:19
+                     komi:6.5
+                 handicap:(isQueryA ? 0 : 2)
+                    moves:(isQueryA ? [self movesA] : [self movesB])];
+  });
+  // Commands are answered in order, so when a synchronous command is complete
+  // all queries are complete, too
+  GtpCommand* fastCommand = [GtpCommand command:@"fast"];
+  fastCommand.gtpClient = analysisClient;
+  [fastCommand submit];
+
+  NSArray* submittedCommands = [m_fixture takeSubmittedCommandStringsOfClient:analysisClient];
+  NSUInteger numberOfSubmittedQueries = 0;
+  NSString* lastPlaySequence = nil;
+  for (NSString* command in submittedCommands)
+  {
+    if ([command hasPrefix:@"gogui-play_sequence"])
+      lastPlaySequence = command;
+    else if ([command isEqualToString:@"queryA"])
+      XCTAssertEqualObjects(playSequenceA, lastPlaySequence);
+    else if ([command isEqualToString:@"queryB"])
+      XCTAssertEqualObjects(playSequenceB, lastPlaySequence);
+    else
+      continue;
+    if ([command hasPrefix:@"query"])
+      ++numberOfSubmittedQueries;
+  }
+  XCTAssertEqual((NSUInteger)numberOfQueries, numberOfSubmittedQueries);
+
+  [self quitPool];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Private helper method of all tests in this class. Sets up a new pool
+/// whose play engine and @a numberOfAnalysisEngines analysis engines are
+/// replay engines, and lets the application delegate use the pool.
+// -----------------------------------------------------------------------------
+- (void) setupPoolWithNumberOfAnalysisEngines:(int)numberOfAnalysisEngines
+{
+  m_fixture = [[GtpReplayEngineFixture alloc] initWithReplayTranscript:replayTranscript
+                                               numberOfAnalysisEngines:numberOfAnalysisEngines];
+  [m_fixture installInDelegate:m_delegate];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Private helper method of all tests in this class. Submits "quit" to
+/// all engines in the pool so that the threads of all clients and engines
+/// end.
+// -----------------------------------------------------------------------------
+- (void) quitPool
+{
+  XCTAssertTrue([m_fixture quit]);
+  [m_fixture release];
+  m_fixture = nil;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Private helper method of all tests in this class. Returns the moves
+/// of the position that "queryA" stands for.
+// -----------------------------------------------------------------------------
+- (NSArray*) movesA
+{
+  return [NSArray arrayWithObjects:@"B D4", nil];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Private helper method of all tests in this class. Returns the moves
+/// of the position that "queryB" stands for. The position has 2 handicap
+/// stones.
+// -----------------------------------------------------------------------------
+- (NSArray*) movesB
+{
+  return [NSArray arrayWithObjects:@"W Q16", @"B Q4", nil];
+}
+
+@end
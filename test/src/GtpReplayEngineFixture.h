@@ -0,0 +1,67 @@
+// -----------------------------------------------------------------------------
+// Copyright 2014 Patrick Näf (herzbube@herzbube.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// -----------------------------------------------------------------------------
+
+
+// Forward declarations
+@class ApplicationDelegate;
+@class GtpClient;
+@class GtpEnginePool;
+
+
+// -----------------------------------------------------------------------------
+/// @brief The GtpReplayEngineFixture class provides unit tests with a
+/// GtpEnginePool whose engines are replay engines (see GtpReplayEngine), and
+/// records the GTP commands that are written to the engines.
+///
+/// All engines answer commands from the same transcript. Each engine owns the
+/// GtpChannel that it uses to communicate with its GtpClient, the channel is
+/// deallocated together with the engine when the fixture is deallocated.
+///
+/// A test typically proceeds like this:
+/// - Create the fixture, and if the code under test uses the GTP engine
+///   through ApplicationDelegate, install the fixture into the application
+///   delegate with installInDelegate:()
+/// - Exercise the code under test, then check the commands returned by
+///   takeSubmittedCommandStrings() or
+///   takeSubmittedCommandStringsOfClient:()
+/// - Invoke quit() so that the threads of all clients and engines end, then
+///   release the fixture
+///
+/// The fixture records a command when GtpClient posts
+/// #gtpCommandWillBeSubmittedNotification for the command, i.e. in the
+/// context of the client's secondary thread. Recording begins when the
+/// fixture is created, and ends when quit() returns. The "quit" commands are
+/// therefore recorded, too.
+// -----------------------------------------------------------------------------
+@interface GtpReplayEngineFixture : NSObject
+{
+}
+
+- (id) initWithReplayTranscript:(NSString*)transcript;
+- (id) initWithReplayTranscript:(NSString*)transcript numberOfAnalysisEngines:(int)numberOfAnalysisEngines;
+- (void) installInDelegate:(ApplicationDelegate*)delegate;
+- (bool) quit;
+- (NSArray*) submittedCommands;
+- (NSArray*) takeSubmittedCommandStrings;
+- (NSArray*) takeSubmittedCommandStringsOfClient:(GtpClient*)client;
+
+/// @brief The pool that contains the play engine and the analysis engines.
+@property(retain, readonly) GtpEnginePool* pool;
+/// @brief The GtpClient of the play engine. This is a shortcut for the
+/// @e playClient property of @e pool.
+@property(nonatomic, assign, readonly) GtpClient* playClient;
+
+@end
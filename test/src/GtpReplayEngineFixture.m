@@ -0,0 +1,244 @@
+// -----------------------------------------------------------------------------
+// Copyright 2014 Patrick Näf (herzbube@herzbube.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// -----------------------------------------------------------------------------
+
+
+
+// Test includes
+#import "GtpReplayEngineFixture.h"
+
+// Application includes
+#import <gtp/GtpClient.h>
+#import <gtp/GtpCommand.h>
+#import <gtp/GtpEngine.h>
+#import <gtp/GtpEnginePool.h>
+#import <gtp/GtpResponse.h>
+#import <main/ApplicationDelegate.h>
+
+
+// -----------------------------------------------------------------------------
+/// @brief Class extension with private properties for GtpReplayEngineFixture.
+// -----------------------------------------------------------------------------
+@interface GtpReplayEngineFixture()
+/// @name Re-declaration of properties to make them readwrite privately
+//@{
+@property(retain, readwrite) GtpEnginePool* pool;
+//@}
+/// @name Private properties
+//@{
+/// @brief The play engine.
+@property(retain) GtpEngine* playEngine;
+/// @brief The application delegate that the fixture is installed into, or nil
+/// if the fixture is not installed.
+@property(assign) ApplicationDelegate* delegate;
+/// @brief The GtpCommand objects that were written to the engines since they
+/// were last taken, in the order in which they were written.
+@property(retain) NSMutableArray* commands;
+//@}
+@end
+
+
+@implementation GtpReplayEngineFixture
+
+// -----------------------------------------------------------------------------
+/// @brief Initializes a GtpReplayEngineFixture object whose pool contains only
+/// a play engine, which answers commands from @a transcript.
+// -----------------------------------------------------------------------------
+- (id) initWithReplayTranscript:(NSString*)transcript
+{
+  return [self initWithReplayTranscript:transcript numberOfAnalysisEngines:0];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Initializes a GtpReplayEngineFixture object whose pool contains a
+/// play engine and @a numberOfAnalysisEngines analysis engines. All engines
+/// answer commands from @a transcript.
+///
+/// @note This is the designated initializer of GtpReplayEngineFixture.
+// -----------------------------------------------------------------------------
+- (id) initWithReplayTranscript:(NSString*)transcript numberOfAnalysisEngines:(int)numberOfAnalysisEngines
+{
+  // Call designated initializer of superclass (NSObject)
+  self = [super init];
+  if (! self)
+    return nil;
+
+  self.delegate = nil;
+  self.commands = [NSMutableArray array];
+  [[NSNotificationCenter defaultCenter] addObserver:self
+                                           selector:@selector(commandWillBeSubmitted:)
+                                               name:gtpCommandWillBeSubmittedNotification
+                                             object:nil];
+
+  GtpEngine* playEngine = [GtpEngine engineWithReplayTranscript:transcript];
+  GtpClient* playClient = [GtpClient clientWithInProcessChannelOfEngine:playEngine];
+  self.playEngine = playEngine;
+  self.pool = [[[GtpEnginePool alloc] initWithPlayClient:playClient playEngine:playEngine] autorelease];
+  for (int indexOfAnalysisEngine = 0; indexOfAnalysisEngine < numberOfAnalysisEngines; ++indexOfAnalysisEngine)
+  {
+    GtpEngine* analysisEngine = [GtpEngine engineWithReplayTranscript:transcript];
+    GtpClient* analysisClient = [GtpClient clientWithInProcessChannelOfEngine:analysisEngine];
+    [self.pool addAnalysisClient:analysisClient analysisEngine:analysisEngine];
+  }
+
+  return self;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Deallocates memory allocated by this GtpReplayEngineFixture object.
+///
+/// If quit() has not been invoked the threads of the clients and engines keep
+/// running, and so do the objects that the threads retain.
+// -----------------------------------------------------------------------------
+- (void) dealloc
+{
+  [[NSNotificationCenter defaultCenter] removeObserver:self];
+  [self uninstallFromDelegate];
+  self.pool = nil;
+  self.playEngine = nil;
+  self.commands = nil;
+  [super dealloc];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns the GtpClient of the play engine.
+// -----------------------------------------------------------------------------
+- (GtpClient*) playClient
+{
+  return self.pool.playClient;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Lets @a delegate use the play engine and the pool of the fixture.
+/// quit() undoes this.
+// -----------------------------------------------------------------------------
+- (void) installInDelegate:(ApplicationDelegate*)delegate
+{
+  delegate.gtpEngine = self.playEngine;
+  delegate.gtpClient = self.pool.playClient;
+  delegate.gtpEnginePool = self.pool;
+  self.delegate = delegate;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Submits "quit" to all engines in the pool so that the threads of
+/// all clients and engines end, then ends the recording of commands and
+/// undoes installInDelegate:(). Returns true if all engines answered "quit"
+/// with success.
+///
+/// Because "quit" is submitted synchronously, all commands that were
+/// submitted before quit() was invoked have been written to the engines when
+/// quit() returns.
+// -----------------------------------------------------------------------------
+- (bool) quit
+{
+  bool success = true;
+  NSArray* clients = [[NSArray arrayWithObject:self.pool.playClient] arrayByAddingObjectsFromArray:self.pool.analysisClients];
+  for (GtpClient* client in clients)
+  {
+    GtpCommand* quitCommand = [GtpCommand command:@"quit"];
+    quitCommand.gtpClient = client;
+    [quitCommand submit];
+    if (! quitCommand.response.status)
+      success = false;
+  }
+  [[NSNotificationCenter defaultCenter] removeObserver:self];
+  [self uninstallFromDelegate];
+  return success;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns the GtpCommand objects that were written to the engines
+/// since the commands were last taken, in the order in which they were
+/// written. The commands remain recorded.
+// -----------------------------------------------------------------------------
+- (NSArray*) submittedCommands
+{
+  @synchronized(self)
+  {
+    return [NSArray arrayWithArray:self.commands];
+  }
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns the command strings of the commands that were written to
+/// any engine since the commands were last taken, in the order in which they
+/// were written. Forgets about the commands.
+// -----------------------------------------------------------------------------
+- (NSArray*) takeSubmittedCommandStrings
+{
+  return [self takeSubmittedCommandStringsOfClient:nil];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Returns the command strings of the commands that were written to
+/// the engine of @a client since the commands were last taken, in the order
+/// in which they were written. Forgets about the commands, but not about
+/// commands that were written to other engines.
+///
+/// If @a client is nil, returns the commands that were written to any
+/// engine. This is the only way to take commands that were submitted
+/// directly to a GtpClient, because those commands do not know their client.
+// -----------------------------------------------------------------------------
+- (NSArray*) takeSubmittedCommandStringsOfClient:(GtpClient*)client
+{
+  NSMutableArray* commandStrings = [NSMutableArray array];
+  @synchronized(self)
+  {
+    NSMutableArray* takenCommands = [NSMutableArray array];
+    for (GtpCommand* command in self.commands)
+    {
+      if (! client || command.gtpClient == client)
+      {
+        [takenCommands addObject:command];
+        [commandStrings addObject:command.command];
+      }
+    }
+    [self.commands removeObjectsInArray:takenCommands];
+  }
+  return commandStrings;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Undoes installInDelegate:(). Does nothing if the fixture is not
+/// installed.
+///
+/// This is a private helper.
+// -----------------------------------------------------------------------------
+- (void) uninstallFromDelegate
+{
+  ApplicationDelegate* delegate = self.delegate;
+  if (! delegate)
+    return;
+  delegate.gtpEnginePool = nil;
+  delegate.gtpClient = nil;
+  delegate.gtpEngine = nil;
+  self.delegate = nil;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Responds to the #gtpCommandWillBeSubmittedNotification, which is
+/// posted in the context of the secondary thread of the client that writes
+/// the command.
+// -----------------------------------------------------------------------------
+- (void) commandWillBeSubmitted:(NSNotification*)notification
+{
+  @synchronized(self)
+  {
+    [self.commands addObject:notification.object];
+  }
+}
+
+@end
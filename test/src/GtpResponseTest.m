@@ -0,0 +1,276 @@
+// -----------------------------------------------------------------------------
+// Copyright 2014 Patrick Näf (herzbube@herzbube.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// -----------------------------------------------------------------------------
+
+
+
+// Test includes
+#import "GtpResponseTest.h"
+
+// Application includes
+#import <go/GoBoard.h>
+#import <go/GoBoardState.h>
+#import <go/GoGame.h>
+#import <gtp/GtpResponse.h>
+
+
+@implementation GtpResponseTest
+
+// -----------------------------------------------------------------------------
+/// @brief Exercises the status() property and the parsedResponse() method.
+// -----------------------------------------------------------------------------
+- (void) testStatus
+{
+  GtpResponse* response = [GtpResponse response:@"= D4" toCommand:nil];
+  XCTAssertTrue(response.status);
+  XCTAssertEqualObjects(@"D4", [response parsedResponse]);
+  response = [GtpResponse response:@"? unknown command" toCommand:nil];
+  XCTAssertFalse(response.status);
+  XCTAssertEqualObjects(@"unknown command", [response parsedResponse]);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Exercises the responseWithBytes:length:toCommand:() convenience
+/// constructor with bytes that are not zero-terminated.
+// -----------------------------------------------------------------------------
+- (void) testResponseWithBytes
+{
+  const char bytes[] = { '=', ' ', 'D', '4', ' ', 'Q', '1', '6', 'x' };
+  GtpResponse* response = [GtpResponse responseWithBytes:bytes length:8 toCommand:nil];
+  XCTAssertTrue(response.status);
+  int numberOfVertices = -1;
+  const struct GoVertexNumeric* vertices = [response verticesWithCount:&numberOfVertices];
+  XCTAssertEqual(2, numberOfVertices);
+  [self checkVertex:vertices[1] x:16 y:16];
+  XCTAssertEqualObjects(@"= D4 Q16", response.rawResponse);
+  XCTAssertEqualObjects(@"D4 Q16", [response parsedResponse]);
+  // The strings are created only once
+  XCTAssertTrue([response parsedResponse] == [response parsedResponse]);
+
+  response = [GtpResponse responseWithBytes:"?" length:1 toCommand:nil];
+  XCTAssertFalse(response.status);
+  XCTAssertEqualObjects(@"", [response parsedResponse]);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Exercises the verticesWithCount:() method with a well-formed vertex
+/// list that uses all of the supported delimiters.
+// -----------------------------------------------------------------------------
+- (void) testVertices
+{
+  GtpResponse* response = [GtpResponse response:@"= D4 q16,T19\nA1\r\n\tJ9" toCommand:nil];
+  int numberOfVertices = -1;
+  const struct GoVertexNumeric* vertices = [response verticesWithCount:&numberOfVertices];
+  XCTAssertEqual(5, numberOfVertices);
+  [self checkVertex:vertices[0] x:4 y:4];
+  [self checkVertex:vertices[1] x:16 y:16];
+  [self checkVertex:vertices[2] x:19 y:19];
+  [self checkVertex:vertices[3] x:1 y:1];
+  // "I" is not used, so "J" is the 9th column
+  [self checkVertex:vertices[4] x:9 y:9];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Exercises the verticesWithCount:() method with tokens that are not
+/// valid vertices.
+// -----------------------------------------------------------------------------
+- (void) testMalformedVertices
+{
+  GtpResponse* response = [GtpResponse response:@"= I5 U1 A0 A20 A D4x 4D pass D4" toCommand:nil];
+  int numberOfVertices = -1;
+  const struct GoVertexNumeric* vertices = [response verticesWithCount:&numberOfVertices];
+  XCTAssertEqual(9, numberOfVertices);
+  for (int indexOfVertex = 0; indexOfVertex < 8; ++indexOfVertex)
+    [self checkVertex:vertices[indexOfVertex] x:0 y:0];
+  [self checkVertex:vertices[8] x:4 y:4];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Exercises the pointIndexesWithBoardState:count:() method.
+// -----------------------------------------------------------------------------
+- (void) testPointIndexes
+{
+  struct GoBoardState* boardState = GoBoardStateCreate(9);
+  GtpResponse* response = [GtpResponse response:@"= A1 J9 K10 xx" toCommand:nil];
+  int numberOfPointIndexes = -1;
+  const int* pointIndexes = [response pointIndexesWithBoardState:boardState count:&numberOfPointIndexes];
+  XCTAssertEqual(4, numberOfPointIndexes);
+  XCTAssertEqual(GoBoardStatePointIndexOfVertex(boardState, 1, 1), pointIndexes[0]);
+  XCTAssertEqual(GoBoardStatePointIndexOfVertex(boardState, 9, 9), pointIndexes[1]);
+  // K10 is a valid vertex, but not on a 9x9 board
+  XCTAssertEqual(-1, pointIndexes[2]);
+  XCTAssertEqual(-1, pointIndexes[3]);
+  GoBoardStateFree(boardState);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Exercises the movesWithCount:() method with a well-formed move list.
+// -----------------------------------------------------------------------------
+- (void) testMoves
+{
+  GtpResponse* response = [GtpResponse response:@"= B D4, W q16, black PASS, white resign" toCommand:nil];
+  int numberOfMoves = -1;
+  const struct GtpResponseMove* moves = [response movesWithCount:&numberOfMoves];
+  XCTAssertEqual(4, numberOfMoves);
+  XCTAssertEqual(GoColorBlack, moves[0].color);
+  XCTAssertEqual(GtpResponseMoveTypePlay, moves[0].type);
+  [self checkVertex:moves[0].vertex x:4 y:4];
+  XCTAssertEqual(GoColorWhite, moves[1].color);
+  XCTAssertEqual(GtpResponseMoveTypePlay, moves[1].type);
+  [self checkVertex:moves[1].vertex x:16 y:16];
+  XCTAssertEqual(GoColorBlack, moves[2].color);
+  XCTAssertEqual(GtpResponseMoveTypePass, moves[2].type);
+  XCTAssertEqual(GoColorWhite, moves[3].color);
+  XCTAssertEqual(GtpResponseMoveTypeResign, moves[3].type);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Exercises the movesWithCount:() method with a move list that
+/// contains an unknown color, an invalid vertex and a color that is not
+/// followed by a vertex.
+// -----------------------------------------------------------------------------
+- (void) testMalformedMoves
+{
+  GtpResponse* response = [GtpResponse response:@"= X D4, B Z99, W" toCommand:nil];
+  int numberOfMoves = -1;
+  const struct GtpResponseMove* moves = [response movesWithCount:&numberOfMoves];
+  XCTAssertEqual(3, numberOfMoves);
+  XCTAssertEqual(GoColorNone, moves[0].color);
+  [self checkVertex:moves[0].vertex x:4 y:4];
+  XCTAssertEqual(GoColorBlack, moves[1].color);
+  XCTAssertEqual(GtpResponseMoveTypePlay, moves[1].type);
+  [self checkVertex:moves[1].vertex x:0 y:0];
+  XCTAssertEqual(GoColorWhite, moves[2].color);
+  XCTAssertEqual(GtpResponseMoveTypePlay, moves[2].type);
+  [self checkVertex:moves[2].vertex x:0 y:0];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Exercises the floatGridWithNumberOfRows:numberOfColumns:() method
+/// with a well-formed grid. Lines without numbers do not form rows.
+// -----------------------------------------------------------------------------
+- (void) testFloatGrid
+{
+  GtpResponse* response = [GtpResponse response:@"= \n 0.5 -1 1e-1\n\n  0 1.25  -0.75\n" toCommand:nil];
+  int numberOfRows = -1;
+  int numberOfColumns = -1;
+  const float* grid = [response floatGridWithNumberOfRows:&numberOfRows numberOfColumns:&numberOfColumns];
+  XCTAssertTrue(grid != NULL);
+  XCTAssertEqual(2, numberOfRows);
+  XCTAssertEqual(3, numberOfColumns);
+  XCTAssertEqual(0.5f, grid[0]);
+  XCTAssertEqual(-1.0f, grid[1]);
+  XCTAssertEqualWithAccuracy(0.1f, grid[2], 0.0001f);
+  XCTAssertEqual(0.0f, grid[3]);
+  XCTAssertEqual(1.25f, grid[4]);
+  XCTAssertEqual(-0.75f, grid[5]);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Exercises the floatGridWithNumberOfRows:numberOfColumns:() method
+/// with grids that contain a token that is not a number, or rows of different
+/// length.
+// -----------------------------------------------------------------------------
+- (void) testMalformedFloatGrid
+{
+  NSArray* malformedResponses = @[@"= 1 2\n3 x", @"= 1 2\n3 4 5", @"= 1 2\n3", @"= 1.5.5"];
+  for (NSString* malformedResponse in malformedResponses)
+  {
+    GtpResponse* response = [GtpResponse response:malformedResponse toCommand:nil];
+    int numberOfRows = -1;
+    int numberOfColumns = -1;
+    const float* grid = [response floatGridWithNumberOfRows:&numberOfRows numberOfColumns:&numberOfColumns];
+    XCTAssertTrue(grid == NULL, @"%@", malformedResponse);
+    XCTAssertEqual(0, numberOfRows, @"%@", malformedResponse);
+    XCTAssertEqual(0, numberOfColumns, @"%@", malformedResponse);
+  }
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Checks that all typed views of an empty response are empty.
+// -----------------------------------------------------------------------------
+- (void) testEmptyResponse
+{
+  NSArray* emptyResponses = @[@"= ", @"= \n\n", @"=  ,\t"];
+  for (NSString* emptyResponse in emptyResponses)
+  {
+    GtpResponse* response = [GtpResponse response:emptyResponse toCommand:nil];
+    int numberOfVertices = -1;
+    XCTAssertTrue([response verticesWithCount:&numberOfVertices] == NULL);
+    XCTAssertEqual(0, numberOfVertices);
+    int numberOfPointIndexes = -1;
+    XCTAssertTrue([response pointIndexesWithBoardState:m_game.board.boardState count:&numberOfPointIndexes] == NULL);
+    XCTAssertEqual(0, numberOfPointIndexes);
+    int numberOfMoves = -1;
+    XCTAssertTrue([response movesWithCount:&numberOfMoves] == NULL);
+    XCTAssertEqual(0, numberOfMoves);
+    int numberOfRows = -1;
+    int numberOfColumns = -1;
+    XCTAssertTrue([response floatGridWithNumberOfRows:&numberOfRows numberOfColumns:&numberOfColumns] == NULL);
+    XCTAssertEqual(0, numberOfRows);
+    XCTAssertEqual(0, numberOfColumns);
+  }
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Checks that the typed views are parsed only once, and that the point
+/// indexes are mapped again when the board size changes.
+// -----------------------------------------------------------------------------
+- (void) testCachedViews
+{
+  GtpResponse* response = [GtpResponse response:@"= D4 E5" toCommand:nil];
+  int numberOfVertices;
+  const struct GoVertexNumeric* vertices1 = [response verticesWithCount:&numberOfVertices];
+  const struct GoVertexNumeric* vertices2 = [response verticesWithCount:&numberOfVertices];
+  XCTAssertTrue(vertices1 == vertices2);
+  XCTAssertEqual(2, numberOfVertices);
+
+  int numberOfMoves;
+  const struct GtpResponseMove* moves1 = [response movesWithCount:&numberOfMoves];
+  const struct GtpResponseMove* moves2 = [response movesWithCount:&numberOfMoves];
+  XCTAssertTrue(moves1 == moves2);
+  // The vertex list view is not affected by parsing a different view
+  XCTAssertTrue(vertices1 == [response verticesWithCount:&numberOfVertices]);
+
+  struct GoBoardState* boardState9 = GoBoardStateCreate(9);
+  struct GoBoardState* otherBoardState9 = GoBoardStateCreate(9);
+  struct GoBoardState* boardState19 = GoBoardStateCreate(19);
+  int numberOfPointIndexes;
+  const int* pointIndexes = [response pointIndexesWithBoardState:boardState9 count:&numberOfPointIndexes];
+  XCTAssertEqual(GoBoardStatePointIndexOfVertex(boardState9, 4, 4), pointIndexes[0]);
+  pointIndexes = [response pointIndexesWithBoardState:otherBoardState9 count:&numberOfPointIndexes];
+  XCTAssertEqual(GoBoardStatePointIndexOfVertex(boardState9, 4, 4), pointIndexes[0]);
+  pointIndexes = [response pointIndexesWithBoardState:boardState19 count:&numberOfPointIndexes];
+  XCTAssertEqual(2, numberOfPointIndexes);
+  XCTAssertEqual(GoBoardStatePointIndexOfVertex(boardState19, 4, 4), pointIndexes[0]);
+  XCTAssertEqual(GoBoardStatePointIndexOfVertex(boardState19, 5, 5), pointIndexes[1]);
+  XCTAssertTrue(GoBoardStatePointIndexOfVertex(boardState9, 4, 4) != pointIndexes[0]);
+  GoBoardStateFree(boardState9);
+  GoBoardStateFree(otherBoardState9);
+  GoBoardStateFree(boardState19);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Private helper method of the tests that exercise vertex and move
+/// lists. Checks that @a vertex has the compounds @a expectedX and
+/// @a expectedY.
+// -----------------------------------------------------------------------------
+- (void) checkVertex:(struct GoVertexNumeric)vertex x:(int)expectedX y:(int)expectedY
+{
+  XCTAssertEqual(expectedX, vertex.x);
+  XCTAssertEqual(expectedY, vertex.y);
+}
+
+@end
@@ -0,0 +1,204 @@
+// -----------------------------------------------------------------------------
+// Copyright 2014 Patrick Näf (herzbube@herzbube.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// -----------------------------------------------------------------------------
+
+
+
+// Test includes
+#import "GtpSearchProgressStreamBufferTest.h"
+
+// Application includes
+#import <gtp/GtpSearchProgress.h>
+#include <gtp/GtpSearchProgressStreamBuffer.h>
+
+// System includes
+#include <ostream>
+#include <string>
+#include <vector>
+
+
+/// @brief A live graphics block as Fuego writes it to its debug stream.
+static const std::string fuegoGfxBlock =
+  "gogui-gfx:\n"
+  "VAR b D4 w Q16 b Q4\n"
+  "TEXT N=1234 V=0.55 Len=3\n"
+  "\n";
+
+
+// -----------------------------------------------------------------------------
+/// @brief Is invoked by GtpSearchProgressStreamBuffer when a live graphics
+/// block is complete. Appends the block to the std::vector that @a context
+/// points to.
+// -----------------------------------------------------------------------------
+static void gfxBlockReceived(const std::string& gfxBlock, void* context)
+{
+  static_cast<std::vector<std::string>*>(context)->push_back(gfxBlock);
+}
+
+
+@implementation GtpSearchProgressStreamBufferTest
+
+// -----------------------------------------------------------------------------
+/// @brief Checks that a block that is written in one piece, surrounded by
+/// other debug output, is extracted and parsed.
+// -----------------------------------------------------------------------------
+- (void) testCompleteBlock
+{
+  std::vector<std::string> gfxBlocks;
+  GtpSearchProgressStreamBuffer streamBuffer(gfxBlockReceived, &gfxBlocks);
+  std::ostream debugStream(&streamBuffer);
+
+  debugStream << "SgUctSearch: start\n" << fuegoGfxBlock << "SgUctSearch: stop\n" << std::flush;
+  XCTAssertEqual((size_t)1, gfxBlocks.size());
+  XCTAssertTrue("VAR b D4 w Q16 b Q4\nTEXT N=1234 V=0.55 Len=3\n" == gfxBlocks[0]);
+  [self checkSearchProgressOfGfxBlock:gfxBlocks[0]];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Checks that a block is delivered only when the empty line that ends
+/// the block has been received.
+// -----------------------------------------------------------------------------
+- (void) testPartialBlock
+{
+  std::vector<std::string> gfxBlocks;
+  GtpSearchProgressStreamBuffer streamBuffer(gfxBlockReceived, &gfxBlocks);
+  std::ostream debugStream(&streamBuffer);
+
+  std::string blockWithoutEnd = fuegoGfxBlock.substr(0, fuegoGfxBlock.size() - 1);
+  debugStream << blockWithoutEnd << std::flush;
+  XCTAssertEqual((size_t)0, gfxBlocks.size());
+  // An incomplete empty line does not end the block either
+  debugStream << "\r" << std::flush;
+  XCTAssertEqual((size_t)0, gfxBlocks.size());
+  debugStream << "\n" << std::flush;
+  XCTAssertEqual((size_t)1, gfxBlocks.size());
+  [self checkSearchProgressOfGfxBlock:gfxBlocks[0]];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Checks that a block is extracted no matter where it is split into
+/// two xsputn() calls, including a split in the middle of the start line.
+// -----------------------------------------------------------------------------
+- (void) testBlockSplitAcrossWrites
+{
+  for (size_t splitIndex = 1; splitIndex < fuegoGfxBlock.size(); ++splitIndex)
+  {
+    std::vector<std::string> gfxBlocks;
+    GtpSearchProgressStreamBuffer streamBuffer(gfxBlockReceived, &gfxBlocks);
+    std::ostream debugStream(&streamBuffer);
+
+    debugStream.write(fuegoGfxBlock.data(), splitIndex);
+    debugStream.flush();
+    XCTAssertEqual((size_t)0, gfxBlocks.size());
+    debugStream.write(fuegoGfxBlock.data() + splitIndex, fuegoGfxBlock.size() - splitIndex);
+    debugStream.flush();
+    XCTAssertEqual((size_t)1, gfxBlocks.size());
+    if (1 == gfxBlocks.size())
+      [self checkSearchProgressOfGfxBlock:gfxBlocks[0]];
+  }
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Checks that a block is extracted if each character arrives in a
+/// separate overflow() call, and that the same block can then be mixed with
+/// an xsputn() call.
+// -----------------------------------------------------------------------------
+- (void) testBlockWrittenCharacterByCharacter
+{
+  std::vector<std::string> gfxBlocks;
+  GtpSearchProgressStreamBuffer streamBuffer(gfxBlockReceived, &gfxBlocks);
+  std::ostream debugStream(&streamBuffer);
+
+  for (std::string::const_iterator it = fuegoGfxBlock.begin(); it != fuegoGfxBlock.end(); ++it)
+    debugStream.put(*it);
+  debugStream.flush();
+  XCTAssertEqual((size_t)1, gfxBlocks.size());
+  [self checkSearchProgressOfGfxBlock:gfxBlocks[0]];
+
+  // The first half character by character, the second half in one piece
+  size_t splitIndex = fuegoGfxBlock.size() / 2;
+  for (size_t indexOfCharacter = 0; indexOfCharacter < splitIndex; ++indexOfCharacter)
+    debugStream.put(fuegoGfxBlock[indexOfCharacter]);
+  debugStream.write(fuegoGfxBlock.data() + splitIndex, fuegoGfxBlock.size() - splitIndex);
+  debugStream.flush();
+  XCTAssertEqual((size_t)2, gfxBlocks.size());
+  XCTAssertTrue(gfxBlocks[0] == gfxBlocks[1]);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Checks that consecutive blocks, blocks with CR/LF line endings and
+/// debug output that resembles the start of a block are handled correctly.
+// -----------------------------------------------------------------------------
+- (void) testInterleavedOutput
+{
+  std::vector<std::string> gfxBlocks;
+  GtpSearchProgressStreamBuffer streamBuffer(gfxBlockReceived, &gfxBlocks);
+  std::ostream debugStream(&streamBuffer);
+
+  debugStream << "gogui-gfx: is not a start line\n"
+              << "gogui-gfx:but neither is this much longer line\n"
+              << "VAR b A1\n"
+              << "\n"
+              << fuegoGfxBlock
+              << "gogui-gfx:\r\n"
+              << "TEXT N=99\r\n"
+              << "\r\n"
+              << "SgUctSearch: stop\n"
+              << "gogui-gfx:\n"
+              << "VAR w pass\n"
+              << "\n"
+              << std::flush;
+  XCTAssertEqual((size_t)3, gfxBlocks.size());
+  if (3 != gfxBlocks.size())
+    return;
+  [self checkSearchProgressOfGfxBlock:gfxBlocks[0]];
+
+  GtpSearchProgress* searchProgress = [self searchProgressWithGfxBlock:gfxBlocks[1]];
+  XCTAssertEqual((NSUInteger)0, searchProgress.principalVariation.count);
+  XCTAssertNil(searchProgress.bestMove);
+  XCTAssertEqual(99ull, searchProgress.numberOfSimulations);
+  XCTAssertEqual(-1.0f, searchProgress.winningProbability);
+
+  searchProgress = [self searchProgressWithGfxBlock:gfxBlocks[2]];
+  NSArray* expectedPrincipalVariation = [NSArray arrayWithObjects:@"W PASS", nil];
+  XCTAssertEqualObjects(expectedPrincipalVariation, searchProgress.principalVariation);
+  XCTAssertEqualObjects(@"PASS", searchProgress.bestMove);
+  XCTAssertEqual(0ull, searchProgress.numberOfSimulations);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Private helper method of all tests in this class. Returns a
+/// GtpSearchProgress object that is created from @a gfxBlock.
+// -----------------------------------------------------------------------------
+- (GtpSearchProgress*) searchProgressWithGfxBlock:(const std::string&)gfxBlock
+{
+  return [GtpSearchProgress searchProgressWithGfxBlock:[NSString stringWithUTF8String:gfxBlock.c_str()]];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Private helper method of all tests in this class. Checks that
+/// @a gfxBlock contains the information of the static block #fuegoGfxBlock.
+// -----------------------------------------------------------------------------
+- (void) checkSearchProgressOfGfxBlock:(const std::string&)gfxBlock
+{
+  GtpSearchProgress* searchProgress = [self searchProgressWithGfxBlock:gfxBlock];
+  NSArray* expectedPrincipalVariation = [NSArray arrayWithObjects:@"B D4", @"W Q16", @"B Q4", nil];
+  XCTAssertEqualObjects(expectedPrincipalVariation, searchProgress.principalVariation);
+  XCTAssertEqualObjects(@"D4", searchProgress.bestMove);
+  XCTAssertEqual(1234ull, searchProgress.numberOfSimulations);
+  XCTAssertEqualWithAccuracy(0.55f, searchProgress.winningProbability, 0.0001f);
+}
+
+@end
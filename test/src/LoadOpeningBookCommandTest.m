@@ -0,0 +1,201 @@
+// -----------------------------------------------------------------------------
+// Copyright 2014 Patrick Näf (herzbube@herzbube.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// -----------------------------------------------------------------------------
+
+
+
+// Test includes
+#import "LoadOpeningBookCommandTest.h"
+#import "GtpReplayEngineFixture.h"
+
+// Application includes
+#import <command/gtp/LoadOpeningBookCommand.h>
+#import <gtp/GtpCommand.h>
+#import <main/ApplicationDelegate.h>
+
+
+/// @brief The maximum time (in seconds) that a test waits for the response to
+/// "book_load" to be handled.
+static const NSTimeInterval maximumWaitTime = 2.0;
+
+
+@implementation LoadOpeningBookCommandTest
+
+// -----------------------------------------------------------------------------
+/// @brief Checks that "book_load" reaches the GTP engine before commands that
+/// the same thread submits after LoadOpeningBookCommand, even if the engine
+/// takes a while to load the opening book, and that the link to the opening
+/// book file is removed when the engine has responded.
+// -----------------------------------------------------------------------------
+- (void) testBookLoadPrecedesLaterCommands
+{
+  NSString* bookLoadCommand = [@"book_load " stringByAppendingString:[self bookLinkPath]];
+  NSString* transcript = [NSString stringWithFormat:@"# latency book_load 0.5 0.0\n%@\n=\n\nboardsize 19\n=\n\n", bookLoadCommand];
+  [self setupEngineWithReplayTranscript:transcript];
+
+  // Startup runs LoadOpeningBookCommand in a secondary thread, while the main
+  // thread keeps running
+  __block bool setupDone = false;
+  __block bool bookLoadSubmitted = false;
+  dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+    NSAutoreleasePool* pool = [[NSAutoreleasePool alloc] init];
+    bookLoadSubmitted = [[[[LoadOpeningBookCommand alloc] init] autorelease] submit];
+    GtpCommand* command = [GtpCommand command:@"boardsize 19"];
+    command.waitUntilDone = false;
+    [command submit];
+    [pool drain];
+    setupDone = true;
+  });
+  NSDate* giveUpDate = [NSDate dateWithTimeIntervalSinceNow:maximumWaitTime];
+  while (! setupDone && [giveUpDate timeIntervalSinceNow] > 0)
+  {
+    [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode
+                             beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.05]];
+  }
+  XCTAssertTrue(setupDone);
+  [self waitForRemovalOfLink];
+  XCTAssertTrue(bookLoadSubmitted);
+  XCTAssertFalse([self linkExists]);
+
+  XCTAssertTrue([m_fixture quit]);
+  NSArray* expectedCommands = [NSArray arrayWithObjects:bookLoadCommand, @"boardsize 19", @"quit", nil];
+  XCTAssertEqualObjects(expectedCommands, [m_fixture takeSubmittedCommandStrings]);
+  [self tearDownEngine];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Checks that LoadOpeningBookCommand, when it runs in a secondary
+/// thread, submits "book_load" without the help of the main thread, so that it
+/// does not deadlock while the main thread waits for it.
+// -----------------------------------------------------------------------------
+- (void) testBookLoadDoesNotWaitForMainThread
+{
+  NSString* bookLoadCommand = [@"book_load " stringByAppendingString:[self bookLinkPath]];
+  NSString* transcript = [NSString stringWithFormat:@"%@\n=\n\n", bookLoadCommand];
+  [self setupEngineWithReplayTranscript:transcript];
+
+  // The main thread blocks without running its run loop
+  dispatch_semaphore_t submitDone = dispatch_semaphore_create(0);
+  __block bool bookLoadSubmitted = false;
+  dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+    NSAutoreleasePool* pool = [[NSAutoreleasePool alloc] init];
+    bookLoadSubmitted = [[[[LoadOpeningBookCommand alloc] init] autorelease] submit];
+    [pool drain];
+    dispatch_semaphore_signal(submitDone);
+  });
+  dispatch_time_t giveUpTime = dispatch_time(DISPATCH_TIME_NOW, (int64_t)(maximumWaitTime * NSEC_PER_SEC));
+  XCTAssertEqual(0L, dispatch_semaphore_wait(submitDone, giveUpTime));
+  dispatch_release(submitDone);
+  XCTAssertTrue(bookLoadSubmitted);
+  [self waitForRemovalOfLink];
+  XCTAssertFalse([self linkExists]);
+
+  XCTAssertTrue([m_fixture quit]);
+  NSArray* expectedCommands = [NSArray arrayWithObjects:bookLoadCommand, @"quit", nil];
+  XCTAssertEqualObjects(expectedCommands, [m_fixture takeSubmittedCommandStrings]);
+  [self tearDownEngine];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Checks that the link to the opening book file is removed if the GTP
+/// engine fails to load the opening book.
+// -----------------------------------------------------------------------------
+- (void) testLinkIsRemovedAfterFailure
+{
+  NSString* bookLoadCommand = [@"book_load " stringByAppendingString:[self bookLinkPath]];
+  NSString* transcript = [NSString stringWithFormat:@"%@\n? Invalid file format\n\n", bookLoadCommand];
+  [self setupEngineWithReplayTranscript:transcript];
+
+  // Failure to load the opening book does not fail the command
+  XCTAssertTrue([[[[LoadOpeningBookCommand alloc] init] autorelease] submit]);
+  [self waitForRemovalOfLink];
+  XCTAssertFalse([self linkExists]);
+
+  XCTAssertTrue([m_fixture quit]);
+  NSArray* expectedCommands = [NSArray arrayWithObjects:bookLoadCommand, @"quit", nil];
+  XCTAssertEqualObjects(expectedCommands, [m_fixture takeSubmittedCommandStrings]);
+  [self tearDownEngine];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Private helper method of all tests in this class. Sets up the
+/// application delegate with a replay engine that answers commands from
+/// @a transcript, and with a
+/// resource bundle that contains an opening book file. The bundle's path
+/// contains a space, like the path of the application bundle.
+// -----------------------------------------------------------------------------
+- (void) setupEngineWithReplayTranscript:(NSString*)transcript
+{
+  NSFileManager* fileManager = [NSFileManager defaultManager];
+  m_bookFolderPath = [[NSTemporaryDirectory() stringByAppendingPathComponent:@"Opening Book"] retain];
+  [fileManager createDirectoryAtPath:m_bookFolderPath withIntermediateDirectories:YES attributes:nil error:nil];
+  NSString* bookFilePath = [m_bookFolderPath stringByAppendingPathComponent:openingBookResource];
+  XCTAssertTrue([fileManager createFileAtPath:bookFilePath contents:[@"19 D4|\n" dataUsingEncoding:NSUTF8StringEncoding] attributes:nil]);
+  m_delegate.resourceBundle = [NSBundle bundleWithPath:m_bookFolderPath];
+  // Any leftover from a previous test run must not affect the test
+  [fileManager removeItemAtPath:[self bookLinkPath] error:nil];
+
+  m_fixture = [[GtpReplayEngineFixture alloc] initWithReplayTranscript:transcript];
+  [m_fixture installInDelegate:m_delegate];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Private helper method of all tests in this class. Undoes what
+/// setupEngineWithReplayTranscript:() did.
+// -----------------------------------------------------------------------------
+- (void) tearDownEngine
+{
+  [m_fixture release];
+  m_fixture = nil;
+  [[NSFileManager defaultManager] removeItemAtPath:m_bookFolderPath error:nil];
+  [m_bookFolderPath release];
+  m_bookFolderPath = nil;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Private helper method of all tests in this class. Returns the path
+/// of the link to the opening book file that LoadOpeningBookCommand creates.
+// -----------------------------------------------------------------------------
+- (NSString*) bookLinkPath
+{
+  return [NSTemporaryDirectory() stringByAppendingPathComponent:openingBookResource];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Private helper method of all tests in this class. Returns true if
+/// the link to the opening book file exists. Does not follow the link.
+// -----------------------------------------------------------------------------
+- (bool) linkExists
+{
+  return (nil != [[NSFileManager defaultManager] attributesOfItemAtPath:[self bookLinkPath] error:nil]);
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Private helper method of all tests in this class. Runs the run loop
+/// of the current thread, so that the response to "book_load" can be
+/// delivered, until the link to the opening book file has been removed. Gives
+/// up after #maximumWaitTime.
+// -----------------------------------------------------------------------------
+- (void) waitForRemovalOfLink
+{
+  NSDate* giveUpDate = [NSDate dateWithTimeIntervalSinceNow:maximumWaitTime];
+  while ([self linkExists] && [giveUpDate timeIntervalSinceNow] > 0)
+  {
+    [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode
+                             beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.05]];
+  }
+}
+
+@end
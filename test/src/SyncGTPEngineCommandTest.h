@@ -0,0 +1,47 @@
+// -----------------------------------------------------------------------------
+// Copyright 2014 Patrick Näf (herzbube@herzbube.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// -----------------------------------------------------------------------------
+
+
+
+// Project includes
+#import "BaseTestCase.h"
+
+// Forward declarations
+@class GtpReplayEngineFixture;
+
+
+// -----------------------------------------------------------------------------
+/// @brief The SyncGTPEngineCommandTest class contains unit tests that exercise
+/// the SyncGTPEngineCommand class.
+///
+/// The tests use GtpReplayEngine as the GTP engine, and check which GTP
+/// commands SyncGTPEngineCommand submits to bring the engine in sync with the
+/// GoGame.
+// -----------------------------------------------------------------------------
+@interface SyncGTPEngineCommandTest : BaseTestCase
+{
+@private
+  GtpReplayEngineFixture* m_fixture;
+}
+
+- (void) testFullSync;
+- (void) testAppendMoves;
+- (void) testUndoMoves;
+- (void) testUndoThenPlay;
+- (void) testKomiChangeForcesFullSync;
+- (void) testBoardSizeChangeForcesFullSync;
+
+@end
@@ -0,0 +1,221 @@
+// -----------------------------------------------------------------------------
+// Copyright 2014 Patrick Näf (herzbube@herzbube.ch)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// -----------------------------------------------------------------------------
+
+
+
+// Test includes
+#import "SyncGTPEngineCommandTest.h"
+#import "GtpReplayEngineFixture.h"
+
+// Application includes
+#import <command/boardposition/SyncGTPEngineCommand.h>
+#import <go/GoBoard.h>
+#import <go/GoBoardPosition.h>
+#import <go/GoGame.h>
+#import <gtp/GtpCommand.h>
+
+
+/// @brief The transcript that the replay engine answers commands from. Every
+/// command that the tests expect SyncGTPEngineCommand to submit must appear in
+/// the transcript, otherwise the replay engine answers with an error.
+static NSString* replayTranscript =
+  @"boardsize 9\n=\n\n"
+  @"boardsize 19\n=\n\n"
+  @"komi 6.5\n=\n\n"
+  @"komi 7.5\n=\n\n"
+  @"clear_board\n=\n\n"
+  @"undo\n=\n\n"
+  @"play B R3\n=\n\n"
+  @"gogui-play_sequence B D4 W Q16\n=\n\n"
+  @"gogui-play_sequence B D4 W Q16 B Q4\n=\n\n"
+  @"gogui-play_sequence B Q4\n=\n\n";
+
+
+@implementation SyncGTPEngineCommandTest
+
+// -----------------------------------------------------------------------------
+/// @brief Checks that the first synchronization sets up the GTP engine from
+/// scratch, because the content of the engine's board is unknown.
+// -----------------------------------------------------------------------------
+- (void) testFullSync
+{
+  [self setupReplayEngine];
+  [self playMoves:[NSArray arrayWithObjects:@"D4", @"Q16", nil]];
+
+  NSArray* expectedCommands = [NSArray arrayWithObjects:
+                               @"boardsize 19",
+                               @"komi 6.5",
+                               @"clear_board",
+                               @"gogui-play_sequence B D4 W Q16",
+                               nil];
+  XCTAssertEqualObjects(expectedCommands, [self commandsSubmittedBySync]);
+  // The engine is now in sync
+  XCTAssertEqualObjects([NSArray array], [self commandsSubmittedBySync]);
+
+  [self quitReplayEngine];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Checks that only the new moves are played if moves were appended
+/// to the game.
+// -----------------------------------------------------------------------------
+- (void) testAppendMoves
+{
+  [self setupReplayEngine];
+  [self playMoves:[NSArray arrayWithObjects:@"D4", @"Q16", nil]];
+  [self commandsSubmittedBySync];
+
+  [self playMoves:[NSArray arrayWithObjects:@"Q4", nil]];
+  NSArray* expectedCommands = [NSArray arrayWithObjects:@"gogui-play_sequence B Q4", nil];
+  XCTAssertEqualObjects(expectedCommands, [self commandsSubmittedBySync]);
+
+  [self quitReplayEngine];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Checks that moves are taken back if the current board position is
+/// changed to an earlier board position, and that they are played again when
+/// the current board position is changed back.
+// -----------------------------------------------------------------------------
+- (void) testUndoMoves
+{
+  [self setupReplayEngine];
+  [self playMoves:[NSArray arrayWithObjects:@"D4", @"Q16", @"Q4", nil]];
+  [self commandsSubmittedBySync];
+
+  m_game.boardPosition.currentBoardPosition = 2;
+  NSArray* expectedCommands = [NSArray arrayWithObjects:@"undo", nil];
+  XCTAssertEqualObjects(expectedCommands, [self commandsSubmittedBySync]);
+
+  m_game.boardPosition.currentBoardPosition = 3;
+  expectedCommands = [NSArray arrayWithObjects:@"gogui-play_sequence B Q4", nil];
+  XCTAssertEqualObjects(expectedCommands, [self commandsSubmittedBySync]);
+
+  [self quitReplayEngine];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Checks that if the GTP engine's moves diverge from the game's
+/// moves, only the divergent moves are taken back and replaced.
+// -----------------------------------------------------------------------------
+- (void) testUndoThenPlay
+{
+  [self setupReplayEngine];
+  [self playMoves:[NSArray arrayWithObjects:@"D4", @"Q16", @"Q4", nil]];
+  [self commandsSubmittedBySync];
+
+  // Make the engine's last move differ from the game's last move
+  [[GtpCommand command:@"undo"] submit];
+  [[GtpCommand command:@"play B R3"] submit];
+  NSArray* expectedCommands = [NSArray arrayWithObjects:@"undo", @"gogui-play_sequence B Q4", nil];
+  XCTAssertEqualObjects(expectedCommands, [self commandsSubmittedBySync]);
+
+  [self quitReplayEngine];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Checks that a komi change causes the GTP engine to be set up from
+/// scratch, even if the moves are the same.
+// -----------------------------------------------------------------------------
+- (void) testKomiChangeForcesFullSync
+{
+  [self setupReplayEngine];
+  [self playMoves:[NSArray arrayWithObjects:@"D4", @"Q16", @"Q4", nil]];
+  [self commandsSubmittedBySync];
+
+  m_game.komi = 7.5;
+  NSArray* expectedCommands = [NSArray arrayWithObjects:
+                               @"boardsize 19",
+                               @"komi 7.5",
+                               @"clear_board",
+                               @"gogui-play_sequence B D4 W Q16 B Q4",
+                               nil];
+  XCTAssertEqualObjects(expectedCommands, [self commandsSubmittedBySync]);
+
+  [self quitReplayEngine];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Checks that the GTP engine is set up from scratch if its board size
+/// differs from the game's board size.
+// -----------------------------------------------------------------------------
+- (void) testBoardSizeChangeForcesFullSync
+{
+  [self setupReplayEngine];
+  [self playMoves:[NSArray arrayWithObjects:@"D4", @"Q16", nil]];
+  [self commandsSubmittedBySync];
+
+  // The engine's board is empty and known, but has the wrong size
+  [[GtpCommand command:@"boardsize 9"] submit];
+  [[GtpCommand command:@"clear_board"] submit];
+  NSArray* expectedCommands = [NSArray arrayWithObjects:
+                               @"boardsize 19",
+                               @"komi 6.5",
+                               @"clear_board",
+                               @"gogui-play_sequence B D4 W Q16",
+                               nil];
+  XCTAssertEqualObjects(expectedCommands, [self commandsSubmittedBySync]);
+
+  [self quitReplayEngine];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Private helper method of all tests in this class. Lets the
+/// application delegate use a new replay engine as the play engine, and sets
+/// up the game with komi 6.5.
+// -----------------------------------------------------------------------------
+- (void) setupReplayEngine
+{
+  m_fixture = [[GtpReplayEngineFixture alloc] initWithReplayTranscript:replayTranscript];
+  [m_fixture installInDelegate:m_delegate];
+  m_game.komi = 6.5;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Private helper method of all tests in this class. Submits "quit" so
+/// that both the client's and the replay engine's threads end.
+// -----------------------------------------------------------------------------
+- (void) quitReplayEngine
+{
+  XCTAssertTrue([m_fixture quit]);
+  [m_fixture release];
+  m_fixture = nil;
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Private helper method of all tests in this class. Plays the moves
+/// at the vertexes in @a vertexes, alternating between black and white.
+// -----------------------------------------------------------------------------
+- (void) playMoves:(NSArray*)vertexes
+{
+  for (NSString* vertex in vertexes)
+    [m_game play:[m_game.board pointAtVertex:vertex]];
+}
+
+// -----------------------------------------------------------------------------
+/// @brief Private helper method of all tests in this class. Executes
+/// SyncGTPEngineCommand and returns the GTP commands that it submitted.
+// -----------------------------------------------------------------------------
+- (NSArray*) commandsSubmittedBySync
+{
+  [m_fixture takeSubmittedCommandStrings];
+  bool success = [[[[SyncGTPEngineCommand alloc] init] autorelease] submit];
+  XCTAssertTrue(success);
+  // All commands have been answered, so all notifications have been posted
+  return [m_fixture takeSubmittedCommandStrings];
+}
+
+@end